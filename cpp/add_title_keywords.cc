@@ -23,12 +23,14 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <vector>
 #include <cstdlib>
 #include <cstring>
 #include "MARC.h"
 #include "StringUtil.h"
-#include "TextUtil.h"
+#include "TextAnalysis.h"
 #include "util.h"
 
 
@@ -43,43 +45,6 @@ namespace {
 }
 
 
-void LoadStopwords(const bool verbose, File * const input, std::unordered_set<std::string> * const stopwords_set) {
-    if (verbose)
-        std::cout << "Starting loading of stopwords.\n";
-
-    unsigned count(0);
-    while (not input->eof()) {
-        const std::string line(input->getline());
-        if (line.empty() or line[0] == ';') // Empty or comment line?
-            continue;
-
-        stopwords_set->insert(TextUtil::UTF8ToLower(line));
-        ++count;
-    }
-
-    if (verbose)
-        std::cerr << "Read " << count << " stopwords.\n";
-}
-
-
-void LowercaseSet(std::unordered_set<std::string> * const words) {
-    std::unordered_set<std::string> lowercase_set;
-    for (const auto &word : *words)
-        lowercase_set.insert(TextUtil::UTF8ToLower(word));
-    std::swap(lowercase_set, *words);
-}
-
-
-void FilterOutStopwords(const std::unordered_set<std::string> &stopwords, std::unordered_set<std::string> * const words) {
-    for (std::unordered_set<std::string>::iterator word(words->begin()); word != words->end(); /* Empty! */) {
-        if (stopwords.find(*word) != stopwords.end())
-            word = words->erase(word);
-        else
-            ++word;
-    }
-}
-
-
 bool HasExpertAssignedKeywords(const MARC::Record &record) {
     const std::vector<std::string> keyword_fields{ "600", "610", "611", "630", "648", "650", "651", "653", "655", "656", "689" };
     for (const auto &keyword_field : keyword_fields) {
@@ -92,11 +57,12 @@ bool HasExpertAssignedKeywords(const MARC::Record &record) {
 
 
 void AugmentKeywordsWithTitleWords(const bool verbose, MARC::Reader * const marc_reader, MARC::Writer * const marc_writer,
-                                   const std::map<std::string, std::unordered_set<std::string>> &language_codes_to_stopword_sets) {
+                                   TextAnalysis::Pipeline * const text_analysis_pipeline) {
     if (verbose)
         std::cerr << "Starting augmentation of stopwords.\n";
 
     unsigned total_count(0), augment_count(0), title_count(0);
+    std::vector<std::string_view> title_tokens;
     while (MARC::Record record = marc_reader->read()) {
         ++total_count;
 
@@ -125,16 +91,9 @@ void AugmentKeywordsWithTitleWords(const bool verbose, MARC::Reader * const marc
 
         ++title_count;
 
-        std::unordered_set<std::string> title_words;
-        TextUtil::ChopIntoWords(title, &title_words, /* min_word_length = */ 3);
-        LowercaseSet(&title_words);
-
         const std::string &language_code(MARC::GetLanguageCode(record));
-        const auto code_and_stopwords(language_codes_to_stopword_sets.find(language_code));
-        if (code_and_stopwords != language_codes_to_stopword_sets.end())
-            FilterOutStopwords(code_and_stopwords->second, &title_words);
-        if (language_code != "eng") // Hack, because people suck at cataloging!
-            FilterOutStopwords(language_codes_to_stopword_sets.find("eng")->second, &title_words);
+        text_analysis_pipeline->analyse(title, language_code, &title_tokens);
+        const std::unordered_set<std::string_view> title_words(title_tokens.cbegin(), title_tokens.cend());
 
         if (title_words.empty()) {
             marc_writer->write(record);
@@ -174,24 +133,19 @@ int Main(int argc, char **argv) {
     auto marc_writer(MARC::Writer::Factory(marc_output_filename));
 
     // Read optional stopword lists:
-    std::map<std::string, std::unordered_set<std::string>> language_codes_to_stopword_sets;
+    TextAnalysis::Pipeline text_analysis_pipeline(/* min_word_length = */ 3);
     for (int arg_no(verbose ? 4 : 3); arg_no < argc; ++arg_no) {
         const std::string stopwords_filename(argv[arg_no]);
         if (stopwords_filename.length() != 13 or not StringUtil::StartsWith(stopwords_filename, "stopwords."))
             LOG_ERROR("Invalid stopwords filename \"" + stopwords_filename + "\"!");
-        const std::string language_code(stopwords_filename.substr(10));
-        File stopwords(stopwords_filename, "r");
-        if (not stopwords)
-            LOG_ERROR("can't open \"" + stopwords_filename + "\" for reading!");
-        std::unordered_set<std::string> stopwords_set;
-        LoadStopwords(verbose, &stopwords, &stopwords_set);
-        language_codes_to_stopword_sets[language_code] = stopwords_set;
+        text_analysis_pipeline.loadStopwords(stopwords_filename.substr(10), stopwords_filename);
     }
 
     // We always need English because librarians suck at specifying English:
-    if (language_codes_to_stopword_sets.find("eng") == language_codes_to_stopword_sets.end())
+    if (not text_analysis_pipeline.hasStopwords("eng"))
         LOG_ERROR("You always need to provide \"stopwords.eng\"!");
+    text_analysis_pipeline.setAdditionalStopwordsLanguage("eng"); // Hack, because people suck at cataloging!
 
-    AugmentKeywordsWithTitleWords(verbose, marc_reader.get(), marc_writer.get(), language_codes_to_stopword_sets);
+    AugmentKeywordsWithTitleWords(verbose, marc_reader.get(), marc_writer.get(), &text_analysis_pipeline);
     return EXIT_SUCCESS;
 }
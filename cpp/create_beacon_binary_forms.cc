@@ -0,0 +1,48 @@
+/** \file    create_beacon_binary_forms.cc
+ *  \brief   Stores BEACON files in the binary form that BeaconFile loads w/o parsing them.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include "BeaconFile.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("beacon_file1 [beacon_file2 .. beacon_fileN]\n"
+            "Parses each BEACON file and stores the result next to it, e.g. in \"x.beacon.bin\" for \"x.beacon\".\n"
+            "The binary form will be ignored once the BEACON file changes.");
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc < 2)
+        Usage();
+
+    for (int arg_no(1); arg_no < argc; ++arg_no)
+        BeaconFile::CreateBinaryForm(argv[arg_no]);
+
+    return EXIT_SUCCESS;
+}
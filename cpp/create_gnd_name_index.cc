@@ -0,0 +1,48 @@
+/** \file    create_gnd_name_index.cc
+ *  \brief   Creates the local index that maps person names to GND numbers.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdlib>
+#include "GNDNameIndex.h"
+#include "MARC.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("authority_records [index_path]\n"
+            "Indexes the preferred and variant names of all persons in \"authority_records\".\n"
+            "\"index_path\" defaults to " + GNDNameIndex::DEFAULT_INDEX_PATH + " which is where BSZUtil and LobidUtil look for it.");
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 2 and argc != 3)
+        Usage();
+
+    const auto authority_reader(MARC::Reader::Factory(argv[1]));
+    GNDNameIndex::Build(authority_reader.get(), argc == 3 ? argv[2] : GNDNameIndex::DEFAULT_INDEX_PATH);
+
+    return EXIT_SUCCESS;
+}
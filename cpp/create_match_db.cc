@@ -18,14 +18,22 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <iostream>
+#include <numeric>
 #include <set>
+#include <thread>
 #include <unordered_set>
 #include <cctype>
 #include <cstdlib>
+#include <cstring>
 #include "BSZUtil.h"
 #include "Compiler.h"
 #include "ControlNumberGuesser.h"
+#include "FileUtil.h"
 #include "MARC.h"
+#include "MiscUtil.h"
+#include "StringUtil.h"
+#include "ThreadUtil.h"
+#include "WallClockTimer.h"
 #include "util.h"
 
 
@@ -33,48 +41,64 @@ namespace {
 
 
 [[noreturn]] void Usage() {
-    std::cerr << "Usage: " << ::progname << " [--min-log-level=min_verbosity] marc_titles\n";
+    std::cerr << "Usage: " << ::progname << " [--min-log-level=min_verbosity] [--bulk-load [--thread-count=count] [--buffer-size=MiB]\n"
+              << "       [--spill-directory=path]] marc_titles\n"
+              << "       With \"--bulk-load\" the records are normalised on \"count\" threads, the results are sorted externally\n"
+              << "       and each table is loaded in a single pass.  The thread count defaults to the number of CPU cores.\n"
+              << "       At most \"MiB\" mebibytes of keys, 4096 by default, are kept in memory by all threads together, the rest is\n"
+              << "       spilled to sorted runs in \"path\", which defaults to $TMPDIR or /tmp if TMPDIR is not set.\n"
+              << "       The database is built next to the live one and only replaces it if everything went well.\n";
     std::exit(EXIT_FAILURE);
 }
 
 
-void PopulateTables(ControlNumberGuesser * const control_number_guesser, MARC::Reader * const reader) {
-    control_number_guesser->clearDatabase();
-    control_number_guesser->beginUpdate();
+// Works w/ ControlNumberGuesser as well as ControlNumberGuesser::KeyCollector.
+// \return False if "record" has an empty title, o/w true.
+template <typename Inserter>
+bool InsertRecord(const MARC::Record &record, Inserter * const inserter) {
+    const auto control_number(record.getControlNumber());
 
-    unsigned processed_record_count(0), records_with_empty_titles(0);
-    while (const auto record = reader->read()) {
-        ++processed_record_count;
-        const auto control_number(record.getControlNumber());
+    const std::map<std::string, std::string> author_names_and_ppns(record.getAllAuthorsAndPPNs());
+    std::set<std::string> author_names;
+    for (const auto &author_name_and_ppn : author_names_and_ppns)
+        author_names.emplace(author_name_and_ppn.first);
+    inserter->insertAuthors(author_names, control_number);
 
-        const std::map<std::string, std::string> author_names_and_ppns(record.getAllAuthorsAndPPNs());
-        std::set<std::string> author_names;
-        for (const auto &author_name_and_ppn : author_names_and_ppns)
-            author_names.emplace(author_name_and_ppn.first);
-        control_number_guesser->insertAuthors(author_names, control_number);
+    const auto title(record.getCompleteTitle());
+    const bool has_title(not title.empty());
+    if (unlikely(not has_title))
+        LOG_DEBUG("Empty title in record w/ control number: " + control_number);
+    else
+        inserter->insertTitle(title, control_number);
 
-        const auto title(record.getCompleteTitle());
-        if (unlikely(title.empty())) {
-            ++records_with_empty_titles;
-            LOG_DEBUG("Empty title in record w/ control number: " + control_number);
-        } else
-            control_number_guesser->insertTitle(title, control_number);
+    const auto issue_info(BSZUtil::ExtractYearVolumeIssue(record));
+    if (not issue_info.year_.empty())
+        inserter->insertYear(issue_info.year_, control_number);
 
-        const auto issue_info(BSZUtil::ExtractYearVolumeIssue(record));
-        if (not issue_info.year_.empty())
-            control_number_guesser->insertYear(issue_info.year_, control_number);
+    for (const auto &doi : record.getDOIs())
+        inserter->insertDOI(doi, control_number);
 
-        for (const auto &doi : record.getDOIs())
-            control_number_guesser->insertDOI(doi, control_number);
+    for (const auto &issn : record.getISSNs())
+        inserter->insertISSN(issn, control_number);
 
-        for (const auto &issn : record.getISSNs())
-            control_number_guesser->insertISSN(issn, control_number);
+    for (const auto &superior_issn : record.getSuperiorISSNs())
+        inserter->insertISSN(superior_issn, control_number);
 
-        for (const auto &superior_issn : record.getSuperiorISSNs())
-            control_number_guesser->insertISSN(superior_issn, control_number);
+    for (const auto &isbn : record.getISBNs())
+        inserter->insertISBN(isbn, control_number);
 
-        for (const auto &isbn : record.getISBNs())
-            control_number_guesser->insertISBN(isbn, control_number);
+    return has_title;
+}
+
+
+void PopulateTables(ControlNumberGuesser * const control_number_guesser, MARC::Reader * const reader) {
+    control_number_guesser->beginUpdate();
+
+    unsigned processed_record_count(0), records_with_empty_titles(0);
+    while (const auto record = reader->read()) {
+        ++processed_record_count;
+        if (not InsertRecord(record, control_number_guesser))
+            ++records_with_empty_titles;
     }
     control_number_guesser->endUpdate();
 
@@ -83,16 +107,107 @@ void PopulateTables(ControlNumberGuesser * const control_number_guesser, MARC::R
 }
 
 
+const size_t RECORDS_PER_BATCH(1000);
+const size_t MAX_QUEUED_BATCHES_PER_THREAD(4);
+
+
+// \param max_buffered_bytes  Shared by all threads.
+void BulkLoadTables(ControlNumberGuesser * const control_number_guesser, MARC::Reader * const reader, const unsigned thread_count,
+                    const size_t max_buffered_bytes, const std::string &spill_directory) {
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+
+    ThreadUtil::BoundedQueue<std::vector<MARC::Record>> record_batch_queue(thread_count * MAX_QUEUED_BATCHES_PER_THREAD);
+    std::vector<std::unique_ptr<ControlNumberGuesser::KeyCollector>> key_collectors;
+    std::vector<unsigned> records_with_empty_titles(thread_count);
+    std::vector<std::thread> threads;
+    for (unsigned thread_no(0); thread_no < thread_count; ++thread_no) {
+        key_collectors.emplace_back(new ControlNumberGuesser::KeyCollector(max_buffered_bytes / thread_count, spill_directory));
+        threads.emplace_back([&record_batch_queue, &key_collectors, &records_with_empty_titles, thread_no] {
+            std::vector<MARC::Record> batch;
+            while (record_batch_queue.pop(&batch)) {
+                for (const auto &record : batch) {
+                    if (not InsertRecord(record, key_collectors[thread_no].get()))
+                        ++records_with_empty_titles[thread_no];
+                }
+            }
+        });
+    }
+
+    unsigned processed_record_count(0);
+    std::vector<MARC::Record> batch;
+    while (auto record = reader->read()) {
+        ++processed_record_count;
+        batch.emplace_back(std::move(record));
+        if (batch.size() == RECORDS_PER_BATCH) {
+            record_batch_queue.push(std::move(batch));
+            batch = std::vector<MARC::Record>();
+        }
+    }
+    if (not batch.empty())
+        record_batch_queue.push(std::move(batch));
+    record_batch_queue.close();
+    for (auto &thread : threads)
+        thread.join();
+
+    timer.stop();
+    LOG_INFO("Normalised " + std::to_string(processed_record_count) + " records on " + std::to_string(thread_count) + " thread(s) in "
+             + StringUtil::ToString(timer.getTime(), 1) + " s ("
+             + std::to_string(static_cast<unsigned>(processed_record_count / std::max(timer.getTime(), 0.001))) + " records/s).");
+    LOG_INFO("Found " + std::to_string(std::accumulate(records_with_empty_titles.cbegin(), records_with_empty_titles.cend(), 0u))
+             + " records with empty titles.");
+
+    std::vector<ControlNumberGuesser::KeyCollector *> key_collector_pointers;
+    for (const auto &key_collector : key_collectors)
+        key_collector_pointers.emplace_back(key_collector.get());
+    control_number_guesser->rebuildDatabase(key_collector_pointers);
+}
+
+
 } // unnamed namespace
 
 
 int Main(int argc, char **argv) {
+    bool bulk_load(false);
+    unsigned thread_count(std::max(std::thread::hardware_concurrency(), 1u)), buffer_size_in_mib(4096);
+    std::string spill_directory(MiscUtil::SafeGetEnv("TMPDIR"));
+    if (spill_directory.empty())
+        spill_directory = "/tmp";
+    if (argc > 1 and std::strcmp(argv[1], "--bulk-load") == 0) {
+        bulk_load = true;
+        --argc;
+        ++argv;
+        if (argc > 1 and StringUtil::StartsWith(argv[1], "--thread-count=")) {
+            if (not StringUtil::ToUnsigned(argv[1] + __builtin_strlen("--thread-count="), &thread_count) or thread_count == 0)
+                LOG_ERROR("bad thread count: \"" + std::string(argv[1]) + "\"!");
+            --argc;
+            ++argv;
+        }
+        if (argc > 1 and StringUtil::StartsWith(argv[1], "--buffer-size=")) {
+            if (not StringUtil::ToUnsigned(argv[1] + __builtin_strlen("--buffer-size="), &buffer_size_in_mib) or buffer_size_in_mib == 0)
+                LOG_ERROR("bad buffer size: \"" + std::string(argv[1]) + "\"!");
+            --argc;
+            ++argv;
+        }
+        if (argc > 1 and StringUtil::StartsWith(argv[1], "--spill-directory=")) {
+            spill_directory = argv[1] + __builtin_strlen("--spill-directory=");
+            if (not FileUtil::IsDirectory(spill_directory))
+                LOG_ERROR("spill directory \"" + spill_directory + "\" does not exist!");
+            --argc;
+            ++argv;
+        }
+    }
+
     if (argc != 2)
         Usage();
 
-    ControlNumberGuesser control_number_guesser;
+    ControlNumberGuesser control_number_guesser(ControlNumberGuesser::SQL_LOOKUPS, ControlNumberGuesser::REPLACE_DATABASE);
     auto reader(MARC::Reader::Factory(argv[1]));
-    PopulateTables(&control_number_guesser, reader.get());
+    if (bulk_load)
+        BulkLoadTables(&control_number_guesser, reader.get(), thread_count, size_t(buffer_size_in_mib) * 1024 * 1024, spill_directory);
+    else
+        PopulateTables(&control_number_guesser, reader.get());
+    control_number_guesser.installNewDatabase();
 
     return EXIT_SUCCESS;
 }
@@ -33,7 +33,9 @@ namespace {
 
 
 [[noreturn]] void Usage() {
-    ::Usage("[--force-overwrite] [--set-publisher-provided] [--verbose] fulltext_file1  [fulltext_file2 .. fulltext_fileN]");
+    ::Usage("[--force-overwrite] [--set-publisher-provided] [--verbose] [--in-memory-index] fulltext_file1 "
+            "[fulltext_file2 .. fulltext_fileN]\n"
+            "\"--in-memory-index\" loads the control number guesser tables into memory up front which pays off for large batches.");
 }
 
 
@@ -125,9 +127,16 @@ int Main(int argc, char *argv[]) {
         --argc;
         ++argv;
     }
+
+    ControlNumberGuesser::LookupMode lookup_mode(ControlNumberGuesser::SQL_LOOKUPS);
+    if (argc > 1 and std::strcmp(argv[1], "--in-memory-index") == 0) {
+        lookup_mode = ControlNumberGuesser::IN_MEMORY_INDEX;
+        --argc;
+        ++argv;
+    }
     if (argc < 2)
         Usage();
-    ControlNumberGuesser control_number_guesser;
+    ControlNumberGuesser control_number_guesser(lookup_mode);
     FullTextCache full_text_cache;
 
     unsigned total_count(0), failure_count(0);
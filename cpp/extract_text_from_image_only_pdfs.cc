@@ -18,10 +18,7 @@
  */
 #include <iostream>
 #include <cstdlib>
-#include <cstring>
-#include <libgen.h>
 #include <unistd.h>
-#include "ExecUtil.h"
 #include "FileUtil.h"
 #include "PdfUtil.h"
 #include "util.h"
@@ -34,11 +31,9 @@ void Usage() {
 }
 
 
-const std::string BASH_HELPER("pdf_images_to_text.sh");
-
-
 int main(int argc, char *argv[]) {
     ::progname = argv[0];
+    PdfUtil::LimitTesseractThreads();
 
     try {
         if (argc != 2 and argc != 3)
@@ -55,28 +50,10 @@ int main(int argc, char *argv[]) {
         if (not PdfUtil::PdfDocContainsNoText(pdf))
             logger->error("input file \"" + input_filename + "\" contains text!");
 
-        char output_filename[] = "OCR_OUT_XXXXXX";
-        const int output_fd(::mkstemp(output_filename));
-        if (output_fd == -1)
-            logger->error("failed to create a temporary file!");
-        const FileUtil::AutoDeleteFile auto_deleter(output_filename);
-
-#pragma GCC diagnostic ignored "-Wvla"
-        char path[std::strlen(argv[0]) + 1];
-#pragma GCC diagnostic warning "-Wvla"
-        std::strcpy(path, argv[0]);
-        const std::string dir_path(::dirname(path));
-
-        std::vector<std::string> args{ input_filename, output_filename };
-        if (argc == 3)
-            args.emplace_back(argv[2]);
-
-        if (ExecUtil::Exec(dir_path + "/" + BASH_HELPER, args, "", "", "", 20 /* seconds */) != 0)
-            logger->error("failed to execute conversion script!");
-
         std::string extracted_text;
-        if (not FileUtil::ReadString(output_filename, &extracted_text))
-            logger->error("failed to read contents of \"" + std::string(output_filename) + "\"!");
+        if (not PdfUtil::GetTextFromImagePDF(pdf, argc == 3 ? argv[2] : "deu", &extracted_text,
+                                          PdfUtil::DEFAULT_PDF_EXTRACTION_TIMEOUT, /* thread_count = */ 0))
+            logger->error("failed to OCR \"" + input_filename + "\"!");
 
         if (extracted_text.empty())
             logger->error("No text was extracted from \"" + input_filename + "\"!");
@@ -21,6 +21,8 @@
 #pragma once
 
 
+#include <functional>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -53,6 +55,13 @@ enum ArchiveType { TITLE_RECORDS, SUPERIOR_TITLES, AUTHORITY_RECORDS, LOCAL_RECO
 ArchiveType GetArchiveType(const std::string &member_name);
 
 
+// An SWB author lookup URL w/o any restrictions regarding e.g. professions or years of birth.  Only for this URL the
+// author lookup functions below will consult the local GND name index.
+const std::string UNFILTERED_AUTHOR_LOOKUP_BASE_URL("https://swb.bsz-bw.de/DB=2.104/SET=1/TTL=1/"
+                                                   "CMD?RETRACE=0&TRM_OLD=&ACT=SRCHA&IKT=1&SRT=RLV&"
+                                                   "&MATCFILTER=N&MATCSET=N&NOABS=Y&SHRTST=50&TRM=");
+
+
 // Try to resolve the GND number for an author using the BSZ (SWB / OGND) website.
 // The base URL can e.g. be taken from zotero_harvester.conf.
 // This funciton is thread-safe, since it is used in zotero harvester.
@@ -70,6 +79,13 @@ void ExtractArchiveMembers(const std::string &archive_name, std::vector<std::str
                            const std::string &optional_suffix = "");
 
 
+// Calls "member_processor" for each MARC-21 member of "archive_name", i.e. each regular file ending in ".raw" or ".mrc", whose type
+// is one of "selected_member_types".  The members are read straight from the archive w/o being extracted to disk.  The path of each
+// reader is "archive_name" followed by a slash and the member name.
+void ProcessArchiveMembers(const std::string &archive_name, const std::set<ArchiveType> &selected_member_types,
+                           const std::function<void(MARC::Reader * const marc_reader)> &member_processor);
+
+
 struct IssueInfo {
     std::string year_;
     std::string volume_;
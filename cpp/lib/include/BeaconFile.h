@@ -22,11 +22,22 @@
 
 #include <map>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 #include "util.h"
 
 
+/** \class BeaconFile
+ *  \brief Gives access to the entries of a BEACON file w/ GND numbers as identifiers.
+ *  \note  The GND numbers are kept in a sorted array of packed 64-bit integers along w/ the offsets of the unparsed remainders
+ *         of their lines which will only be parsed when a GND number is found.  If there is an up-to-date binary form of the
+ *         BEACON file, c.f. CreateBinaryForm(), it gets mmap(2)'ed instead of parsing the BEACON file itself.
+ */
 class BeaconFile {
+    struct Header;
+    struct PackedEntry;
+
 public:
     struct Entry {
         std::string gnd_number_;
@@ -34,7 +45,7 @@ public:
         std::string id_or_url_;
 
     public:
-        Entry() = default;
+        Entry(): optional_count_(0) { }
         Entry(const Entry &other) = default;
         Entry(const std::string &gnd_number, const unsigned optional_count, const std::string &id_or_url)
             : gnd_number_(gnd_number), optional_count_(optional_count), id_or_url_(id_or_url) { }
@@ -43,31 +54,31 @@ public:
         inline bool operator==(const Entry &rhs) const { return rhs.gnd_number_ == gnd_number_; }
     };
 
-    class EntryHasher {
-    public:
-        inline std::size_t operator()(const Entry &entry) const { return std::hash<std::string>()(entry.gnd_number_); }
-    };
-
 private:
     std::string filename_;
     std::string url_template_;
-    std::unordered_set<Entry, EntryHasher> entries_;
     std::map<std::string, std::string> keys_and_values_;
+    const char *map_start_; // Only used for binary forms.
+    size_t map_size_;
+    std::string beacon_file_contents_;         // Only used if we had to parse the BEACON file.
+    std::vector<PackedEntry> parsed_entries_; // Only used if we had to parse the BEACON file.
+    const PackedEntry *entries_;
+    size_t entry_count_;
+    const char *line_remainders_;
 
 public:
-    typedef std::unordered_set<Entry, EntryHasher>::const_iterator const_iterator;
-
-public:
-    explicit BeaconFile(const std::string &filename);
+    explicit BeaconFile(const std::string &filename): BeaconFile(filename, /* use_binary_form = */ true) { }
+    BeaconFile(BeaconFile &&other);
+    BeaconFile(const BeaconFile &rhs) = delete;
+    ~BeaconFile();
 
-    inline size_t size() const { return entries_.size(); }
+    inline size_t size() const { return entry_count_; }
     inline const std::string &getFileName() const { return filename_; }
     inline const std::string &getUrlTemplate() const { return url_template_; }
     std::string getURL(const Entry &entry) const;
 
-    inline const_iterator begin() const { return entries_.cbegin(); }
-    inline const_iterator end() const { return entries_.cend(); }
-    inline const_iterator find(const std::string &gnd_number) const { return entries_.find(Entry(gnd_number, 0, "")); }
+    //* \return True if "gnd_number" was found, in which case "*entry" will be set, o/w false.
+    bool find(const std::string &gnd_number, Entry * const entry) const;
 
     /** \return the value if the metadatum with name "name" exists o/w the empty string */
     inline std::string getMetadatum(const std::string &name) const {
@@ -77,4 +88,21 @@ public:
 
     /** \return a descriptive name for the Beacon source */
     std::string getName() const;
+
+    inline bool usesBinaryForm() const { return map_start_ != nullptr; }
+
+    //* \return Where we expect the binary form of "beacon_filename", e.g. "x.beacon.bin" for "x.beacon".
+    static std::string GetBinaryFormPath(const std::string &beacon_filename);
+
+    /** \brief Parses "beacon_filename" and stores the result at GetBinaryFormPath(beacon_filename).
+     *  \note  The binary form is written to a temporary file first which will then be renamed.  It will be ignored once
+     *         the size or the modification time of "beacon_filename" changes.
+     */
+    static void CreateBinaryForm(const std::string &beacon_filename);
+
+private:
+    BeaconFile(const std::string &filename, const bool use_binary_form);
+    void processHeaderLines(const std::string_view header_lines);
+    bool openBinaryForm();
+    void parseBeaconFile();
 };
@@ -0,0 +1,73 @@
+/** \file    CompressedFile.h
+ *  \brief   stdio streams that transparently read and write seekable gzip and zstd files.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+
+#include <string>
+#include <cstdio>
+
+
+/** \namespace CompressedFile
+ *  \brief     Frame-based compression that keeps files seekable.
+ *
+ *  We write the uncompressed data in independently compressed frames of FRAME_SIZE bytes.  Zstd files get a seek table
+ *  in the format of the zstd "seekable" contrib library appended as a skippable frame.  Gzip files consist of one gzip
+ *  member per frame and each member carries its compressed size in an extra header subfield ("UB").  Both kinds of
+ *  files can be decompressed with the standard command-line tools.  All offsets used with tell()/seek() refer to the
+ *  uncompressed data.  With a frame index seeking costs at most the decompression of a single frame.  We can read
+ *  files that were compressed by other tools as well but seeking backwards in them requires decompressing from the
+ *  beginning of the file.
+ */
+namespace CompressedFile {
+
+
+enum class Codec { NONE, GZIP, ZSTD };
+
+
+// The amount of uncompressed data per independently compressed frame.
+constexpr size_t FRAME_SIZE(1024 * 1024);
+
+
+/** \return GZIP for paths ending in ".gz", ZSTD for paths ending in ".zst" and NONE for everything else. */
+Codec GuessCodec(const std::string &path);
+
+
+/** \return "path" w/o a trailing ".gz" or ".zst", e.g. "x.mrc" for "x.mrc.zst". */
+std::string StripCodecSuffix(const std::string &path);
+
+
+/** \brief  Opens a stdio stream that returns the decompressed contents of "path".
+ *  \return nullptr if "path" could not be opened, in which case errno will have been set.
+ *  \note   Aborts on corrupt or truncated compressed data.
+ */
+FILE *OpenForReading(const std::string &path, const Codec codec);
+
+
+/** \brief  Opens a stdio stream whose contents will be compressed and written to "path".
+ *  \param  thread_count  The number of frames that we compress concurrently.  0 means one per CPU core.
+ *  \return nullptr if "path" could not be opened, in which case errno will have been set.
+ *  \note   The seek table will only be written when the stream gets closed.  The stream can't seek, ftell(3) is
+ *          supported, however.
+ */
+FILE *OpenForWriting(const std::string &path, const Codec codec, const unsigned thread_count = 0);
+
+
+} // namespace CompressedFile
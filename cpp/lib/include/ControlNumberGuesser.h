@@ -21,29 +21,96 @@
 #pragma once
 
 
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "BSZUtil.h"
 #include "DbConnection.h"
+#include "FileUtil.h"
 
 
 class ControlNumberGuesser {
+public:
+    /** In SQL_LOOKUPS mode every lookup results in an SQL query.  IN_MEMORY_INDEX loads all tables once into an inverted
+     *  index when the guesser gets constructed which is what you want if you guess the control numbers of many records.
+     *  Updating the database is only supported in SQL_LOOKUPS mode.
+     */
+    enum LookupMode { SQL_LOOKUPS, IN_MEMORY_INDEX };
+
+    /** In REPLACE_DATABASE mode all updates go to a new, initially empty database next to the live one.  The new database only
+     *  replaces the live one when installNewDatabase() gets called, so the live database stays intact if anything fails before.
+     */
+    enum UpdateMode { UPDATE_IN_PLACE, REPLACE_DATABASE };
+
+private:
+    enum Table { TITLES, AUTHORS, YEARS, DOIS, ISSNS, ISBNS, TABLE_COUNT };
+    class InMemoryIndex;
+
     static const std::set<std::string> EMPTY_SET;
     static const std::string DATABASE_PATH;
     static const std::string INSTALLER_SCRIPT_PATH;
 
     const size_t MAX_CONTROL_NUMBER_LENGTH;
+    const UpdateMode update_mode_;
+    const std::string database_path_, new_database_path_;
     mutable DbConnection db_connection_;
     mutable std::unique_ptr<DbResultSet> title_cursor_, author_cursor_, year_cursor_;
     DbTransaction *db_transaction_;
+    std::unique_ptr<InMemoryIndex> in_memory_index_;
 
 public:
-    explicit ControlNumberGuesser()
-        : MAX_CONTROL_NUMBER_LENGTH(BSZUtil::PPN_LENGTH_NEW),
-          db_connection_(DbConnection::Sqlite3Factory(DATABASE_PATH, DbConnection::CREATE)), db_transaction_(nullptr) { }
+    /** \brief Gathers normalised keys for rebuildDatabase().
+     *  \note  The insert*() member functions mirror those of ControlNumberGuesser.  Instances are not thread-safe but
+     *         you can use one instance per thread to normalise data in parallel.  Whenever more than
+     *         "max_buffered_bytes" have accumulated, the keys are sorted and spilled to a temporary file in
+     *         "spill_directory", so memory usage stays bounded no matter how much data you insert.
+     */
+    class KeyCollector {
+        friend class ControlNumberGuesser;
+        typedef std::pair<std::string, std::string> KeyAndControlNumber;
+
+        const size_t max_buffered_bytes_;
+        const std::string spill_directory_;
+        size_t buffered_bytes_;
+        std::vector<KeyAndControlNumber> keys_and_control_numbers_[TABLE_COUNT];
+        std::vector<std::unique_ptr<FileUtil::AutoTempFile>> sorted_runs_[TABLE_COUNT];
+
+    public:
+        explicit KeyCollector(const size_t max_buffered_bytes = 512 * 1024 * 1024, const std::string &spill_directory = "/tmp")
+            : max_buffered_bytes_(max_buffered_bytes), spill_directory_(spill_directory), buffered_bytes_(0) { }
+        KeyCollector(const KeyCollector &rhs) = delete;
+
+        void insertTitle(const std::string &title, const std::string &control_number);
+        void insertAuthors(const std::set<std::string> &authors, const std::string &control_number);
+        void insertYear(const std::string &year, const std::string &control_number);
+        void insertDOI(const std::string &doi, const std::string &control_number);
+        void insertISSN(const std::string &issn, const std::string &control_number);
+        void insertISBN(const std::string &isbn, const std::string &control_number);
+
+    private:
+        void insert(const Table table, const std::string &key, const std::string &control_number);
+        void sortBufferedKeys(const Table table);
+        void spill();
+    };
+
+public:
+    /** \param database_path  Only needs to be specified if you don't want to use the live database, e.g. for testing.  In
+     *                        REPLACE_DATABASE mode the new database will be created at "database_path" + ".new".
+     */
+    explicit ControlNumberGuesser(const LookupMode lookup_mode = SQL_LOOKUPS, const UpdateMode update_mode = UPDATE_IN_PLACE,
+                                  const std::string &database_path = DATABASE_PATH);
     ~ControlNumberGuesser();
 
+    /** \brief Makes getGuessedControlNumbers() fall back to titles that are similar to the one that has been passed in if
+     *         there is no exact match.
+     *  \param min_similarity  The minimum Jaccard similarity of the character trigrams of two normalised titles.
+     *  \note  Only available in IN_MEMORY_INDEX mode.  Candidates are found w/ MinHash-based locality-sensitive hashing,
+     *         so titles w/ a similarity below approx. 0.6 will rarely be found, even if "min_similarity" is lower.
+     */
+    void enableFuzzyTitleMatching(const double min_similarity = 0.8);
+
 public:
     void clearDatabase();
     void beginUpdate();
@@ -56,6 +123,15 @@ public:
     void insertISSN(const std::string &issn, const std::string &control_number);
     void insertISBN(const std::string &isbn, const std::string &control_number);
 
+    /** \brief Replaces the contents of the database w/ the keys that have been gathered by "key_collectors".
+     *  \note  The sorted runs of all collectors are merged table by table and loaded in key order w/ multi-row
+     *         INSERTs.  This is much faster than calling the insert*() member functions for each record.
+     */
+    void rebuildDatabase(const std::vector<KeyCollector *> &key_collectors);
+
+    //* \brief Atomically replaces the live database w/ the new one.  Only available in REPLACE_DATABASE mode.
+    void installNewDatabase();
+
     /** \warning You *must* pass in complete titles for "title"!  If you obtain the title from a MARC record,
                  you can use getCompleteTitle() on the MARC:Record instance. */
     std::set<std::string> getGuessedControlNumbers(const std::string &title, const std::set<std::string> &authors,
@@ -77,6 +153,14 @@ public:
     static std::string NormaliseAuthorName(const std::string &author_name);
 
 private:
+    //* \return The key under which "value" is stored in "table" or the empty string if "value" should not be stored.
+    static std::string GetInsertionKey(const Table table, const std::string &value, const std::string &control_number);
+
+    void insertKey(const Table table, const std::string &key, const std::string &control_number);
+    void checkUpdatesAreAllowed() const;
+    std::set<std::string> getGuessedControlNumbersFromIndex(const std::string &title, const std::set<std::string> &authors,
+                                                            const std::string &year, const std::set<std::string> &dois,
+                                                            const std::set<std::string> &issns, const std::set<std::string> &isbns) const;
     void lookupControlNumber(const std::string &table, const std::string &column_name, const std::string &column_value,
                              std::set<std::string> * const control_numbers) const;
     void splitControlNumbers(const std::string &concatenated_control_numbers,
@@ -58,14 +58,17 @@ private:
     char pushed_back_chars_[2];
     int precision_;
     OpenMode open_mode_;
+    bool compressed_;
 
 public:
     /** \brief  Creates and initalises a File object.
      *  \param  path                      The pathname for the file (see fopen(3) for details).
      *  \param  mode                      The open mode (see fopen(3) for details).  An extension to the fopen modes
      *                                    are either "c" or "u".  "c" meaning "compress" can only be combined with "w"
-     *                                    and "u" meaning "uncompress" with "r".  Using either flag makes seeking or
-     *                                    rewinding impossible.
+     *                                    and "u" meaning "uncompress" with "r".  The compression format is chosen
+     *                                    based on the suffix of "filename", ".gz" or ".zst", see CompressedFile.h for
+     *                                    details.  Offsets refer to the uncompressed data and compressed output files
+     *                                    can't seek or rewind.
      *  \param  throw_on_error_behaviour  If true, any open failure will cause an exception to be thrown.  If not true
      *                                    you must use the fail() member function.
      */
@@ -86,8 +89,12 @@ public:
     /** Closes this File.  If this fails you may consult the global "errno" for the reason. */
     bool close();
 
+    /** \note Returns -1 for compressed files. */
     inline int getFileDescriptor() const { return fileno(file_); }
 
+    /** \return True if this File was opened with one of the "c" or "u" mode flags. */
+    inline bool isCompressed() const { return compressed_; }
+
     inline off_t tell() const {
         const off_t file_pos(::ftello(file_));
         if (open_mode_ == WRITING)
@@ -191,7 +198,7 @@ public:
 
     inline const std::string &getPath() const { return filename_; }
 
-    /** Returns a File's size in bytes. */
+    /** Returns a File's size in bytes.  For compressed files this is the size of the compressed data. */
     off_t size() const;
 
     inline bool eof() const { return (buffer_ptr_ == buffer_ + read_count_) and std::feof(file_) != 0; }
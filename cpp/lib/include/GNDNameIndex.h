@@ -0,0 +1,113 @@
+/** \file    GNDNameIndex.h
+ *  \brief   A local, memory-mapped index of the person names in the GND authority data.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DbConnection.h"
+#include "MARC.h"
+
+
+/** \class GNDNameIndex
+ *  \brief Maps normalised preferred (100$a) and variant (400$a) person names to GND persons.
+ *  \note  The index file gets mmap(2)'ed, so opening it is cheap and its pages are shared by all processes that use it.
+ *         All member functions are thread-safe.
+ */
+class GNDNameIndex {
+public:
+    struct Person {
+        std::string gnd_number_;
+        std::string preferred_name_;
+        std::string life_dates_;
+        std::vector<std::string> professions_;
+    };
+
+    static const std::string DEFAULT_INDEX_PATH;
+
+private:
+    struct Header;
+    struct NameEntry;
+    struct PersonEntry;
+
+    std::string index_path_;
+    const char *map_start_;
+    size_t map_size_;
+    const Header *header_;
+    const NameEntry *names_;
+    const PersonEntry *persons_;
+    const char *strings_;
+
+public:
+    explicit GNDNameIndex(const std::string &index_path = DEFAULT_INDEX_PATH);
+    GNDNameIndex(const GNDNameIndex &rhs) = delete;
+    ~GNDNameIndex();
+
+    //* \return The number of (name, person) entries.
+    size_t size() const;
+
+    //* \brief Appends all persons w/ a preferred or variant name that matches "name" after normalisation to "persons".
+    void lookup(const std::string &name, std::vector<Person> * const persons) const;
+
+    /** \brief Normalises "name" so that "Müller, Hans-Peter", "Hans-Peter Müller" and "muller, hans peter" match.
+     *  \note  Names w/o a comma are assumed to be in "first names last name" order.
+     */
+    static std::string NormaliseName(const std::string &name);
+
+    /** \brief Creates an index at "index_path" from the person records that "authority_reader" returns.
+     *  \note  The index is written to a temporary file first which will then be renamed, so processes that use an older
+     *         version of the index are not affected.
+     */
+    static void Build(MARC::Reader * const authority_reader, const std::string &index_path = DEFAULT_INDEX_PATH);
+
+    //* \return The index at DEFAULT_INDEX_PATH or nullptr if it has not been installed.
+    static const GNDNameIndex *GetDefaultInstance();
+};
+
+
+/** \class GNDLookupCache
+ *  \brief A persistent cache for the answers of remote GND lookups, e.g. via the SWB or lobid.org, that is shared by all
+ *         processes on a host.
+ *  \note  Answers that are older than "max_age" are ignored.  Empty answers, i.e. "not found", are cached as well.
+ *         Failures to access the cache are logged as warnings but are not fatal.  All member functions are thread-safe.
+ */
+class GNDLookupCache {
+    std::mutex mutex_;
+    DbConnection db_connection_;
+    const unsigned max_age_;
+    bool enabled_; // False if the cache couldn't be initialised.
+
+public:
+    static const std::string DEFAULT_CACHE_PATH;
+
+public:
+    explicit GNDLookupCache(const std::string &cache_path = DEFAULT_CACHE_PATH, const unsigned max_age = 30 * 86400 /* seconds */);
+
+    //* \return True if an answer for "query" was found, o/w false.
+    bool lookup(const std::string &query, std::string * const answer);
+
+    void store(const std::string &query, const std::string &answer);
+
+    //* \return The cache at DEFAULT_CACHE_PATH or nullptr if it neither exists nor can be created.
+    static GNDLookupCache *GetDefaultInstance();
+};
@@ -20,6 +20,7 @@
 #pragma once
 
 
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
@@ -56,15 +57,19 @@ class Scanner {
     double last_double_constant_;
     std::string last_error_message_;
     unsigned line_no_;
-    std::string::const_iterator ch_;
-    const std::string::const_iterator begin_;
-    const std::string::const_iterator end_;
+    const char *ch_;
+    const char * const begin_;
+    const char * const end_;
     bool pushed_back_;
     TokenType pushed_back_token_;
 
 public:
     explicit Scanner(const std::string &json_document)
-        : line_no_(1), ch_(json_document.cbegin()), begin_(json_document.cbegin()), end_(json_document.cend()), pushed_back_(false) { }
+        : line_no_(1), ch_(json_document.data()), begin_(json_document.data()), end_(json_document.data() + json_document.size()),
+          pushed_back_(false) { }
+
+    // Scans the characters in [begin, end), e.g. a memory-mapped file.  They must remain valid for the lifetime of the Scanner.
+    Scanner(const char * const begin, const char * const end): line_no_(1), ch_(begin), begin_(begin), end_(end), pushed_back_(false) { }
     TokenType getToken();
     void ungetToken(const TokenType token);
     const std::string &getLastStringConstant() const { return last_string_constant_; }
@@ -464,9 +469,137 @@ private:
 };
 
 
+/** \class PullParser
+ *  \brief Reads a JSON document, or a JSON Lines document, i.e. a sequence of JSON values, as a stream of events w/o
+ *         building a tree.
+ *  \note  Uncompressed regular files get mmap(2)'ed, compressed files, see File.h, and FIFOs are read into memory.
+ *         Syntax errors and unexpected input result in std::runtime_error exceptions.
+ *
+ *  Typical use case for a large array of objects, or a JSON Lines file w/ one object per line:
+ *
+ *  JSON::PullParser parser(path);
+ *  JSON::PullParser::EventType element_start;
+ *  if (not parser.isJSONLines() and parser.getNextEvent() != JSON::PullParser::ARRAY_START)
+ *      LOG_ERROR(...);
+ *  std::vector<std::string> values;
+ *  while (parser.getNextElement(&element_start)) {
+ *      parser.extractStrings(element_start, { "/id", "/location/url" }, &values);
+ *      ...
+ *  }
+ */
+class PullParser {
+public:
+    enum EventType {
+        OBJECT_START,
+        OBJECT_END,
+        ARRAY_START,
+        ARRAY_END,
+        LABEL,
+        STRING_VALUE,
+        INTEGER_VALUE,
+        DOUBLE_VALUE,
+        BOOLEAN_VALUE,
+        NULL_VALUE,
+        END_OF_DOCUMENT
+    };
+
+private:
+    struct Container {
+        bool is_object_;
+        bool seen_first_element_;
+        bool expecting_value_; // Only used for objects, true after we returned a LABEL event.
+    };
+
+    std::string path_;
+    const bool json_lines_;
+    const char *map_start_;
+    size_t map_size_;
+    std::string document_; // Only used if we could not mmap(2) the input.
+    std::unique_ptr<Scanner> scanner_;
+    std::vector<Container> open_containers_;
+    bool seen_top_level_value_;
+    std::string last_label_;
+    bool last_boolean_value_;
+
+public:
+    /** \param json_lines  If true, we expect a JSON Lines document, o/w a single JSON value.  See IsJSONLinesFile() for a
+     *                     sensible default.
+     */
+    PullParser(const std::string &path, const bool json_lines);
+    explicit PullParser(const std::string &path): PullParser(path, IsJSONLinesFile(path)) { }
+    PullParser(const PullParser &rhs) = delete;
+    ~PullParser();
+
+    inline const std::string &getPath() const { return path_; }
+    inline bool isJSONLines() const { return json_lines_; }
+    inline unsigned getLineNumber() const { return scanner_->getLineNumber(); }
+
+    //* \return The number of currently open objects and arrays.
+    inline size_t getDepth() const { return open_containers_.size(); }
+
+    EventType getNextEvent();
+
+    // The values that belong to the last LABEL, STRING_VALUE, INTEGER_VALUE, DOUBLE_VALUE and BOOLEAN_VALUE events.
+    inline const std::string &getLabel() const { return last_label_; }
+    inline const std::string &getStringValue() const { return scanner_->getLastStringConstant(); }
+    inline int64_t getIntegerValue() const { return scanner_->getLastIntegerConstant(); }
+    inline double getDoubleValue() const { return scanner_->getLastDoubleConstant(); }
+    inline bool getBooleanValue() const { return last_boolean_value_; }
+
+    //* \return The value of the scalar event "event" as a string in the same format that LookupString() uses.
+    std::string getScalarValueAsString(const EventType event) const;
+
+    /** \brief Advances to the first event of the next element of the array that we are currently in or, if we are at the
+     *         top level of a JSON Lines document, to the first event of the next value.
+     *  \return False at the end of the array or document, o/w true.
+     *  \note   The element must be consumed completely, e.g. w/ skipValue(), parseValue() or extractStrings(), before the
+     *          next call.
+     */
+    bool getNextElement(EventType * const element_start_event);
+
+    //* \brief Skips over the rest of the value whose first event was "start_event".
+    void skipValue(const EventType start_event);
+
+    //* \brief Builds a tree for the value whose first event was "start_event".
+    std::shared_ptr<JSONNode> parseValue(const EventType start_event);
+
+    /** \brief Consumes the value whose first event was "start_event" and extracts scalars from it.
+     *  \param paths   Paths relative to the value, in the format that LookupString() uses.
+     *  \param values  Will be set to one entry per path w/ the string representation of the referenced scalar, or the empty
+     *                 string if it does not exist.  Paths that reference objects or arrays yield empty strings as well.
+     */
+    void extractStrings(const EventType start_event, const std::vector<std::string> &paths, std::vector<std::string> * const values);
+
+    /** \brief Advances to the value referenced by "path", in the format that LookupNode() uses, in the next value.
+     *  \return False if "path" could not be found, o/w true and "*start_event" will be set to the first event of the
+     *          value.
+     *  \note   "/" references the next value itself.
+     *  \note   If there is no next value, we return true and set "*start_event" to END_OF_DOCUMENT.
+     */
+    bool descend(const std::string &path, EventType * const start_event);
+
+    //* \return True if "path" has a ".jsonl", ".ndjson" or ".jsonlines" extension, optionally followed by ".gz" or ".zst".
+    static bool IsJSONLinesFile(const std::string &path);
+
+private:
+    [[noreturn]] void throwError(const std::string &msg) const;
+    EventType startValue(const TokenType token);
+    EventType endContainer();
+    void extractStrings(const EventType start_event, std::vector<std::string> * const current_path,
+                        const std::vector<std::vector<std::string>> &paths, std::vector<std::string> * const values);
+};
+
+
 std::string TokenTypeToString(const TokenType token);
 
 
+/** \brief Splits a path as used by LookupNode() et al. into its components.
+ *  \return The number of components.
+ *  \throws std::runtime_error if "path_is_absolute" and "path" does not start w/ a slash or "path" has empty components.
+ */
+size_t ParsePath(const std::string &path, std::deque<std::string> * const components, const bool path_is_absolute);
+
+
 /** \brief Locates a JSON node from in JSON tree structure.
  *  \param path           A path of the form /X/Y/X...  Individual path components may contain slashes if they are
  *                        backslash escaped.  Literal backslashes also have to be escaped.  No other escapes are
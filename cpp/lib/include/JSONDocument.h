@@ -0,0 +1,191 @@
+/** \file    JSONDocument.h
+ *  \brief   A read-only JSON DOM whose nodes live in a per-document arena.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "JSON.h"
+
+
+namespace JSON {
+
+
+/** \class Value
+ *  \brief A node of a JSON::Document.
+ *  \note  Values are only valid as long as the Document that they belong to exists and has not been reparsed.  The members
+ *         of objects are kept in the order in which they appear in the input.  Objects w/ many members get a hash table for
+ *         lookups by label, smaller ones are searched linearly.  If an object has several members w/ the same label, only
+ *         the first one can be looked up, just like w/ ObjectNode.
+ */
+class Value {
+    friend class Document;
+
+public:
+    struct Member;
+
+    // Objects w/ more members than this get a hash table.
+    static constexpr size_t HASH_THRESHOLD = 16;
+
+private:
+    JSONNode::Type type_;
+    uint32_t size_; // The length of a string, the number of members of an object or the number of elements of an array.
+    union {
+        bool boolean_value_;
+        int64_t integer_value_;
+        double double_value_;
+        const char *string_value_;
+        const Member *members_; // Followed by the hash table, if there is one.
+        const Value *elements_;
+    };
+
+public:
+    Value(): type_(JSONNode::NULL_NODE), size_(0), integer_value_(0) { }
+
+    inline JSONNode::Type getType() const { return type_; }
+    inline bool isNull() const { return type_ == JSONNode::NULL_NODE; }
+    inline bool isObject() const { return type_ == JSONNode::OBJECT_NODE; }
+    inline bool isArray() const { return type_ == JSONNode::ARRAY_NODE; }
+
+    // Value accessors, if the type of the value is not applicable, they abort.
+    bool getBooleanValue() const;
+    int64_t getIntegerValue() const;
+    double getDoubleValue() const;
+    std::string_view getStringValue() const;
+    std::span<const Member> getMembers() const;
+    std::span<const Value> getElements() const;
+
+    //* \return The number of members of an object or the number of elements of an array, 0 for other types.
+    inline size_t size() const { return (type_ == JSONNode::OBJECT_NODE or type_ == JSONNode::ARRAY_NODE) ? size_ : 0; }
+
+    //* \return The value of the member w/ label "label" or nullptr if there is none or we're not an object.
+    const Value *getMember(const std::string_view label) const;
+
+    //* \return The element w/ index "index" or nullptr if it does not exist or we're not an array.
+    const Value *getElement(const size_t index) const;
+
+    //* \return A string representation of a scalar in the same format that LookupString() uses.
+    std::string getScalarValueAsString() const;
+
+    std::string toString() const;
+};
+
+
+struct Value::Member {
+    std::string_view label_;
+    Value value_;
+};
+
+
+/** \class Document
+ *  \brief Parses a JSON document into Values that are allocated from a per-document arena.
+ *  \note  Strings w/o escapes are not copied but reference the document's copy of the input.  Unlike the JSONNode tree the
+ *         Values can't be modified.  Use this for large, read-only documents like API responses.
+ */
+class Document {
+    class Arena {
+        static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char *next_;
+        size_t remaining_;
+        size_t next_block_size_;
+
+    public:
+        Arena(): next_(nullptr), remaining_(0), next_block_size_(MIN_BLOCK_SIZE) { }
+
+        //* \return Uninitialised memory for "size" bytes w/ an alignment of 8.
+        inline void *allocate(size_t size) {
+            size = (size + 7) & ~size_t(7);
+            if (unlikely(size > remaining_))
+                addBlock(size);
+            void * const memory(next_);
+            next_ += size;
+            remaining_ -= size;
+            return memory;
+        }
+
+        void clear();
+
+    private:
+        void addBlock(const size_t min_size);
+    };
+
+    std::string json_document_;
+    const char *end_; // The end of "json_document_".
+    Arena arena_;
+    Value root_;
+    std::string error_message_;
+    std::vector<Value::Member> member_stack_;
+    std::vector<Value> element_stack_;
+    std::string unescaped_string_;
+
+public:
+    Document(): end_(nullptr) { }
+    Document(const Document &rhs) = delete;
+
+    /** \brief Replaces the current contents w/ a parsed copy of "json_document".
+     *  \return True upon success, o/w false and getErrorMessage() will tell you what went wrong.
+     */
+    bool parse(const std::string &json_document);
+    bool parse(std::string &&json_document);
+
+    inline const std::string &getErrorMessage() const { return error_message_; }
+    inline const Value &getRoot() const { return root_; }
+
+private:
+    bool parse();
+    bool parseValue(const char *&cp, Value * const value);
+    bool parseObject(const char *&cp, Value * const value);
+    bool parseArray(const char *&cp, Value * const value);
+    bool parseString(const char *&cp, std::string_view * const string);
+    bool appendUTF16Escape(const char *&cp);
+    bool parseNumber(const char *&cp, Value * const value);
+    bool parseConstant(const char *&cp, const std::string_view constant);
+    void skipWhite(const char *&cp) const;
+    bool setError(const char * const cp, const std::string &msg);
+};
+
+
+/** \brief Locates a value in a Document.
+ *  \param path  A path of the form /X/Y/X..., see the LookupNode() overload for JSONNode trees for details.
+ *  \return The referenced value if found or nullptr o/w.
+ */
+const Value *LookupValue(const std::string &path, const Value &root);
+
+
+/** \brief Like the LookupString() overload for JSONNode trees.
+ *  \throws std::runtime_error if the datum is not found or not a scalar.
+ */
+std::string LookupString(const std::string &path, const Value &root);
+
+
+/** \brief Like the LookupString() overload for JSONNode trees.
+ *  \return The datum, if found, o/w "default_value".
+ */
+std::string LookupString(const std::string &path, const Value &root, const std::string &default_value);
+
+
+} // namespace JSON
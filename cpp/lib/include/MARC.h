@@ -25,9 +25,11 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <cstring>
 #include <arpa/inet.h>
 #include "Compiler.h"
 #include "File.h"
@@ -37,8 +39,11 @@
 #include "XMLSubsetParser.h"
 
 
-// Forward declaration:
+// Forward declarations:
 class RegexMatcher;
+namespace Archive {
+class Reader;
+}
 
 
 namespace MARC {
@@ -313,6 +318,107 @@ public:
 };
 
 
+/** \brief A subfield code and a view of the corresponding value inside of some field's contents. */
+struct SubfieldView {
+    char code_;
+    std::string_view value_;
+
+public:
+    SubfieldView(const char code, const std::string_view value): code_(code), value_(value) { }
+    inline bool empty() const { return value_.empty(); }
+};
+
+
+/** \brief Iterates over the subfields of a data field w/o copying any subfield values.
+ *  \warning Instances and their iterators refer to the contents of the field they were created from.  They are invalidated
+ *           by any modification of that field.
+ */
+class SubfieldsView {
+    std::string_view subfields_; // Field contents w/o the indicators.
+
+public:
+    class const_iterator {
+        friend class SubfieldsView;
+        const char *subfield_start_, *end_;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef SubfieldView value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const SubfieldView *pointer;
+        typedef SubfieldView reference;
+
+    private:
+        // "subfield_start" must point to a subfield delimiter or equal "end".
+        const_iterator(const char * const subfield_start, const char * const end): subfield_start_(subfield_start), end_(end) {
+            skipTruncatedSubfield();
+        }
+
+    public:
+        inline SubfieldView operator*() const {
+            const char * const value_start(subfield_start_ + 2 /* delimiter and subfield code */);
+            return SubfieldView(subfield_start_[1], std::string_view(value_start, getValueEnd() - value_start));
+        }
+        inline const_iterator &operator++() {
+            subfield_start_ = getValueEnd();
+            skipTruncatedSubfield();
+            return *this;
+        }
+        inline const_iterator operator++(int) {
+            const const_iterator old_value(*this);
+            ++*this;
+            return old_value;
+        }
+        inline bool operator==(const const_iterator &rhs) const { return subfield_start_ == rhs.subfield_start_; }
+        inline bool operator!=(const const_iterator &rhs) const { return subfield_start_ != rhs.subfield_start_; }
+
+    private:
+        inline const char *getValueEnd() const {
+            const void * const next_delimiter(std::memchr(subfield_start_ + 2, '\x1F', end_ - (subfield_start_ + 2)));
+            return next_delimiter == nullptr ? end_ : reinterpret_cast<const char *>(next_delimiter);
+        }
+        inline void skipTruncatedSubfield() {
+            if (unlikely(subfield_start_ != end_ and subfield_start_ + 1 == end_))
+                subfield_start_ = end_; // A trailing delimiter w/o a subfield code.
+        }
+    };
+
+public:
+    explicit SubfieldsView(const std::string_view field_contents) {
+        // Anything between the indicators and the first subfield delimiter is garbage that we skip:
+        const size_t first_delimiter_pos(field_contents.find('\x1F', 2 /* indicators */));
+        if (first_delimiter_pos != std::string_view::npos)
+            subfields_ = field_contents.substr(first_delimiter_pos);
+    }
+
+    inline const_iterator begin() const { return const_iterator(subfields_.data(), subfields_.data() + subfields_.size()); }
+    inline const_iterator end() const {
+        return const_iterator(subfields_.data() + subfields_.size(), subfields_.data() + subfields_.size());
+    }
+    inline bool empty() const { return begin() == end(); }
+
+    inline bool hasSubfield(const char subfield_code) const {
+        for (const auto subfield : *this) {
+            if (subfield.code_ == subfield_code)
+                return true;
+        }
+        return false;
+    }
+
+    /** \return Either the contents of the subfield or the empty string if no corresponding subfield was found. */
+    inline std::string_view getFirstSubfieldWithCode(const char subfield_code) const {
+        for (const auto subfield : *this) {
+            if (subfield.code_ == subfield_code)
+                return subfield.value_;
+        }
+        return std::string_view();
+    }
+
+    /** \return A copy of the subfields. */
+    Subfields toSubfields() const;
+};
+
+
 enum EditInstructionType { INSERT_FIELD, INSERT_SUBFIELD, ADD_SUBFIELD };
 
 
@@ -346,6 +452,14 @@ private:
 };
 
 
+/** \brief The kinds of hashes that CalcChecksum() and Record::Field::getHash() generate.
+ *  \note  SHA1 yields 20 bytes and should be used whenever the hashes get stored, e.g. in a database, so that they remain
+ *         comparable.  FAST yields 16 bytes of a non-cryptographic hash that is much cheaper to calculate and is meant for
+ *         comparisons within a single run, e.g. for detecting duplicates.
+ */
+enum class ChecksumType { SHA1, FAST };
+
+
 class Record {
 public:
     class Field {
@@ -396,6 +510,9 @@ public:
                 contents_[1] = new_indicator2;
         }
         inline Subfields getSubfields() const { return Subfields(contents_); }
+
+        /** \warning The returned view is invalidated by any modification of this field! */
+        inline SubfieldsView getSubfieldsView() const { return SubfieldsView(contents_); }
         inline void setSubfields(const Subfields &subfields) { setContents(subfields, getIndicator1(), getIndicator2()); }
         inline bool isLocal() const { return tag_.isLocal(); }
         Tag getLocalTag() const;
@@ -420,6 +537,8 @@ public:
         std::string getFirstSubfieldWithCodeAndPrefix(const char subfield_code, const std::string &prefix) const;
 
         bool hasSubfield(const char subfield_code) const;
+
+        /** \note Only compares the first value.length() characters of subfield values, i.e. "value" may be a prefix. */
         bool hasSubfieldWithValue(const char subfield_code, const std::string &value, const bool case_insensitive = false) const;
 
         /** \param value  Where to store the extracted data, if we have a match.
@@ -433,8 +552,28 @@ public:
             contents_ += std::string(1, '\x1F') + std::string(1, subfield_code) + subfield_value;
         }
 
+        /** \note If "subfield_contents" is empty, the first subfield w/ code "subfield_code" gets removed and nothing gets inserted. */
         void insertOrReplaceSubfield(const char subfield_code, const std::string &subfield_contents);
 
+        /** \brief Replaces the value of the first subfield w/ code "subfield_code" in place.  If "new_subfield_value" is empty, the
+         *         subfield gets removed instead.
+         *  \return True if we found a subfield w/ code "subfield_code", else false.
+         */
+        bool replaceFirstSubfieldValue(const char subfield_code, const std::string_view new_subfield_value);
+
+        /** \brief Calls "replacement_generator" for the value of each subfield whose code is in "subfield_codes" and replaces the
+         *         value in place w/ what it returns unless it returned nullptr.  Subfields that would become empty are removed.
+         *  \param replacement_generator  Something that can be called as "const std::string *(const std::string_view value)".
+         *  \return True if at least one subfield value was replaced, else false.
+         */
+        template <typename ReplacementGenerator>
+        bool replaceSubfieldValues(const std::string_view subfield_codes, ReplacementGenerator replacement_generator);
+
+        /** \brief Removes the first subfield w/ code "subfield_code" in place.
+         *  \return True if we found a subfield w/ code "subfield_code", else false.
+         */
+        bool deleteFirstSubfieldWithCode(const char subfield_code);
+
         /** \return True if one or more subfield codes were replaces, else false. */
         bool replaceSubfieldCode(const char old_code, const char new_code);
 
@@ -443,7 +582,7 @@ public:
         /** \note Do *not* call this on control fields! */
         void deleteAllSubfieldsWithCode(const char subfield_code);
 
-        std::string getHash() const { return StringUtil::Sha1(toString()); }
+        std::string getHash(const ChecksumType checksum_type = ChecksumType::SHA1) const;
 
         inline void swap(Field &other) {
             tag_.swap(other.tag_);
@@ -542,9 +681,11 @@ public:
 private:
     friend class BinaryReader;
     friend class XmlReader;
+    friend class ArchiveMemberReader;
     friend class BinaryWriter;
     friend class XmlWriter;
-    friend std::string CalcChecksum(const Record &record, const std::set<Tag> &excluded_fields, const bool suppress_local_fields);
+    friend std::string CalcChecksum(const Record &record, const std::set<Tag> &excluded_fields, const bool suppress_local_fields,
+                                    const ChecksumType checksum_type);
     friend bool UBTueIsElectronicResource(const Record &marc_record);
     size_t record_size_; // in bytes
     std::string leader_;
@@ -1031,6 +1172,11 @@ public:
     std::string toBinaryString() const;
     void toXmlStringHelper(MarcXmlWriter * const xml_writer) const;
 
+    /** \brief Appends the same MARC-XML that toXmlStringHelper() generates w/o indentation and text conversion to "xml".
+     *  \note  The subfields are written straight from the field contents.
+     */
+    void appendXml(std::string * const xml) const;
+
     /** \brief   Removes all fields starting at and including "field_iter".
      *  \return  The number of fields that were removed at the end of the records.
      *  \warning "field_iter" must be a valid interator into the fields of the current record!
@@ -1042,6 +1188,38 @@ public:
 };
 
 
+template <typename ReplacementGenerator>
+bool Record::Field::replaceSubfieldValues(const std::string_view subfield_codes, ReplacementGenerator replacement_generator) {
+    bool replaced_at_least_one_value(false);
+    size_t subfield_start(contents_.find('\x1F', 2 /* indicators */));
+    while (subfield_start != std::string::npos and subfield_start + 1 < contents_.size()) {
+        const size_t value_start(subfield_start + 2 /* delimiter and subfield code */);
+        size_t value_end(contents_.find('\x1F', value_start));
+        if (value_end == std::string::npos)
+            value_end = contents_.size();
+
+        if (subfield_codes.find(contents_[subfield_start + 1]) != std::string_view::npos) {
+            const std::string * const replacement(
+                replacement_generator(std::string_view(contents_.data() + value_start, value_end - value_start)));
+            if (replacement != nullptr) {
+                replaced_at_least_one_value = true;
+                if (replacement->empty()) {
+                    contents_.erase(subfield_start, value_end - subfield_start);
+                    value_end = subfield_start;
+                } else {
+                    contents_.replace(value_start, value_end - value_start, *replacement);
+                    value_end = value_start + replacement->size();
+                }
+            }
+        }
+
+        subfield_start = (value_end < contents_.size()) ? value_end : std::string::npos;
+    }
+
+    return replaced_at_least_one_value;
+}
+
+
 enum class FileType { AUTO, BINARY, XML };
 enum class GuessFileTypeBehaviour { ATTEMPT_A_READ, USE_THE_FILENAME_ONLY };
 
@@ -1074,15 +1252,28 @@ public:
     virtual void rewind() = 0;
 
     /** \return The path of the underlying file. */
-    inline const std::string &getPath() const { return input_->getPath(); }
+    virtual const std::string &getPath() const { return input_->getPath(); }
 
     /** \return The file position of the start of the next record. */
     virtual off_t tell() const = 0;
 
     virtual bool seek(const off_t offset, const int whence = SEEK_SET) = 0;
 
-    /** \return a BinaryMarcReader or an XmlMarcReader. */
-    static std::unique_ptr<Reader> Factory(const std::string &input_filename, FileType reader_type = FileType::AUTO);
+    /** \return a BinaryMarcReader or an XmlMarcReader.
+     *  \note  Files ending in ".gz" or ".zst", e.g. "x.mrc.zst", will be decompressed on the fly.  tell() and seek() then refer
+     *         to offsets in the uncompressed data.
+     *  \param validate_utf8  If true, a BinaryMarcReader checks the raw bytes of each record for UTF-8 validity before parsing
+     *                        it and aborts with the offset of the first bad record.  Ignored for MARC-XML.
+     */
+    static std::unique_ptr<Reader> Factory(const std::string &input_filename, FileType reader_type = FileType::AUTO,
+                                           const bool validate_utf8 = false);
+
+    /** \return An ArchiveMemberReader for the current entry of "archive_reader".
+     *  \param member_path  Will be returned by getPath() and used in error messages, typically the archive name followed by a
+     *                      slash and the member name.
+     */
+    static std::unique_ptr<Reader> Factory(Archive::Reader * const archive_reader, const std::string &member_path,
+                                           const bool validate_utf8 = false);
 };
 
 
@@ -1092,9 +1283,10 @@ class BinaryReader final : public Reader {
     off_t next_record_start_;
     const char *mmap_;
     size_t offset_, input_file_size_;
+    bool validate_utf8_;
 
 private:
-    explicit BinaryReader(File * const input);
+    explicit BinaryReader(File * const input, const bool validate_utf8 = false);
 
 public:
     virtual ~BinaryReader() final;
@@ -1110,6 +1302,7 @@ public:
 
 private:
     Record actualRead();
+    void validateUTF8(const char * const record_start, const unsigned record_length, const off_t record_offset) const;
 };
 
 
@@ -1152,6 +1345,44 @@ private:
 };
 
 
+/** \brief Reads MARC-21 records straight from the current entry of an Archive::Reader, i.e. w/o extracting it first.
+ *  \note  Only sequential reading is supported, rewind() aborts and seek() always fails.  The archive reader must not be advanced
+ *         to its next entry while an instance is still in use.
+ */
+class ArchiveMemberReader final : public Reader {
+    friend class Reader;
+    Archive::Reader * const archive_reader_;
+    const std::string member_path_;
+    Record last_record_;
+    std::string buffer_;
+    size_t buffer_offset_;
+    off_t buffer_start_, next_record_start_; // Offsets relative to the start of the archive entry.
+    bool end_of_entry_, validate_utf8_;
+
+private:
+    ArchiveMemberReader(Archive::Reader * const archive_reader, const std::string &member_path, const bool validate_utf8);
+
+public:
+    virtual ~ArchiveMemberReader() final = default;
+
+    virtual FileType getReaderType() override final { return FileType::BINARY; }
+    virtual Record read() override final;
+    virtual void rewind() override final;
+    virtual const std::string &getPath() const override final { return member_path_; }
+
+    /** \return The offset of the start of the next record relative to the start of the archive entry. */
+    virtual off_t tell() const override final { return next_record_start_; }
+
+    virtual bool seek(const off_t /*offset*/, const int /*whence*/ = SEEK_SET) override final { return false; }
+
+private:
+    Record actualRead();
+
+    // \return False if the archive entry ended before "min_size" unconsumed bytes were available.
+    bool fillBuffer(const size_t min_size);
+};
+
+
 class Writer {
 protected:
     std::unique_ptr<File> output_;
@@ -1173,9 +1404,12 @@ public:
     /** \brief Flushes the buffers of the underlying File to the storage medium.
      *  \return True on success and false on failure.  Sets errno if there is a failure.
      */
-    bool flush() { return output_->flush(); }
+    virtual bool flush() { return output_->flush(); }
 
-    /** \note If you pass in AUTO for "writer_type", "output_filename" must end in ".mrc" or ".xml"! */
+    /** \note If you pass in AUTO for "writer_type", "output_filename" must end in ".mrc" or ".xml"!
+     *  \note An additional ".gz" or ".zst" suffix, e.g. "x.mrc.zst", results in seekable compressed output, see CompressedFile.h.
+     *        Compressed files can't be opened in APPEND mode and flush() does not write out incomplete compression frames.
+     */
     static std::unique_ptr<Writer> Factory(const std::string &output_filename, FileType writer_type = FileType::AUTO,
                                            const WriterMode writer_mode = WriterMode::OVERWRITE);
 };
@@ -1194,19 +1428,25 @@ public:
 };
 
 
+/** \brief Writes unindented MARC-XML.
+ *  \note  Records are serialised into a large buffer that gets handed to the output file in one go whenever it is full,
+ *         which, for compressed output, means that the compression threads of CompressedFile get whole frames.
+ */
 class XmlWriter final : public Writer {
     friend class Writer;
-    MarcXmlWriter xml_writer_;
+    std::string buffer_; // Serialised records that have not been written to "output_" yet.
 
 private:
-    explicit XmlWriter(File * const output, const unsigned indent_amount = 0,
-                       const MarcXmlWriter::TextConversionType text_conversion_type = MarcXmlWriter::NoConversion)
-        : Writer(output), xml_writer_(output, /* suppress_header_and_tailer = */ false, indent_amount, text_conversion_type) { }
+    explicit XmlWriter(File * const output);
 
 public:
     virtual ~XmlWriter() override final;
 
     virtual void write(const Record &record) override final;
+    virtual bool flush() override final;
+
+private:
+    bool writeBuffer();
 };
 
 
@@ -1250,14 +1490,17 @@ bool GetWikidataId(const Record &record, std::string * const wikidata_id);
 bool GetWikipediaLink(const Record &record, std::string * const wikipedia_link);
 
 
-/** \brief Generates a reproducible SHA-1 hash over our internal data.
+/** \brief Generates a reproducible hash over our internal data.
  *  \param excluded_fields        The list of tags specified here will be excluded from the checksum calculation.
  *  \param suppress_local_fields  If true we exclude fields that have non-pure-digit tags or tags that contain at least one digit nine.
+ *  \param checksum_type          See ChecksumType.  FAST hashes each field separately and adds up the results, so neither the
+ *                                fields have to be sorted nor a copy of the record has to be made.
  *  \return the hash
  *  \note Equivalent records with different field order generate the same hash.  (This can only happen if at least one tag
  *        has been repeated.)
  */
-std::string CalcChecksum(const Record &record, const std::set<Tag> &excluded_fields = { "001" }, const bool suppress_local_fields = true);
+std::string CalcChecksum(const Record &record, const std::set<Tag> &excluded_fields = { "001" }, const bool suppress_local_fields = true,
+                         const ChecksumType checksum_type = ChecksumType::SHA1);
 
 
 // Takes local UB Tübingen criteria into account.
@@ -1286,6 +1529,14 @@ size_t CollectRecordOffsets(MARC::Reader * const marc_reader, std::unordered_map
 FileType GetOptionalReaderType(int * const argc, char *** const argv, const int arg_no, const FileType default_file_type = FileType::AUTO);
 
 
+/** \brief Handles an optional "--validate-utf8" command-line argument.
+ *
+ *  If argv[arg_no] is "--validate-utf8", argc and argv will be decremented and incremented respectively and we return true.
+ *  O/w we return false and leave "argc" and "argv" unmodified.  The result is intended to be passed on to Reader::Factory().
+ */
+bool GetOptionalValidateUTF8Flag(int * const argc, char *** const argv, const int arg_no);
+
+
 /** \brief Handles optional command-line arguments of the form "--output-format=marc-21" and "--output-format=marc-xml"
  *
  *  If an optional argument of one of the expected forms is found in argv[arg_no], argc and argv will be incremented and
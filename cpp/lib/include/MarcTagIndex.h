@@ -0,0 +1,116 @@
+/** \file    MarcTagIndex.h
+ *  \brief   A sidecar index that maps MARC tags to the records that contain them.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <sys/types.h>
+#include "MARC.h"
+
+
+/** \class MarcTagIndex
+ *  \brief Stores, for each tag, the set of ordinals of the records that contain at least one field w/ that tag as well as the
+ *         file offset of each record.
+ *  \note  Record ordinals refer to the records as returned by MARC::Reader::read(), i.e. the physical records of a logical
+ *         record w/ a single control number count as one.  The sets are stored as roaring-style bitmaps: the ordinals are
+ *         partitioned into chunks of 2^16 and each chunk is either stored as a sorted array of 16-bit values or, if it is
+ *         dense, as a bitmap.  The index file gets mmap(2)'ed, so opening it is cheap.
+ */
+class MarcTagIndex {
+    struct Header;
+    struct TagEntry;
+    struct ContainerEntry;
+
+    std::string index_path_;
+    const char *map_start_;
+    size_t map_size_;
+    const Header *header_;
+    const uint64_t *record_offsets_;
+    const TagEntry *tags_;
+    const ContainerEntry *containers_;
+    const char *container_data_;
+
+public:
+    explicit MarcTagIndex(const std::string &index_path);
+    MarcTagIndex(const MarcTagIndex &rhs) = delete;
+    ~MarcTagIndex();
+
+    size_t getRecordCount() const;
+
+    //* \return The number of records that contain "tag".
+    size_t getRecordCount(const MARC::Tag &tag) const;
+
+    //* \return All tags that occur in the indexed file in ascending order.
+    std::vector<MARC::Tag> getTags() const;
+
+    //* \return The offset of the record w/ ordinal "record_ordinal" suitable for MARC::Reader::seek().
+    inline off_t getRecordOffset(const size_t record_ordinal) const { return record_offsets_[record_ordinal]; }
+
+    /** \return True if the index was generated from a file w/ the same size and modification time as "marc_path", o/w
+     *          false.
+     */
+    bool isUpToDate(const std::string &marc_path) const;
+
+    //* \brief Sets "record_ordinals" to the ordinals of all records that contain at least one of "tags" in ascending order.
+    void getRecordsWithAnyTag(const std::set<MARC::Tag> &tags, std::vector<uint32_t> * const record_ordinals) const;
+
+    /** \brief Indexes all records that "marc_reader" returns.  "marc_reader" should be positioned at the start of its file.
+     *  \note  The index is written to a temporary file first which will then be renamed.
+     */
+    static void Create(MARC::Reader * const marc_reader, const std::string &index_path);
+
+    //* \return Where we expect the tag index of "marc_path", e.g. "x.mrc.tag_index" for "x.mrc".
+    static std::string GetSidecarPath(const std::string &marc_path);
+
+    //* \return The index at GetSidecarPath(marc_path) or nullptr if it doesn't exist or is out of date.
+    static std::unique_ptr<MarcTagIndex> OpenSidecar(const std::string &marc_path);
+
+private:
+    const TagEntry *findTag(const MARC::Tag &tag) const;
+};
+
+
+/** \class TaggedRecordReader
+ *  \brief Returns only those records of a MARC::Reader that contain at least one field w/ one of a set of tags.
+ *  \note  If there is an up-to-date sidecar tag index for the file of the MARC::Reader, only the matching records will be read
+ *         at all, o/w all records will be read and filtered.  Either way the MARC::Reader must be positioned at the start of its
+ *         file.  Once all matching records have been returned, its position is unspecified but it can be rewound.
+ */
+class TaggedRecordReader {
+    MARC::Reader * const marc_reader_;
+    const std::set<MARC::Tag> tags_;
+    std::unique_ptr<MarcTagIndex> tag_index_;
+    std::vector<uint32_t> record_ordinals_;
+    std::vector<uint32_t>::const_iterator next_record_ordinal_;
+    uint32_t current_record_ordinal_; // The ordinal of the record at the current position of "marc_reader_".
+
+public:
+    TaggedRecordReader(MARC::Reader * const marc_reader, const std::set<MARC::Tag> &tags);
+
+    //* \return The next matching record or an empty record when there are no more.
+    MARC::Record read();
+
+    inline bool usesTagIndex() const { return tag_index_ != nullptr; }
+};
@@ -44,13 +44,32 @@ bool PdfFileContainsNoText(const std::string &path);
 bool PdfDocContainsNoText(const std::string &document);
 
 
+/** \brief Keeps tesseract from starting OpenMP threads of its own, which would only compete w/ our threads when we OCR several
+ *         images in parallel.  An OMP_THREAD_LIMIT that has already been set will be kept.
+ *  \note  OpenMP reads its environment when it gets initialised and setenv(3) is not thread-safe, so this must be called at the
+ *         start of main() before any threads have been started.
+ */
+void LimitTesseractThreads();
+
+
 /** \brief Uses tesseract API to attempt OCR. */
 bool GetTextFromImage(const std::string &img_path, const std::string &tesseract_language_code, std::string * const extracted_text);
 
 
-/** \brief Uses pdfimages + tesseract API to attempt OCR. */
+/** \brief Uses tesseract API to attempt OCR on an image held in memory.
+ *  \param image_data  The contents of an image file in any format that leptonica understands, e.g. PNG, JPEG, TIFF or PBM.
+ *  \note  Initialised tesseract instances are pooled per language, so this is cheap to call repeatedly and from several threads.
+ */
+bool GetTextFromImageData(const std::string &image_data, const std::string &tesseract_language_code, std::string * const extracted_text);
+
+
+/** \brief Uses pdfimages + tesseract API to attempt OCR.
+ *  \param thread_count  The number of threads that OCR the extracted images in parallel.  0 means one per CPU core.  Each thread
+ *                       uses a tesseract instance w/ its own copy of the language model, so only use more than one thread if
+ *                       there aren't other processes OCRing documents at the same time, c.f. LimitTesseractThreads().
+ */
 bool GetTextFromImagePDF(const std::string &pdf_document, const std::string &tesseract_language_code, std::string * const extracted_text,
-                         const unsigned timeout = DEFAULT_PDF_EXTRACTION_TIMEOUT /* in s */);
+                         const unsigned timeout = DEFAULT_PDF_EXTRACTION_TIMEOUT /* in s */, const unsigned thread_count = 1);
 
 /** \brief Convert pdf to image and then attempt tesseract OCR. */
 bool GetOCRedTextFromPDF(const std::string &pdf_document_path, const std::string &tesseract_language_code,
@@ -22,11 +22,16 @@
 #pragma once
 
 
+#include <map>
+#include <memory>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
+#include <cstdint>
 
 
 namespace RangeUtil {
@@ -131,4 +136,83 @@ void EsraSpecialProcessing(std::string * const book, std::vector<std::string> *
 std::string ConvertToDatesQuery(const std::string &ranges_str);
 
 
+// The suffixes of the range indices that we keep next to authority dumps.
+const std::string BIBLE_RANGE_INDEX_SUFFIX(".bible_ranges");
+const std::string CANON_LAW_RANGE_INDEX_SUFFIX(".canon_law_ranges");
+
+
+/** \class RangeIndex
+ *  \brief Maps the keys of authority records, e.g. GND codes or PPNs, to the numeric ranges that they stand for, e.g. bible or
+ *         canon law references, and finds all ranges that overlap a given range.
+ *  \note  The index file gets mmap(2)'ed, so opening it is cheap.  Ranges are stored sorted by key as well as sorted by their
+ *         starts.  The latter are accompanied by the running maximum of their ends, which makes overlap queries binary searches
+ *         followed by a scan over the candidates.
+ */
+class RangeIndex {
+    struct Header;
+    struct KeyEntry;
+    struct IntervalEntry;
+
+public:
+    struct Range {
+        uint32_t start_, end_;
+
+        Range() = default;
+        Range(const uint32_t start, const uint32_t end): start_(start), end_(end) { }
+        inline bool operator<(const Range &rhs) const { return start_ < rhs.start_ or (start_ == rhs.start_ and end_ < rhs.end_); }
+        inline bool operator==(const Range &rhs) const { return start_ == rhs.start_ and end_ == rhs.end_; }
+    };
+
+    struct KeyAndRange {
+        std::string_view key_;
+        Range range_;
+    };
+
+private:
+    std::string index_path_;
+    const char *map_start_;
+    size_t map_size_;
+    const Header *header_;
+    const KeyEntry *keys_;
+    const Range *ranges_;
+    const IntervalEntry *intervals_;
+    const char *key_data_;
+
+public:
+    explicit RangeIndex(const std::string &index_path);
+    RangeIndex(const RangeIndex &rhs) = delete;
+    ~RangeIndex();
+
+    size_t getKeyCount() const;
+    size_t getRangeCount() const;
+
+    //* \return The ranges of the authority record w/ key "key" in ascending order, empty if there is no such record.
+    std::span<const Range> getRanges(const std::string_view key) const;
+
+    //* \brief Sets "keys_and_ranges" to all ranges that overlap [start, end], ordered by their starts.
+    void findOverlappingRanges(const uint32_t start, const uint32_t end, std::vector<KeyAndRange> * const keys_and_ranges) const;
+
+    //* \return "range" as "start:end" w/ both numbers zero-padded to the digit count that was passed to Create().
+    std::string toString(const Range &range) const;
+
+    /** \return True if the index was generated from a file w/ the same size and modification time as "authority_path", o/w
+     *          false.
+     */
+    bool isUpToDate(const std::string &authority_path) const;
+
+    /** \brief Writes the index for "keys_and_ranges", which should have been extracted from "authority_path", to "index_path".
+     *  \param digit_count  The number of digits of the textual representation of the range boundaries, see toString().
+     *  \note  The index is written to a temporary file first which will then be renamed.
+     */
+    static void Create(const std::string &index_path, const std::string &authority_path, const unsigned digit_count,
+                       const std::map<std::string, std::vector<Range>> &keys_and_ranges);
+
+    //* \return The index at "authority_path" + "suffix" or nullptr if it doesn't exist or is out of date.
+    static std::unique_ptr<RangeIndex> OpenSidecar(const std::string &authority_path, const std::string &suffix);
+
+private:
+    const KeyEntry *findKey(const std::string_view key) const;
+};
+
+
 } // namespace RangeUtil
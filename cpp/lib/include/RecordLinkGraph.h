@@ -0,0 +1,105 @@
+/** \file    RecordLinkGraph.h
+ *  \brief   A compact, persistent snapshot of the links between the title records of a MARC collection.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "MARC.h"
+
+
+/** \class RecordLinkGraph
+ *  \brief Stores the PPN's of all records of a collection along w/ their superior works, cross links, publication years,
+ *         bibliographic levels and whether they're electronic resources.
+ *  \note  The nodes of the graph are the PPN's of the records as well as the PPN's that links point to, sorted by PPN.  Nodes
+ *         that are only link targets can be recognised w/ Node::isRecord().  If several records have the same PPN, only the
+ *         first one is stored.  The graph file gets mmap(2)'ed, so loading it is cheap.
+ */
+class RecordLinkGraph {
+    struct Header;
+    struct NodeEntry;
+
+public:
+    class Node {
+        friend class RecordLinkGraph;
+        const RecordLinkGraph *graph_;
+        const NodeEntry *entry_;
+
+    public:
+        Node(): graph_(nullptr), entry_(nullptr) { }
+
+        std::string_view getPPN() const;
+
+        //* \return False if no record has our PPN, i.e. we're only the target of links.
+        bool isRecord() const;
+
+        bool isElectronicResource() const;
+
+        //* \return Leader position 07, e.g. 'a' for component parts or 's' for serials.
+        char getBibliographicLevel() const;
+
+        //* \return "Date 1" of the 008 field or 0 if it is missing or not a number.
+        unsigned getPublicationYear() const;
+
+        //* \return The PPN's from the up-link fields, see MARC::Record::getParentControlNumbers().
+        std::vector<std::string_view> getSuperiorPPNs() const;
+
+        //* \return The PPN's that MARC::ExtractCrossLinkPPNs() returns.
+        std::vector<std::string_view> getCrossLinkPPNs() const;
+
+    private:
+        Node(const RecordLinkGraph * const graph, const NodeEntry * const entry): graph_(graph), entry_(entry) { }
+        std::vector<std::string_view> getPPNs(const uint32_t first_link, const uint32_t link_count) const;
+    };
+
+private:
+    std::string graph_path_;
+    const char *map_start_;
+    size_t map_size_;
+    const Header *header_;
+    const NodeEntry *nodes_;
+    const uint32_t *links_;
+    const char *ppn_data_;
+
+public:
+    explicit RecordLinkGraph(const std::string &graph_path);
+    RecordLinkGraph(const RecordLinkGraph &rhs) = delete;
+    ~RecordLinkGraph();
+
+    size_t getRecordCount() const;
+
+    //* \return The number of records plus the number of PPN's that links point to but that have no records.
+    size_t getNodeCount() const;
+
+    //* \return The node w/ index "node_no", nodes are sorted by PPN.
+    Node getNode(const size_t node_no) const;
+
+    //* \return True if there is a record w/ PPN "ppn", in which case "*node" will be set to its node, o/w false.
+    bool findRecord(const std::string_view ppn, Node * const node) const;
+
+    /** \brief Extracts the links of all records that "marc_reader" returns.  "marc_reader" should be positioned at the start of
+     *         its file.
+     *  \note  The graph is written to a temporary file first which will then be renamed.
+     */
+    static void Create(MARC::Reader * const marc_reader, const std::string &graph_path);
+};
@@ -20,6 +20,7 @@
 #pragma once
 
 
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -68,7 +69,8 @@ public:
         }
     };
 
-    enum Option { ENABLE_UTF8 = 1, CASE_INSENSITIVE = 2, MULTILINE = 4, ENABLE_UCP = 8 };
+    // ENABLE_JIT compiles the pattern to machine code which pays off if it will be used to match very many subjects.
+    enum Option { ENABLE_UTF8 = 1, CASE_INSENSITIVE = 2, MULTILINE = 4, ENABLE_UCP = 8, ENABLE_JIT = 16 };
 
 private:
     static constexpr size_t MAX_SUBSTRING_MATCHES = 40;
@@ -86,9 +88,63 @@ public:
     inline const std::string &getPattern() const { return pattern_; }
     MatchResult match(const std::string &subject, const size_t subject_start_offset = 0, size_t * const start_pos = nullptr,
                       size_t * const end_pos = nullptr) const;
+
+    //* \return True if the pattern matches somewhere in "subject".  Cheaper than match() as no MatchResult has to be constructed.
+    bool matched(const std::string &subject) const;
+
     std::string replaceAll(const std::string &subject, const std::string &replacement) const;
     /* c.f. description of RegexMatcher::replaceWithBackreferences below for usage and examples */
-    std::string replaceWithBackreferences(const std::string &subject, const std::string &replacement, const bool global = false);
+    std::string replaceWithBackreferences(const std::string &subject, const std::string &replacement, const bool global = false) const;
+};
+
+
+/** \class RegexSet
+ *  \brief Matches a subject against many patterns at once.
+ *  \note  For each pattern we extract a literal that every match has to contain.  A single Aho-Corasick scan of a subject over
+ *         all of these literals then tells us which patterns could possibly match and only those are handed to PCRE.  Patterns
+ *         w/o such a literal, e.g. those w/ a top-level alternation, are always considered to be candidates.
+ *  \note  All member functions are const and instances may be shared between threads.
+ */
+class RegexSet {
+    class LiteralAutomaton;
+
+    std::vector<ThreadSafeRegexMatcher> matchers_;
+    std::vector<size_t> unfiltered_pattern_indices_;
+    std::shared_ptr<const LiteralAutomaton> case_sensitive_automaton_, case_insensitive_automaton_;
+
+public:
+    static constexpr size_t NO_MATCH = std::numeric_limits<size_t>::max();
+
+    /** \param options  Or'ed together values of type ThreadSafeRegexMatcher::Option which will be applied to all patterns. */
+    explicit RegexSet(const std::vector<std::string> &patterns, const unsigned options = ThreadSafeRegexMatcher::ENABLE_UTF8);
+
+    inline size_t size() const { return matchers_.size(); }
+    inline bool empty() const { return matchers_.empty(); }
+    inline const ThreadSafeRegexMatcher &getMatcher(const size_t pattern_index) const { return matchers_[pattern_index]; }
+    inline const std::string &getPattern(const size_t pattern_index) const { return matchers_[pattern_index].getPattern(); }
+
+    /** \brief Determines the patterns that may match "subject" w/o running any of them.
+     *  \param candidate_indices    Will be set to the ascending indices of all patterns, starting at "first_pattern_index", whose
+     *                              literal occurs in "subject" or which have no literal at all.
+     */
+    void getCandidates(const std::string &subject, std::vector<size_t> * const candidate_indices,
+                       const size_t first_pattern_index = 0) const;
+
+    /** \return The lowest index, that is not less than "first_pattern_index", of a pattern that matches "subject" or NO_MATCH. */
+    size_t findFirstMatch(const std::string &subject, const size_t first_pattern_index = 0) const;
+
+    inline bool matchAny(const std::string &subject) const { return findFirstMatch(subject) != NO_MATCH; }
+
+    /** \brief Sets "matched_pattern_indices" to the ascending indices of all patterns that match "subject". */
+    void match(const std::string &subject, std::vector<size_t> * const matched_pattern_indices) const;
+
+    /** \brief Determines the longest literal that has to be part of any text that is matched by "pattern".
+     *  \param case_insensitive  Will be set to true if the literal has to be compared case-insensitively.  In that case the
+     *                           returned literal has been converted to lowercase.
+     *  \return The literal or the empty string if we were unable to find one.
+     *  \note   When in doubt, e.g. for patterns w/ rarely used escape sequences, we err on the side of returning a shorter literal.
+     */
+    static std::string ExtractRequiredLiteral(const std::string &pattern, const unsigned options, bool * const case_insensitive);
 };
 
 
@@ -1,15 +1,20 @@
 #pragma once
 
 
+#include <array>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #ifndef LIBSTEMMER_H
 #include "libstemmer.h"
 #define LIBSTEMMER_H
 #endif
 
 
-/** \warning This class is not thread-safe! */
+/** \warning This class is not thread-safe!  Use ConcurrentStemmer in multithreaded code. */
 class Stemmer {
+    friend class ConcurrentStemmer;
     sb_stemmer *stemmer_;
 
     explicit Stemmer(const std::string &language_name_or_code);
@@ -36,3 +41,52 @@ public:
      */
     static const Stemmer *StemmerFactory(const std::string &language_name_or_code);
 };
+
+
+/** \brief A thread-safe stemming facade.
+ *  \note  Each thread lazily creates its own Snowball stemmer per language.  Stemmed words are memoised in a cache keyed by
+ *         (language, word) that is split into independently locked shards so that concurrent lookups rarely contend.
+ */
+class ConcurrentStemmer {
+    static constexpr size_t SHARD_COUNT = 64;
+
+    struct Shard {
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::string> language_and_word_to_stem_map_;
+    };
+    std::array<Shard, SHARD_COUNT> shards_;
+    const size_t max_shard_size_;
+
+public:
+    /** \param max_cache_size  An approximate upper bound for the number of memoised stems.  Shards that become too large
+     *                         are simply cleared.
+     */
+    explicit ConcurrentStemmer(const size_t max_cache_size = 4000000);
+
+    /** \return True if we have a stemmer for "language_name_or_code", o/w false. */
+    bool supportsLanguage(const std::string &language_name_or_code) const {
+        return getThreadLocalStemmer(language_name_or_code) != nullptr;
+    }
+
+    /** \return The stem of "word" or "word" itself if "language_name_or_code" is not supported. */
+    std::string stem(const std::string &language_name_or_code, const std::string &word);
+
+    /** \brief Stems all of "words".
+     *  \return False if "language_name_or_code" is not supported, in which case "stemmed_words" will be a copy of "words".
+     */
+    bool stem(const std::string &language_name_or_code, const std::vector<std::string> &words,
+              std::vector<std::string> * const stemmed_words);
+
+    /** \brief Discards all memoised stems. */
+    void clearCache();
+
+    /** \return The number of currently memoised stems. */
+    size_t getCacheSize();
+
+    /** \return A process-wide instance with the default cache size. */
+    static ConcurrentStemmer &GetDefaultInstance();
+
+private:
+    static const Stemmer *getThreadLocalStemmer(const std::string &language_name_or_code);
+    std::string lookupOrStem(const Stemmer &stemmer, const std::string &language_name_or_code, const std::string &word);
+};
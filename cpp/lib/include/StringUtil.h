@@ -2141,6 +2141,17 @@ inline size_t SuperFastHash(const std::string &s) {
 }
 
 
+/** \brief  Calculates Austin Appleby's MurmurHash3_x64_128, a fast, non-cryptographic 128-bit hash.
+ *  \param  hash  Must point to two elements which will be set to the first and the second 64 bits of the hash.
+ *  \note   Don't use this where an adversary could benefit from constructing collisions.
+ */
+void MurmurHash3_128(const void * const data, const size_t len, const uint64_t seed, uint64_t * const hash);
+
+
+//* \return The 128-bit MurmurHash3 of "s" as a 16-byte binary string.
+std::string MurmurHash3_128(const std::string &s, const uint64_t seed = 0);
+
+
 /** \brief    Calculates the Adler-32 checksum for "s".
  *  \param    s         The string whose checksum we desire.
  *  \param    s_length  The number of bytes in "s."
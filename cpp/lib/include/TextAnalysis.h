@@ -0,0 +1,110 @@
+/** \file    TextAnalysis.h
+ *  \brief   A reusable tokenise -> lowercase -> stopword filter -> stem pipeline for keyword extraction.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+namespace TextAnalysis {
+
+
+/** \brief Bump-pointer storage for short strings.
+ *  \note  Memory is only released by the destructor; clear() makes all blocks available for reuse.
+ */
+class TokenArena {
+    struct Block {
+        std::unique_ptr<char[]> data_;
+        size_t size_;
+    };
+    std::vector<Block> blocks_;
+    size_t block_size_, current_block_no_, used_in_current_block_;
+
+public:
+    explicit TokenArena(const size_t block_size = 64 * 1024): block_size_(block_size), current_block_no_(0), used_in_current_block_(0) { }
+    TokenArena(const TokenArena &rhs) = delete;
+    TokenArena &operator=(const TokenArena &rhs) = delete;
+
+    /** \return A view of a copy of "s" which remains valid until the next call to clear(). */
+    std::string_view store(const std::string_view s);
+
+    /** \brief Invalidates all previously returned views. */
+    void clear() { current_block_no_ = used_in_current_block_ = 0; }
+};
+
+
+/** \brief Breaks "text" up into words in the same way as TextUtil::ChopIntoWords() but w/o copying anything.
+ *  \note  Unlike TextUtil::ChopIntoWords() we also strip trailing apostrophes from the last word of "text".
+ *  \param text             Assumed to be in UTF-8.  Invalid byte sequences act as word separators.
+ *  \param tokens           Views into "text".
+ *  \param min_word_length  Reject words that have fewer code points than this.
+ */
+void Tokenise(const std::string_view text, std::vector<std::string_view> * const tokens, const unsigned min_word_length = 1);
+
+
+class Pipeline {
+    unsigned min_word_length_;
+    bool stem_;
+    std::string additional_stopwords_language_code_;
+    TokenArena stopwords_arena_, token_arena_;
+    std::unordered_map<std::string, std::unordered_set<std::string_view>> language_codes_to_stopword_sets_;
+    std::string lowercase_text_;
+    std::vector<std::string_view> unfiltered_tokens_;
+
+public:
+    /** \param stem  If true, tokens will be stemmed with the process-wide ConcurrentStemmer if we have a stemmer for the
+     *               language passed into analyse().
+     */
+    explicit Pipeline(const unsigned min_word_length = 1, const bool stem = false)
+        : min_word_length_(min_word_length), stem_(stem), stopwords_arena_(16 * 1024) { }
+    Pipeline(const Pipeline &rhs) = delete;
+    Pipeline &operator=(const Pipeline &rhs) = delete;
+
+    /** \brief Loads a list of stopwords, one per line.  Empty lines and lines starting with a semicolon are ignored.
+     *  \note  Aborts if "stopwords_filename" can't be read.
+     */
+    void loadStopwords(const std::string &language_code, const std::string &stopwords_filename);
+
+    bool hasStopwords(const std::string &language_code) const {
+        return language_codes_to_stopword_sets_.find(language_code) != language_codes_to_stopword_sets_.cend();
+    }
+
+    /** \brief The stopwords for "language_code" will be removed in addition to those for the language passed into analyse(). */
+    void setAdditionalStopwordsLanguage(const std::string &language_code) { additional_stopwords_language_code_ = language_code; }
+
+    /** \brief Lowercases and tokenises "text", removes stopwords and, optionally, stems the remaining tokens.
+     *  \param language_code  Selects the stopword list and stemmer.  Unknown or empty codes disable the respective steps.
+     *  \param tokens         Views into storage owned by the pipeline that remain valid until the next call to analyse().
+     *  \return False if "text" was not valid UTF-8, else true.
+     */
+    bool analyse(const std::string &text, const std::string &language_code, std::vector<std::string_view> * const tokens);
+
+private:
+    bool isStopword(const std::unordered_set<std::string_view> * const stopwords, const std::string_view token) const;
+};
+
+
+} // namespace TextAnalysis
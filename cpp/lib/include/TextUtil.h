@@ -53,6 +53,7 @@ constexpr uint32_t NON_BREAKING_HYPHEN(0x2011u);
  */
 class EncodingConverter {
     friend class IdentityConverter;
+    friend class SingleByteToUTF8Converter;
     const std::string from_encoding_;
     const std::string to_encoding_;
 
@@ -101,6 +102,22 @@ public:
 };
 
 
+/** \brief Converts ISO-8859-1 or ISO-8859-15 to UTF-8 w/o going through iconv(3).
+ *  \note  EncodingConverter::Factory() returns an instance of this class when asked for one of these conversions.
+ */
+class SingleByteToUTF8Converter : public EncodingConverter {
+    friend std::unique_ptr<EncodingConverter> EncodingConverter::Factory(const std::string &from_encoding, const std::string &to_encoding,
+                                                                         std::string * const error_message);
+    bool latin9_;
+
+    SingleByteToUTF8Converter(const std::string &from_encoding, const std::string &to_encoding, const bool latin9)
+        : EncodingConverter(from_encoding, to_encoding, (iconv_t)-1), latin9_(latin9) { }
+
+public:
+    virtual bool convert(const std::string &input, std::string * const output) final override;
+};
+
+
 /** \brief Strips HTML tags and converts entities.
  *  \param html             The HTML to process.
  *  \param initial_charset  Typically the content-type header's charset, if any.
@@ -235,9 +252,32 @@ inline bool IsUFT8ContinuationByte(const char ch) {
 }
 
 
+/** \brief Checks whether the "length" bytes starting at "data" are valid UTF-8 as defined by RFC 3629.
+ *  \note  Overlong encodings, surrogates and code points beyond U+10FFFF are rejected.
+ *  \note  Uses an AVX2, SSE4.1 or scalar implementation depending on what the CPU supports.  Fast enough to be applied to
+ *         entire memory-mapped record buffers.
+ */
+bool IsValidUTF8(const char * const data, const size_t length);
 bool IsValidUTF8(const std::string &utf8_candidate);
 
 
+/** \brief Bulk conversion of ISO-8859-1 (Latin-1) or ISO-8859-15 (Latin-9) text to UTF-8.
+ *  \note  Runs of ASCII characters are copied as a whole, which makes this much faster than iconv(3) for typical
+ *         bibliographic data.
+ */
+void Latin1ToUTF8(const char * const data, const size_t length, std::string * const utf8_string);
+void Latin9ToUTF8(const char * const data, const size_t length, std::string * const utf8_string);
+
+
+/** \return True if none of the "length" bytes starting at "data" has its high bit set.
+ *  \note   Uses SSE2 where available and examines 8 bytes at a time otherwise.
+ */
+bool IsASCII(const char *data, const size_t length);
+inline bool IsASCII(const std::string &s) {
+    return IsASCII(s.data(), s.size());
+}
+
+
 /** \brief Break up text into individual lowercase "words".
  *
  *  \param text             Assumed to be in UTF8.
@@ -26,6 +26,8 @@
 #pragma once
 
 
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <stdexcept>
 #include <pthread.h>
@@ -215,6 +217,65 @@ private:
 };
 
 
+/** \class  BoundedQueue
+ *  \brief  A queue that hands items from producer threads to consumer threads.
+ *  \note   Producers block while "max_size" items are queued, so a fast producer can't outrun the consumers.  Typically one
+ *          thread reads records in batches and pushes them while several worker threads pop and process the batches.
+ */
+template <typename ItemType>
+class BoundedQueue {
+    const size_t max_size_;
+    std::deque<ItemType> items_;
+    bool closed_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_, not_full_;
+
+public:
+    explicit BoundedQueue(const size_t max_size): max_size_(max_size), closed_(false) { }
+    BoundedQueue(const BoundedQueue &rhs) = delete;
+
+    //* \note Blocks while the queue is full.
+    void push(ItemType &&item);
+
+    //* \return False if the queue has been closed and there are no more items, o/w true.
+    bool pop(ItemType * const item);
+
+    //* \brief Signals that no more items will be pushed.
+    void close();
+};
+
+
+template <typename ItemType>
+void BoundedQueue<ItemType>::push(ItemType &&item) {
+    std::unique_lock<std::mutex> mutex_locker(mutex_);
+    not_full_.wait(mutex_locker, [this] { return items_.size() < max_size_; });
+    items_.emplace_back(std::move(item));
+    not_empty_.notify_one();
+}
+
+
+template <typename ItemType>
+bool BoundedQueue<ItemType>::pop(ItemType * const item) {
+    std::unique_lock<std::mutex> mutex_locker(mutex_);
+    not_empty_.wait(mutex_locker, [this] { return closed_ or not items_.empty(); });
+    if (items_.empty())
+        return false;
+
+    *item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+}
+
+
+template <typename ItemType>
+void BoundedQueue<ItemType>::close() {
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+}
+
+
 pid_t GetThreadId();
 
 
@@ -359,8 +359,8 @@ std::string StructTmToString(const struct tm &tm);
  *  \note The strptime format may be prefixed by a comma-separated list of locale names sourrounded by paretheses.  If more than one
  *        local has been provided, conversions will be attempted until one succeeds of the list has been exhausted.
  */
-struct tm StringToStructTm(std::string date_str, std::string optional_strptime_format = DEFAULT_FORMAT);
-bool StringToStructTm(struct tm * const tm, std::string date_str, std::string optional_strptime_format = DEFAULT_FORMAT);
+struct tm StringToStructTm(const std::string &date_str, const std::string &optional_strptime_format = DEFAULT_FORMAT);
+bool StringToStructTm(struct tm * const tm, const std::string &date_str, const std::string &optional_strptime_format = DEFAULT_FORMAT);
 
 
 /* Returns the difference in seconds between beginning and end. */
@@ -30,6 +30,7 @@
 #include <list>
 #include <stack>
 #include <string>
+#include <string_view>
 #include "File.h"
 
 
@@ -153,6 +154,12 @@ public:
     static std::string XmlEscape(const std::string &unescaped_text, const XmlWriter::TextConversionType text_conversion_type,
                                  const std::string &additional_escapes = "");
 
+    /** \brief  Appends "unescaped_text" w/ the XML metacharacters escaped to "output".
+     *  \note   This is what XmlEscape() does w/o a text conversion and additional escapes but we don't need a temporary string
+     *          and runs of characters that don't need escaping are copied en bloc.
+     */
+    static void AppendXmlEscaped(const std::string_view unescaped_text, std::string * const output);
+
 private:
     XmlWriter();                                // intentionally unimplemented
     XmlWriter(const XmlWriter &rhs);            // intentionally unimplemented
@@ -20,6 +20,7 @@
 #pragma once
 
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -41,10 +42,18 @@
  * \note Set the environment variable LOGGER_FORMAT to control the output format of our logger.  So far we support
  *       "process_pids", "strip_call_site" and "no_decorations".  You may combine any of these, e.g. by separating them with
  *       commas.
+ * \note Set the environment variable LOGGER_MODE to "async" to start out in asynchronous mode, see setMode() below.
  */
 class Logger {
 public:
     enum LogLevel { LL_ERROR = 1, LL_WARNING = 2, LL_INFO = 3, LL_DEBUG = 4 };
+
+    /** In SYNCHRONOUS mode every message is written with its own write(2) call by the thread that logged it.  In
+     *  ASYNCHRONOUS mode messages are formatted by the logging thread, queued in a lock-free per-thread ring buffer
+     *  and written in batches by a background writer thread.  Use the latter for long-running, heavily multithreaded
+     *  programs and the former for short-lived tools.
+     */
+    enum Mode { SYNCHRONOUS, ASYNCHRONOUS };
     friend Logger *LoggerInstantiator();
 
 protected:
@@ -52,13 +61,15 @@ protected:
 
     std::mutex mutex_;
     bool log_process_pids_, log_no_decorations_, log_strip_call_site_;
+    bool debug_environment_override_; // True if the environment variable "UTIL_LOG_DEBUG" was set to "true" at startup.
     LogLevel min_log_level_;
+    std::atomic<Mode> mode_;
 
     void formatMessage(const std::string &level, std::string * const msg);
 
 public:
     Logger();
-    virtual ~Logger() = default;
+    virtual ~Logger();
 
 public:
     void redirectOutput(const int new_fd);
@@ -72,6 +83,23 @@ public:
     void setMinimumLogLevel(const LogLevel min_log_level) { min_log_level_ = min_log_level; }
     LogLevel getMinimumLogLevel() const { return min_log_level_; }
 
+    /** \return True if a message of level "log_level" would actually be emitted.
+     *  \note   Used by the LOG_XXX macros to avoid constructing messages that would be discarded anyway.
+     */
+    inline bool isEnabled(const LogLevel log_level) const {
+        return log_level <= min_log_level_ or (log_level == LL_DEBUG and debug_environment_override_);
+    }
+
+    /** \brief Switches between synchronous and asynchronous logging.
+     *  \note  Switching back to SYNCHRONOUS mode stops the background writer thread after it wrote all pending messages.
+     *         This also happens automatically at exit(3) and before fatal errors are reported.
+     */
+    void setMode(const Mode new_mode);
+    Mode getMode() const { return mode_.load(); }
+
+    /** \brief Blocks until all messages queued in ASYNCHRONOUS mode have been written.  A no-op in SYNCHRONOUS mode. */
+    void flush();
+
     //* Emits "msg" and then calls exit(3), also generates a call stack trace if the environment variable BACKTRACE has been set.
     [[noreturn]] virtual void error(const std::string &msg) __attribute__((noreturn));
     [[noreturn]] virtual void error(const std::string &function_name, const std::string &msg) __attribute__((noreturn)) {
@@ -92,7 +120,7 @@ public:
     inline void info(const std::string &function_name, const int msg) { info(function_name, std::to_string(msg)); }
 
     /** \note Only writes actual log messages if the environment variable "UTIL_LOG_DEBUG" exists and is set
-     *  to "true"!
+     *  to "true"!  The variable is only checked when the logger gets constructed.
      */
     virtual void debug(const std::string &msg);
     inline void debug(const std::string &function_name, const std::string &msg) {
@@ -109,14 +137,19 @@ public:
 protected:
     virtual void writeString(const std::string &level, std::string msg, const bool format_message = true);
     int getFileDescriptor() const;
+
+private:
+    void queueOrWriteString(const std::string &level, const std::string &msg);
 };
 extern Logger *logger;
 
 
 #define LOG_ERROR(message) logger->error(__PRETTY_FUNCTION__, message), __builtin_unreachable()
-#define LOG_WARNING(message) logger->warning(__PRETTY_FUNCTION__, message)
-#define LOG_INFO(message) logger->info(__PRETTY_FUNCTION__, message)
-#define LOG_DEBUG(message) logger->debug(__PRETTY_FUNCTION__, message)
+// The level checks in the following macros happen before "message" gets evaluated so that we don't construct strings
+// that would be discarded anyway.
+#define LOG_WARNING(message) (logger->isEnabled(::Logger::LL_WARNING) ? logger->warning(__PRETTY_FUNCTION__, message) : void())
+#define LOG_INFO(message) (logger->isEnabled(::Logger::LL_INFO) ? logger->info(__PRETTY_FUNCTION__, message) : void())
+#define LOG_DEBUG(message) (logger->isEnabled(::Logger::LL_DEBUG) ? logger->debug(__PRETTY_FUNCTION__, message) : void())
 
 
 // TestAndThrowOrReturn -- tests condition "cond" and, if it evaluates to "true", throws an exception unless another
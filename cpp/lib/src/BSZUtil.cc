@@ -24,10 +24,12 @@
 #include <memory>
 #include <mutex>
 #include <regex>
+#include <set>
 #include <thread>
 #include "Archive.h"
 #include "Downloader.h"
 #include "FileUtil.h"
+#include "GNDNameIndex.h"
 #include "RegexMatcher.h"
 #include "StringUtil.h"
 #include "UrlUtil.h"
@@ -139,12 +141,39 @@ ArchiveType GetArchiveType(const std::string &member_name) {
 }
 
 
+// \return False if there is no local GND name index or it doesn't know "author", o/w true and the GND numbers of all matching
+//         persons.
+// \note   As the local index can't apply the restrictions of a filtered lookup URL, e.g. regarding professions or years of birth,
+//         we only use it for UNFILTERED_AUTHOR_LOOKUP_BASE_URL.
+static bool LookupLocalGNDNumbers(const std::string &author, const std::string &author_lookup_base_url,
+                                  std::set<std::string> * const gnd_numbers) {
+    if (author_lookup_base_url != UNFILTERED_AUTHOR_LOOKUP_BASE_URL)
+        return false;
+
+    const auto gnd_name_index(GNDNameIndex::GetDefaultInstance());
+    if (gnd_name_index == nullptr)
+        return false;
+
+    std::vector<GNDNameIndex::Person> persons;
+    gnd_name_index->lookup(author, &persons);
+    for (const auto &person : persons)
+        gnd_numbers->emplace(person.gnd_number_);
+
+    return not gnd_numbers->empty();
+}
+
+
 std::string GetAuthorGNDNumber(const std::string &author, const std::string &author_lookup_base_url) {
     static std::mutex fetch_author_gnd_url_to_gnd_cache_mutex;
     static std::unordered_map<std::string, std::string> fetch_author_gnd_url_to_gnd_cache;
     static const ThreadSafeRegexMatcher AUTHOR_GND_MATCHER(
         "Link zu diesem Datensatz in der GND:\\s*<[^>]+><a[^>]*>http(?:s)?://d-nb.info/gnd/([0-9X]+)</a>");
 
+    // If the name is ambiguous, the remote lookup wouldn't return a unique GND number either:
+    std::set<std::string> local_gnd_numbers;
+    if (LookupLocalGNDNumbers(author, author_lookup_base_url, &local_gnd_numbers))
+        return local_gnd_numbers.size() == 1 ? *local_gnd_numbers.cbegin() : "";
+
     // "author" must be in the lastname,firstname format
     const std::string lookup_url(author_lookup_base_url + UrlUtil::UrlEncode(author));
     {
@@ -154,20 +183,28 @@ std::string GetAuthorGNDNumber(const std::string &author, const std::string &aut
             return match->second;
     }
 
-    Downloader downloader(lookup_url);
-    if (downloader.anErrorOccurred()) {
-        LOG_WARNING("couldn't download author GND results! downloader error: " + downloader.getLastErrorMessage());
-        return "";
+    const auto persistent_cache(GNDLookupCache::GetDefaultInstance());
+    std::string gnd_number;
+    if (persistent_cache == nullptr or not persistent_cache->lookup(lookup_url, &gnd_number)) {
+        Downloader downloader(lookup_url);
+        if (downloader.anErrorOccurred()) {
+            LOG_WARNING("couldn't download author GND results! downloader error: " + downloader.getLastErrorMessage());
+            return "";
+        }
+
+        const auto match(AUTHOR_GND_MATCHER.match(downloader.getMessageBody()));
+        if (match)
+            gnd_number = match[1];
+        if (persistent_cache != nullptr)
+            persistent_cache->store(lookup_url, gnd_number);
     }
 
-    const auto match(AUTHOR_GND_MATCHER.match(downloader.getMessageBody()));
-    if (match) {
+    if (not gnd_number.empty()) {
         std::lock_guard<std::mutex> lock(fetch_author_gnd_url_to_gnd_cache_mutex);
-        fetch_author_gnd_url_to_gnd_cache.emplace(lookup_url, match[1]);
-        return match[1];
+        fetch_author_gnd_url_to_gnd_cache.emplace(lookup_url, gnd_number);
     }
 
-    return "";
+    return gnd_number;
 }
 
 
@@ -178,6 +215,9 @@ std::string GetAllAuthorGNDNumberCandidates(const std::string &author, const std
     static std::regex GND_LIST_MATCHER(R"(\(GND\s+/\s+([\dX]+)\))");
 
     std::set<std::string> gnds;
+    if (LookupLocalGNDNumbers(author, author_lookup_base_url, &gnds))
+        return StringUtil::Join(gnds, " ");
+
     // "author" must be in the lastname,firstname format
     const std::string lookup_url(author_lookup_base_url + UrlUtil::UrlEncode(author));
     {
@@ -188,6 +228,19 @@ std::string GetAllAuthorGNDNumberCandidates(const std::string &author, const std
             return StringUtil::Join(gnds, " ");
     }
 
+    // We use a different key than GetAuthorGNDNumber() as we cache a list of candidates here:
+    const auto persistent_cache(GNDLookupCache::GetDefaultInstance());
+    const std::string persistent_cache_key("candidates:" + lookup_url);
+    std::string joined_gnds;
+    if (persistent_cache != nullptr and persistent_cache->lookup(persistent_cache_key, &joined_gnds)) {
+        std::vector<std::string> cached_gnds;
+        StringUtil::Split(joined_gnds, ' ', &cached_gnds, /* suppress_empty_components = */ true);
+        std::lock_guard<std::mutex> lock(fetch_author_gnd_url_to_gnds_cache_mutex);
+        for (const auto &gnd : cached_gnds)
+            fetch_author_gnd_url_to_gnds_cache.emplace(lookup_url, gnd);
+        return joined_gnds;
+    }
+
     Downloader downloader(lookup_url);
     if (downloader.anErrorOccurred()) {
         LOG_WARNING("couldn't download author GND results! downloader error: " + downloader.getLastErrorMessage());
@@ -198,7 +251,10 @@ std::string GetAllAuthorGNDNumberCandidates(const std::string &author, const std
     // Unique GND
     std::regex_search(downloader.getMessageBody(), matches, AUTHOR_GND_MATCHER);
     if (matches.size()) {
+        std::lock_guard<std::mutex> lock(fetch_author_gnd_url_to_gnds_cache_mutex);
         fetch_author_gnd_url_to_gnds_cache.emplace(lookup_url, matches[1]);
+        if (persistent_cache != nullptr)
+            persistent_cache->store(persistent_cache_key, matches[1]);
         return matches[1];
     }
     // Several candidates
@@ -207,7 +263,10 @@ std::string GetAllAuthorGNDNumberCandidates(const std::string &author, const std
     auto match_end((std::sregex_iterator()));
     std::lock_guard<std::mutex> lock(fetch_author_gnd_url_to_gnds_cache_mutex);
     std::for_each(match_begin, match_end, [&gnds](auto one_match) { gnds.emplace(one_match[1].str()); });
-    return StringUtil::Join(gnds, " ");
+    joined_gnds = StringUtil::Join(gnds, " ");
+    if (persistent_cache != nullptr)
+        persistent_cache->store(persistent_cache_key, joined_gnds);
+    return joined_gnds;
 }
 
 
@@ -263,6 +322,25 @@ void ExtractArchiveMembers(const std::string &archive_name, std::vector<std::str
 }
 
 
+void ProcessArchiveMembers(const std::string &archive_name, const std::set<ArchiveType> &selected_member_types,
+                           const std::function<void(MARC::Reader * const marc_reader)> &member_processor) {
+    Archive::Reader archive_reader(archive_name);
+    Archive::Reader::EntryInfo entry_info;
+    while (archive_reader.getNext(&entry_info)) {
+        if (not entry_info.isRegularFile())
+            continue;
+
+        const std::string member_name(entry_info.getFilename());
+        if (not StringUtil::EndsWith(member_name, ".raw") and not StringUtil::EndsWith(member_name, ".mrc"))
+            continue;
+        if (selected_member_types.find(GetArchiveType(member_name)) == selected_member_types.cend())
+            continue;
+
+        const auto marc_reader(MARC::Reader::Factory(&archive_reader, archive_name + "/" + member_name));
+        member_processor(marc_reader.get());
+    }
+}
+
 IssueInfo ExtractYearVolumeIssue(const MARC::Record &record) {
     IssueInfo issue_info;
 
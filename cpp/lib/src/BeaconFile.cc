@@ -18,34 +18,111 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "BeaconFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Compiler.h"
 #include "FileUtil.h"
 #include "StringUtil.h"
 #include "Url.h"
 
 
-// In order to understand what we do here, have a look at: https://gbv.github.io/beaconspec/beacon.html
-BeaconFile::BeaconFile(const std::string &filename): filename_(filename) {
-    const auto input(FileUtil::OpenInputFileOrDie(filename));
+struct BeaconFile::Header {
+    char magic_[8];
+    uint64_t beacon_file_size_;
+    int64_t beacon_file_mtime_;
+    uint64_t entry_count_;
+    uint64_t line_remainders_size_;
+    uint64_t header_lines_size_;
+};
 
-    std::string line(input->getLineAny());
-    if (line != "#FORMAT: BEACON")
-        LOG_ERROR("expected \"#FORMAT: BEACON\" as the first line in \"" + filename + "\"!");
 
-    line = input->getLineAny();
-    if (line != "#PREFIX: http://d-nb.info/gnd/" and line != "#PREFIX: https://d-nb.info/gnd/")
-        LOG_ERROR(
-            "expected \"#PREFIX: http://d-nb.info/gnd/\" or "
-            "line != #PREFIX: https://d-nb.info/gnd/ as the second line in \""
-            + filename + "\"!");
+// The line remainder is the text following the first vertical bar of the line of a GND number.  It will only be parsed once the
+// GND number has been found.
+struct BeaconFile::PackedEntry {
+    uint64_t gnd_number_;
+    uint32_t line_remainder_offset_;
+    uint32_t line_remainder_length_;
+};
 
-    do {
-        line = input->getLineAny();
-        if (not line.empty() and line[0] == '#') {
-            const auto first_colon_pos(line.find(':'));
-            if (first_colon_pos != std::string::npos)
-                keys_and_values_[line.substr(1, first_colon_pos - 1)] = StringUtil::TrimWhite(line.substr(first_colon_pos + 1));
-        }
-    } while (not line.empty() and line[0] == '#');
+
+namespace {
+
+
+const char BINARY_FORM_MAGIC[8] = { 'U', 'B', 'B', 'E', 'A', 'C', 'N', '1' };
+
+
+// GND numbers consist of digits, hyphens and X's, so we can store them w/ 4 bits per character.  As we don't use 0 for any
+// character, leading zeroes can't get lost.
+bool PackGNDNumber(const std::string_view gnd_number, uint64_t * const packed_gnd_number) {
+    if (unlikely(gnd_number.empty() or gnd_number.length() > 2 * sizeof(uint64_t)))
+        return false;
+
+    *packed_gnd_number = 0;
+    for (const char ch : gnd_number) {
+        uint64_t nibble;
+        if (likely(ch >= '0' and ch <= '9'))
+            nibble = ch - '0' + 1;
+        else if (ch == '-')
+            nibble = 11;
+        else if (ch == 'X')
+            nibble = 12;
+        else
+            return false;
+        *packed_gnd_number = (*packed_gnd_number << 4u) | nibble;
+    }
+
+    return true;
+}
+
+
+std::string_view TrimWhite(std::string_view s) {
+    const auto first_non_white_pos(s.find_first_not_of(StringUtil::WHITE_SPACE));
+    if (first_non_white_pos == std::string_view::npos)
+        return std::string_view();
+    s.remove_prefix(first_non_white_pos);
+    s.remove_suffix(s.length() - s.find_last_not_of(StringUtil::WHITE_SPACE) - 1);
+    return s;
+}
+
+
+// Like File::getLineAny(), accepts any of { CR, LF, CR/LF } as line ends.
+// \return False if "*line_start" points past the end of "contents", o/w true.
+bool GetNextLine(const std::string_view contents, size_t * const line_start, std::string_view * const line) {
+    if (*line_start >= contents.length()) {
+        *line = std::string_view();
+        return false;
+    }
+
+    auto line_end(contents.find_first_of("\r\n", *line_start));
+    if (line_end == std::string_view::npos)
+        line_end = contents.length();
+    *line = contents.substr(*line_start, line_end - *line_start);
+
+    *line_start = line_end + 1;
+    if (line_end < contents.length() and contents[line_end] == '\r' and *line_start < contents.length() and contents[*line_start] == '\n')
+        ++*line_start;
+
+    return true;
+}
+
+
+void WriteOrDie(File * const output, const void * const data, const size_t size) {
+    if (unlikely(output->write(data, size) != size))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+} // unnamed namespace
+
+
+BeaconFile::BeaconFile(const std::string &filename, const bool use_binary_form)
+    : filename_(filename), map_start_(nullptr), map_size_(0), entries_(nullptr), entry_count_(0), line_remainders_(nullptr) {
+    if (not use_binary_form or not openBinaryForm())
+        parseBeaconFile();
 
     const auto target(keys_and_values_.find("TARGET"));
     if (target == keys_and_values_.cend())
@@ -53,34 +130,174 @@ BeaconFile::BeaconFile(const std::string &filename): filename_(filename) {
     url_template_ = target->second;
     if (url_template_.find("{ID}") == std::string::npos)
         LOG_ERROR("{ID} is missing in URL template \"" + url_template_ + " in \"" + filename + "\"!");
+}
+
+
+BeaconFile::BeaconFile(BeaconFile &&other)
+    : filename_(std::move(other.filename_)), url_template_(std::move(other.url_template_)),
+      keys_and_values_(std::move(other.keys_and_values_)), map_start_(other.map_start_), map_size_(other.map_size_),
+      beacon_file_contents_(std::move(other.beacon_file_contents_)), parsed_entries_(std::move(other.parsed_entries_)),
+      entries_(other.entries_), entry_count_(other.entry_count_), line_remainders_(other.line_remainders_) {
+    if (map_start_ == nullptr) {
+        entries_ = parsed_entries_.data();
+        line_remainders_ = beacon_file_contents_.data();
+    }
+    other.map_start_ = nullptr;
+}
+
+
+BeaconFile::~BeaconFile() {
+    if (map_start_ != nullptr and unlikely(::munmap(const_cast<char *>(map_start_), map_size_) != 0))
+        LOG_ERROR("munmap(2) on \"" + GetBinaryFormPath(filename_) + "\" failed!");
+}
+
+
+void BeaconFile::processHeaderLines(const std::string_view header_lines) {
+    size_t line_start(0);
+    std::string_view line;
+    while (GetNextLine(header_lines, &line_start, &line)) {
+        if (line.empty() or line[0] != '#')
+            continue;
+        const auto first_colon_pos(line.find(':'));
+        if (first_colon_pos != std::string_view::npos)
+            keys_and_values_[std::string(line.substr(1, first_colon_pos - 1))] = TrimWhite(line.substr(first_colon_pos + 1));
+    }
+}
+
+
+bool BeaconFile::openBinaryForm() {
+    const std::string binary_form_path(GetBinaryFormPath(filename_));
+    const int fd(::open(binary_form_path.c_str(), O_RDONLY));
+    if (fd == -1)
+        return false;
+
+    struct stat stat_buf;
+    if (unlikely(::fstat(fd, &stat_buf) != 0))
+        LOG_ERROR("failed to fstat(2) \"" + binary_form_path + "\"!");
+    map_size_ = stat_buf.st_size;
+    if (unlikely(map_size_ < sizeof(Header)))
+        LOG_ERROR("\"" + binary_form_path + "\" is too small to be the binary form of a BEACON file!");
+
+    map_start_ = static_cast<const char *>(::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+    if (map_start_ == MAP_FAILED or map_start_ == nullptr)
+        LOG_ERROR("failed to mmap(2) \"" + binary_form_path + "\"!");
+    ::close(fd);
+
+    const Header * const header(reinterpret_cast<const Header *>(map_start_));
+    if (unlikely(std::memcmp(header->magic_, BINARY_FORM_MAGIC, sizeof BINARY_FORM_MAGIC) != 0))
+        LOG_ERROR("\"" + binary_form_path + "\" is not the binary form of a BEACON file!");
+    if (unlikely(map_size_
+                 != sizeof(Header) + header->entry_count_ * sizeof(PackedEntry) + header->line_remainders_size_
+                        + header->header_lines_size_))
+        LOG_ERROR("\"" + binary_form_path + "\" is truncated or corrupt!");
+
+    if (::stat(filename_.c_str(), &stat_buf) != 0 or static_cast<uint64_t>(stat_buf.st_size) != header->beacon_file_size_
+        or stat_buf.st_mtime != header->beacon_file_mtime_) {
+        LOG_WARNING("ignoring \"" + binary_form_path + "\" because it is out of date!");
+        ::munmap(const_cast<char *>(map_start_), map_size_);
+        map_start_ = nullptr;
+        return false;
+    }
+
+    entries_ = reinterpret_cast<const PackedEntry *>(map_start_ + sizeof(Header));
+    entry_count_ = header->entry_count_;
+    line_remainders_ = reinterpret_cast<const char *>(entries_ + entry_count_);
+    processHeaderLines(std::string_view(line_remainders_ + header->line_remainders_size_, header->header_lines_size_));
+
+    return true;
+}
+
 
+// In order to understand what we do here, have a look at: https://gbv.github.io/beaconspec/beacon.html
+void BeaconFile::parseBeaconFile() {
+    beacon_file_contents_ = FileUtil::ReadStringOrDie(filename_);
+    if (unlikely(beacon_file_contents_.length() > UINT32_MAX))
+        LOG_ERROR("\"" + filename_ + "\" is too large!");
+    const std::string_view contents(beacon_file_contents_);
+
+    size_t line_start(0);
+    std::string_view line;
+    GetNextLine(contents, &line_start, &line);
+    if (line != "#FORMAT: BEACON")
+        LOG_ERROR("expected \"#FORMAT: BEACON\" as the first line in \"" + filename_ + "\"!");
+
+    GetNextLine(contents, &line_start, &line);
+    if (line != "#PREFIX: http://d-nb.info/gnd/" and line != "#PREFIX: https://d-nb.info/gnd/")
+        LOG_ERROR(
+            "expected \"#PREFIX: http://d-nb.info/gnd/\" or "
+            "line != #PREFIX: https://d-nb.info/gnd/ as the second line in \""
+            + filename_ + "\"!");
+
+    const size_t header_lines_start(line_start);
+    size_t header_lines_end;
+    bool more_lines;
     do {
-        std::string gnd_number;
-        unsigned count(1);
-        std::string id_or_url;
+        header_lines_end = line_start;
+        more_lines = GetNextLine(contents, &line_start, &line);
+    } while (more_lines and not line.empty() and line[0] == '#');
+    processHeaderLines(contents.substr(header_lines_start, header_lines_end - header_lines_start));
 
+    unsigned invalid_gnd_number_count(0);
+    for (; more_lines; more_lines = GetNextLine(contents, &line_start, &line)) {
         const auto first_vertical_bar_pos(line.find('|'));
-        if (first_vertical_bar_pos == std::string::npos)
-            gnd_number = StringUtil::TrimWhite(line);
-        else {
-            gnd_number = StringUtil::TrimWhite(line.substr(0, first_vertical_bar_pos));
-            const auto second_vertical_bar_pos(line.find('|', first_vertical_bar_pos + 1));
-            if (second_vertical_bar_pos == std::string::npos) {
-                const std::string count_str(StringUtil::TrimWhite(line.substr(first_vertical_bar_pos + 1)));
-                if (not count_str.empty())
-                    StringUtil::ToUnsigned(count_str, &count);
-            } else {
-                const std::string count_str(
-                    StringUtil::TrimWhite(line.substr(first_vertical_bar_pos + 1, second_vertical_bar_pos - first_vertical_bar_pos - 1)));
-                if (not count_str.empty())
-                    StringUtil::ToUnsigned(count_str, &count);
-                id_or_url = StringUtil::TrimWhite(line.substr(second_vertical_bar_pos + 1));
-            }
+        const std::string_view gnd_number(TrimWhite(line.substr(0, first_vertical_bar_pos)));
+        if (gnd_number.empty())
+            continue;
+
+        PackedEntry packed_entry{ 0, 0, 0 };
+        if (unlikely(not PackGNDNumber(gnd_number, &packed_entry.gnd_number_))) {
+            ++invalid_gnd_number_count;
+            continue;
+        }
+        if (first_vertical_bar_pos != std::string_view::npos) {
+            packed_entry.line_remainder_offset_ = line.data() + first_vertical_bar_pos + 1 - contents.data();
+            packed_entry.line_remainder_length_ = line.length() - first_vertical_bar_pos - 1;
         }
-        entries_.emplace(gnd_number, count, id_or_url);
+        parsed_entries_.emplace_back(packed_entry);
+    }
+    if (invalid_gnd_number_count > 0)
+        LOG_WARNING("ignored " + std::to_string(invalid_gnd_number_count) + " line(s) w/ invalid GND numbers in \"" + filename_ + "\"!");
+
+    // If a GND number occurs more than once, we keep its first line:
+    std::stable_sort(parsed_entries_.begin(), parsed_entries_.end(), [](const PackedEntry &lhs, const PackedEntry &rhs) {
+        return lhs.gnd_number_ < rhs.gnd_number_;
+    });
+    parsed_entries_.erase(std::unique(parsed_entries_.begin(), parsed_entries_.end(),
+                                      [](const PackedEntry &lhs, const PackedEntry &rhs) { return lhs.gnd_number_ == rhs.gnd_number_; }),
+                          parsed_entries_.end());
+    parsed_entries_.shrink_to_fit();
 
-        line = input->getLineAny();
-    } while (not input->eof());
+    entries_ = parsed_entries_.data();
+    entry_count_ = parsed_entries_.size();
+    line_remainders_ = beacon_file_contents_.data();
+}
+
+
+bool BeaconFile::find(const std::string &gnd_number, Entry * const entry) const {
+    uint64_t packed_gnd_number;
+    if (not PackGNDNumber(gnd_number, &packed_gnd_number))
+        return false;
+
+    const auto entries_end(entries_ + entry_count_);
+    const auto packed_entry(std::lower_bound(entries_, entries_end, packed_gnd_number,
+                                             [](const PackedEntry &lhs, const uint64_t rhs) { return lhs.gnd_number_ < rhs; }));
+    if (packed_entry == entries_end or packed_entry->gnd_number_ != packed_gnd_number)
+        return false;
+
+    entry->gnd_number_ = gnd_number;
+    entry->optional_count_ = 1;
+    entry->id_or_url_.clear();
+
+    const std::string_view line_remainder(line_remainders_ + packed_entry->line_remainder_offset_,
+                                          packed_entry->line_remainder_length_);
+    const auto vertical_bar_pos(line_remainder.find('|'));
+    const std::string_view count_str(TrimWhite(line_remainder.substr(0, vertical_bar_pos)));
+    if (not count_str.empty())
+        StringUtil::ToUnsigned(std::string(count_str), &entry->optional_count_);
+    if (vertical_bar_pos != std::string_view::npos)
+        entry->id_or_url_ = TrimWhite(line_remainder.substr(vertical_bar_pos + 1));
+
+    return true;
 }
 
 
@@ -124,3 +341,53 @@ std::string BeaconFile::getName() const {
 
     return NameFromURL(url_template_);
 }
+
+
+std::string BeaconFile::GetBinaryFormPath(const std::string &beacon_filename) {
+    return beacon_filename + ".bin";
+}
+
+
+void BeaconFile::CreateBinaryForm(const std::string &beacon_filename) {
+    Header header;
+    std::memcpy(header.magic_, BINARY_FORM_MAGIC, sizeof BINARY_FORM_MAGIC);
+
+    struct stat stat_buf;
+    if (unlikely(::stat(beacon_filename.c_str(), &stat_buf) != 0))
+        LOG_ERROR("failed to stat(2) \"" + beacon_filename + "\"!");
+    header.beacon_file_size_ = stat_buf.st_size;
+    header.beacon_file_mtime_ = stat_buf.st_mtime;
+
+    const BeaconFile beacon_file(beacon_filename, /* use_binary_form = */ false);
+    header.entry_count_ = beacon_file.entry_count_;
+    header.line_remainders_size_ = 0;
+    for (auto packed_entry(beacon_file.entries_); packed_entry != beacon_file.entries_ + beacon_file.entry_count_; ++packed_entry)
+        header.line_remainders_size_ += packed_entry->line_remainder_length_;
+
+    std::string header_lines;
+    for (const auto &[key, value] : beacon_file.keys_and_values_)
+        header_lines += "#" + key + ": " + value + "\n";
+    header.header_lines_size_ = header_lines.size();
+
+    const std::string binary_form_path(GetBinaryFormPath(beacon_filename));
+    const std::string temp_binary_form_path(binary_form_path + ".tmp");
+    const auto output(FileUtil::OpenOutputFileOrDie(temp_binary_form_path));
+    WriteOrDie(output.get(), &header, sizeof header);
+
+    // The line remainders are stored in the order of the GND numbers w/o the rest of the lines:
+    uint32_t line_remainder_offset(0);
+    for (auto packed_entry(beacon_file.entries_); packed_entry != beacon_file.entries_ + beacon_file.entry_count_; ++packed_entry) {
+        const PackedEntry stored_entry{ packed_entry->gnd_number_, line_remainder_offset, packed_entry->line_remainder_length_ };
+        WriteOrDie(output.get(), &stored_entry, sizeof stored_entry);
+        line_remainder_offset += packed_entry->line_remainder_length_;
+    }
+    for (auto packed_entry(beacon_file.entries_); packed_entry != beacon_file.entries_ + beacon_file.entry_count_; ++packed_entry)
+        WriteOrDie(output.get(), beacon_file.line_remainders_ + packed_entry->line_remainder_offset_,
+                   packed_entry->line_remainder_length_);
+    WriteOrDie(output.get(), header_lines.data(), header_lines.size());
+    output->close();
+    FileUtil::RenameFileOrDie(temp_binary_form_path, binary_form_path, /* remove_target = */ true);
+
+    LOG_INFO("stored " + std::to_string(header.entry_count_) + " GND numbers of \"" + beacon_filename + "\" in \"" + binary_form_path
+             + "\".");
+}
@@ -0,0 +1,662 @@
+/** \file    CompressedFile.cc
+ *  \brief   Implementation of the seekable gzip and zstd stdio streams.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "CompressedFile.h"
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <zstd.h>
+#include "StringUtil.h"
+#include "util.h"
+
+
+namespace CompressedFile {
+
+
+Codec GuessCodec(const std::string &path) {
+    if (StringUtil::EndsWith(path, ".gz", /* ignore_case = */ true))
+        return Codec::GZIP;
+    if (StringUtil::EndsWith(path, ".zst", /* ignore_case = */ true))
+        return Codec::ZSTD;
+    return Codec::NONE;
+}
+
+
+std::string StripCodecSuffix(const std::string &path) {
+    switch (GuessCodec(path)) {
+    case Codec::GZIP:
+        return path.substr(0, path.length() - std::strlen(".gz"));
+    case Codec::ZSTD:
+        return path.substr(0, path.length() - std::strlen(".zst"));
+    default:
+        return path;
+    }
+}
+
+
+namespace {
+
+
+constexpr int GZIP_COMPRESSION_LEVEL(6);
+constexpr int ZSTD_COMPRESSION_LEVEL(ZSTD_CLEVEL_DEFAULT);
+constexpr size_t RAW_BUFFER_SIZE(128 * 1024);
+
+
+// The seek table layout, see https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md
+constexpr uint32_t ZSTD_SKIPPABLE_FRAME_MAGIC(0x184D2A5EU);
+constexpr uint32_t ZSTD_SEEKABLE_MAGIC(0x8F92EAB1U);
+constexpr size_t ZSTD_SKIPPABLE_FRAME_HEADER_SIZE(8);
+constexpr size_t ZSTD_SEEK_TABLE_FOOTER_SIZE(9);
+constexpr unsigned char ZSTD_SEEK_TABLE_CHECKSUM_FLAG(0x80);
+
+
+// Our gzip members start w/ a 10 byte header that has FEXTRA set, followed by XLEN and a single "UB" subfield that holds the
+// size of the entire member.  Then come the raw deflate data and the standard 8 byte trailer w/ the CRC-32 and the
+// uncompressed size.
+constexpr unsigned char GZIP_HEADER_PREFIX[] = { 0x1F, 0x8B, /* CM = deflate */ 8, /* FLG = FEXTRA */ 0x04, /* MTIME */ 0, 0, 0, 0,
+                                                 /* XFL */ 0, /* OS = Unix */ 3, /* XLEN */ 8, 0, 'U', 'B', /* LEN */ 4, 0 };
+constexpr size_t GZIP_HEADER_SIZE(sizeof(GZIP_HEADER_PREFIX) + 4);
+constexpr size_t GZIP_TRAILER_SIZE(8);
+
+
+inline void AppendLittleEndian32(const uint32_t value, std::string * const s) {
+    for (unsigned shift(0); shift < 32; shift += 8)
+        *s += static_cast<char>((value >> shift) & 0xFFu);
+}
+
+
+inline void StoreLittleEndian32(const uint32_t value, char * const p) {
+    for (unsigned i(0); i < 4; ++i)
+        p[i] = static_cast<char>((value >> (8 * i)) & 0xFFu);
+}
+
+
+inline uint32_t LoadLittleEndian32(const unsigned char * const p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16)
+           | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+
+std::string CompressZstdFrame(const std::string &uncompressed_data) {
+    std::string frame(ZSTD_compressBound(uncompressed_data.size()), '\0');
+    const size_t frame_size(
+        ZSTD_compress(frame.data(), frame.size(), uncompressed_data.data(), uncompressed_data.size(), ZSTD_COMPRESSION_LEVEL));
+    if (unlikely(ZSTD_isError(frame_size)))
+        LOG_ERROR("ZSTD_compress failed: " + std::string(ZSTD_getErrorName(frame_size)));
+    frame.resize(frame_size);
+
+    return frame;
+}
+
+
+std::string CompressGzipMember(const std::string &uncompressed_data) {
+    z_stream stream;
+    std::memset(&stream, '\0', sizeof stream);
+    if (unlikely(::deflateInit2(&stream, GZIP_COMPRESSION_LEVEL, Z_DEFLATED, -MAX_WBITS, /* memLevel = */ 8, Z_DEFAULT_STRATEGY) != Z_OK))
+        LOG_ERROR("deflateInit2 failed!");
+
+    std::string member(GZIP_HEADER_SIZE + ::deflateBound(&stream, uncompressed_data.size()) + GZIP_TRAILER_SIZE, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(uncompressed_data.data()));
+    stream.avail_in = uncompressed_data.size();
+    stream.next_out = reinterpret_cast<Bytef *>(member.data() + GZIP_HEADER_SIZE);
+    stream.avail_out = member.size() - GZIP_HEADER_SIZE;
+    if (unlikely(::deflate(&stream, Z_FINISH) != Z_STREAM_END))
+        LOG_ERROR("deflate failed: " + std::string(stream.msg == nullptr ? "unknown error" : stream.msg));
+    member.resize(GZIP_HEADER_SIZE + stream.total_out);
+    ::deflateEnd(&stream);
+
+    std::memcpy(member.data(), GZIP_HEADER_PREFIX, sizeof(GZIP_HEADER_PREFIX));
+    StoreLittleEndian32(member.size() + GZIP_TRAILER_SIZE, member.data() + sizeof(GZIP_HEADER_PREFIX));
+    AppendLittleEndian32(::crc32(0, reinterpret_cast<const Bytef *>(uncompressed_data.data()), uncompressed_data.size()), &member);
+    AppendLittleEndian32(uncompressed_data.size(), &member);
+
+    return member;
+}
+
+
+// The start of an independently compressed frame.
+struct Frame {
+    off_t compressed_offset_, uncompressed_offset_;
+
+    Frame(const off_t compressed_offset, const off_t uncompressed_offset)
+        : compressed_offset_(compressed_offset), uncompressed_offset_(uncompressed_offset) { }
+};
+
+
+bool ReadAt(const int fd, const off_t offset, void * const buf, const size_t count) {
+    return ::pread(fd, buf, count, offset) == static_cast<ssize_t>(count);
+}
+
+
+// \return False if "fd" does not end w/ a seek table.
+// \note   On success the last entry of "frames" marks the end of the compressed frames and holds the uncompressed size.
+bool LoadZstdSeekTable(const int fd, const off_t file_size, std::vector<Frame> * const frames) {
+    unsigned char footer[ZSTD_SEEK_TABLE_FOOTER_SIZE];
+    if (file_size < static_cast<off_t>(ZSTD_SKIPPABLE_FRAME_HEADER_SIZE + ZSTD_SEEK_TABLE_FOOTER_SIZE)
+        or not ReadAt(fd, file_size - ZSTD_SEEK_TABLE_FOOTER_SIZE, footer, sizeof footer)
+        or LoadLittleEndian32(footer + 5) != ZSTD_SEEKABLE_MAGIC)
+        return false;
+
+    const off_t frame_count(LoadLittleEndian32(footer));
+    const off_t entry_size((footer[4] & ZSTD_SEEK_TABLE_CHECKSUM_FLAG) ? 12 : 8);
+    const off_t seek_table_size(frame_count * entry_size + ZSTD_SEEK_TABLE_FOOTER_SIZE);
+    if (seek_table_size + static_cast<off_t>(ZSTD_SKIPPABLE_FRAME_HEADER_SIZE) > file_size)
+        return false;
+
+    const off_t skippable_frame_start(file_size - seek_table_size - ZSTD_SKIPPABLE_FRAME_HEADER_SIZE);
+    std::vector<unsigned char> seek_table(ZSTD_SKIPPABLE_FRAME_HEADER_SIZE + seek_table_size);
+    if (not ReadAt(fd, skippable_frame_start, seek_table.data(), seek_table.size())
+        or LoadLittleEndian32(seek_table.data()) != ZSTD_SKIPPABLE_FRAME_MAGIC
+        or LoadLittleEndian32(seek_table.data() + 4) != seek_table_size)
+        return false;
+
+    frames->clear();
+    frames->reserve(frame_count + 1);
+    off_t compressed_offset(0), uncompressed_offset(0);
+    for (const unsigned char *entry(seek_table.data() + ZSTD_SKIPPABLE_FRAME_HEADER_SIZE);
+         entry < seek_table.data() + seek_table.size() - ZSTD_SEEK_TABLE_FOOTER_SIZE; entry += entry_size)
+    {
+        frames->emplace_back(compressed_offset, uncompressed_offset);
+        compressed_offset += LoadLittleEndian32(entry);
+        uncompressed_offset += LoadLittleEndian32(entry + 4);
+    }
+    frames->emplace_back(compressed_offset, uncompressed_offset);
+
+    return compressed_offset == skippable_frame_start;
+}
+
+
+// \return False if not all members of "fd" have our "UB" subfield.
+// \note   On success the last entry of "frames" marks the end of the file and holds the uncompressed size.
+bool LoadGzipMemberIndex(const int fd, const off_t file_size, std::vector<Frame> * const frames) {
+    frames->clear();
+    off_t compressed_offset(0), uncompressed_offset(0);
+    while (compressed_offset < file_size) {
+        unsigned char header[GZIP_HEADER_SIZE];
+        if (not ReadAt(fd, compressed_offset, header, sizeof header)
+            or std::memcmp(header, GZIP_HEADER_PREFIX, 4) != 0 // ID1, ID2, CM and FLG
+            or std::memcmp(header + 10, GZIP_HEADER_PREFIX + 10, sizeof(GZIP_HEADER_PREFIX) - 10) != 0)
+            return false;
+
+        const off_t member_size(LoadLittleEndian32(header + sizeof(GZIP_HEADER_PREFIX)));
+        unsigned char uncompressed_size[4];
+        if (member_size < static_cast<off_t>(GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE) or compressed_offset + member_size > file_size
+            or not ReadAt(fd, compressed_offset + member_size - 4, uncompressed_size, sizeof uncompressed_size))
+            return false;
+
+        frames->emplace_back(compressed_offset, uncompressed_offset);
+        compressed_offset += member_size;
+        uncompressed_offset += LoadLittleEndian32(uncompressed_size);
+    }
+    frames->emplace_back(compressed_offset, uncompressed_offset);
+
+    return true;
+}
+
+
+class Decompressor {
+public:
+    virtual ~Decompressor() = default;
+
+    // Prepares for decompressing from the start of a frame.
+    virtual void reset() = 0;
+
+    // \return The number of bytes written to "output".
+    virtual size_t decompress(const char * const input, const size_t input_size, size_t * const consumed, char * const output,
+                              const size_t output_size) = 0;
+
+    // \return True if the last call to decompress() finished a frame.
+    virtual bool atEndOfFrame() const = 0;
+};
+
+
+class ZstdDecompressor final : public Decompressor {
+    const std::string path_;
+    ZSTD_DCtx * const context_;
+    bool at_end_of_frame_;
+
+public:
+    explicit ZstdDecompressor(const std::string &path): path_(path), context_(ZSTD_createDCtx()), at_end_of_frame_(true) {
+        if (unlikely(context_ == nullptr))
+            LOG_ERROR("ZSTD_createDCtx failed!");
+    }
+    virtual ~ZstdDecompressor() final { ZSTD_freeDCtx(context_); }
+
+    virtual void reset() override final {
+        ZSTD_DCtx_reset(context_, ZSTD_reset_session_only);
+        at_end_of_frame_ = true;
+    }
+
+    virtual size_t decompress(const char * const input, const size_t input_size, size_t * const consumed, char * const output,
+                              const size_t output_size) override final {
+        ZSTD_inBuffer in_buffer{ input, input_size, 0 };
+        ZSTD_outBuffer out_buffer{ output, output_size, 0 };
+        const size_t result(ZSTD_decompressStream(context_, &out_buffer, &in_buffer));
+        if (unlikely(ZSTD_isError(result)))
+            LOG_ERROR("failed to decompress \"" + path_ + "\": " + std::string(ZSTD_getErrorName(result)));
+        if (in_buffer.pos > 0 or out_buffer.pos > 0) // W/o any progress "result" is merely a hint for the next input size.
+            at_end_of_frame_ = result == 0;
+        *consumed = in_buffer.pos;
+        return out_buffer.pos;
+    }
+
+    virtual bool atEndOfFrame() const override final { return at_end_of_frame_; }
+};
+
+
+class GzipDecompressor final : public Decompressor {
+    const std::string path_;
+    z_stream stream_;
+    bool at_end_of_frame_;
+
+public:
+    explicit GzipDecompressor(const std::string &path): path_(path), at_end_of_frame_(true) {
+        std::memset(&stream_, '\0', sizeof stream_);
+        if (unlikely(::inflateInit2(&stream_, MAX_WBITS + 16 /* = gzip only */) != Z_OK))
+            LOG_ERROR("inflateInit2 failed!");
+    }
+    virtual ~GzipDecompressor() final { ::inflateEnd(&stream_); }
+
+    virtual void reset() override final {
+        ::inflateReset(&stream_);
+        at_end_of_frame_ = true;
+    }
+
+    virtual size_t decompress(const char * const input, const size_t input_size, size_t * const consumed, char * const output,
+                              const size_t output_size) override final {
+        stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input));
+        stream_.avail_in = input_size;
+        stream_.next_out = reinterpret_cast<Bytef *>(output);
+        stream_.avail_out = output_size;
+        const int result(::inflate(&stream_, Z_NO_FLUSH));
+        if (unlikely(result != Z_OK and result != Z_STREAM_END and result != Z_BUF_ERROR))
+            LOG_ERROR("failed to decompress \"" + path_ + "\": " + std::string(stream_.msg == nullptr ? "unknown error" : stream_.msg));
+
+        *consumed = input_size - stream_.avail_in;
+        if (result == Z_STREAM_END) {
+            // The next member, if any, starts w/ a new header:
+            ::inflateReset(&stream_);
+            at_end_of_frame_ = true;
+        } else if (*consumed > 0)
+            at_end_of_frame_ = false;
+        return output_size - stream_.avail_out;
+    }
+
+    virtual bool atEndOfFrame() const override final { return at_end_of_frame_; }
+};
+
+
+class CompressedInput {
+    const std::string path_;
+    FILE * const raw_;
+    std::unique_ptr<Decompressor> decompressor_;
+    std::vector<Frame> frames_; // Empty if we don't have a frame index.
+    std::vector<char> raw_buffer_;
+    size_t raw_buffer_pos_, raw_buffer_size_;
+    bool raw_eof_;
+    std::vector<char> buffer_;    // Decompressed data.
+    off_t buffer_start_;          // The uncompressed offset of buffer_[0].
+    size_t buffer_pos_, buffer_size_;
+
+public:
+    CompressedInput(const std::string &path, FILE * const raw, const Codec codec);
+    ~CompressedInput() { std::fclose(raw_); }
+
+    ssize_t read(char * const buf, const size_t size);
+    bool seek(off_t * const offset, const int whence);
+
+private:
+    void restartAt(const Frame &frame);
+
+    // \return False if there are no more data.
+    bool fillBuffer();
+};
+
+
+CompressedInput::CompressedInput(const std::string &path, FILE * const raw, const Codec codec)
+    : path_(path), raw_(raw), raw_buffer_(RAW_BUFFER_SIZE), raw_buffer_pos_(0), raw_buffer_size_(0), raw_eof_(false), buffer_(FRAME_SIZE),
+      buffer_start_(0), buffer_pos_(0), buffer_size_(0) {
+    if (codec == Codec::ZSTD)
+        decompressor_.reset(new ZstdDecompressor(path));
+    else
+        decompressor_.reset(new GzipDecompressor(path));
+
+    struct stat stat_buf;
+    if (::fstat(fileno(raw_), &stat_buf) != 0 or not S_ISREG(stat_buf.st_mode))
+        return;
+    const bool have_frame_index(codec == Codec::ZSTD ? LoadZstdSeekTable(fileno(raw_), stat_buf.st_size, &frames_)
+                                                     : LoadGzipMemberIndex(fileno(raw_), stat_buf.st_size, &frames_));
+    if (not have_frame_index) {
+        LOG_DEBUG("\"" + path_ + "\" has no frame index, seeking backwards will be slow");
+        frames_.clear();
+    }
+}
+
+
+ssize_t CompressedInput::read(char * const buf, const size_t size) {
+    size_t total_count(0);
+    while (total_count < size) {
+        if (buffer_pos_ == buffer_size_ and not fillBuffer())
+            break;
+        const size_t count(std::min(size - total_count, buffer_size_ - buffer_pos_));
+        std::memcpy(buf + total_count, buffer_.data() + buffer_pos_, count);
+        buffer_pos_ += count;
+        total_count += count;
+    }
+
+    return total_count;
+}
+
+
+bool CompressedInput::seek(off_t * const offset, const int whence) {
+    off_t target;
+    switch (whence) {
+    case SEEK_SET:
+        target = *offset;
+        break;
+    case SEEK_CUR:
+        target = buffer_start_ + buffer_pos_ + *offset;
+        break;
+    case SEEK_END:
+        if (frames_.empty()) {
+            while (fillBuffer())
+                /* Intentionally empty! */;
+            target = buffer_start_ + buffer_size_ + *offset;
+        } else
+            target = frames_.back().uncompressed_offset_ + *offset;
+        break;
+    default:
+        errno = EINVAL;
+        return false;
+    }
+    if (target < 0 or (not frames_.empty() and target > frames_.back().uncompressed_offset_)) {
+        errno = EINVAL;
+        return false;
+    }
+
+    if (target < buffer_start_ or target > buffer_start_ + static_cast<off_t>(buffer_size_)) {
+        if (not frames_.empty()) {
+            const auto frame(std::upper_bound(frames_.cbegin(), frames_.cend(), target, [](const off_t offset1, const Frame &frame1) {
+                return offset1 < frame1.uncompressed_offset_;
+            }));
+            restartAt(*(frame - 1));
+        } else if (target < buffer_start_)
+            restartAt(Frame(0, 0));
+
+        while (target > buffer_start_ + static_cast<off_t>(buffer_size_)) {
+            if (not fillBuffer()) {
+                errno = EINVAL;
+                return false;
+            }
+        }
+    }
+
+    buffer_pos_ = target - buffer_start_;
+    *offset = target;
+    return true;
+}
+
+
+void CompressedInput::restartAt(const Frame &frame) {
+    if (unlikely(::fseeko(raw_, frame.compressed_offset_, SEEK_SET) != 0))
+        LOG_ERROR("failed to seek to offset " + std::to_string(frame.compressed_offset_) + " in \"" + path_ + "\"!");
+    raw_buffer_pos_ = raw_buffer_size_ = 0;
+    raw_eof_ = false;
+    decompressor_->reset();
+    buffer_start_ = frame.uncompressed_offset_;
+    buffer_pos_ = buffer_size_ = 0;
+}
+
+
+bool CompressedInput::fillBuffer() {
+    buffer_start_ += buffer_size_;
+    buffer_pos_ = buffer_size_ = 0;
+
+    for (;;) {
+        if (raw_buffer_pos_ == raw_buffer_size_ and not raw_eof_) {
+            raw_buffer_pos_ = 0;
+            raw_buffer_size_ = std::fread(raw_buffer_.data(), 1, raw_buffer_.size(), raw_);
+            if (unlikely(std::ferror(raw_) != 0))
+                LOG_ERROR("error while reading \"" + path_ + "\"!");
+            raw_eof_ = raw_buffer_size_ == 0;
+        }
+
+        size_t consumed;
+        buffer_size_ = decompressor_->decompress(raw_buffer_.data() + raw_buffer_pos_, raw_buffer_size_ - raw_buffer_pos_, &consumed,
+                                                 buffer_.data(), buffer_.size());
+        raw_buffer_pos_ += consumed;
+        if (buffer_size_ > 0)
+            return true;
+
+        if (raw_eof_ and raw_buffer_pos_ == raw_buffer_size_) {
+            if (unlikely(not decompressor_->atEndOfFrame()))
+                LOG_ERROR("\"" + path_ + "\" is truncated!");
+            return false;
+        }
+    }
+}
+
+
+ssize_t ReadCompressedInput(void *cookie, char *buf, size_t size) {
+    return reinterpret_cast<CompressedInput *>(cookie)->read(buf, size);
+}
+
+
+int SeekCompressedInput(void *cookie, off64_t *offset, int whence) {
+    off_t new_offset(*offset);
+    if (not reinterpret_cast<CompressedInput *>(cookie)->seek(&new_offset, whence))
+        return -1;
+    *offset = new_offset;
+    return 0;
+}
+
+
+int CloseCompressedInput(void *cookie) {
+    delete reinterpret_cast<CompressedInput *>(cookie);
+    return 0;
+}
+
+
+class CompressedOutput {
+    const std::string path_;
+    FILE * const raw_;
+    const Codec codec_;
+    const unsigned thread_count_;
+    std::string frame_; // Uncompressed data that have not been handed to a compression thread yet.
+    std::deque<std::pair<size_t, std::future<std::string>>> frames_in_progress_; // uncompressed sizes and compressed frames
+    std::vector<std::pair<uint32_t, uint32_t>> frame_sizes_;                      // compressed and uncompressed sizes
+    off_t uncompressed_size_;                                                      // excluding "frame_"
+    bool write_error_;
+
+public:
+    CompressedOutput(const std::string &path, FILE * const raw, const Codec codec, const unsigned thread_count)
+        : path_(path), raw_(raw), codec_(codec), thread_count_(thread_count), uncompressed_size_(0), write_error_(false) {
+        frame_.reserve(FRAME_SIZE);
+    }
+
+    ssize_t write(const char *buf, size_t size);
+    off_t tell() const { return uncompressed_size_ + frame_.size(); }
+
+    // \return False if any write failed.
+    bool close();
+
+private:
+    void startCompressingFrame();
+    void writeOldestFrame();
+    void writeSeekTable();
+};
+
+
+ssize_t CompressedOutput::write(const char *buf, size_t size) {
+    const size_t total_size(size);
+    while (size > 0) {
+        const size_t count(std::min(size, FRAME_SIZE - frame_.size()));
+        frame_.append(buf, count);
+        buf += count;
+        size -= count;
+        if (frame_.size() == FRAME_SIZE)
+            startCompressingFrame();
+    }
+
+    if (unlikely(write_error_)) {
+        errno = EIO;
+        return -1;
+    }
+    return total_size;
+}
+
+
+bool CompressedOutput::close() {
+    // We always write at least one frame, as the command-line tools won't accept empty files:
+    if (not frame_.empty() or (frame_sizes_.empty() and frames_in_progress_.empty()))
+        startCompressingFrame();
+    while (not frames_in_progress_.empty())
+        writeOldestFrame();
+    if (codec_ == Codec::ZSTD)
+        writeSeekTable();
+
+    if (unlikely(std::fclose(raw_) != 0))
+        write_error_ = true;
+    return not write_error_;
+}
+
+
+void CompressedOutput::startCompressingFrame() {
+    while (frames_in_progress_.size() >= thread_count_)
+        writeOldestFrame();
+
+    const size_t uncompressed_size(frame_.size());
+    const auto compress_frame(codec_ == Codec::ZSTD ? CompressZstdFrame : CompressGzipMember);
+    frames_in_progress_.emplace_back(uncompressed_size, std::async(std::launch::async, compress_frame, std::move(frame_)));
+    uncompressed_size_ += uncompressed_size;
+    frame_.clear();
+    frame_.reserve(FRAME_SIZE);
+}
+
+
+void CompressedOutput::writeOldestFrame() {
+    const std::string compressed_frame(frames_in_progress_.front().second.get());
+    if (unlikely(std::fwrite(compressed_frame.data(), 1, compressed_frame.size(), raw_) != compressed_frame.size()))
+        write_error_ = true;
+    frame_sizes_.emplace_back(compressed_frame.size(), frames_in_progress_.front().first);
+    frames_in_progress_.pop_front();
+}
+
+
+void CompressedOutput::writeSeekTable() {
+    std::string seek_table;
+    AppendLittleEndian32(ZSTD_SKIPPABLE_FRAME_MAGIC, &seek_table);
+    AppendLittleEndian32(frame_sizes_.size() * 8 + ZSTD_SEEK_TABLE_FOOTER_SIZE, &seek_table);
+    for (const auto &[compressed_size, uncompressed_size] : frame_sizes_) {
+        AppendLittleEndian32(compressed_size, &seek_table);
+        AppendLittleEndian32(uncompressed_size, &seek_table);
+    }
+    AppendLittleEndian32(frame_sizes_.size(), &seek_table);
+    seek_table += '\0'; // Seek_Table_Descriptor: no checksums
+    AppendLittleEndian32(ZSTD_SEEKABLE_MAGIC, &seek_table);
+
+    if (unlikely(std::fwrite(seek_table.data(), 1, seek_table.size(), raw_) != seek_table.size()))
+        write_error_ = true;
+}
+
+
+ssize_t WriteCompressedOutput(void *cookie, const char *buf, size_t size) {
+    return reinterpret_cast<CompressedOutput *>(cookie)->write(buf, size);
+}
+
+
+// We only support ftell(3).
+int SeekCompressedOutput(void *cookie, off64_t *offset, int whence) {
+    if (*offset != 0 or whence != SEEK_CUR) {
+        errno = ESPIPE;
+        return -1;
+    }
+
+    *offset = reinterpret_cast<CompressedOutput *>(cookie)->tell();
+    return 0;
+}
+
+
+int CloseCompressedOutput(void *cookie) {
+    const auto output(reinterpret_cast<CompressedOutput *>(cookie));
+    const bool success(output->close());
+    delete output;
+    if (success)
+        return 0;
+    errno = EIO;
+    return EOF;
+}
+
+
+} // unnamed namespace
+
+
+FILE *OpenForReading(const std::string &path, const Codec codec) {
+    if (codec == Codec::NONE)
+        return std::fopen(path.c_str(), "r");
+
+    FILE * const raw(std::fopen(path.c_str(), "r"));
+    if (raw == nullptr)
+        return nullptr;
+
+    const auto input(new CompressedInput(path, raw, codec));
+    static const cookie_io_functions_t INPUT_FUNCTIONS{
+        .read = ReadCompressedInput, .write = nullptr, .seek = SeekCompressedInput, .close = CloseCompressedInput
+    };
+    FILE * const stream(::fopencookie(input, "r", INPUT_FUNCTIONS));
+    if (stream == nullptr)
+        delete input;
+
+    return stream;
+}
+
+
+FILE *OpenForWriting(const std::string &path, const Codec codec, const unsigned thread_count) {
+    if (codec == Codec::NONE)
+        return std::fopen(path.c_str(), "w");
+
+    FILE * const raw(std::fopen(path.c_str(), "w"));
+    if (raw == nullptr)
+        return nullptr;
+
+    const auto output(
+        new CompressedOutput(path, raw, codec, thread_count != 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency())));
+    static const cookie_io_functions_t OUTPUT_FUNCTIONS{
+        .read = nullptr, .write = WriteCompressedOutput, .seek = SeekCompressedOutput, .close = CloseCompressedOutput
+    };
+    FILE * const stream(::fopencookie(output, "w", OUTPUT_FUNCTIONS));
+    if (stream == nullptr) {
+        std::fclose(raw);
+        delete output;
+    }
+
+    return stream;
+}
+
+
+} // namespace CompressedFile
@@ -21,13 +21,18 @@
 #include "ControlNumberGuesser.h"
 #include <algorithm>
 #include <iterator>
+#include <numeric>
+#include <span>
 #include <unordered_set>
 #include <vector>
+#include <cstdio>
+#include "BinaryIO.h"
 #include "Compiler.h"
 #include "MiscUtil.h"
 #include "StringUtil.h"
 #include "TextUtil.h"
 #include "UBTools.h"
+#include "WallClockTimer.h"
 
 
 const std::set<std::string> ControlNumberGuesser::EMPTY_SET;
@@ -35,17 +40,367 @@ const std::string ControlNumberGuesser::DATABASE_PATH(UBTools::GetTuelibPath() +
 const std::string ControlNumberGuesser::INSTALLER_SCRIPT_PATH("/usr/local/ub_tools/cpp/data/installer/control_number_guesser.sql");
 
 
+namespace {
+
+
+// Indexed by ControlNumberGuesser::Table.
+const struct {
+    const char *table_name_, *column_name_;
+} TABLE_AND_COLUMN_NAMES[] = {
+    { "normalised_titles", "title" }, { "normalised_authors", "author" }, { "publication_year", "year" },
+    { "doi", "doi" },                 { "issn", "issn" },                 { "isbn", "isbn" },
+};
+
+
+// The keys under which titles and author names are stored in the database.
+inline std::string GetTitleLookupKey(const std::string &title) {
+    return TextUtil::UTF8ToLower(ControlNumberGuesser::NormaliseTitle(title));
+}
+
+
+inline std::string GetAuthorLookupKey(const std::string &author_name) {
+    return TextUtil::UTF8ToLower(ControlNumberGuesser::NormaliseAuthorName(author_name));
+}
+
+
+// Both ranges must be sorted.
+void IntersectSortedIDs(const std::span<const uint32_t> ids1, const std::span<const uint32_t> ids2,
+                        std::vector<uint32_t> * const intersection) {
+    intersection->clear();
+    const auto &smaller_ids(ids1.size() <= ids2.size() ? ids1 : ids2);
+    const auto &larger_ids(ids1.size() <= ids2.size() ? ids2 : ids1);
+
+    // Posting lists for years are huge while those for titles typically only have a handful of entries.  In that case
+    // binary searches beat a linear merge by far:
+    if (smaller_ids.size() * 32 < larger_ids.size()) {
+        auto search_start(larger_ids.begin());
+        for (const uint32_t id : smaller_ids) {
+            search_start = std::lower_bound(search_start, larger_ids.end(), id);
+            if (search_start == larger_ids.end())
+                break;
+            if (*search_start == id)
+                intersection->emplace_back(id);
+        }
+    } else
+        std::set_intersection(smaller_ids.begin(), smaller_ids.end(), larger_ids.begin(), larger_ids.end(),
+                              std::back_inserter(*intersection));
+}
+
+
+inline void SortAndRemoveDuplicates(std::vector<uint32_t> * const ids) {
+    std::sort(ids->begin(), ids->end());
+    ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+}
+
+
+constexpr unsigned MINHASH_BAND_COUNT(6);
+constexpr unsigned MINHASH_ROWS_PER_BAND(3);
+
+
+inline uint64_t SplitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30u)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27u)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31u);
+}
+
+
+// \return The sorted and unique hashes of all byte trigrams of "s".
+std::vector<uint64_t> GetTrigramHashes(const std::string &s) {
+    std::vector<uint64_t> trigram_hashes;
+    if (s.length() < 3) {
+        uint64_t packed_bytes(s.length());
+        for (const char ch : s)
+            packed_bytes = (packed_bytes << 8u) | static_cast<unsigned char>(ch);
+        trigram_hashes.emplace_back(SplitMix64(packed_bytes));
+    } else {
+        trigram_hashes.reserve(s.length() - 2);
+        for (size_t i(0); i < s.length() - 2; ++i)
+            trigram_hashes.emplace_back(SplitMix64(static_cast<unsigned char>(s[i]) << 16u | static_cast<unsigned char>(s[i + 1]) << 8u
+                                                   | static_cast<unsigned char>(s[i + 2])));
+    }
+    std::sort(trigram_hashes.begin(), trigram_hashes.end());
+    trigram_hashes.erase(std::unique(trigram_hashes.begin(), trigram_hashes.end()), trigram_hashes.end());
+
+    return trigram_hashes;
+}
+
+
+// Computes a MinHash signature of "trigram_hashes" and hashes each of its bands.  Two sets w/ a Jaccard similarity of J
+// share at least one band hash with a probability of 1 - (1 - J^MINHASH_ROWS_PER_BAND)^MINHASH_BAND_COUNT.
+void GetBandHashes(const std::vector<uint64_t> &trigram_hashes, uint32_t band_hashes[MINHASH_BAND_COUNT]) {
+    uint64_t min_hashes[MINHASH_BAND_COUNT * MINHASH_ROWS_PER_BAND];
+    std::fill(std::begin(min_hashes), std::end(min_hashes), UINT64_MAX);
+    for (const uint64_t trigram_hash : trigram_hashes) {
+        for (unsigned i(0); i < MINHASH_BAND_COUNT * MINHASH_ROWS_PER_BAND; ++i)
+            min_hashes[i] = std::min(min_hashes[i], SplitMix64(trigram_hash + i));
+    }
+
+    for (unsigned band(0); band < MINHASH_BAND_COUNT; ++band) {
+        uint64_t band_hash(band);
+        for (unsigned row(0); row < MINHASH_ROWS_PER_BAND; ++row)
+            band_hash = SplitMix64(band_hash ^ min_hashes[band * MINHASH_ROWS_PER_BAND + row]);
+        band_hashes[band] = static_cast<uint32_t>(band_hash);
+    }
+}
+
+
+// Both arguments must be sorted and free of duplicates.
+double JaccardSimilarity(const std::vector<uint64_t> &hashes1, const std::vector<uint64_t> &hashes2) {
+    size_t intersection_size(0);
+    auto hash1(hashes1.cbegin()), hash2(hashes2.cbegin());
+    while (hash1 != hashes1.cend() and hash2 != hashes2.cend()) {
+        if (*hash1 < *hash2)
+            ++hash1;
+        else if (*hash2 < *hash1)
+            ++hash2;
+        else {
+            ++intersection_size;
+            ++hash1, ++hash2;
+        }
+    }
+
+    return static_cast<double>(intersection_size) / (hashes1.size() + hashes2.size() - intersection_size);
+}
+
+
+// The number of rows that rebuildDatabase() inserts per INSERT statement.
+constexpr unsigned ROWS_PER_BULK_INSERT(1000);
+
+
+// Hands out the sorted (key, control number) pairs of a run that has either been spilled to a file or is still in memory.
+class SortedRun {
+    std::unique_ptr<File> run_file_;
+    uint64_t remaining_count_;
+    std::vector<std::pair<std::string, std::string>>::const_iterator next_in_memory_;
+    std::pair<std::string, std::string> current_;
+
+public:
+    explicit SortedRun(const std::string &path);
+    explicit SortedRun(const std::vector<std::pair<std::string, std::string>> &keys_and_control_numbers)
+        : remaining_count_(keys_and_control_numbers.size()), next_in_memory_(keys_and_control_numbers.cbegin()) { }
+
+    //* \return False if the run has been exhausted, o/w makes the next pair the current one.
+    bool advance();
+
+    inline const std::pair<std::string, std::string> &current() const { return current_; }
+};
+
+
+SortedRun::SortedRun(const std::string &path): run_file_(FileUtil::OpenInputFileOrDie(path)) {
+    BinaryIO::ReadOrDie(*run_file_, &remaining_count_);
+}
+
+
+bool SortedRun::advance() {
+    if (remaining_count_ == 0)
+        return false;
+    --remaining_count_;
+
+    if (run_file_ == nullptr)
+        current_ = *next_in_memory_++;
+    else {
+        BinaryIO::ReadOrDie(*run_file_, &current_.first);
+        BinaryIO::ReadOrDie(*run_file_, &current_.second);
+    }
+
+    return true;
+}
+
+
+} // unnamed namespace
+
+
+/** An inverted index over all tables w/ the control numbers replaced by integer IDs.  The IDs are assigned in the sort
+ *  order of the control numbers and each posting list is a sorted range of IDs in "ids_".
+ */
+class ControlNumberGuesser::InMemoryIndex {
+public:
+    typedef std::span<const uint32_t> PostingList;
+
+private:
+    typedef std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> KeyToRangeMap; // offset and length in "ids_"
+    std::vector<std::string> control_numbers_;
+    KeyToRangeMap key_to_range_maps_[TABLE_COUNT];
+    std::vector<uint32_t> ids_;
+
+    // Only used for fuzzy title matching:
+    double min_title_similarity_;
+    std::vector<const KeyToRangeMap::value_type *> titles_;
+    std::vector<std::pair<uint32_t, uint32_t>> band_hashes_and_title_indices_; // sorted
+
+public:
+    explicit InMemoryIndex(DbConnection * const db_connection);
+
+    //* \return False if "table_name" is not a table we know about.
+    static bool GetTable(const std::string &table_name, Table * const table);
+
+    PostingList lookup(const Table table, const std::string &key) const;
+    inline const std::string &getControlNumber(const uint32_t id) const { return control_numbers_[id]; }
+
+    void enableFuzzyTitleMatching(const double min_similarity);
+    inline bool fuzzyTitleMatchingIsEnabled() const { return min_title_similarity_ > 0.0; }
+
+    //* \brief Appends the IDs of the records whose titles are similar to "title_key" to "ids" which will be sorted afterwards.
+    void lookupSimilarTitles(const std::string &title_key, std::vector<uint32_t> * const ids) const;
+};
+
+
+ControlNumberGuesser::InMemoryIndex::InMemoryIndex(DbConnection * const db_connection): min_title_similarity_(0.0) {
+    std::unordered_map<std::string, uint32_t> control_number_to_id_map;
+    for (unsigned table(TITLES); table < TABLE_COUNT; ++table) {
+        std::unordered_map<std::string, std::vector<uint32_t>> key_to_ids_map;
+        db_connection->queryOrDie(std::string("SELECT ") + TABLE_AND_COLUMN_NAMES[table].column_name_ + ", control_number FROM "
+                                  + TABLE_AND_COLUMN_NAMES[table].table_name_);
+        auto result_set(db_connection->getLastResultSet());
+        while (const auto row = result_set.getNextRow()) {
+            const auto control_number_and_id(control_number_to_id_map.emplace(row["control_number"], control_numbers_.size()));
+            if (control_number_and_id.second)
+                control_numbers_.emplace_back(control_number_and_id.first->first);
+            key_to_ids_map[row[0]].emplace_back(control_number_and_id.first->second);
+        }
+
+        auto &key_to_range_map(key_to_range_maps_[table]);
+        key_to_range_map.reserve(key_to_ids_map.size());
+        for (const auto &[key, ids] : key_to_ids_map) {
+            key_to_range_map.emplace(key, std::make_pair(ids_.size(), ids.size()));
+            ids_.insert(ids_.end(), ids.cbegin(), ids.cend());
+        }
+        LOG_INFO("loaded " + std::to_string(key_to_range_map.size()) + " keys from " + TABLE_AND_COLUMN_NAMES[table].table_name_ + ".");
+    }
+
+    // Renumber the control numbers in sort order so that sorted ID ranges correspond to sorted control numbers:
+    std::vector<uint32_t> old_ids(control_numbers_.size());
+    std::iota(old_ids.begin(), old_ids.end(), 0);
+    std::sort(old_ids.begin(), old_ids.end(), [this](const uint32_t id1, const uint32_t id2) {
+        return control_numbers_[id1] < control_numbers_[id2];
+    });
+    std::vector<uint32_t> old_to_new_ids(old_ids.size());
+    std::vector<std::string> sorted_control_numbers;
+    sorted_control_numbers.reserve(control_numbers_.size());
+    for (uint32_t new_id(0); new_id < old_ids.size(); ++new_id) {
+        old_to_new_ids[old_ids[new_id]] = new_id;
+        sorted_control_numbers.emplace_back(std::move(control_numbers_[old_ids[new_id]]));
+    }
+    control_numbers_.swap(sorted_control_numbers);
+
+    for (auto &id : ids_)
+        id = old_to_new_ids[id];
+    for (const auto &key_to_range_map : key_to_range_maps_) {
+        for (const auto &[key, offset_and_length] : key_to_range_map)
+            std::sort(ids_.begin() + offset_and_length.first, ids_.begin() + offset_and_length.first + offset_and_length.second);
+    }
+    LOG_INFO("the in-memory index contains " + std::to_string(control_numbers_.size()) + " control numbers.");
+}
+
+
+bool ControlNumberGuesser::InMemoryIndex::GetTable(const std::string &table_name, Table * const table) {
+    for (unsigned i(TITLES); i < TABLE_COUNT; ++i) {
+        if (table_name == TABLE_AND_COLUMN_NAMES[i].table_name_) {
+            *table = static_cast<Table>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+ControlNumberGuesser::InMemoryIndex::PostingList ControlNumberGuesser::InMemoryIndex::lookup(const Table table,
+                                                                                           const std::string &key) const {
+    const auto key_and_range(key_to_range_maps_[table].find(key));
+    if (key_and_range == key_to_range_maps_[table].cend())
+        return PostingList();
+    return PostingList(ids_.data() + key_and_range->second.first, key_and_range->second.second);
+}
+
+
+void ControlNumberGuesser::InMemoryIndex::enableFuzzyTitleMatching(const double min_similarity) {
+    if (unlikely(min_similarity <= 0.0 or min_similarity > 1.0))
+        LOG_ERROR("the minimum similarity must be in (0,1]!");
+    min_title_similarity_ = min_similarity;
+    if (not titles_.empty())
+        return;
+
+    const auto &title_to_range_map(key_to_range_maps_[TITLES]);
+    titles_.reserve(title_to_range_map.size());
+    band_hashes_and_title_indices_.reserve(title_to_range_map.size() * MINHASH_BAND_COUNT);
+    for (const auto &title_and_range : title_to_range_map) {
+        uint32_t band_hashes[MINHASH_BAND_COUNT];
+        GetBandHashes(GetTrigramHashes(title_and_range.first), band_hashes);
+        for (const uint32_t band_hash : band_hashes)
+            band_hashes_and_title_indices_.emplace_back(band_hash, titles_.size());
+        titles_.emplace_back(&title_and_range);
+    }
+    std::sort(band_hashes_and_title_indices_.begin(), band_hashes_and_title_indices_.end());
+    LOG_INFO("built the fuzzy matching index for " + std::to_string(titles_.size()) + " titles.");
+}
+
+
+void ControlNumberGuesser::InMemoryIndex::lookupSimilarTitles(const std::string &title_key, std::vector<uint32_t> * const ids) const {
+    const auto trigram_hashes(GetTrigramHashes(title_key));
+    uint32_t band_hashes[MINHASH_BAND_COUNT];
+    GetBandHashes(trigram_hashes, band_hashes);
+
+    std::vector<uint32_t> candidate_title_indices;
+    for (const uint32_t band_hash : band_hashes) {
+        for (auto band_hash_and_title_index(std::lower_bound(band_hashes_and_title_indices_.cbegin(), band_hashes_and_title_indices_.cend(),
+                                                             std::make_pair(band_hash, uint32_t(0))));
+             band_hash_and_title_index != band_hashes_and_title_indices_.cend() and band_hash_and_title_index->first == band_hash;
+             ++band_hash_and_title_index)
+            candidate_title_indices.emplace_back(band_hash_and_title_index->second);
+    }
+    SortAndRemoveDuplicates(&candidate_title_indices);
+
+    for (const uint32_t title_index : candidate_title_indices) {
+        const auto &[title, offset_and_length](*titles_[title_index]);
+        if (JaccardSimilarity(trigram_hashes, GetTrigramHashes(title)) < min_title_similarity_)
+            continue;
+        LOG_DEBUG("\"" + title_key + "\" is similar to \"" + title + "\".");
+        const auto posting_list_start(ids_.cbegin() + offset_and_length.first);
+        ids->insert(ids->end(), posting_list_start, posting_list_start + offset_and_length.second);
+    }
+    SortAndRemoveDuplicates(ids);
+}
+
+
+ControlNumberGuesser::ControlNumberGuesser(const LookupMode lookup_mode, const UpdateMode update_mode, const std::string &database_path)
+    : MAX_CONTROL_NUMBER_LENGTH(BSZUtil::PPN_LENGTH_NEW), update_mode_(update_mode), database_path_(database_path),
+      new_database_path_(database_path + ".new"),
+      db_connection_(
+          DbConnection::Sqlite3Factory(update_mode == REPLACE_DATABASE ? new_database_path_ : database_path_, DbConnection::CREATE)),
+      db_transaction_(nullptr) {
+    if (update_mode == REPLACE_DATABASE) {
+        if (unlikely(lookup_mode == IN_MEMORY_INDEX))
+            LOG_ERROR("REPLACE_DATABASE mode can't be combined w/ IN_MEMORY_INDEX mode!");
+        db_connection_.sqliteResetDatabase(INSTALLER_SCRIPT_PATH); // Discard leftovers of an earlier, failed run.
+    }
+
+    if (lookup_mode == IN_MEMORY_INDEX)
+        in_memory_index_.reset(new InMemoryIndex(&db_connection_));
+}
+
+
 ControlNumberGuesser::~ControlNumberGuesser() {
     delete db_transaction_;
 }
 
 
+void ControlNumberGuesser::enableFuzzyTitleMatching(const double min_similarity) {
+    if (unlikely(in_memory_index_ == nullptr))
+        LOG_ERROR("fuzzy title matching is only available in IN_MEMORY_INDEX mode!");
+    in_memory_index_->enableFuzzyTitleMatching(min_similarity);
+}
+
+
 void ControlNumberGuesser::clearDatabase() {
+    checkUpdatesAreAllowed();
     db_connection_.sqliteResetDatabase(INSTALLER_SCRIPT_PATH);
 }
 
 
 void ControlNumberGuesser::beginUpdate() {
+    checkUpdatesAreAllowed();
     db_transaction_ = new DbTransaction(&db_connection_);
 }
 
@@ -56,69 +411,188 @@ void ControlNumberGuesser::endUpdate() {
 }
 
 
+void ControlNumberGuesser::rebuildDatabase(const std::vector<KeyCollector *> &key_collectors) {
+    clearDatabase();
+    beginUpdate();
+
+    for (unsigned table(TITLES); table < TABLE_COUNT; ++table) {
+        WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+        timer.start();
+
+        std::vector<std::unique_ptr<SortedRun>> sorted_runs;
+        for (const auto key_collector : key_collectors) {
+            for (const auto &run_file : key_collector->sorted_runs_[table])
+                sorted_runs.emplace_back(new SortedRun(run_file->getFilePath()));
+            key_collector->sortBufferedKeys(static_cast<Table>(table));
+            sorted_runs.emplace_back(new SortedRun(key_collector->keys_and_control_numbers_[table]));
+        }
+
+        // A k-way merge w/ a min-heap of the runs ordered by their current pairs:
+        const auto run_is_greater([](const SortedRun * const run1, const SortedRun * const run2) {
+            return run1->current() > run2->current();
+        });
+        std::vector<SortedRun *> heap;
+        for (const auto &sorted_run : sorted_runs) {
+            if (sorted_run->advance())
+                heap.emplace_back(sorted_run.get());
+        }
+        std::make_heap(heap.begin(), heap.end(), run_is_greater);
+
+        const std::string insert_prefix(std::string("INSERT INTO ") + TABLE_AND_COLUMN_NAMES[table].table_name_ + " ("
+                                        + TABLE_AND_COLUMN_NAMES[table].column_name_ + ", control_number) VALUES ");
+        std::string insert_statement;
+        unsigned pending_row_count(0);
+        size_t row_count(0);
+        std::pair<std::string, std::string> last_key_and_control_number;
+        while (not heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), run_is_greater);
+            SortedRun * const sorted_run(heap.back());
+            const auto &[key, control_number](sorted_run->current());
+            if (row_count == 0 or sorted_run->current() != last_key_and_control_number) {
+                insert_statement += (pending_row_count == 0 ? insert_prefix : std::string(",")) + "('"
+                                    + db_connection_.escapeString(key) + "','" + db_connection_.escapeString(control_number) + "')";
+                last_key_and_control_number = sorted_run->current();
+                ++row_count;
+                if (++pending_row_count == ROWS_PER_BULK_INSERT) {
+                    db_connection_.queryOrDie(insert_statement);
+                    insert_statement.clear();
+                    pending_row_count = 0;
+                }
+            }
+
+            if (sorted_run->advance())
+                std::push_heap(heap.begin(), heap.end(), run_is_greater);
+            else
+                heap.pop_back();
+        }
+        if (pending_row_count > 0)
+            db_connection_.queryOrDie(insert_statement);
+
+        timer.stop();
+        LOG_INFO("loaded " + std::to_string(row_count) + " rows from " + std::to_string(sorted_runs.size()) + " sorted run(s) into "
+                 + TABLE_AND_COLUMN_NAMES[table].table_name_ + " in " + StringUtil::ToString(timer.getTime(), 1) + " s ("
+                 + std::to_string(static_cast<size_t>(row_count / std::max(timer.getTime(), 0.001))) + " rows/s).");
+    }
+
+    endUpdate();
+}
+
+
+void ControlNumberGuesser::installNewDatabase() {
+    if (unlikely(update_mode_ != REPLACE_DATABASE))
+        LOG_ERROR("installNewDatabase() is only available in REPLACE_DATABASE mode!");
+    if (unlikely(db_transaction_ != nullptr))
+        LOG_ERROR("can't install the new database while an update is in progress!");
+
+    // Our connection uses a write-ahead log which is not renamed along w/ the database, so we have to move everything into the
+    // database file first.  Leaving WAL mode also removes the log and shared-memory files:
+    db_connection_.queryOrDie("PRAGMA wal_checkpoint(TRUNCATE)");
+    db_connection_.queryOrDie("PRAGMA journal_mode = DELETE");
+    if (unlikely(::rename(new_database_path_.c_str(), database_path_.c_str()) != 0))
+        LOG_ERROR("failed to rename \"" + new_database_path_ + "\" to \"" + database_path_ + "\"!");
+}
+
+
 void ControlNumberGuesser::insertTitle(const std::string &title, const std::string &control_number) {
-    const auto normalised_title(NormaliseTitle(title));
-    LOG_DEBUG("normalised_title=\"" + normalised_title + "\".");
-    if (unlikely(normalised_title.empty()))
-        LOG_WARNING("Empty normalised title in record w/ control number: " + control_number);
-    else
-        db_connection_.queryOrDie("INSERT OR IGNORE INTO normalised_titles (title, control_number) VALUES('" + db_connection_.escapeString(normalised_title) + "', '" + control_number + "')");
+    insertKey(TITLES, GetInsertionKey(TITLES, title, control_number), control_number);
 }
 
 
 void ControlNumberGuesser::insertAuthors(const std::set<std::string> &authors, const std::string &control_number) {
-    for (const auto &author : authors) {
-        const auto normalised_author_name(TextUtil::UTF8ToLower(NormaliseAuthorName(author)));
-        LOG_DEBUG("normalised_author_name=\"" + normalised_author_name + "\".");
-        if (unlikely(normalised_author_name.empty()))
-            LOG_WARNING("Empty normalised author in record w/ control number: " + control_number + " (orig. \"" + author + "\")");
-        else
-            db_connection_.queryOrDie("INSERT OR IGNORE INTO normalised_authors (author, control_number) VALUES('" + db_connection_.escapeString(normalised_author_name) + "', '" + control_number + "')");
-    }
+    for (const auto &author : authors)
+        insertKey(AUTHORS, GetInsertionKey(AUTHORS, author, control_number), control_number);
 }
 
 
 void ControlNumberGuesser::insertYear(const std::string &year, const std::string &control_number) {
-    if (unlikely(control_number.length() > MAX_CONTROL_NUMBER_LENGTH))
-        LOG_ERROR("\"" + control_number + "\" is too large to fit!");
-
-    db_connection_.queryOrDie("INSERT OR IGNORE INTO publication_year (year, control_number) VALUES('" + year + "', '" + control_number + "')");
+    insertKey(YEARS, GetInsertionKey(YEARS, year, control_number), control_number);
 }
 
 
 void ControlNumberGuesser::insertDOI(const std::string &doi, const std::string &control_number) {
-    std::string normalised_doi;
-    MiscUtil::NormaliseDOI(doi, &normalised_doi);
-
-    LOG_DEBUG("normalised_doi=\"" + normalised_doi + "\".");
-    if (unlikely(normalised_doi.empty()))
-        LOG_WARNING("Empty normalised doi in record w/ control number: " + control_number + ": " + doi);
-    else
-        db_connection_.queryOrDie("INSERT OR IGNORE INTO doi (doi, control_number) VALUES('" + normalised_doi + "', '" + control_number + "')");
+    insertKey(DOIS, GetInsertionKey(DOIS, doi, control_number), control_number);
 }
 
 
 void ControlNumberGuesser::insertISSN(const std::string &issn, const std::string &control_number) {
-    std::string normalised_issn;
-    MiscUtil::NormaliseISSN(issn, &normalised_issn);
-
-    LOG_DEBUG("normalised_issn=\"" + normalised_issn + "\".");
-    if (unlikely(normalised_issn.empty()))
-        LOG_WARNING("Empty normalised ISSN in record w/ control number: " + control_number + ": " + issn);
-    else
-        db_connection_.queryOrDie("INSERT OR IGNORE INTO issn (issn, control_number) VALUES('" + normalised_issn + "', '" + control_number + "')");
+    insertKey(ISSNS, GetInsertionKey(ISSNS, issn, control_number), control_number);
 }
 
 
 void ControlNumberGuesser::insertISBN(const std::string &isbn, const std::string &control_number) {
-    std::string normalised_isbn;
-    MiscUtil::NormaliseISBN(isbn, &normalised_isbn);
+    insertKey(ISBNS, GetInsertionKey(ISBNS, isbn, control_number), control_number);
+}
+
+
+void ControlNumberGuesser::KeyCollector::insertTitle(const std::string &title, const std::string &control_number) {
+    insert(TITLES, GetInsertionKey(TITLES, title, control_number), control_number);
+}
+
+
+void ControlNumberGuesser::KeyCollector::insertAuthors(const std::set<std::string> &authors, const std::string &control_number) {
+    for (const auto &author : authors)
+        insert(AUTHORS, GetInsertionKey(AUTHORS, author, control_number), control_number);
+}
+
+
+void ControlNumberGuesser::KeyCollector::insertYear(const std::string &year, const std::string &control_number) {
+    insert(YEARS, GetInsertionKey(YEARS, year, control_number), control_number);
+}
+
+
+void ControlNumberGuesser::KeyCollector::insertDOI(const std::string &doi, const std::string &control_number) {
+    insert(DOIS, GetInsertionKey(DOIS, doi, control_number), control_number);
+}
+
 
-    LOG_DEBUG("normalised_isbn=\"" + normalised_isbn + "\".");
-    if (unlikely(normalised_isbn.empty()))
-        LOG_WARNING("Empty normalised ISBN in record w/ control number: " + control_number + ": " + isbn);
-    else
-        db_connection_.queryOrDie("INSERT OR IGNORE INTO isbn (isbn, control_number) VALUES('" + normalised_isbn + "', '" + control_number + "')");
+void ControlNumberGuesser::KeyCollector::insertISSN(const std::string &issn, const std::string &control_number) {
+    insert(ISSNS, GetInsertionKey(ISSNS, issn, control_number), control_number);
+}
+
+
+void ControlNumberGuesser::KeyCollector::insertISBN(const std::string &isbn, const std::string &control_number) {
+    insert(ISBNS, GetInsertionKey(ISBNS, isbn, control_number), control_number);
+}
+
+
+void ControlNumberGuesser::KeyCollector::insert(const Table table, const std::string &key, const std::string &control_number) {
+    if (key.empty())
+        return;
+
+    keys_and_control_numbers_[table].emplace_back(key, control_number);
+    buffered_bytes_ += sizeof(KeyAndControlNumber) + key.length() + control_number.length();
+    if (buffered_bytes_ > max_buffered_bytes_)
+        spill();
+}
+
+
+void ControlNumberGuesser::KeyCollector::sortBufferedKeys(const Table table) {
+    auto &keys_and_control_numbers(keys_and_control_numbers_[table]);
+    std::sort(keys_and_control_numbers.begin(), keys_and_control_numbers.end());
+    keys_and_control_numbers.erase(std::unique(keys_and_control_numbers.begin(), keys_and_control_numbers.end()),
+                                   keys_and_control_numbers.end());
+}
+
+
+// Each sorted run starts w/ the number of pairs that follow.
+void ControlNumberGuesser::KeyCollector::spill() {
+    for (unsigned table(TITLES); table < TABLE_COUNT; ++table) {
+        auto &keys_and_control_numbers(keys_and_control_numbers_[table]);
+        if (keys_and_control_numbers.empty())
+            continue;
+
+        sortBufferedKeys(static_cast<Table>(table));
+        sorted_runs_[table].emplace_back(new FileUtil::AutoTempFile(spill_directory_ + "/CNG"));
+        const auto run_file(FileUtil::OpenOutputFileOrDie(sorted_runs_[table].back()->getFilePath()));
+        BinaryIO::WriteOrDie(*run_file, static_cast<uint64_t>(keys_and_control_numbers.size()));
+        for (const auto &[key, control_number] : keys_and_control_numbers) {
+            BinaryIO::WriteOrDie(*run_file, key);
+            BinaryIO::WriteOrDie(*run_file, control_number);
+        }
+        keys_and_control_numbers.clear();
+        keys_and_control_numbers.shrink_to_fit();
+    }
+    buffered_bytes_ = 0;
 }
 
 
@@ -126,6 +600,9 @@ std::set<std::string> ControlNumberGuesser::getGuessedControlNumbers(const std::
                                                                      const std::string &year, const std::set<std::string> &dois,
                                                                      const std::set<std::string> &issns,
                                                                      const std::set<std::string> &isbns) const {
+    if (in_memory_index_ != nullptr)
+        return getGuessedControlNumbersFromIndex(title, authors, year, dois, issns, isbns);
+
     std::set<std::string> control_numbers;
 
     for (const auto &doi : dois) {
@@ -222,16 +699,14 @@ void ControlNumberGuesser::getControlNumbersAndAuthors(std::unordered_map<std::s
 void ControlNumberGuesser::lookupTitle(const std::string &title, std::set<std::string> * const control_numbers) const {
     control_numbers->clear();
 
-    const auto normalised_title(TextUtil::UTF8ToLower(NormaliseTitle(title)));
-    lookupControlNumber("normalised_titles", "title", normalised_title, control_numbers);
+    lookupControlNumber("normalised_titles", "title", GetTitleLookupKey(title), control_numbers);
 }
 
 
 void ControlNumberGuesser::lookupAuthor(const std::string &author_name, std::set<std::string> * const control_numbers) const {
     control_numbers->clear();
 
-    const auto normalised_author_name(TextUtil::UTF8ToLower(NormaliseAuthorName(author_name)));
-    lookupControlNumber("normalised_authors", "author", normalised_author_name, control_numbers);
+    lookupControlNumber("normalised_authors", "author", GetAuthorLookupKey(author_name), control_numbers);
 }
 
 
@@ -361,9 +836,131 @@ std::string ControlNumberGuesser::NormaliseAuthorName(const std::string &author_
 }
 
 
+std::string ControlNumberGuesser::GetInsertionKey(const Table table, const std::string &value, const std::string &control_number) {
+    std::string key;
+    switch (table) {
+    case TITLES:
+        key = NormaliseTitle(value);
+        break;
+    case AUTHORS:
+        key = GetAuthorLookupKey(value);
+        break;
+    case YEARS:
+        if (unlikely(control_number.length() > BSZUtil::PPN_LENGTH_NEW))
+            LOG_ERROR("\"" + control_number + "\" is too large to fit!");
+        return value;
+    case DOIS:
+        MiscUtil::NormaliseDOI(value, &key);
+        break;
+    case ISSNS:
+        MiscUtil::NormaliseISSN(value, &key);
+        break;
+    case ISBNS:
+        MiscUtil::NormaliseISBN(value, &key);
+        break;
+    default:
+        LOG_ERROR("unknown table: " + std::to_string(table));
+    }
+
+    LOG_DEBUG(std::string("normalised ") + TABLE_AND_COLUMN_NAMES[table].column_name_ + "=\"" + key + "\".");
+    if (unlikely(key.empty()))
+        LOG_WARNING(std::string("Empty normalised ") + TABLE_AND_COLUMN_NAMES[table].column_name_ + " in record w/ control number: "
+                    + control_number + " (orig. \"" + value + "\")");
+
+    return key;
+}
+
+
+void ControlNumberGuesser::insertKey(const Table table, const std::string &key, const std::string &control_number) {
+    checkUpdatesAreAllowed();
+    if (key.empty())
+        return;
+
+    db_connection_.queryOrDie(std::string("INSERT OR IGNORE INTO ") + TABLE_AND_COLUMN_NAMES[table].table_name_ + " ("
+                              + TABLE_AND_COLUMN_NAMES[table].column_name_ + ", control_number) VALUES('"
+                              + db_connection_.escapeString(key) + "', '" + db_connection_.escapeString(control_number) + "')");
+}
+
+
+void ControlNumberGuesser::checkUpdatesAreAllowed() const {
+    if (unlikely(in_memory_index_ != nullptr))
+        LOG_ERROR("the database can't be updated in IN_MEMORY_INDEX mode!");
+}
+
+
+std::set<std::string> ControlNumberGuesser::getGuessedControlNumbersFromIndex(const std::string &title,
+                                                                              const std::set<std::string> &authors, const std::string &year,
+                                                                              const std::set<std::string> &dois,
+                                                                              const std::set<std::string> &issns,
+                                                                              const std::set<std::string> &isbns) const {
+    const auto ids_to_control_numbers([this](const std::vector<uint32_t> &ids) {
+        std::set<std::string> control_numbers;
+        for (const uint32_t id : ids)
+            control_numbers.emplace_hint(control_numbers.end(), in_memory_index_->getControlNumber(id));
+        return control_numbers;
+    });
+
+    std::vector<uint32_t> ids;
+    const auto lookup_identifiers([this, &ids](const Table table, const std::set<std::string> &identifiers,
+                                               bool (*normaliser)(const std::string &, std::string * const)) {
+        for (const auto &identifier : identifiers) {
+            std::string normalised_identifier;
+            normaliser(identifier, &normalised_identifier);
+            const auto posting_list(in_memory_index_->lookup(table, normalised_identifier));
+            ids.insert(ids.end(), posting_list.begin(), posting_list.end());
+        }
+        SortAndRemoveDuplicates(&ids);
+        return not ids.empty();
+    });
+
+    if (lookup_identifiers(DOIS, dois, MiscUtil::NormaliseDOI)
+        or lookup_identifiers(ISSNS, issns, MiscUtil::NormaliseISSN)
+        or lookup_identifiers(ISBNS, isbns, MiscUtil::NormaliseISBN))
+        return ids_to_control_numbers(ids);
+
+    // We normalise twice, just like the SQL code path does:
+    const auto title_key(GetTitleLookupKey(NormaliseTitle(title)));
+    const auto title_posting_list(in_memory_index_->lookup(TITLES, title_key));
+    std::vector<uint32_t> title_ids(title_posting_list.begin(), title_posting_list.end());
+    if (title_ids.empty() and in_memory_index_->fuzzyTitleMatchingIsEnabled())
+        in_memory_index_->lookupSimilarTitles(title_key, &title_ids);
+    if (title_ids.empty()) {
+        LOG_DEBUG("no entries found for normalised title \"" + title_key + "\"");
+        return {};
+    }
+
+    std::vector<uint32_t> author_ids;
+    for (const auto &author : authors) {
+        const auto author_posting_list(in_memory_index_->lookup(AUTHORS, GetAuthorLookupKey(NormaliseAuthorName(author))));
+        author_ids.insert(author_ids.end(), author_posting_list.begin(), author_posting_list.end());
+    }
+    if (author_ids.empty()) {
+        LOG_DEBUG("no entries found for the authors \"" + StringUtil::Join(authors, ',') + "\"");
+        return {};
+    }
+    SortAndRemoveDuplicates(&author_ids);
+
+    IntersectSortedIDs(title_ids, author_ids, &ids);
+    if (year.empty() or ids.empty())
+        return ids_to_control_numbers(ids);
+
+    std::vector<uint32_t> ids_with_matching_year;
+    IntersectSortedIDs(ids, in_memory_index_->lookup(YEARS, year), &ids_with_matching_year);
+    return ids_to_control_numbers(ids_with_matching_year);
+}
+
+
 void ControlNumberGuesser::lookupControlNumber(const std::string &table, const std::string &column_name, const std::string &column_value,
                                                std::set<std::string> * const control_numbers) const {
     control_numbers->clear();
+
+    Table index_table;
+    if (in_memory_index_ != nullptr and InMemoryIndex::GetTable(table, &index_table)) {
+        for (const uint32_t id : in_memory_index_->lookup(index_table, column_value))
+            control_numbers->emplace_hint(control_numbers->end(), in_memory_index_->getControlNumber(id));
+        return;
+    }
+
     db_connection_.queryOrDie("SELECT control_number FROM " + table + " WHERE " + column_name + "='"
                               + db_connection_.escapeString(column_value) + "'");
 
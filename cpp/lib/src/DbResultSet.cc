@@ -109,8 +109,10 @@ Sqlite3ResultSet::~Sqlite3ResultSet() {
 
 
 DbRow Sqlite3ResultSet::getNextRow() {
-    if (no_of_rows_ == 0)
-        return DbRow(nullptr, nullptr, 0, {});
+    if (no_of_rows_ == 0) {
+        field_name_to_index_map_.clear();
+        return DbRow(nullptr, nullptr, 0, field_name_to_index_map_); // The map must outlive the returned row!
+    }
 
     switch (::sqlite3_step(stmt_handle_)) {
     case SQLITE_DONE:
@@ -33,6 +33,7 @@ DbRow::DbRow(DbRow &&other) {
     other.field_count_ = 0;
     stmt_handle_ = other.stmt_handle_;
     other.stmt_handle_ = nullptr;
+    field_name_to_index_map_ = other.field_name_to_index_map_;
 }
 
 
@@ -30,6 +30,7 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include "CompressedFile.h"
 #include "FileUtil.h"
 #include "MiscUtil.h"
 #include "StringUtil.h"
@@ -37,7 +38,7 @@
 
 
 File::File(const std::string &filename, const std::string &mode, const ThrowOnOpenBehaviour throw_on_error_behaviour)
-    : filename_(filename), buffer_ptr_(buffer_), read_count_(0), file_(nullptr), pushed_back_count_(0), precision_(6) {
+    : filename_(filename), buffer_ptr_(buffer_), read_count_(0), file_(nullptr), pushed_back_count_(0), precision_(6), compressed_(false) {
     if (mode == "w")
         open_mode_ = WRITING;
     else if (mode == "a")
@@ -46,13 +47,28 @@ File::File(const std::string &filename, const std::string &mode, const ThrowOnOp
         open_mode_ = READING;
     else if (mode == "r+")
         open_mode_ = READING_AND_WRITING;
-    else {
+    else if (mode == "wc") {
+        open_mode_ = WRITING;
+        compressed_ = true;
+    } else if (mode == "ru") {
+        open_mode_ = READING;
+        compressed_ = true;
+    } else {
         if (throw_on_error_behaviour == THROW_ON_ERROR)
             throw std::runtime_error("in File::File: open mode \"" + mode + "\" not supported! (1)");
         return;
     }
 
-    file_ = std::fopen(filename.c_str(), mode.c_str());
+    if (compressed_) {
+        const auto codec(CompressedFile::GuessCodec(filename));
+        if (codec == CompressedFile::Codec::NONE) {
+            if (throw_on_error_behaviour == THROW_ON_ERROR)
+                throw std::runtime_error("in File::File: can't determine the compression format of \"" + filename + "\"!");
+            return;
+        }
+        file_ = open_mode_ == WRITING ? CompressedFile::OpenForWriting(filename, codec) : CompressedFile::OpenForReading(filename, codec);
+    } else
+        file_ = std::fopen(filename.c_str(), mode.c_str());
     if (file_ == nullptr) {
         if (throw_on_error_behaviour == THROW_ON_ERROR)
             throw std::runtime_error("in File::File: could not open \"" + filename + "\" w/ mode \"" + mode + "\"!");
@@ -62,7 +78,7 @@ File::File(const std::string &filename, const std::string &mode, const ThrowOnOp
 
 File::File(const int fd, const std::string &mode)
     : filename_(FileUtil::GetPathFromFileDescriptor(fd)), buffer_ptr_(buffer_), read_count_(0), file_(nullptr), pushed_back_count_(0),
-      precision_(6) {
+      precision_(6), compressed_(false) {
     std::string local_mode;
     if (mode.empty()) {
         // Determine the mode from "fd":
@@ -125,7 +141,7 @@ off_t File::size() const {
         throw std::runtime_error("in File::size: can't obtain the size of non-open File \"" + filename_ + "\"!");
 
     struct stat stat_buf;
-    if (unlikely(::fstat(fileno(file_), &stat_buf) == -1))
+    if (unlikely((compressed_ ? ::stat(filename_.c_str(), &stat_buf) : ::fstat(fileno(file_), &stat_buf)) == -1))
         throw std::runtime_error("in File::size: fstat(2) failed on \"" + filename_ + "\" (" + std::string(::strerror(errno)) + ")!");
 
     return stat_buf.st_size;
@@ -0,0 +1,376 @@
+/** \file    GNDNameIndex.cc
+ *  \brief   Implementation of the GNDNameIndex and GNDLookupCache classes.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GNDNameIndex.h"
+#include <algorithm>
+#include <string_view>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Compiler.h"
+#include "FileUtil.h"
+#include "TextUtil.h"
+#include "UBTools.h"
+#include "util.h"
+
+
+const std::string GNDNameIndex::DEFAULT_INDEX_PATH(UBTools::GetTuelibPath() + "gnd_names.index");
+const std::string GNDLookupCache::DEFAULT_CACHE_PATH(UBTools::GetTuelibPath() + "gnd_lookup_cache.sq3");
+
+
+// The index file consists of a header followed by the name entries, sorted by their keys, the person entries and finally
+// all strings.  A person's string contains the GND number, the preferred name, the life dates and the professions, each
+// terminated by a NUL character.  All offsets are relative to the start of the string area.
+struct GNDNameIndex::Header {
+    char magic_[8];
+    uint64_t name_count_;
+    uint64_t person_count_;
+    uint64_t strings_size_;
+};
+
+
+struct GNDNameIndex::NameEntry {
+    uint64_t key_offset_;
+    uint32_t key_length_;
+    uint32_t person_index_;
+};
+
+
+struct GNDNameIndex::PersonEntry {
+    uint64_t offset_;
+    uint64_t length_;
+};
+
+
+namespace {
+
+
+constexpr char INDEX_MAGIC[8] = { 'U', 'B', 'G', 'N', 'D', 'N', 'I', '1' };
+
+
+// Undifferentiated names ("Tn" records) are shared by several people, so we can't use them to identify anybody.
+bool IsUndifferentiatedName(const MARC::Record &record) {
+    for (const auto &_075_field : record.getTagRange("075")) {
+        if (_075_field.hasSubfieldWithValue('b', "n"))
+            return true;
+    }
+
+    return false;
+}
+
+
+std::string GetLifeDates(const MARC::Record &record) {
+    for (const auto &_548_field : record.getTagRange("548")) {
+        if (_548_field.hasSubfieldWithValue('4', "datl"))
+            return _548_field.getFirstSubfieldWithCode('a');
+    }
+
+    const auto _100_field(record.findTag("100"));
+    return _100_field == record.end() ? "" : _100_field->getFirstSubfieldWithCode('d');
+}
+
+
+std::vector<std::string> GetProfessions(const MARC::Record &record) {
+    std::vector<std::string> professions;
+    for (const auto &_550_field : record.getTagRange("550")) {
+        if (_550_field.hasSubfieldWithValue('4', "berc") or _550_field.hasSubfieldWithValue('4', "beru")) {
+            const auto profession(_550_field.getFirstSubfieldWithCode('a'));
+            if (not profession.empty() and std::find(professions.cbegin(), professions.cend(), profession) == professions.cend())
+                professions.emplace_back(profession);
+        }
+    }
+
+    return professions;
+}
+
+
+template <typename T>
+void WriteOrDie(File * const output, const T &value) {
+    if (unlikely(output->write(&value, sizeof value) != sizeof value))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+void WriteOrDie(File * const output, const std::string &s) {
+    if (unlikely(output->write(s.data(), s.size()) != s.size()))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+} // unnamed namespace
+
+
+GNDNameIndex::GNDNameIndex(const std::string &index_path): index_path_(index_path) {
+    const int fd(::open(index_path.c_str(), O_RDONLY));
+    if (fd == -1)
+        LOG_ERROR("failed to open(2) \"" + index_path + "\"!");
+
+    struct stat stat_buf;
+    if (unlikely(::fstat(fd, &stat_buf) != 0))
+        LOG_ERROR("failed to fstat(2) \"" + index_path + "\"!");
+    map_size_ = stat_buf.st_size;
+    if (unlikely(map_size_ < sizeof(Header)))
+        LOG_ERROR("\"" + index_path + "\" is too small to be a GND name index!");
+
+    map_start_ = static_cast<const char *>(::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+    if (map_start_ == MAP_FAILED or map_start_ == nullptr)
+        LOG_ERROR("failed to mmap(2) \"" + index_path + "\"!");
+    ::close(fd);
+
+    header_ = reinterpret_cast<const Header *>(map_start_);
+    if (unlikely(std::memcmp(header_->magic_, INDEX_MAGIC, sizeof INDEX_MAGIC) != 0))
+        LOG_ERROR("\"" + index_path + "\" is not a GND name index!");
+    if (unlikely(map_size_
+                 != sizeof(Header) + header_->name_count_ * sizeof(NameEntry) + header_->person_count_ * sizeof(PersonEntry)
+                        + header_->strings_size_))
+        LOG_ERROR("\"" + index_path + "\" is truncated or corrupt!");
+
+    names_ = reinterpret_cast<const NameEntry *>(map_start_ + sizeof(Header));
+    persons_ = reinterpret_cast<const PersonEntry *>(names_ + header_->name_count_);
+    strings_ = reinterpret_cast<const char *>(persons_ + header_->person_count_);
+}
+
+
+GNDNameIndex::~GNDNameIndex() {
+    if (unlikely(::munmap(const_cast<char *>(map_start_), map_size_) != 0))
+        LOG_ERROR("munmap(2) on \"" + index_path_ + "\" failed!");
+}
+
+
+size_t GNDNameIndex::size() const {
+    return header_->name_count_;
+}
+
+
+void GNDNameIndex::lookup(const std::string &name, std::vector<Person> * const persons) const {
+    const std::string key(NormaliseName(name));
+    if (key.empty())
+        return;
+
+    const auto get_key([this](const NameEntry &name_entry) {
+        return std::string_view(strings_ + name_entry.key_offset_, name_entry.key_length_);
+    });
+    const auto names_end(names_ + header_->name_count_);
+    for (auto name_entry(std::lower_bound(names_, names_end, key,
+                                          [&get_key](const NameEntry &lhs, const std::string &rhs) { return get_key(lhs) < rhs; }));
+         name_entry != names_end and get_key(*name_entry) == key; ++name_entry)
+    {
+        const PersonEntry &person_entry(persons_[name_entry->person_index_]);
+        std::vector<std::string> fields;
+        for (const char *field(strings_ + person_entry.offset_), *person_end(field + person_entry.length_); field < person_end;
+             field += fields.back().length() + 1 /* terminating NUL */)
+            fields.emplace_back(field);
+        if (unlikely(fields.size() < 3))
+            LOG_ERROR("corrupt person entry in \"" + index_path_ + "\"!");
+
+        Person person;
+        person.gnd_number_ = fields[0];
+        person.preferred_name_ = fields[1];
+        person.life_dates_ = fields[2];
+        person.professions_.assign(fields.cbegin() + 3, fields.cend());
+        persons->emplace_back(person);
+    }
+}
+
+
+std::string GNDNameIndex::NormaliseName(const std::string &name) {
+    std::wstring wname;
+    if (unlikely(not TextUtil::UTF8ToWCharString(name, &wname))) {
+        LOG_WARNING("failed to convert \"" + name + "\" to a wide character string!");
+        return "";
+    }
+    wname = TextUtil::RemoveDiacritics(TextUtil::ExpandLigatures(wname));
+    TextUtil::ToLower(&wname);
+
+    // Split into words, remembering which words precede the first comma:
+    std::vector<std::wstring> words;
+    size_t words_before_comma(0);
+    bool comma_seen(false);
+    std::wstring word;
+    for (const wchar_t ch : wname + L" ") {
+        if (ch == ',' or TextUtil::IsSpace(ch) or TextUtil::IsPunctuationCharacter(ch) or ch == '-') {
+            if (not word.empty()) {
+                words.emplace_back(word);
+                word.clear();
+            }
+            if (ch == ',' and not comma_seen) {
+                comma_seen = true;
+                words_before_comma = words.size();
+            }
+        } else
+            word += ch;
+    }
+    if (words.empty())
+        return "";
+
+    // We want "last name(s), first name(s)":
+    if (not comma_seen) {
+        std::rotate(words.begin(), words.end() - 1, words.end());
+        words_before_comma = 1;
+    }
+    std::wstring normalised_name;
+    for (size_t i(0); i < words.size(); ++i) {
+        if (i > 0)
+            normalised_name += (i == words_before_comma) ? L", " : L" ";
+        normalised_name += words[i];
+    }
+
+    std::string utf8_normalised_name;
+    if (unlikely(not TextUtil::WCharToUTF8String(normalised_name, &utf8_normalised_name)))
+        LOG_ERROR("failed to convert a wstring to an UTF8 string!");
+    return utf8_normalised_name;
+}
+
+
+void GNDNameIndex::Build(MARC::Reader * const authority_reader, const std::string &index_path) {
+    std::vector<std::string> person_strings;
+    std::vector<std::pair<std::string, uint32_t>> keys_and_person_indices;
+    unsigned record_count(0);
+    while (const auto record = authority_reader->read()) {
+        ++record_count;
+        if (not record.isPerson() or IsUndifferentiatedName(record))
+            continue;
+
+        std::string gnd_number;
+        if (not MARC::GetGNDCode(record, &gnd_number))
+            continue;
+        const std::string preferred_name(record.findTag("100")->getFirstSubfieldWithCode('a'));
+        if (unlikely(preferred_name.empty())) {
+            LOG_WARNING("person record w/o a name: " + record.getControlNumber());
+            continue;
+        }
+
+        const uint32_t person_index(person_strings.size());
+        const auto add_name([&keys_and_person_indices, person_index](const std::string &name) {
+            auto key(NormaliseName(name));
+            if (not key.empty())
+                keys_and_person_indices.emplace_back(std::move(key), person_index);
+        });
+        add_name(preferred_name);
+        for (const auto &_400_field : record.getTagRange("400"))
+            add_name(_400_field.getFirstSubfieldWithCode('a'));
+
+        std::string person_string(gnd_number + '\0' + preferred_name + '\0' + GetLifeDates(record) + '\0');
+        for (const auto &profession : GetProfessions(record))
+            person_string += profession + '\0';
+        person_strings.emplace_back(person_string);
+    }
+    std::sort(keys_and_person_indices.begin(), keys_and_person_indices.end());
+    keys_and_person_indices.erase(std::unique(keys_and_person_indices.begin(), keys_and_person_indices.end()),
+                                  keys_and_person_indices.end());
+
+    Header header;
+    std::memcpy(header.magic_, INDEX_MAGIC, sizeof INDEX_MAGIC);
+    header.name_count_ = keys_and_person_indices.size();
+    header.person_count_ = person_strings.size();
+    header.strings_size_ = 0;
+    for (const auto &[key, person_index] : keys_and_person_indices)
+        header.strings_size_ += key.size();
+    for (const auto &person_string : person_strings)
+        header.strings_size_ += person_string.size();
+
+    const std::string temp_index_path(index_path + ".tmp");
+    const auto index_file(FileUtil::OpenOutputFileOrDie(temp_index_path));
+    WriteOrDie(index_file.get(), header);
+
+    uint64_t string_offset(0);
+    for (const auto &[key, person_index] : keys_and_person_indices) {
+        const NameEntry name_entry{ string_offset, static_cast<uint32_t>(key.size()), person_index };
+        WriteOrDie(index_file.get(), name_entry);
+        string_offset += key.size();
+    }
+    for (const auto &person_string : person_strings) {
+        const PersonEntry person_entry{ string_offset, person_string.size() };
+        WriteOrDie(index_file.get(), person_entry);
+        string_offset += person_string.size();
+    }
+
+    for (const auto &[key, person_index] : keys_and_person_indices)
+        WriteOrDie(index_file.get(), key);
+    for (const auto &person_string : person_strings)
+        WriteOrDie(index_file.get(), person_string);
+    index_file->close();
+    FileUtil::RenameFileOrDie(temp_index_path, index_path, /* remove_target = */ true);
+
+    LOG_INFO("processed " + std::to_string(record_count) + " authority records and indexed " + std::to_string(header.name_count_)
+             + " names of " + std::to_string(header.person_count_) + " persons.");
+}
+
+
+const GNDNameIndex *GNDNameIndex::GetDefaultInstance() {
+    static const std::unique_ptr<const GNDNameIndex> default_instance(FileUtil::Exists(DEFAULT_INDEX_PATH) ? new GNDNameIndex()
+                                                                                                           : nullptr);
+    return default_instance.get();
+}
+
+
+GNDLookupCache::GNDLookupCache(const std::string &cache_path, const unsigned max_age)
+    : db_connection_(DbConnection::Sqlite3Factory(cache_path, DbConnection::CREATE)), max_age_(max_age), enabled_(true) {
+    // Several processes may share the cache:
+    if (unlikely(not db_connection_.query("PRAGMA busy_timeout = 10000")
+                 or not db_connection_.query("CREATE TABLE IF NOT EXISTS lookups (query TEXT PRIMARY KEY, answer TEXT NOT NULL, "
+                                             "fetched_at INTEGER NOT NULL)")))
+    {
+        LOG_WARNING("disabling the GND lookup cache \"" + cache_path + "\": " + db_connection_.getLastErrorMessage());
+        enabled_ = false;
+    }
+}
+
+
+bool GNDLookupCache::lookup(const std::string &query, std::string * const answer) {
+    if (unlikely(not enabled_))
+        return false;
+
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+    if (unlikely(not db_connection_.query("SELECT answer FROM lookups WHERE query=" + db_connection_.escapeAndQuoteString(query)
+                                          + " AND fetched_at >= CAST(strftime('%s','now') AS INTEGER) - " + std::to_string(max_age_))))
+    {
+        LOG_WARNING("failed to query the GND lookup cache: " + db_connection_.getLastErrorMessage());
+        return false;
+    }
+
+    auto result_set(db_connection_.getLastResultSet());
+    const auto row(result_set.getNextRow());
+    if (not row)
+        return false;
+    *answer = row["answer"];
+    return true;
+}
+
+
+void GNDLookupCache::store(const std::string &query, const std::string &answer) {
+    if (unlikely(not enabled_))
+        return;
+
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+    if (unlikely(not db_connection_.query("INSERT OR REPLACE INTO lookups (query, answer, fetched_at) VALUES("
+                                          + db_connection_.escapeAndQuoteString(query) + ","
+                                          + db_connection_.escapeAndQuoteString(answer) + ",CAST(strftime('%s','now') AS INTEGER))")))
+        LOG_WARNING("failed to update the GND lookup cache: " + db_connection_.getLastErrorMessage());
+}
+
+
+GNDLookupCache *GNDLookupCache::GetDefaultInstance() {
+    static const std::unique_ptr<GNDLookupCache> default_instance(
+        (FileUtil::Exists(DEFAULT_CACHE_PATH) or ::access(UBTools::GetTuelibPath().c_str(), W_OK) == 0) ? new GNDLookupCache() : nullptr);
+    return default_instance.get();
+}
@@ -18,12 +18,18 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "JSON.h"
+#include <algorithm>
 #include <deque>
 #include <stdexcept>
 #include <string>
 #include <cctype>
 #include <cstdio>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "Compiler.h"
+#include "CompressedFile.h"
+#include "File.h"
 #include "FileUtil.h"
 #include "StringUtil.h"
 #include "TextUtil.h"
@@ -171,9 +177,9 @@ TokenType Scanner::parseNumber() {
         number_as_string += *ch_;
 
     ++ch_;
-    if (*ch_ == '+' or *ch_ == '-')
+    if (ch_ != end_ and (*ch_ == '+' or *ch_ == '-'))
         number_as_string += *ch_++;
-    if (unlikely(not StringUtil::IsDigit(*ch_))) {
+    if (unlikely(ch_ == end_ or not StringUtil::IsDigit(*ch_))) {
         last_error_message_ = "missing digits for the exponent!";
         return ERROR;
     }
@@ -254,24 +260,22 @@ bool Scanner::UTF16EscapeToUTF8(std::string * const utf8) {
 }
 
 
-// Helper for parseStringConstant; copies a singe Unicode codepoint from ch to s.
+// Helper for parseStringConstant; copies a singe Unicode codepoint from ch to s.  Invalid lead bytes are copied as is and
+// sequences that are truncated by "end" are copied up to "end".
 // See https://en.wikipedia.org/wiki/UTF-8 in order to understand the implementation.
-inline static void UTF8Advance(std::string::const_iterator &ch, std::string * const s) {
-    if ((static_cast<unsigned char>(*ch) & 0b10000000u) == 0) { // High bit is not set.
-        *s += *ch++;
-    } else if ((static_cast<unsigned char>(*ch) & 0b11100000u) == 0b11000000u) {
-        *s += *ch++;
-        *s += *ch++;
-    } else if ((static_cast<unsigned char>(*ch) & 0b11110000u) == 0b11100000u) {
-        *s += *ch++;
-        *s += *ch++;
-        *s += *ch++;
-    } else if ((static_cast<unsigned char>(*ch) & 0b11111000u) == 0b11110000u) {
-        *s += *ch++;
-        *s += *ch++;
-        *s += *ch++;
-        *s += *ch++;
-    }
+inline static void UTF8Advance(const char *&ch, const char * const end, std::string * const s) {
+    size_t sequence_length(1);
+    if ((static_cast<unsigned char>(*ch) & 0b11100000u) == 0b11000000u)
+        sequence_length = 2;
+    else if ((static_cast<unsigned char>(*ch) & 0b11110000u) == 0b11100000u)
+        sequence_length = 3;
+    else if ((static_cast<unsigned char>(*ch) & 0b11111000u) == 0b11110000u)
+        sequence_length = 4;
+    if (unlikely(sequence_length > static_cast<size_t>(end - ch)))
+        sequence_length = end - ch;
+
+    s->append(ch, sequence_length);
+    ch += sequence_length;
 }
 
 
@@ -282,7 +286,7 @@ TokenType Scanner::parseStringConstant() {
     std::string string_value;
     while (ch_ != end_ and *ch_ != '"') {
         if (*ch_ != '\\')
-            UTF8Advance(ch_, &string_value);
+            UTF8Advance(ch_, end_, &string_value);
         else { // Deal w/ an escape sequence.
             if (unlikely(ch_ + 1 == end_)) {
                 last_error_message_ =
@@ -486,7 +490,7 @@ std::string ObjectNode::getOptionalStringValue(const std::string &label, const s
 }
 
 
-static size_t ParsePath(const std::string &path, std::deque<std::string> * const components, const bool path_is_absolute) {
+size_t ParsePath(const std::string &path, std::deque<std::string> * const components, const bool path_is_absolute) {
     if (unlikely(path_is_absolute and not StringUtil::StartsWith(path, "/")))
         throw std::runtime_error("in JSON::ParsePath: path must start with a slash!");
 
@@ -737,6 +741,329 @@ bool Parser::parse(std::shared_ptr<JSONNode> * const tree_root) {
 }
 
 
+PullParser::PullParser(const std::string &path, const bool json_lines)
+    : path_(path), json_lines_(json_lines), map_start_(nullptr), map_size_(0), seen_top_level_value_(false), last_boolean_value_(false) {
+    File input(path, CompressedFile::GuessCodec(path) == CompressedFile::Codec::NONE ? "r" : "ru");
+    if (unlikely(input.anErrorOccurred()))
+        throw std::runtime_error("in JSON::PullParser::PullParser: can't open \"" + path + "\" for reading!");
+
+    struct stat stat_buf;
+    if (not input.isCompressed() and ::fstat(input.getFileDescriptor(), &stat_buf) == 0 and S_ISREG(stat_buf.st_mode)) {
+        map_size_ = stat_buf.st_size;
+        if (map_size_ > 0) {
+            void * const map_start(::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, input.getFileDescriptor(), 0));
+            if (unlikely(map_start == MAP_FAILED))
+                throw std::runtime_error("in JSON::PullParser::PullParser: failed to mmap(2) \"" + path + "\"!");
+            ::madvise(map_start, map_size_, MADV_SEQUENTIAL);
+            map_start_ = reinterpret_cast<const char *>(map_start);
+        }
+        scanner_.reset(new Scanner(map_start_, map_start_ + map_size_));
+    } else {
+        char buffer[64 * 1024];
+        size_t read_count;
+        while ((read_count = input.read(buffer, sizeof(buffer))) > 0)
+            document_.append(buffer, read_count);
+        if (unlikely(input.anErrorOccurred()))
+            throw std::runtime_error("in JSON::PullParser::PullParser: failed to read \"" + path + "\"!");
+        scanner_.reset(new Scanner(document_));
+    }
+}
+
+
+PullParser::~PullParser() {
+    if (map_start_ != nullptr and ::munmap(const_cast<char *>(map_start_), map_size_) != 0)
+        LOG_ERROR("munmap(2) failed!");
+}
+
+
+void PullParser::throwError(const std::string &msg) const {
+    throw std::runtime_error("in JSON::PullParser: " + msg + " (" + path_ + ", line " + std::to_string(getLineNumber()) + ")");
+}
+
+
+PullParser::EventType PullParser::startValue(const TokenType token) {
+    switch (token) {
+    case OPEN_BRACE:
+        open_containers_.emplace_back(Container{ /* is_object_ = */ true, /* seen_first_element_ = */ false,
+                                                 /* expecting_value_ = */ false });
+        return OBJECT_START;
+    case OPEN_BRACKET:
+        open_containers_.emplace_back(Container{ /* is_object_ = */ false, /* seen_first_element_ = */ false,
+                                                 /* expecting_value_ = */ false });
+        return ARRAY_START;
+    case STRING_CONST:
+        return STRING_VALUE;
+    case INTEGER_CONST:
+        return INTEGER_VALUE;
+    case DOUBLE_CONST:
+        return DOUBLE_VALUE;
+    case TRUE_CONST:
+        last_boolean_value_ = true;
+        return BOOLEAN_VALUE;
+    case FALSE_CONST:
+        last_boolean_value_ = false;
+        return BOOLEAN_VALUE;
+    case NULL_CONST:
+        return NULL_VALUE;
+    case ERROR:
+        throwError(scanner_->getLastErrorMessage());
+    case END_OF_INPUT:
+        throwError("unexpected end of input!");
+    default:
+        throwError("syntax error, found '" + TokenTypeToString(token) + "' but expected some kind of value!");
+    }
+}
+
+
+PullParser::EventType PullParser::endContainer() {
+    const bool is_object(open_containers_.back().is_object_);
+    open_containers_.pop_back();
+    return is_object ? OBJECT_END : ARRAY_END;
+}
+
+
+PullParser::EventType PullParser::getNextEvent() {
+    if (open_containers_.empty()) {
+        const TokenType token(scanner_->getToken());
+        if (token == END_OF_INPUT) {
+            if (unlikely(not seen_top_level_value_ and not json_lines_))
+                throwError("empty document!");
+            return END_OF_DOCUMENT;
+        }
+        if (unlikely(seen_top_level_value_ and not json_lines_))
+            throwError("found trailing garbage " + TokenTypeToString(token) + "!");
+        seen_top_level_value_ = true;
+        return startValue(token);
+    }
+
+    Container &container(open_containers_.back());
+    TokenType token(scanner_->getToken());
+    if (container.is_object_) {
+        if (container.expecting_value_) {
+            if (unlikely(token != COLON))
+                throwError("colon expected after label but found '" + TokenTypeToString(token) + "' instead!");
+            container.expecting_value_ = false;
+            return startValue(scanner_->getToken());
+        }
+
+        if (token == CLOSE_BRACE)
+            return endContainer();
+        if (container.seen_first_element_) {
+            if (unlikely(token != COMMA))
+                throwError("expected ',' or '}' but found '" + TokenTypeToString(token) + "'!");
+            token = scanner_->getToken();
+        }
+        if (unlikely(token != STRING_CONST))
+            throwError("label expected but found '" + TokenTypeToString(token) + "' instead!");
+        container.seen_first_element_ = true;
+        container.expecting_value_ = true;
+        last_label_ = scanner_->getLastStringConstant();
+        return LABEL;
+    }
+
+    if (token == CLOSE_BRACKET)
+        return endContainer();
+    if (container.seen_first_element_) {
+        if (unlikely(token != COMMA))
+            throwError("expected ',' or ']' but found '" + TokenTypeToString(token) + "'!");
+        token = scanner_->getToken();
+    }
+    container.seen_first_element_ = true;
+    return startValue(token);
+}
+
+
+std::string PullParser::getScalarValueAsString(const EventType event) const {
+    switch (event) {
+    case STRING_VALUE:
+        return getStringValue();
+    case INTEGER_VALUE:
+        return std::to_string(getIntegerValue());
+    case DOUBLE_VALUE:
+        return std::to_string(getDoubleValue());
+    case BOOLEAN_VALUE:
+        return getBooleanValue() ? "true" : "false";
+    case NULL_VALUE:
+        return "null";
+    default:
+        throwError("expected a scalar value!");
+    }
+}
+
+
+bool PullParser::getNextElement(EventType * const element_start_event) {
+    if (open_containers_.empty()) {
+        if (unlikely(not json_lines_))
+            throwError("getNextElement() called outside of an array!");
+        *element_start_event = getNextEvent();
+        return *element_start_event != END_OF_DOCUMENT;
+    }
+
+    if (unlikely(open_containers_.back().is_object_))
+        throwError("getNextElement() called inside of an object!");
+    *element_start_event = getNextEvent();
+    return *element_start_event != ARRAY_END;
+}
+
+
+void PullParser::skipValue(const EventType start_event) {
+    if (start_event != OBJECT_START and start_event != ARRAY_START) {
+        getScalarValueAsString(start_event); // Only for the check.
+        return;
+    }
+
+    const size_t depth(open_containers_.size());
+    while (open_containers_.size() >= depth)
+        getNextEvent();
+}
+
+
+std::shared_ptr<JSONNode> PullParser::parseValue(const EventType start_event) {
+    switch (start_event) {
+    case OBJECT_START: {
+        const auto object_node(std::make_shared<ObjectNode>());
+        while (getNextEvent() != OBJECT_END) {
+            const std::string label(last_label_);
+            object_node->insert(label, parseValue(getNextEvent()));
+        }
+        return object_node;
+    }
+    case ARRAY_START: {
+        const auto array_node(std::make_shared<ArrayNode>());
+        EventType element_start_event;
+        while ((element_start_event = getNextEvent()) != ARRAY_END)
+            array_node->push_back(parseValue(element_start_event));
+        return array_node;
+    }
+    case STRING_VALUE:
+        return std::make_shared<StringNode>(getStringValue());
+    case INTEGER_VALUE:
+        return std::make_shared<IntegerNode>(getIntegerValue());
+    case DOUBLE_VALUE:
+        return std::make_shared<DoubleNode>(getDoubleValue());
+    case BOOLEAN_VALUE:
+        return std::make_shared<BooleanNode>(getBooleanValue());
+    case NULL_VALUE:
+        return std::make_shared<NullNode>();
+    default:
+        throwError("expected the start of a value!");
+    }
+}
+
+
+static bool IsPrefixOfAnyPath(const std::vector<std::string> &prefix, const std::vector<std::vector<std::string>> &paths) {
+    for (const auto &path : paths) {
+        if (path.size() >= prefix.size() and std::equal(prefix.cbegin(), prefix.cend(), path.cbegin()))
+            return true;
+    }
+    return false;
+}
+
+
+void PullParser::extractStrings(const EventType start_event, std::vector<std::string> * const current_path,
+                                const std::vector<std::vector<std::string>> &paths, std::vector<std::string> * const values) {
+    switch (start_event) {
+    case OBJECT_START:
+        while (getNextEvent() != OBJECT_END) {
+            current_path->emplace_back(last_label_);
+            const EventType value_start_event(getNextEvent());
+            if (IsPrefixOfAnyPath(*current_path, paths))
+                extractStrings(value_start_event, current_path, paths, values);
+            else
+                skipValue(value_start_event);
+            current_path->pop_back();
+        }
+        return;
+    case ARRAY_START: {
+        unsigned index(0);
+        EventType element_start_event;
+        while ((element_start_event = getNextEvent()) != ARRAY_END) {
+            current_path->emplace_back(std::to_string(index++));
+            if (IsPrefixOfAnyPath(*current_path, paths))
+                extractStrings(element_start_event, current_path, paths, values);
+            else
+                skipValue(element_start_event);
+            current_path->pop_back();
+        }
+        return;
+    }
+    default: {
+        const std::string value(getScalarValueAsString(start_event));
+        for (unsigned i(0); i < paths.size(); ++i) {
+            if (paths[i] == *current_path)
+                (*values)[i] = value;
+        }
+    }
+    }
+}
+
+
+void PullParser::extractStrings(const EventType start_event, const std::vector<std::string> &paths,
+                                std::vector<std::string> * const values) {
+    std::vector<std::vector<std::string>> split_paths;
+    split_paths.reserve(paths.size());
+    for (const auto &path : paths) {
+        std::deque<std::string> path_components;
+        ParsePath(path, &path_components, /* path_is_absolute = */ true);
+        split_paths.emplace_back(path_components.cbegin(), path_components.cend());
+    }
+
+    values->assign(paths.size(), "");
+    std::vector<std::string> current_path;
+    extractStrings(start_event, &current_path, split_paths, values);
+}
+
+
+bool PullParser::descend(const std::string &path, EventType * const start_event) {
+    std::deque<std::string> path_components;
+    ParsePath(path, &path_components, /* path_is_absolute = */ true);
+
+    EventType event(getNextEvent());
+    if (event == END_OF_DOCUMENT) { // E.g. at the end of a JSON Lines file.
+        *start_event = END_OF_DOCUMENT;
+        return true;
+    }
+
+    for (const auto &path_component : path_components) {
+        bool found(false);
+        if (event == OBJECT_START) {
+            while (getNextEvent() != OBJECT_END) {
+                event = getNextEvent();
+                if (last_label_ == path_component) {
+                    found = true;
+                    break;
+                }
+                skipValue(event);
+            }
+        } else if (event == ARRAY_START) {
+            unsigned index;
+            if (unlikely(not StringUtil::ToUnsigned(path_component, &index)))
+                return false;
+            for (unsigned element_no(0); (event = getNextEvent()) != ARRAY_END; ++element_no) {
+                if (element_no == index) {
+                    found = true;
+                    break;
+                }
+                skipValue(event);
+            }
+        }
+
+        if (not found)
+            return false;
+    }
+
+    *start_event = event;
+    return true;
+}
+
+
+bool PullParser::IsJSONLinesFile(const std::string &path) {
+    const std::string extension(FileUtil::GetExtension(CompressedFile::StripCodecSuffix(path)));
+    return ::strcasecmp(extension.c_str(), "jsonl") == 0 or ::strcasecmp(extension.c_str(), "ndjson") == 0
+           or ::strcasecmp(extension.c_str(), "jsonlines") == 0;
+}
+
+
 std::string TokenTypeToString(const TokenType token) {
     switch (token) {
     case COMMA:
@@ -0,0 +1,598 @@
+/** \file    JSONDocument.cc
+ *  \brief   Implementation of the arena-allocated JSON DOM.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "JSONDocument.h"
+#include <algorithm>
+#include <charconv>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include "Compiler.h"
+#include "StringUtil.h"
+#include "TextUtil.h"
+
+
+namespace JSON {
+
+
+namespace {
+
+
+// The number of slots of the hash table of an object w/ "member_count" members, always a power of 2.
+inline size_t HashTableSize(const size_t member_count) {
+    size_t hash_table_size(1);
+    while (hash_table_size < 2 * member_count)
+        hash_table_size <<= 1;
+    return hash_table_size;
+}
+
+
+inline size_t HashLabel(const std::string_view label) {
+    return std::hash<std::string_view>()(label);
+}
+
+
+} // unnamed namespace
+
+
+bool Value::getBooleanValue() const {
+    if (unlikely(type_ != JSONNode::BOOLEAN_NODE))
+        LOG_ERROR("expected a BOOLEAN_NODE but found a " + JSONNode::TypeToString(type_) + "!");
+    return boolean_value_;
+}
+
+
+int64_t Value::getIntegerValue() const {
+    if (unlikely(type_ != JSONNode::INT64_NODE))
+        LOG_ERROR("expected an INT64_NODE but found a " + JSONNode::TypeToString(type_) + "!");
+    return integer_value_;
+}
+
+
+double Value::getDoubleValue() const {
+    if (unlikely(type_ != JSONNode::DOUBLE_NODE))
+        LOG_ERROR("expected a DOUBLE_NODE but found a " + JSONNode::TypeToString(type_) + "!");
+    return double_value_;
+}
+
+
+std::string_view Value::getStringValue() const {
+    if (unlikely(type_ != JSONNode::STRING_NODE))
+        LOG_ERROR("expected a STRING_NODE but found a " + JSONNode::TypeToString(type_) + "!");
+    return std::string_view(string_value_, size_);
+}
+
+
+std::span<const Value::Member> Value::getMembers() const {
+    if (unlikely(type_ != JSONNode::OBJECT_NODE))
+        LOG_ERROR("expected an OBJECT_NODE but found a " + JSONNode::TypeToString(type_) + "!");
+    return std::span<const Member>(members_, size_);
+}
+
+
+std::span<const Value> Value::getElements() const {
+    if (unlikely(type_ != JSONNode::ARRAY_NODE))
+        LOG_ERROR("expected an ARRAY_NODE but found a " + JSONNode::TypeToString(type_) + "!");
+    return std::span<const Value>(elements_, size_);
+}
+
+
+const Value *Value::getMember(const std::string_view label) const {
+    if (type_ != JSONNode::OBJECT_NODE)
+        return nullptr;
+
+    if (size_ <= HASH_THRESHOLD) {
+        for (const Member *member(members_); member != members_ + size_; ++member) {
+            if (member->label_ == label)
+                return &member->value_;
+        }
+        return nullptr;
+    }
+
+    const uint32_t * const hash_table(reinterpret_cast<const uint32_t *>(members_ + size_));
+    const size_t mask(HashTableSize(size_) - 1);
+    for (size_t slot(HashLabel(label) & mask); hash_table[slot] != 0; slot = (slot + 1) & mask) {
+        const Member &member(members_[hash_table[slot] - 1]);
+        if (member.label_ == label)
+            return &member.value_;
+    }
+    return nullptr;
+}
+
+
+const Value *Value::getElement(const size_t index) const {
+    if (type_ != JSONNode::ARRAY_NODE or index >= size_)
+        return nullptr;
+    return elements_ + index;
+}
+
+
+std::string Value::getScalarValueAsString() const {
+    switch (type_) {
+    case JSONNode::BOOLEAN_NODE:
+        return boolean_value_ ? "true" : "false";
+    case JSONNode::NULL_NODE:
+        return "null";
+    case JSONNode::STRING_NODE:
+        return std::string(string_value_, size_);
+    case JSONNode::INT64_NODE:
+        return std::to_string(integer_value_);
+    case JSONNode::DOUBLE_NODE:
+        return std::to_string(double_value_);
+    case JSONNode::OBJECT_NODE:
+        throw std::runtime_error("in JSON::Value::getScalarValueAsString: can't get a unique value from an object!");
+    case JSONNode::ARRAY_NODE:
+        throw std::runtime_error("in JSON::Value::getScalarValueAsString: can't get a unique value from an array!");
+    }
+
+    __builtin_unreachable();
+}
+
+
+// N.B. We use the same format as JSONNode::toString().
+std::string Value::toString() const {
+    switch (type_) {
+    case JSONNode::STRING_NODE:
+        return "\"" + EscapeString(std::string(string_value_, size_)) + "\"";
+    case JSONNode::DOUBLE_NODE: {
+        char as_string[30];
+        std::sprintf(as_string, "%20G", double_value_);
+        return as_string;
+    }
+    case JSONNode::OBJECT_NODE: {
+        std::string as_string("{ ");
+        for (const Member *member(members_); member != members_ + size_; ++member) {
+            as_string += "\"" + EscapeString(std::string(member->label_)) + "\": ";
+            as_string += member->value_.toString();
+            as_string += ", ";
+        }
+        if (size_ > 0)
+            as_string.resize(as_string.size() - 2); // Strip off final comma+space.
+        return as_string + " }";
+    }
+    case JSONNode::ARRAY_NODE: {
+        std::string as_string("[ ");
+        for (const Value *element(elements_); element != elements_ + size_; ++element) {
+            as_string += element->toString();
+            as_string += ", ";
+        }
+        if (size_ > 0)
+            as_string.resize(as_string.size() - 2); // Strip off final comma+space.
+        return as_string + " ]";
+    }
+    default:
+        return getScalarValueAsString();
+    }
+}
+
+
+void Document::Arena::addBlock(const size_t min_size) {
+    const size_t block_size(std::max(next_block_size_, min_size));
+    blocks_.emplace_back(new char[block_size]);
+    next_ = blocks_.back().get();
+    remaining_ = block_size;
+    if (next_block_size_ < 16 * MIN_BLOCK_SIZE)
+        next_block_size_ *= 2;
+}
+
+
+void Document::Arena::clear() {
+    blocks_.clear();
+    next_ = nullptr;
+    remaining_ = 0;
+    next_block_size_ = MIN_BLOCK_SIZE;
+}
+
+
+bool Document::parse(const std::string &json_document) {
+    json_document_ = json_document;
+    return parse();
+}
+
+
+bool Document::parse(std::string &&json_document) {
+    json_document_ = std::move(json_document);
+    return parse();
+}
+
+
+bool Document::parse() {
+    arena_.clear();
+    root_ = Value();
+    error_message_.clear();
+    member_stack_.clear();
+    element_stack_.clear();
+
+    const char *cp(json_document_.data());
+    end_ = cp + json_document_.size();
+    if (unlikely(not parseValue(cp, &root_))) {
+        root_ = Value();
+        return false;
+    }
+
+    skipWhite(cp);
+    if (unlikely(cp != end_)) {
+        root_ = Value();
+        return setError(cp, "found trailing garbage!");
+    }
+
+    return true;
+}
+
+
+void Document::skipWhite(const char *&cp) const {
+    while (cp != end_ and (*cp == ' ' or *cp == '\n' or *cp == '\r' or *cp == '\t'))
+        ++cp;
+}
+
+
+bool Document::setError(const char * const cp, const std::string &msg) {
+    const unsigned line_no(1 + std::count(static_cast<const char *>(json_document_.data()), cp, '\n'));
+    error_message_ = msg + " (line: " + std::to_string(line_no) + ")";
+    return false;
+}
+
+
+bool Document::parseValue(const char *&cp, Value * const value) {
+    skipWhite(cp);
+    if (unlikely(cp == end_))
+        return setError(cp, "unexpected end of input!");
+
+    switch (*cp) {
+    case '{':
+        return parseObject(cp, value);
+    case '[':
+        return parseArray(cp, value);
+    case '"': {
+        std::string_view string;
+        if (unlikely(not parseString(cp, &string)))
+            return false;
+        value->type_ = JSONNode::STRING_NODE;
+        value->size_ = string.size();
+        value->string_value_ = string.data();
+        return true;
+    }
+    case 't':
+        value->type_ = JSONNode::BOOLEAN_NODE;
+        value->boolean_value_ = true;
+        return parseConstant(cp, "true");
+    case 'f':
+        value->type_ = JSONNode::BOOLEAN_NODE;
+        value->boolean_value_ = false;
+        return parseConstant(cp, "false");
+    case 'n':
+        value->type_ = JSONNode::NULL_NODE;
+        return parseConstant(cp, "null");
+    case '+':
+    case '-':
+        return parseNumber(cp, value);
+    default:
+        if (StringUtil::IsDigit(*cp))
+            return parseNumber(cp, value);
+        return setError(cp, "unexpected character '" + std::string(1, *cp) + "'!");
+    }
+}
+
+
+bool Document::parseObject(const char *&cp, Value * const value) {
+    ++cp; // Skip over the opening brace.
+
+    const size_t first_member(member_stack_.size());
+    skipWhite(cp);
+    if (cp != end_ and *cp == '}')
+        ++cp;
+    else {
+        for (;;) {
+            skipWhite(cp);
+            if (unlikely(cp == end_ or *cp != '"'))
+                return setError(cp, "label expected!");
+            std::string_view label;
+            if (unlikely(not parseString(cp, &label)))
+                return false;
+
+            skipWhite(cp);
+            if (unlikely(cp == end_ or *cp != ':'))
+                return setError(cp, "colon expected after label!");
+            ++cp;
+
+            Value member_value;
+            if (unlikely(not parseValue(cp, &member_value)))
+                return false;
+            member_stack_.emplace_back(Value::Member{ label, member_value });
+
+            skipWhite(cp);
+            if (likely(cp != end_ and *cp == ','))
+                ++cp;
+            else if (likely(cp != end_ and *cp == '}')) {
+                ++cp;
+                break;
+            } else
+                return setError(cp, "expected ',' or '}'!");
+        }
+    }
+
+    const size_t member_count(member_stack_.size() - first_member);
+    const size_t hash_table_size(member_count > Value::HASH_THRESHOLD ? HashTableSize(member_count) : 0);
+    Value::Member *members(nullptr);
+    if (member_count > 0) {
+        members = reinterpret_cast<Value::Member *>(
+            arena_.allocate(member_count * sizeof(Value::Member) + hash_table_size * sizeof(uint32_t)));
+        std::uninitialized_copy(member_stack_.cbegin() + first_member, member_stack_.cend(), members);
+        member_stack_.resize(first_member);
+    }
+
+    if (hash_table_size > 0) {
+        uint32_t * const hash_table(reinterpret_cast<uint32_t *>(members + member_count));
+        std::fill(hash_table, hash_table + hash_table_size, 0);
+        const size_t mask(hash_table_size - 1);
+        for (uint32_t member_no(0); member_no < member_count; ++member_no) {
+            size_t slot(HashLabel(members[member_no].label_) & mask);
+            while (hash_table[slot] != 0 and members[hash_table[slot] - 1].label_ != members[member_no].label_)
+                slot = (slot + 1) & mask;
+            if (hash_table[slot] == 0) // The first of several members w/ the same label wins.
+                hash_table[slot] = member_no + 1;
+        }
+    }
+
+    value->type_ = JSONNode::OBJECT_NODE;
+    value->size_ = member_count;
+    value->members_ = members;
+    return true;
+}
+
+
+bool Document::parseArray(const char *&cp, Value * const value) {
+    ++cp; // Skip over the opening bracket.
+
+    const size_t first_element(element_stack_.size());
+    skipWhite(cp);
+    if (cp != end_ and *cp == ']')
+        ++cp;
+    else {
+        for (;;) {
+            Value element;
+            if (unlikely(not parseValue(cp, &element)))
+                return false;
+            element_stack_.emplace_back(element);
+
+            skipWhite(cp);
+            if (likely(cp != end_ and *cp == ','))
+                ++cp;
+            else if (likely(cp != end_ and *cp == ']')) {
+                ++cp;
+                break;
+            } else
+                return setError(cp, "expected ',' or ']'!");
+        }
+    }
+
+    const size_t element_count(element_stack_.size() - first_element);
+    Value *elements(nullptr);
+    if (element_count > 0) {
+        elements = reinterpret_cast<Value *>(arena_.allocate(element_count * sizeof(Value)));
+        std::uninitialized_copy(element_stack_.cbegin() + first_element, element_stack_.cend(), elements);
+        element_stack_.resize(first_element);
+    }
+
+    value->type_ = JSONNode::ARRAY_NODE;
+    value->size_ = element_count;
+    value->elements_ = elements;
+    return true;
+}
+
+
+// Strings w/o escapes are returned as views into "json_document_", all others get unescaped into the arena.
+bool Document::parseString(const char *&cp, std::string_view * const string) {
+    const char * const opening_quote(cp++);
+    const char * const start(cp);
+    while (cp != end_ and *cp != '"' and *cp != '\\')
+        ++cp;
+    if (unlikely(cp == end_))
+        return setError(opening_quote, "unterminated string constant!");
+    if (*cp == '"') {
+        *string = std::string_view(start, cp - start);
+        ++cp;
+        return true;
+    }
+
+    unescaped_string_.assign(start, cp - start);
+    while (cp != end_ and *cp != '"') {
+        if (*cp != '\\') {
+            unescaped_string_ += *cp++;
+            continue;
+        }
+
+        if (unlikely(++cp == end_))
+            break;
+        switch (*cp++) {
+        case '/':
+        case '"':
+        case '\\':
+            unescaped_string_ += cp[-1];
+            break;
+        case 'b':
+            unescaped_string_ += '\b';
+            break;
+        case 'f':
+            unescaped_string_ += '\f';
+            break;
+        case 'n':
+            unescaped_string_ += '\n';
+            break;
+        case 'r':
+            unescaped_string_ += '\r';
+            break;
+        case 't':
+            unescaped_string_ += '\t';
+            break;
+        case 'u':
+            if (unlikely(not appendUTF16Escape(cp)))
+                return false;
+            break;
+        default:
+            return setError(cp - 2, "unexpected escape \\" + std::string(1, cp[-1]) + " in string constant!");
+        }
+    }
+    if (unlikely(cp == end_))
+        return setError(opening_quote, "unterminated string constant!");
+    ++cp; // Skip over the closing quote.
+
+    char * const copy(reinterpret_cast<char *>(arena_.allocate(unescaped_string_.size())));
+    std::memcpy(copy, unescaped_string_.data(), unescaped_string_.size());
+    *string = std::string_view(copy, unescaped_string_.size());
+    return true;
+}
+
+
+// Converts the nnnn part of \unnnn, and, for surrogate pairs, a following \unnnn, to UTF-8.
+bool Document::appendUTF16Escape(const char *&cp) {
+    const auto parse_hex_codes([this, &cp](uint16_t * const u) {
+        if (unlikely(end_ - cp < 4))
+            return setError(cp, "unexpected end-of-input while looking for a \\unnnn escape!");
+        const std::string hex_codes(cp, 4);
+        if (unlikely(not StringUtil::ToUnsignedShort(hex_codes, u, 16)))
+            return setError(cp, "invalid hex sequence \\u" + hex_codes + "!");
+        cp += 4;
+        return true;
+    });
+
+    uint16_t u1;
+    if (unlikely(not parse_hex_codes(&u1)))
+        return false;
+    if (TextUtil::IsValidSingleUTF16Char(u1)) {
+        unescaped_string_ += TextUtil::UTF32ToUTF8(TextUtil::UTF16ToUTF32(u1));
+        return true;
+    }
+
+    if (unlikely(not TextUtil::IsFirstHalfOfSurrogatePair(u1)))
+        return setError(cp, "\\u escape is neither a standalone UTF-16 character nor a valid first half of a surrogate pair!");
+    if (unlikely(end_ - cp < 2 or cp[0] != '\\' or cp[1] != 'u'))
+        return setError(cp, "could not find the 2nd half of a surrogate pair!");
+    cp += 2;
+
+    uint16_t u2;
+    if (unlikely(not parse_hex_codes(&u2)))
+        return false;
+    if (unlikely(not TextUtil::IsSecondHalfOfSurrogatePair(u2)))
+        return setError(cp, "invalid 2nd half of a surrogate pair!");
+
+    unescaped_string_ += TextUtil::UTF32ToUTF8(TextUtil::UTF16ToUTF32(u1, u2));
+    return true;
+}
+
+
+// N.B. We accept the same syntax as JSON::Scanner, i.e. also a leading plus sign.
+bool Document::parseNumber(const char *&cp, Value * const value) {
+    const char * const start(cp);
+    if (*cp == '+' or *cp == '-')
+        ++cp;
+
+    const char * const digits_start(cp);
+    while (cp != end_ and StringUtil::IsDigit(*cp))
+        ++cp;
+    if (unlikely(cp == digits_start))
+        return setError(start, "missing digit or digits after a sign!");
+
+    bool is_integer(true);
+    if (cp != end_ and *cp == '.') {
+        is_integer = false;
+        for (++cp; cp != end_ and StringUtil::IsDigit(*cp); ++cp)
+            /* Intentionally empty! */;
+    }
+    if (cp != end_ and (*cp == 'e' or *cp == 'E')) {
+        is_integer = false;
+        ++cp;
+        if (cp != end_ and (*cp == '+' or *cp == '-'))
+            ++cp;
+        const char * const exponent_start(cp);
+        while (cp != end_ and StringUtil::IsDigit(*cp))
+            ++cp;
+        if (unlikely(cp == exponent_start))
+            return setError(start, "missing digits for the exponent!");
+    }
+
+    const char * const number_start(*start == '+' ? start + 1 : start);
+    if (is_integer) {
+        const auto result(std::from_chars(number_start, cp, value->integer_value_));
+        if (unlikely(result.ec != std::errc() or result.ptr != cp))
+            return setError(start, "failed to convert \"" + std::string(start, cp) + "\" to a 64-bit integer!");
+        value->type_ = JSONNode::INT64_NODE;
+    } else {
+        const auto result(std::from_chars(number_start, cp, value->double_value_));
+        if (unlikely(result.ec != std::errc() or result.ptr != cp))
+            return setError(start, "failed to convert \"" + std::string(start, cp) + "\" to a floating point value!");
+        value->type_ = JSONNode::DOUBLE_NODE;
+    }
+
+    return true;
+}
+
+
+bool Document::parseConstant(const char *&cp, const std::string_view constant) {
+    if (unlikely(static_cast<size_t>(end_ - cp) < constant.size() or std::memcmp(cp, constant.data(), constant.size()) != 0))
+        return setError(cp, "expected \"" + std::string(constant) + "\" but found something else!");
+    cp += constant.size();
+    return true;
+}
+
+
+const Value *LookupValue(const std::string &path, const Value &root) {
+    std::deque<std::string> path_components;
+    if (unlikely(ParsePath(path, &path_components, /* path_is_absolute = */ true) == 0))
+        throw std::runtime_error("in JSON::LookupValue: an empty path is invalid!");
+
+    const Value *value(&root);
+    for (const auto &path_component : path_components) {
+        if (value->isObject())
+            value = value->getMember(path_component);
+        else if (value->isArray()) {
+            unsigned index;
+            if (unlikely(not StringUtil::ToUnsigned(path_component, &index)))
+                return nullptr;
+            value = value->getElement(index);
+        } else
+            return nullptr;
+
+        if (value == nullptr)
+            return nullptr;
+    }
+
+    return value;
+}
+
+
+std::string LookupString(const std::string &path, const Value &root) {
+    const Value * const value(LookupValue(path, root));
+    if (value == nullptr)
+        throw std::runtime_error("in JSON::LookupString: can't find \"" + path + "\"!");
+    return value->getScalarValueAsString();
+}
+
+
+std::string LookupString(const std::string &path, const Value &root, const std::string &default_value) {
+    const Value * const value(LookupValue(path, root));
+    return value == nullptr ? default_value : value->getScalarValueAsString();
+}
+
+
+} // namespace JSON
@@ -18,7 +18,9 @@
 #include <thread>
 #include <unordered_map>
 #include "Downloader.h"
+#include "GNDNameIndex.h"
 #include "JSON.h"
+#include "StringUtil.h"
 #include "UrlUtil.h"
 #include "util.h"
 
@@ -67,18 +69,29 @@ const std::shared_ptr<const JSON::ObjectNode> Query(const std::string &url, cons
             return url_and_lookup_result->second;
     }
 
-    Downloader downloader(url);
-    if (downloader.anErrorOccurred()) {
-        LOG_WARNING("failed to lookup using Lobid API. downloader error: " + downloader.getLastErrorMessage());
-        return nullptr;
+    // GND lookups are cached across processes as well:
+    GNDLookupCache * const persistent_cache(StringUtil::StartsWith(url, BASE_URL_GND) ? GNDLookupCache::GetDefaultInstance() : nullptr);
+    std::string json_document;
+    bool downloaded(false);
+    if (persistent_cache == nullptr or not persistent_cache->lookup(url, &json_document)) {
+        Downloader downloader(url);
+        if (downloader.anErrorOccurred()) {
+            LOG_WARNING("failed to lookup using Lobid API. downloader error: " + downloader.getLastErrorMessage());
+            return nullptr;
+        }
+        json_document = downloader.getMessageBody();
+        downloaded = true;
     }
 
-    JSON::Parser json_parser(downloader.getMessageBody());
+    JSON::Parser json_parser(json_document);
     std::shared_ptr<JSON::JSONNode> root_node;
     if (not(json_parser.parse(&root_node))) {
-        LOG_WARNING("failed to parse returned JSON: " + json_parser.getErrorMessage() + "(input was: " + downloader.getMessageBody() + ")");
+        LOG_WARNING("failed to parse returned JSON: " + json_parser.getErrorMessage() + "(input was: " + json_document + ")");
         return nullptr;
     }
+    // Only store fresh answers, so that cached answers still expire:
+    if (persistent_cache != nullptr and downloaded)
+        persistent_cache->store(url, json_document);
 
     const std::shared_ptr<const JSON::ObjectNode> root_object(JSON::JSONNode::CastToObjectNodeOrDie("root", root_node));
     {
@@ -116,7 +129,37 @@ const std::vector<std::string> QueryAndLookupStrings(const std::string &url, con
 }
 
 
+// \return False if we can't answer the query w/ the local GND name index, o/w true and the matching persons.
+static bool LookupLocalPersons(const std::string &author, const std::string &additional_query_params,
+                               std::vector<GNDNameIndex::Person> * const persons) {
+    // We can't evaluate additional query params locally.
+    if (not additional_query_params.empty())
+        return false;
+
+    const auto gnd_name_index(GNDNameIndex::GetDefaultInstance());
+    if (gnd_name_index == nullptr)
+        return false;
+
+    gnd_name_index->lookup(author, persons);
+    return not persons->empty();
+}
+
+
+// Like Query() we refuse to pick one of several candidates.
+static std::string GetUniqueGNDNumber(const std::vector<GNDNameIndex::Person> &persons) {
+    for (const auto &person : persons) {
+        if (person.gnd_number_ != persons.front().gnd_number_)
+            return "";
+    }
+    return persons.front().gnd_number_;
+}
+
+
 std::string GetAuthorGNDNumber(const std::string &author, const std::string &additional_query_params) {
+    std::vector<GNDNameIndex::Person> persons;
+    if (LookupLocalPersons(author, additional_query_params, &persons))
+        return GetUniqueGNDNumber(persons);
+
     return QueryAndLookupString(
         BuildUrl(BASE_URL_GND, { { "preferredName", author } }, { { "type", "DifferentiatedPerson" } }, additional_query_params),
         "/member/0/gndIdentifier", /* allow_multiple_results */ false);
@@ -125,6 +168,10 @@ std::string GetAuthorGNDNumber(const std::string &author, const std::string &add
 
 std::string GetAuthorGNDNumber(const std::string &author_surname, const std::string &author_firstname,
                                const std::string &additional_query_params) {
+    std::vector<GNDNameIndex::Person> persons;
+    if (LookupLocalPersons(author_surname + ", " + author_firstname, additional_query_params, &persons))
+        return GetUniqueGNDNumber(persons);
+
     return QueryAndLookupString(BuildUrl(BASE_URL_GND,
                                          { { "preferredNameEntityForThePerson.surname", author_surname },
                                            { "preferredNameEntityForThePerson.forename", author_firstname } },
@@ -134,6 +181,10 @@ std::string GetAuthorGNDNumber(const std::string &author_surname, const std::str
 
 
 std::vector<std::string> GetAuthorProfessions(const std::string &author, const std::string &additional_query_params) {
+    std::vector<GNDNameIndex::Person> persons;
+    if (LookupLocalPersons(author, additional_query_params, &persons))
+        return GetUniqueGNDNumber(persons).empty() ? std::vector<std::string>{} : persons.front().professions_;
+
     return QueryAndLookupStrings(
         BuildUrl(BASE_URL_GND, { { "preferredName", author } }, { { "type", "DifferentiatedPerson" } }, additional_query_params),
         "/member/*/professionOrOccupation/*/label", /* allow_multiple_results */ false);
@@ -26,7 +26,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include "Archive.h"
 #include "BSZUtil.h"
+#include "CompressedFile.h"
 #include "FileLocker.h"
 #include "FileUtil.h"
 #include "MiscUtil.h"
@@ -199,6 +201,14 @@ std::vector<std::string> Subfields::extractSubfieldsAndNumericSubfields(const st
 }
 
 
+Subfields SubfieldsView::toSubfields() const {
+    Subfields subfields;
+    for (const auto subfield : *this)
+        subfields.appendSubfield(subfield.code_, std::string(subfield.value_));
+    return subfields;
+}
+
+
 bool Record::Field::operator<(const Record::Field &rhs) const {
     if (tag_ < rhs.tag_)
         return true;
@@ -258,64 +268,33 @@ bool Record::Field::filterSubfields(const std::string &codes_to_keep) {
 
 
 std::string Record::Field::getFirstSubfieldWithCode(const char subfield_code) const {
-    if (unlikely(contents_.length() < 5)) // We need more than: 2 indicators + delimiter + subfield code
-        return "";
-
-    const char delimiter_and_code[]{ '\x1F', subfield_code, '\0' };
-    const size_t subfield_start_pos(contents_.find(delimiter_and_code, 2 /*skip indicators*/, 2));
-    if (subfield_start_pos == std::string::npos)
-        return "";
-
-    std::string subfield_value;
-    for (auto ch(contents_.cbegin() + subfield_start_pos + 2); ch != contents_.cend(); ++ch) {
-        if (*ch == '\x1F')
-            break;
-        subfield_value += *ch;
-    }
-
-    return subfield_value;
+    return std::string(getSubfieldsView().getFirstSubfieldWithCode(subfield_code));
 }
 
 
 std::string Record::Field::getFirstSubfieldWithCodeAndPrefix(const char subfield_code, const std::string &prefix) const {
-    const auto subfields(getSubfields());
-    for (const auto &subfield : subfields) {
-        if (subfield.code_ == subfield_code) {
-            if (StringUtil::StartsWith(subfield.value_, prefix))
-                return subfield.value_;
-        }
+    for (const auto subfield : getSubfieldsView()) {
+        if (subfield.code_ == subfield_code and subfield.value_.starts_with(prefix))
+            return std::string(subfield.value_);
     }
     return "";
 }
 
 
 bool Record::Field::hasSubfield(const char subfield_code) const {
-    bool subfield_delimiter_seen(false);
-    for (const char ch : contents_) {
-        if (subfield_delimiter_seen) {
-            if (ch == subfield_code)
-                return true;
-            subfield_delimiter_seen = false;
-        } else if (ch == '\x1F')
-            subfield_delimiter_seen = true;
-    }
-
-    return false;
+    return getSubfieldsView().hasSubfield(subfield_code);
 }
 
 
 bool Record::Field::hasSubfieldWithValue(const char subfield_code, const std::string &value, const bool case_insensitive) const {
-    bool subfield_delimiter_seen(false);
-    for (auto ch(contents_.cbegin()); ch != contents_.cend(); ++ch) {
-        if (subfield_delimiter_seen) {
-            if (*ch == subfield_code
-                and (case_insensitive ? StringUtil::ASCIIToUpper(contents_.substr(ch - contents_.cbegin() + 1, value.length()))
-                                            == StringUtil::ASCIIToUpper(value)
-                                      : contents_.substr(ch - contents_.cbegin() + 1, value.length()) == value))
-                return true;
-            subfield_delimiter_seen = false;
-        } else if (*ch == '\x1F')
-            subfield_delimiter_seen = true;
+    for (const auto subfield : getSubfieldsView()) {
+        if (subfield.code_ != subfield_code)
+            continue;
+
+        const std::string_view value_prefix(subfield.value_.substr(0, value.length()));
+        if (case_insensitive ? StringUtil::ASCIIToUpper(std::string(value_prefix)) == StringUtil::ASCIIToUpper(value)
+                             : value_prefix == value)
+            return true;
     }
 
     return false;
@@ -354,10 +333,47 @@ bool Record::Field::removeSubfieldWithPattern(const char subfield_code, const Th
 
 
 void Record::Field::insertOrReplaceSubfield(const char subfield_code, const std::string &subfield_contents) {
-    Subfields subfields(contents_);
-    if (not subfields.replaceFirstSubfield(subfield_code, subfield_contents))
-        subfields.addSubfield(subfield_code, subfield_contents);
-    contents_ = contents_.substr(0, 2) /* keep our original indicators */ + subfields.toString();
+    if (replaceFirstSubfieldValue(subfield_code, subfield_contents) or subfield_contents.empty())
+        return;
+
+    // Insert the new subfield after all leading subfields w/ codes that preceed "subfield_code", like Subfields::addSubfield():
+    size_t insertion_pos(contents_.size());
+    for (const auto subfield : getSubfieldsView()) {
+        if (not(subfield.code_ < subfield_code)) {
+            insertion_pos = subfield.value_.data() - 2 /* delimiter and subfield code */ - contents_.data();
+            break;
+        }
+    }
+    contents_.insert(insertion_pos, std::string(1, '\x1F') + std::string(1, subfield_code) + subfield_contents);
+}
+
+
+bool Record::Field::replaceFirstSubfieldValue(const char subfield_code, const std::string_view new_subfield_value) {
+    for (const auto subfield : getSubfieldsView()) {
+        if (subfield.code_ == subfield_code) {
+            if (new_subfield_value.empty()) // Like Subfields::toString(), we never leave empty subfields behind.
+                contents_.erase(subfield.value_.data() - 2 /* delimiter and subfield code */ - contents_.data(),
+                                subfield.value_.size() + 2);
+            else
+                contents_.replace(subfield.value_.data() - contents_.data(), subfield.value_.size(), new_subfield_value);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool Record::Field::deleteFirstSubfieldWithCode(const char subfield_code) {
+    for (const auto subfield : getSubfieldsView()) {
+        if (subfield.code_ == subfield_code) {
+            const size_t subfield_start(subfield.value_.data() - 2 /* delimiter and subfield code */ - contents_.data());
+            contents_.erase(subfield_start, 2 + subfield.value_.size());
+            return true;
+        }
+    }
+
+    return false;
 }
 
 
@@ -477,6 +493,8 @@ static std::string TypeOfRecordToString(const Record::TypeOfRecord type_of_recor
         return std::string(1, 'r');
     case Record::TypeOfRecord::MANUSCRIPT_LANGUAGE_MATERIAL:
         return std::string(1, 't');
+    case Record::TypeOfRecord::AUTHORITY:
+        return std::string(1, 'z');
     default:
         LOG_ERROR("unknown type-of-record: " + std::to_string(static_cast<int>(type_of_record)) + "!");
     }
@@ -627,6 +645,66 @@ void Record::toXmlStringHelper(MarcXmlWriter * const xml_writer) const {
 }
 
 
+namespace {
+
+
+const std::string XML_DECLARATION("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+
+
+// Escapes the way XmlWriter escapes attribute values.
+inline void AppendXmlAttribValue(const std::string_view value, std::string * const xml) {
+    for (const char ch : value) {
+        if (ch == '"')
+            xml->append("&quot;");
+        else if (ch == '&')
+            xml->append("&amp;");
+        else
+            *xml += ch;
+    }
+}
+
+
+} // unnamed namespace
+
+
+void Record::appendXml(std::string * const xml) const {
+    xml->append("<record>\n<leader>");
+    ::XmlWriter::AppendXmlEscaped(leader_, xml);
+    xml->append("</leader>\n");
+
+    for (const auto &field : *this) {
+        if (field.isControlField()) {
+            xml->append("<controlfield tag=\"");
+            AppendXmlAttribValue(std::string_view(field.getTag().c_str(), TAG_LENGTH), xml);
+            xml->append("\">");
+            ::XmlWriter::AppendXmlEscaped(field.getContents(), xml);
+            xml->append("</controlfield>\n");
+        } else { // We have a data field.
+            xml->append("<datafield tag=\"");
+            AppendXmlAttribValue(std::string_view(field.getTag().c_str(), TAG_LENGTH), xml);
+            xml->append("\" ind1=\"");
+            const char indicator1(field.getIndicator1()), indicator2(field.getIndicator2());
+            AppendXmlAttribValue(std::string_view(&indicator1, 1), xml);
+            xml->append("\" ind2=\"");
+            AppendXmlAttribValue(std::string_view(&indicator2, 1), xml);
+            xml->append("\">\n");
+
+            for (const auto subfield : field.getSubfieldsView()) {
+                xml->append("<subfield code=\"");
+                AppendXmlAttribValue(std::string_view(&subfield.code_, 1), xml);
+                xml->append("\">");
+                ::XmlWriter::AppendXmlEscaped(subfield.value_, xml);
+                xml->append("</subfield>\n");
+            }
+
+            xml->append("</datafield>\n");
+        }
+    }
+
+    xml->append("</record>\n");
+}
+
+
 size_t Record::truncate(const const_iterator field_iter) {
     const auto old_field_count(fields_.size());
     fields_.erase(field_iter, fields_.cend());
@@ -638,7 +716,11 @@ std::string Record::toString(const RecordFormat record_format, const unsigned in
                              const MarcXmlWriter::TextConversionType text_conversion_type) const {
     if (record_format == RecordFormat::MARC21_BINARY)
         return toBinaryString();
-    else {
+    else if (indent_amount == 0 and text_conversion_type == MarcXmlWriter::NoConversion) {
+        std::string as_string(XML_DECLARATION);
+        appendXml(&as_string);
+        return as_string;
+    } else {
         std::string as_string;
         MarcXmlWriter xml_writer(&as_string, /* suppress_header_and_tailer = */ true, indent_amount, text_conversion_type);
         toXmlStringHelper(&xml_writer);
@@ -1896,7 +1978,7 @@ const ThreadSafeRegexMatcher MARC21_MAGIC_MATCHER("(^[0-9]{5})([acdnp][^bhlnqsu-
 
 
 static MediaType GetMediaType(const std::string &filename) {
-    File input(filename, "r");
+    File input(filename, CompressedFile::GuessCodec(filename) == CompressedFile::Codec::NONE ? "r" : "ru");
     if (input.anErrorOccurred())
         return MediaType::OTHER;
 
@@ -1905,7 +1987,7 @@ static MediaType GetMediaType(const std::string &filename) {
     if (read_count != sizeof(magic) - 1) {
         if (read_count == 0) {
             LOG_WARNING("empty file \"" + filename + "\"!");
-            const std::string extension(FileUtil::GetExtension(filename));
+            const std::string extension(FileUtil::GetExtension(CompressedFile::StripCodecSuffix(filename)));
             if (::strcasecmp(extension.c_str(), "mrc") == 0 or ::strcasecmp(extension.c_str(), "marc") == 0
                 or ::strcasecmp(extension.c_str(), "raw") == 0)
             {
@@ -1952,32 +2034,46 @@ FileType GuessFileType(const std::string &filename, const GuessFileTypeBehaviour
         }
     }
 
-    if (StringUtil::EndsWith(filename, ".mrc", /* ignore_case = */ true)
-        or StringUtil::EndsWith(filename, ".marc", /* ignore_case = */ true)
-        or StringUtil::EndsWith(filename, ".raw", /* ignore_case = */ true))
+    const std::string uncompressed_filename(CompressedFile::StripCodecSuffix(filename));
+    if (StringUtil::EndsWith(uncompressed_filename, ".mrc", /* ignore_case = */ true)
+        or StringUtil::EndsWith(uncompressed_filename, ".marc", /* ignore_case = */ true)
+        or StringUtil::EndsWith(uncompressed_filename, ".raw", /* ignore_case = */ true))
         return FileType::BINARY;
-    if (StringUtil::EndsWith(filename, ".xml", /* ignore_case = */ true))
+    if (StringUtil::EndsWith(uncompressed_filename, ".xml", /* ignore_case = */ true))
         return FileType::XML;
 
     LOG_ERROR("can't guess the file type of \"" + filename + "\"!");
 }
 
 
-std::unique_ptr<Reader> Reader::Factory(const std::string &input_filename, FileType reader_type) {
+std::unique_ptr<Reader> Reader::Factory(const std::string &input_filename, FileType reader_type, const bool validate_utf8) {
     if (reader_type == FileType::AUTO)
         reader_type = GuessFileType(input_filename);
 
-    std::unique_ptr<File> input(FileUtil::OpenInputFileOrDie(input_filename));
+    std::unique_ptr<File> input;
+    if (CompressedFile::GuessCodec(input_filename) == CompressedFile::Codec::NONE)
+        input = FileUtil::OpenInputFileOrDie(input_filename);
+    else {
+        input.reset(new File(input_filename, "ru"));
+        if (input->fail())
+            LOG_ERROR("can't open \"" + input_filename + "\" for reading!");
+    }
     return (reader_type == FileType::XML) ? std::unique_ptr<Reader>(new XmlReader(input.release()))
-                                          : std::unique_ptr<Reader>(new BinaryReader(input.release()));
+                                          : std::unique_ptr<Reader>(new BinaryReader(input.release(), validate_utf8));
+}
+
+
+std::unique_ptr<Reader> Reader::Factory(Archive::Reader * const archive_reader, const std::string &member_path, const bool validate_utf8) {
+    return std::unique_ptr<Reader>(new ArchiveMemberReader(archive_reader, member_path, validate_utf8));
 }
 
 
-BinaryReader::BinaryReader(File * const input): Reader(input), next_record_start_(0) {
+BinaryReader::BinaryReader(File * const input, const bool validate_utf8)
+    : Reader(input), next_record_start_(0), validate_utf8_(validate_utf8) {
     struct stat stat_buf;
-    if (::fstat(input->getFileDescriptor(), &stat_buf) != 0)
+    if (not input->isCompressed() and ::fstat(input->getFileDescriptor(), &stat_buf) != 0)
         LOG_ERROR("fstat(2) on \"" + input->getPath() + "\" failed!");
-    if (S_ISFIFO(stat_buf.st_mode))
+    if (input->isCompressed() or S_ISFIFO(stat_buf.st_mode))
         mmap_ = nullptr;
     else {
         offset_ = 0;
@@ -2038,6 +2134,8 @@ Record BinaryReader::actualRead() {
         if (unlikely(bytes_read != record_length - Record::RECORD_LENGTH_FIELD_LENGTH))
             LOG_ERROR("failed to read a record from \"" + input_->getPath() + "\"!");
 
+        if (validate_utf8_)
+            validateUTF8(buf, record_length, input_->tell() - record_length);
         return Record(record_length, buf);
     } else { // Use memory-mapped I/O.
         if (unlikely(offset_ == input_file_size_))
@@ -2052,6 +2150,8 @@ Record BinaryReader::actualRead() {
         if (unlikely(offset_ + record_length > input_file_size_))
             LOG_ERROR("not enough remaining room in \"" + input_->getPath()
                       + "\" for the rest of the record in the memory mapping, file may be truncated!");
+        if (validate_utf8_)
+            validateUTF8(mmap_ + offset_, record_length, offset_);
         offset_ += record_length;
 
         return Record(record_length, mmap_ + offset_ - record_length);
@@ -2059,12 +2159,18 @@ Record BinaryReader::actualRead() {
 }
 
 
+void BinaryReader::validateUTF8(const char * const record_start, const unsigned record_length, const off_t record_offset) const {
+    if (unlikely(not TextUtil::IsValidUTF8(record_start, record_length)))
+        LOG_ERROR("record at offset " + std::to_string(record_offset) + " in \"" + input_->getPath() + "\" is not valid UTF-8!");
+}
+
+
 void BinaryReader::rewind() {
     if (mmap_ == nullptr) {
         struct stat stat_buf;
-        if (::fstat(input_->getFileDescriptor(), &stat_buf) != 0)
+        if (not input_->isCompressed() and ::fstat(input_->getFileDescriptor(), &stat_buf) != 0)
             LOG_ERROR("fstat(2) on \"" + input_->getPath() + "\" failed!");
-        if (S_ISFIFO(stat_buf.st_mode))
+        if (not input_->isCompressed() and S_ISFIFO(stat_buf.st_mode))
             LOG_ERROR("can't rewind a FIFO (" + input_->getPath() + ")!");
         input_->rewind();
     } else
@@ -2111,6 +2217,87 @@ bool BinaryReader::seek(const off_t offset, const int whence) {
 }
 
 
+ArchiveMemberReader::ArchiveMemberReader(Archive::Reader * const archive_reader, const std::string &member_path, const bool validate_utf8)
+    : Reader(nullptr), archive_reader_(archive_reader), member_path_(member_path), buffer_offset_(0), buffer_start_(0),
+      next_record_start_(0), end_of_entry_(false), validate_utf8_(validate_utf8) {
+    last_record_ = actualRead();
+}
+
+
+Record ArchiveMemberReader::read() {
+    if (unlikely(not last_record_))
+        return last_record_;
+
+    Record new_record;
+    do {
+        next_record_start_ = buffer_start_ + buffer_offset_;
+        new_record = actualRead();
+        if (unlikely(new_record.getControlNumber() == last_record_.getControlNumber()))
+            last_record_.merge(new_record);
+    } while (new_record.getControlNumber() == last_record_.getControlNumber());
+
+    new_record.swap(last_record_);
+
+    // This should not be necessary unless we got bad data!
+    new_record.sortFieldTags(new_record.begin(), new_record.end());
+
+    return new_record;
+}
+
+
+void ArchiveMemberReader::rewind() {
+    LOG_ERROR("can't rewind \"" + member_path_ + "\"!");
+}
+
+
+Record ArchiveMemberReader::actualRead() {
+    if (unlikely(not fillBuffer(Record::RECORD_LENGTH_FIELD_LENGTH))) {
+        if (unlikely(buffer_offset_ != buffer_.size()))
+            LOG_ERROR("not enough remaining data in \"" + member_path_ + "\" for a record length, member may be truncated!");
+        return Record();
+    }
+
+    const unsigned record_length(ToUnsigned(buffer_.data() + buffer_offset_, Record::RECORD_LENGTH_FIELD_LENGTH));
+    if (unlikely(record_length <= Record::RECORD_LENGTH_FIELD_LENGTH))
+        LOG_ERROR("bad record length " + std::to_string(record_length) + " at offset " + std::to_string(buffer_start_ + buffer_offset_)
+                  + " in \"" + member_path_ + "\"!");
+    if (unlikely(not fillBuffer(record_length)))
+        LOG_ERROR("not enough remaining data in \"" + member_path_ + "\" for the rest of the record, member may be truncated!");
+
+    const char * const record_start(buffer_.data() + buffer_offset_);
+    if (validate_utf8_ and unlikely(not TextUtil::IsValidUTF8(record_start, record_length)))
+        LOG_ERROR("record at offset " + std::to_string(buffer_start_ + buffer_offset_) + " in \"" + member_path_
+                  + "\" is not valid UTF-8!");
+    buffer_offset_ += record_length;
+
+    return Record(record_length, record_start);
+}
+
+
+bool ArchiveMemberReader::fillBuffer(const size_t min_size) {
+    if (buffer_.size() - buffer_offset_ >= min_size)
+        return true;
+
+    // Discard the data that we already consumed:
+    buffer_.erase(0, buffer_offset_);
+    buffer_start_ += buffer_offset_;
+    buffer_offset_ = 0;
+
+    static constexpr size_t READ_CHUNK_SIZE(Record::MAX_RECORD_LENGTH);
+    while (buffer_.size() < min_size and not end_of_entry_) {
+        const size_t old_size(buffer_.size());
+        buffer_.resize(old_size + READ_CHUNK_SIZE);
+        const ssize_t no_of_bytes(archive_reader_->read(buffer_.data() + old_size, READ_CHUNK_SIZE));
+        if (unlikely(no_of_bytes < 0))
+            LOG_ERROR("failed to read from \"" + member_path_ + "\"! (" + archive_reader_->getLastErrorMessage() + ")");
+        buffer_.resize(old_size + no_of_bytes);
+        if (no_of_bytes == 0)
+            end_of_entry_ = true;
+    }
+
+    return buffer_.size() >= min_size;
+}
+
 Record XmlReader::read() {
     Record new_record;
 
@@ -2191,7 +2378,7 @@ Record XmlReader::read() {
 void XmlReader::rewind() {
     // We can't handle FIFO's here:
     struct stat stat_buf;
-    if (unlikely(fstat(input_->getFileDescriptor(), &stat_buf) and S_ISFIFO(stat_buf.st_mode)))
+    if (unlikely(not input_->isCompressed() and fstat(input_->getFileDescriptor(), &stat_buf) and S_ISFIFO(stat_buf.st_mode)))
         LOG_ERROR("can't rewind a FIFO!");
 
     input_->rewind();
@@ -2477,8 +2664,17 @@ std::unique_ptr<Writer> Writer::Factory(const std::string &output_filename, File
             writer_type = GuessFileType(output_filename, GuessFileTypeBehaviour::USE_THE_FILENAME_ONLY);
     }
 
-    std::unique_ptr<File> output(writer_mode == WriterMode::OVERWRITE ? FileUtil::OpenOutputFileOrDie(output_filename)
-                                                                      : FileUtil::OpenForAppendingOrDie(output_filename));
+    std::unique_ptr<File> output;
+    if (CompressedFile::GuessCodec(output_filename) == CompressedFile::Codec::NONE)
+        output = writer_mode == WriterMode::OVERWRITE ? FileUtil::OpenOutputFileOrDie(output_filename)
+                                                      : FileUtil::OpenForAppendingOrDie(output_filename);
+    else {
+        if (writer_mode == WriterMode::APPEND)
+            LOG_ERROR("can't append to compressed file \"" + output_filename + "\"!");
+        output.reset(new File(output_filename, "wc"));
+        if (output->fail())
+            LOG_ERROR("can't open \"" + output_filename + "\" for writing!");
+    }
 
     return (writer_type == FileType::XML) ? std::unique_ptr<Writer>(new XmlWriter(output.release()))
                                           : std::unique_ptr<Writer>(new BinaryWriter(output.release()));
@@ -2493,9 +2689,22 @@ void BinaryWriter::write(const Record &record) {
 }
 
 
+// Once the buffer has grown beyond this, we write it out.
+constexpr size_t XML_WRITER_BUFFER_SIZE(CompressedFile::FRAME_SIZE);
+
+
+XmlWriter::XmlWriter(File * const output): Writer(output) {
+    buffer_.reserve(XML_WRITER_BUFFER_SIZE + 128 * 1024);
+    buffer_ = XML_DECLARATION;
+    buffer_ += "<collection xmlns=\"http://www.loc.gov/MARC21/slim\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\""
+               " xsi:schemaLocation=\"http://www.loc.gov/standards/marcxml/schema/MARC21slim.xsd\">\n";
+}
+
+
 XmlWriter::~XmlWriter() {
-    // the MarcXmlWriter owns the File pointer as well, so we cede ownership to it entirely
-    output_.release();
+    buffer_ += "</collection>\n";
+    if (unlikely(not writeBuffer()))
+        LOG_ERROR("failed to write to \"" + output_->getPath() + "\"!");
 }
 
 
@@ -2503,7 +2712,23 @@ void XmlWriter::write(const Record &record) {
     std::string error_message;
     if (not record.isValid(&error_message))
         LOG_ERROR("trying to write an invalid record: " + error_message + " (Control number: " + record.getControlNumber() + ")");
-    record.toXmlStringHelper(&xml_writer_);
+    record.appendXml(&buffer_);
+    if (buffer_.size() >= XML_WRITER_BUFFER_SIZE and unlikely(not writeBuffer()))
+        LOG_ERROR("failed to write to \"" + output_->getPath() + "\"!");
+}
+
+
+bool XmlWriter::flush() {
+    return writeBuffer() and output_->flush();
+}
+
+
+bool XmlWriter::writeBuffer() {
+    if (buffer_.empty())
+        return true;
+    const bool success(output_->write(buffer_.data(), buffer_.size()) == buffer_.size());
+    buffer_.clear();
+    return success;
 }
 
 
@@ -2642,7 +2867,48 @@ static inline bool CompareField(const Record::Field * const field1, const Record
 }
 
 
-std::string CalcChecksum(const Record &record, const std::set<Tag> &excluded_fields, const bool suppress_local_fields) {
+// The tag is used as the seed, so that we don't have to concatenate it w/ the contents.
+static inline void CalcFastFieldHash(const Record::Field &field, uint64_t * const hash) {
+    StringUtil::MurmurHash3_128(field.getContents().data(), field.getContents().size(), field.getTag().to_int(), hash);
+}
+
+
+std::string Record::Field::getHash(const ChecksumType checksum_type) const {
+    if (checksum_type == ChecksumType::SHA1)
+        return StringUtil::Sha1(toString());
+
+    uint64_t hash[2];
+    CalcFastFieldHash(*this, hash);
+    return std::string(reinterpret_cast<const char *>(hash), sizeof hash);
+}
+
+
+std::string CalcChecksum(const Record &record, const std::set<Tag> &excluded_fields, const bool suppress_local_fields,
+                         const ChecksumType checksum_type) {
+    if (checksum_type == ChecksumType::FAST) {
+        // Addition is commutative, so the order of the fields doesn't matter, but unlike w/ XOR, identical fields don't cancel
+        // each other out.
+        uint64_t field_hash_sum[2] = { 0, 0 };
+        for (const auto &field : record.fields_) {
+            if (excluded_fields.find(field.getTag()) != excluded_fields.cend() or (suppress_local_fields and field.getTag().isLocal()))
+                continue;
+
+            uint64_t field_hash[2];
+            CalcFastFieldHash(field, field_hash);
+            field_hash_sum[0] += field_hash[0];
+            field_hash_sum[1] += field_hash[1] + (field_hash_sum[0] < field_hash[0] ? 1 : 0);
+        }
+
+        // Only include leader data that are parameterised, see below:
+        char final_data[sizeof field_hash_sum + (12 - 5) + (20 - 17)];
+        std::memcpy(final_data, field_hash_sum, sizeof field_hash_sum);
+        std::memcpy(final_data + sizeof field_hash_sum, record.leader_.data() + 5, 12 - 5);
+        std::memcpy(final_data + sizeof field_hash_sum + (12 - 5), record.leader_.data() + 17, 20 - 17);
+        uint64_t hash[2];
+        StringUtil::MurmurHash3_128(final_data, sizeof final_data, 0, hash);
+        return std::string(reinterpret_cast<const char *>(hash), sizeof hash);
+    }
+
     std::vector<const Record::Field *> field_refs;
     field_refs.reserve(record.fields_.size());
 
@@ -2893,6 +3159,15 @@ FileType GetOptionalReaderType(int * const argc, char *** const argv, const int
 }
 
 
+bool GetOptionalValidateUTF8Flag(int * const argc, char *** const argv, const int arg_no) {
+    if (*argc <= arg_no or std::strcmp((*argv)[arg_no], "--validate-utf8") != 0)
+        return false;
+
+    --*argc, ++*argv;
+    return true;
+}
+
+
 FileType GetOptionalWriterType(int * const argc, char *** const argv, const int arg_no, const FileType default_file_type) {
     FileType return_value(default_file_type);
 
@@ -0,0 +1,400 @@
+/** \file    MarcTagIndex.cc
+ *  \brief   Implementation of the MarcTagIndex class.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MarcTagIndex.h"
+#include <algorithm>
+#include <map>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Compiler.h"
+#include "FileUtil.h"
+#include "util.h"
+
+
+// The index file consists of a header, the offsets of all records, the tag entries, sorted by tag, the container entries and
+// finally the container data.  A container holds the ordinals of the records of one chunk of 2^16 ordinals that contain a
+// specific tag.  The containers of a tag are sorted by their chunk keys.  Container data is padded to a multiple of 8 bytes.
+struct MarcTagIndex::Header {
+    char magic_[8];
+    uint64_t record_count_;
+    uint64_t tag_count_;
+    uint64_t container_count_;
+    uint64_t container_data_size_;
+    uint64_t marc_file_size_;
+    int64_t marc_file_mtime_;
+};
+
+
+struct MarcTagIndex::TagEntry {
+    char tag_[4];
+    uint32_t first_container_;
+    uint32_t container_count_;
+    uint32_t record_count_;
+};
+
+
+struct MarcTagIndex::ContainerEntry {
+    uint16_t key_;
+    uint16_t type_;
+    uint32_t cardinality_;
+    uint64_t data_offset_;
+};
+
+
+namespace {
+
+
+constexpr char INDEX_MAGIC[8] = { 'U', 'B', 'M', 'T', 'I', 'D', 'X', '1' };
+enum ContainerType : uint16_t { ARRAY_CONTAINER, BITMAP_CONTAINER };
+constexpr size_t CHUNK_SIZE(1u << 16);
+constexpr size_t BITMAP_WORD_COUNT(CHUNK_SIZE / 64);
+
+// Above this cardinality a bitmap needs less space than an array of 16-bit values.
+constexpr size_t MAX_ARRAY_CONTAINER_CARDINALITY(4096);
+
+
+inline size_t PaddedSize(const size_t size) {
+    return (size + 7u) & ~size_t(7u);
+}
+
+
+// Collects the ordinals of the records that contain a specific tag.  Ordinals have to be added in ascending order.
+class TagBitmapBuilder {
+public:
+    struct Container {
+        uint16_t key_;
+        std::vector<uint16_t> values_;
+        std::vector<uint64_t> bitmap_;
+        uint32_t cardinality_;
+
+    public:
+        explicit Container(const uint16_t key): key_(key), cardinality_(0) { }
+        inline bool isBitmap() const { return not bitmap_.empty(); }
+        inline const void *getData() const {
+            return isBitmap() ? static_cast<const void *>(bitmap_.data()) : static_cast<const void *>(values_.data());
+        }
+        inline size_t getDataSize() const {
+            return isBitmap() ? BITMAP_WORD_COUNT * sizeof(uint64_t) : values_.size() * sizeof(uint16_t);
+        }
+    };
+
+private:
+    std::vector<Container> containers_;
+    uint32_t record_count_;
+
+public:
+    TagBitmapBuilder(): record_count_(0) { }
+    void add(const uint32_t record_ordinal);
+    inline uint32_t getRecordCount() const { return record_count_; }
+    inline const std::vector<Container> &getContainers() const { return containers_; }
+};
+
+
+void TagBitmapBuilder::add(const uint32_t record_ordinal) {
+    const uint16_t key(record_ordinal >> 16), value(record_ordinal & 0xFFFFu);
+    if (containers_.empty() or containers_.back().key_ != key)
+        containers_.emplace_back(key);
+
+    auto &container(containers_.back());
+    if (container.isBitmap())
+        container.bitmap_[value / 64] |= uint64_t(1) << (value % 64);
+    else if (container.values_.size() < MAX_ARRAY_CONTAINER_CARDINALITY)
+        container.values_.emplace_back(value);
+    else { // Convert to a bitmap.
+        container.bitmap_.resize(BITMAP_WORD_COUNT);
+        for (const auto old_value : container.values_)
+            container.bitmap_[old_value / 64] |= uint64_t(1) << (old_value % 64);
+        container.bitmap_[value / 64] |= uint64_t(1) << (value % 64);
+        std::vector<uint16_t>().swap(container.values_);
+    }
+    ++container.cardinality_;
+    ++record_count_;
+}
+
+
+template <typename T>
+void WriteOrDie(File * const output, const T &value) {
+    if (unlikely(output->write(&value, sizeof value) != sizeof value))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+void WriteOrDie(File * const output, const void * const data, const size_t size) {
+    if (unlikely(output->write(data, size) != size))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+} // unnamed namespace
+
+
+MarcTagIndex::MarcTagIndex(const std::string &index_path): index_path_(index_path) {
+    const int fd(::open(index_path.c_str(), O_RDONLY));
+    if (fd == -1)
+        LOG_ERROR("failed to open(2) \"" + index_path + "\"!");
+
+    struct stat stat_buf;
+    if (unlikely(::fstat(fd, &stat_buf) != 0))
+        LOG_ERROR("failed to fstat(2) \"" + index_path + "\"!");
+    map_size_ = stat_buf.st_size;
+    if (unlikely(map_size_ < sizeof(Header)))
+        LOG_ERROR("\"" + index_path + "\" is too small to be a MARC tag index!");
+
+    map_start_ = static_cast<const char *>(::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+    if (map_start_ == MAP_FAILED or map_start_ == nullptr)
+        LOG_ERROR("failed to mmap(2) \"" + index_path + "\"!");
+    ::close(fd);
+
+    header_ = reinterpret_cast<const Header *>(map_start_);
+    if (unlikely(std::memcmp(header_->magic_, INDEX_MAGIC, sizeof INDEX_MAGIC) != 0))
+        LOG_ERROR("\"" + index_path + "\" is not a MARC tag index!");
+    if (unlikely(map_size_
+                 != sizeof(Header) + header_->record_count_ * sizeof(uint64_t) + header_->tag_count_ * sizeof(TagEntry)
+                        + header_->container_count_ * sizeof(ContainerEntry) + header_->container_data_size_))
+        LOG_ERROR("\"" + index_path + "\" is truncated or corrupt!");
+
+    record_offsets_ = reinterpret_cast<const uint64_t *>(map_start_ + sizeof(Header));
+    tags_ = reinterpret_cast<const TagEntry *>(record_offsets_ + header_->record_count_);
+    containers_ = reinterpret_cast<const ContainerEntry *>(tags_ + header_->tag_count_);
+    container_data_ = reinterpret_cast<const char *>(containers_ + header_->container_count_);
+}
+
+
+MarcTagIndex::~MarcTagIndex() {
+    if (unlikely(::munmap(const_cast<char *>(map_start_), map_size_) != 0))
+        LOG_ERROR("munmap(2) on \"" + index_path_ + "\" failed!");
+}
+
+
+size_t MarcTagIndex::getRecordCount() const {
+    return header_->record_count_;
+}
+
+
+size_t MarcTagIndex::getRecordCount(const MARC::Tag &tag) const {
+    const TagEntry * const tag_entry(findTag(tag));
+    return (tag_entry == nullptr) ? 0 : tag_entry->record_count_;
+}
+
+
+std::vector<MARC::Tag> MarcTagIndex::getTags() const {
+    std::vector<MARC::Tag> tags;
+    tags.reserve(header_->tag_count_);
+    for (auto tag_entry(tags_); tag_entry != tags_ + header_->tag_count_; ++tag_entry)
+        tags.emplace_back(std::string(tag_entry->tag_, MARC::Record::TAG_LENGTH));
+    return tags;
+}
+
+
+bool MarcTagIndex::isUpToDate(const std::string &marc_path) const {
+    struct stat stat_buf;
+    if (::stat(marc_path.c_str(), &stat_buf) != 0)
+        return false;
+    return static_cast<uint64_t>(stat_buf.st_size) == header_->marc_file_size_ and stat_buf.st_mtime == header_->marc_file_mtime_;
+}
+
+
+const MarcTagIndex::TagEntry *MarcTagIndex::findTag(const MARC::Tag &tag) const {
+    const auto tags_end(tags_ + header_->tag_count_);
+    const auto tag_entry(std::lower_bound(tags_, tags_end, tag, [](const TagEntry &lhs, const MARC::Tag &rhs) {
+        return std::memcmp(lhs.tag_, rhs.c_str(), MARC::Record::TAG_LENGTH) < 0;
+    }));
+    if (tag_entry == tags_end or std::memcmp(tag_entry->tag_, tag.c_str(), MARC::Record::TAG_LENGTH) != 0)
+        return nullptr;
+    return tag_entry;
+}
+
+
+void MarcTagIndex::getRecordsWithAnyTag(const std::set<MARC::Tag> &tags, std::vector<uint32_t> * const record_ordinals) const {
+    record_ordinals->clear();
+
+    // We "or" all containers into a single bitmap over all records and then extract the set bits:
+    std::vector<uint64_t> bitmap((header_->record_count_ + 63) / 64);
+    for (const auto &tag : tags) {
+        const TagEntry * const tag_entry(findTag(tag));
+        if (tag_entry == nullptr)
+            continue;
+
+        for (auto container(containers_ + tag_entry->first_container_);
+             container != containers_ + tag_entry->first_container_ + tag_entry->container_count_; ++container)
+        {
+            const size_t chunk_start(size_t(container->key_) * CHUNK_SIZE);
+            const char * const data(container_data_ + container->data_offset_);
+            if (container->type_ == BITMAP_CONTAINER) {
+                const uint64_t * const words(reinterpret_cast<const uint64_t *>(data));
+                const size_t word_count(std::min(BITMAP_WORD_COUNT, bitmap.size() - chunk_start / 64));
+                for (size_t word_no(0); word_no < word_count; ++word_no)
+                    bitmap[chunk_start / 64 + word_no] |= words[word_no];
+            } else {
+                const uint16_t * const values(reinterpret_cast<const uint16_t *>(data));
+                for (uint32_t i(0); i < container->cardinality_; ++i) {
+                    const size_t record_ordinal(chunk_start + values[i]);
+                    bitmap[record_ordinal / 64] |= uint64_t(1) << (record_ordinal % 64);
+                }
+            }
+        }
+    }
+
+    for (size_t word_no(0); word_no < bitmap.size(); ++word_no) {
+        for (uint64_t word(bitmap[word_no]); word != 0; word &= word - 1)
+            record_ordinals->emplace_back(word_no * 64 + __builtin_ctzll(word));
+    }
+}
+
+
+void MarcTagIndex::Create(MARC::Reader * const marc_reader, const std::string &index_path) {
+    std::vector<uint64_t> record_offsets;
+    std::map<MARC::Tag, TagBitmapBuilder> tags_and_bitmap_builders;
+    for (;;) {
+        const off_t record_offset(marc_reader->tell());
+        const MARC::Record record(marc_reader->read());
+        if (not record)
+            break;
+        if (unlikely(record_offsets.size() == UINT32_MAX))
+            LOG_ERROR("\"" + marc_reader->getPath() + "\" contains too many records!");
+
+        const uint32_t record_ordinal(record_offsets.size());
+        record_offsets.emplace_back(record_offset);
+
+        // The fields are sorted by tag, so we only have to skip over repeated tags:
+        MARC::Tag last_tag;
+        for (const auto &field : record) {
+            if (field.getTag() != last_tag) {
+                last_tag = field.getTag();
+                tags_and_bitmap_builders[last_tag].add(record_ordinal);
+            }
+        }
+    }
+
+    Header header;
+    std::memcpy(header.magic_, INDEX_MAGIC, sizeof INDEX_MAGIC);
+    header.record_count_ = record_offsets.size();
+    header.tag_count_ = tags_and_bitmap_builders.size();
+    header.container_count_ = 0;
+    header.container_data_size_ = 0;
+    for (const auto &[tag, bitmap_builder] : tags_and_bitmap_builders) {
+        header.container_count_ += bitmap_builder.getContainers().size();
+        for (const auto &container : bitmap_builder.getContainers())
+            header.container_data_size_ += PaddedSize(container.getDataSize());
+    }
+
+    struct stat stat_buf;
+    if (unlikely(::stat(marc_reader->getPath().c_str(), &stat_buf) != 0))
+        LOG_ERROR("failed to stat(2) \"" + marc_reader->getPath() + "\"!");
+    header.marc_file_size_ = stat_buf.st_size;
+    header.marc_file_mtime_ = stat_buf.st_mtime;
+
+    const std::string temp_index_path(index_path + ".tmp");
+    const auto index_file(FileUtil::OpenOutputFileOrDie(temp_index_path));
+    WriteOrDie(index_file.get(), header);
+    WriteOrDie(index_file.get(), record_offsets.data(), record_offsets.size() * sizeof(uint64_t));
+
+    uint32_t first_container(0);
+    for (const auto &[tag, bitmap_builder] : tags_and_bitmap_builders) {
+        TagEntry tag_entry{};
+        std::memcpy(tag_entry.tag_, tag.c_str(), MARC::Record::TAG_LENGTH);
+        tag_entry.first_container_ = first_container;
+        tag_entry.container_count_ = bitmap_builder.getContainers().size();
+        tag_entry.record_count_ = bitmap_builder.getRecordCount();
+        WriteOrDie(index_file.get(), tag_entry);
+        first_container += tag_entry.container_count_;
+    }
+
+    uint64_t data_offset(0);
+    for (const auto &[tag, bitmap_builder] : tags_and_bitmap_builders) {
+        for (const auto &container : bitmap_builder.getContainers()) {
+            const ContainerEntry container_entry{ container.key_,
+                                                  container.isBitmap() ? BITMAP_CONTAINER : ARRAY_CONTAINER,
+                                                  container.cardinality_, data_offset };
+            WriteOrDie(index_file.get(), container_entry);
+            data_offset += PaddedSize(container.getDataSize());
+        }
+    }
+
+    static const char PADDING[8] = {};
+    for (const auto &[tag, bitmap_builder] : tags_and_bitmap_builders) {
+        for (const auto &container : bitmap_builder.getContainers()) {
+            WriteOrDie(index_file.get(), container.getData(), container.getDataSize());
+            WriteOrDie(index_file.get(), PADDING, PaddedSize(container.getDataSize()) - container.getDataSize());
+        }
+    }
+    index_file->close();
+    FileUtil::RenameFileOrDie(temp_index_path, index_path, /* remove_target = */ true);
+
+    LOG_INFO("indexed " + std::to_string(header.tag_count_) + " tags of " + std::to_string(header.record_count_) + " records in \""
+             + marc_reader->getPath() + "\" w/ " + std::to_string(header.container_count_) + " containers.");
+}
+
+
+std::string MarcTagIndex::GetSidecarPath(const std::string &marc_path) {
+    return marc_path + ".tag_index";
+}
+
+
+std::unique_ptr<MarcTagIndex> MarcTagIndex::OpenSidecar(const std::string &marc_path) {
+    const std::string sidecar_path(GetSidecarPath(marc_path));
+    if (not FileUtil::Exists(sidecar_path))
+        return nullptr;
+
+    std::unique_ptr<MarcTagIndex> tag_index(new MarcTagIndex(sidecar_path));
+    if (not tag_index->isUpToDate(marc_path)) {
+        LOG_WARNING("ignoring \"" + sidecar_path + "\" because it is out of date!");
+        return nullptr;
+    }
+
+    return tag_index;
+}
+
+
+TaggedRecordReader::TaggedRecordReader(MARC::Reader * const marc_reader, const std::set<MARC::Tag> &tags)
+    : marc_reader_(marc_reader), tags_(tags), tag_index_(MarcTagIndex::OpenSidecar(marc_reader->getPath())), current_record_ordinal_(0) {
+    if (tag_index_ != nullptr)
+        tag_index_->getRecordsWithAnyTag(tags_, &record_ordinals_);
+    next_record_ordinal_ = record_ordinals_.cbegin();
+}
+
+
+MARC::Record TaggedRecordReader::read() {
+    if (tag_index_ == nullptr) {
+        while (MARC::Record record = marc_reader_->read()) {
+            for (const auto &field : record) {
+                if (tags_.find(field.getTag()) != tags_.end())
+                    return record;
+            }
+        }
+        return MARC::Record(std::string(MARC::Record::LEADER_LENGTH, ' '));
+    }
+
+    if (next_record_ordinal_ == record_ordinals_.cend())
+        return MARC::Record(std::string(MARC::Record::LEADER_LENGTH, ' '));
+
+    if (*next_record_ordinal_ != current_record_ordinal_
+        and unlikely(not marc_reader_->seek(tag_index_->getRecordOffset(*next_record_ordinal_))))
+        LOG_ERROR("failed to seek to record #" + std::to_string(*next_record_ordinal_) + " in \"" + marc_reader_->getPath() + "\"!");
+    current_record_ordinal_ = *next_record_ordinal_++ + 1;
+
+    MARC::Record record(marc_reader_->read());
+    if (unlikely(not record))
+        LOG_ERROR("unexpected EOF in \"" + marc_reader_->getPath() + "\"!");
+    return record;
+}
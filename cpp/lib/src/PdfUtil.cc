@@ -18,6 +18,14 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "PdfUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <cstdlib>
 #include <leptonica/allheaders.h>
 #include <tesseract/baseapi.h>
 #include "ExecUtil.h"
@@ -94,25 +102,107 @@ bool PdfDocContainsNoText(const std::string &document) {
 }
 
 
-bool GetTextFromImage(const std::string &img_path, const std::string &tesseract_language_code, std::string * const extracted_text) {
-    static std::string tesseract_path(ExecUtil::LocateOrDie("tesseract"));
+void LimitTesseractThreads() {
+    ::setenv("OMP_THREAD_LIMIT", "1", /* overwrite = */ 0);
+}
+
+
+namespace {
+
+
+// Initialising a tesseract instance loads the language models which takes much longer than OCRing a typical page.  We therefore
+// keep initialised instances around and hand them out to one thread at a time.
+class TesseractPool {
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<tesseract::TessBaseAPI>>> language_codes_to_idle_instances_;
+
+public:
+    // \return nullptr if we failed to initialise a new instance for "tesseract_language_code".
+    std::unique_ptr<tesseract::TessBaseAPI> acquire(const std::string &tesseract_language_code);
+
+    void release(const std::string &tesseract_language_code, std::unique_ptr<tesseract::TessBaseAPI> instance);
+};
+
+
+std::unique_ptr<tesseract::TessBaseAPI> TesseractPool::acquire(const std::string &tesseract_language_code) {
+    {
+        std::lock_guard<std::mutex> mutex_locker(mutex_);
+        auto &idle_instances(language_codes_to_idle_instances_[tesseract_language_code]);
+        if (not idle_instances.empty()) {
+            auto instance(std::move(idle_instances.back()));
+            idle_instances.pop_back();
+            return instance;
+        }
+    }
+
+    std::unique_ptr<tesseract::TessBaseAPI> new_instance(new tesseract::TessBaseAPI());
+    if (new_instance->Init(nullptr, tesseract_language_code.c_str(), tesseract::OEM_LSTM_ONLY) != 0) {
+        LOG_WARNING("failed to initialise tesseract for language \"" + tesseract_language_code + "\"!");
+        return nullptr;
+    }
+
+    return new_instance;
+}
+
+
+void TesseractPool::release(const std::string &tesseract_language_code, std::unique_ptr<tesseract::TessBaseAPI> instance) {
+    instance->Clear();
+
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+    language_codes_to_idle_instances_[tesseract_language_code].emplace_back(std::move(instance));
+}
+
+
+TesseractPool &GetTesseractPool() {
+    static TesseractPool tesseract_pool;
+    return tesseract_pool;
+}
+
+
+// Takes ownership of "image" which may be nullptr.
+bool GetTextFromPix(Pix *image, const std::string &tesseract_language_code, std::string * const extracted_text) {
     extracted_text->clear();
-    std::string stderr_output;
-    if (not ExecUtil::ExecSubcommandAndCaptureStdoutAndStderr(
-            tesseract_path,
-            { img_path, "stdout" /*tesseract arg to redirect*/, "-l", tesseract_language_code, "--oem",
-              "1" /*unlike beforehand use LSTM extract instead of legacy */ },
-            extracted_text, &stderr_output, 0 /* timeout */, SIGKILL,
-            { { "OMP_THREAD_LIMIT", "1" } }, /* address tesseract 4 IPC problems */
-            "" /* working dir */))
-        LOG_WARNING("While processing " + img_path + ": " + stderr_output);
+    if (image == nullptr)
+        return false;
+
+    TesseractPool &tesseract_pool(GetTesseractPool());
+    auto tesseract(tesseract_pool.acquire(tesseract_language_code));
+    if (tesseract != nullptr) {
+        tesseract->SetImage(image);
+        char * const utf8_text(tesseract->GetUTF8Text());
+        if (utf8_text != nullptr) {
+            extracted_text->assign(utf8_text);
+            delete[] utf8_text;
+        }
+        tesseract_pool.release(tesseract_language_code, std::move(tesseract));
+    }
+    ::pixDestroy(&image);
 
     return not extracted_text->empty();
 }
 
 
+} // unnamed namespace
+
+
+bool GetTextFromImage(const std::string &img_path, const std::string &tesseract_language_code, std::string * const extracted_text) {
+    if (not GetTextFromPix(::pixRead(img_path.c_str()), tesseract_language_code, extracted_text)) {
+        LOG_WARNING("failed to OCR \"" + img_path + "\"!");
+        return false;
+    }
+
+    return true;
+}
+
+
+bool GetTextFromImageData(const std::string &image_data, const std::string &tesseract_language_code, std::string * const extracted_text) {
+    return GetTextFromPix(::pixReadMem(reinterpret_cast<const l_uint8 *>(image_data.data()), image_data.size()), tesseract_language_code,
+                          extracted_text);
+}
+
+
 bool GetTextFromImagePDF(const std::string &pdf_document, const std::string &tesseract_language_code, std::string * const extracted_text,
-                         const unsigned timeout) {
+                         const unsigned timeout, const unsigned thread_count) {
     extracted_text->clear();
 
     static std::string pdf_images_script_path(ExecUtil::LocateOrDie("pdfimages"));
@@ -135,16 +225,34 @@ bool GetTextFromImagePDF(const std::string &pdf_document, const std::string &tes
         LOG_WARNING("PDF did not contain any images!");
         return false;
     }
-
-    for (const std::string &pdf_image_filename : pdf_image_filenames) {
-        std::string image_text;
-        if (not GetTextFromImage(output_dirname + "/" + pdf_image_filename, tesseract_language_code, &image_text)) {
-            LOG_WARNING("failed to extract text from image " + pdf_image_filename);
-            return false;
+    std::sort(pdf_image_filenames.begin(), pdf_image_filenames.end()); // pdfimages numbers its output in page order.
+
+    std::vector<std::string> image_texts(pdf_image_filenames.size());
+    std::atomic<size_t> next_image_no(0), failed_image_count(0);
+    const auto ocr_images([&]() {
+        for (size_t image_no(next_image_no++); image_no < pdf_image_filenames.size(); image_no = next_image_no++) {
+            if (not GetTextFromImage(output_dirname + "/" + pdf_image_filenames[image_no], tesseract_language_code, &image_texts[image_no]))
+                ++failed_image_count;
         }
-        *extracted_text += " " + image_text;
+    });
+
+    const size_t actual_thread_count(
+        std::min<size_t>(thread_count == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count, pdf_image_filenames.size()));
+    std::vector<std::thread> threads;
+    for (size_t thread_no(1); thread_no < actual_thread_count; ++thread_no)
+        threads.emplace_back(ocr_images);
+    ocr_images();
+    for (auto &thread : threads)
+        thread.join();
+
+    if (failed_image_count > 0) {
+        LOG_WARNING("failed to extract text from " + std::to_string(failed_image_count.load()) + " image(s)!");
+        return false;
     }
 
+    for (const auto &image_text : image_texts)
+        *extracted_text += " " + image_text;
+
     *extracted_text = StringUtil::TrimWhite(*extracted_text);
     return not extracted_text->empty();
 }
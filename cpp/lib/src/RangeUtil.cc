@@ -21,6 +21,13 @@
 #include "RangeUtil.h"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Compiler.h"
+#include "FileUtil.h"
 #include "Locale.h"
 #include "MapUtil.h"
 #include "RegexMatcher.h"
@@ -972,4 +979,232 @@ std::string ConvertToDatesQuery(const std::string &ranges_str) {
 }
 
 
+// The index file consists of a header, the key entries, sorted by key, the ranges of all keys, grouped by key, the interval
+// entries, sorted by range, and finally the concatenated keys, padded to a multiple of 8 bytes.
+struct RangeIndex::Header {
+    char magic_[8];
+    uint64_t key_count_;
+    uint64_t range_count_;
+    uint64_t key_data_size_;
+    uint64_t digit_count_;
+    uint64_t authority_file_size_;
+    int64_t authority_file_mtime_;
+};
+
+
+struct RangeIndex::KeyEntry {
+    uint32_t key_offset_;
+    uint32_t key_length_;
+    uint32_t first_range_;
+    uint32_t range_count_;
+};
+
+
+struct RangeIndex::IntervalEntry {
+    Range range_;
+    uint32_t max_end_; // The maximum of the ends of this and all preceding intervals.
+    uint32_t key_no_;
+};
+
+
+namespace {
+
+
+constexpr char RANGE_INDEX_MAGIC[8] = { 'U', 'B', 'R', 'N', 'G', 'I', 'X', '1' };
+
+
+template <typename T>
+void WriteOrDie(File * const output, const T * const values, const size_t count) {
+    if (unlikely(output->write(values, count * sizeof(T)) != count * sizeof(T)))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+} // unnamed namespace
+
+
+RangeIndex::RangeIndex(const std::string &index_path): index_path_(index_path) {
+    const int fd(::open(index_path.c_str(), O_RDONLY));
+    if (fd == -1)
+        LOG_ERROR("failed to open(2) \"" + index_path + "\"!");
+
+    struct stat stat_buf;
+    if (unlikely(::fstat(fd, &stat_buf) != 0))
+        LOG_ERROR("failed to fstat(2) \"" + index_path + "\"!");
+    map_size_ = stat_buf.st_size;
+    if (unlikely(map_size_ < sizeof(Header)))
+        LOG_ERROR("\"" + index_path + "\" is too small to be a range index!");
+
+    map_start_ = static_cast<const char *>(::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+    if (map_start_ == MAP_FAILED or map_start_ == nullptr)
+        LOG_ERROR("failed to mmap(2) \"" + index_path + "\"!");
+    ::close(fd);
+
+    header_ = reinterpret_cast<const Header *>(map_start_);
+    if (unlikely(std::memcmp(header_->magic_, RANGE_INDEX_MAGIC, sizeof RANGE_INDEX_MAGIC) != 0))
+        LOG_ERROR("\"" + index_path + "\" is not a range index!");
+    if (unlikely(map_size_
+                 != sizeof(Header) + header_->key_count_ * sizeof(KeyEntry) + header_->range_count_ * sizeof(Range)
+                        + header_->range_count_ * sizeof(IntervalEntry) + header_->key_data_size_))
+        LOG_ERROR("\"" + index_path + "\" is truncated or corrupt!");
+
+    keys_ = reinterpret_cast<const KeyEntry *>(map_start_ + sizeof(Header));
+    ranges_ = reinterpret_cast<const Range *>(keys_ + header_->key_count_);
+    intervals_ = reinterpret_cast<const IntervalEntry *>(ranges_ + header_->range_count_);
+    key_data_ = reinterpret_cast<const char *>(intervals_ + header_->range_count_);
+}
+
+
+RangeIndex::~RangeIndex() {
+    if (unlikely(::munmap(const_cast<char *>(map_start_), map_size_) != 0))
+        LOG_ERROR("munmap(2) on \"" + index_path_ + "\" failed!");
+}
+
+
+size_t RangeIndex::getKeyCount() const {
+    return header_->key_count_;
+}
+
+
+size_t RangeIndex::getRangeCount() const {
+    return header_->range_count_;
+}
+
+
+const RangeIndex::KeyEntry *RangeIndex::findKey(const std::string_view key) const {
+    const auto keys_end(keys_ + header_->key_count_);
+    const auto key_entry(std::lower_bound(keys_, keys_end, key, [this](const KeyEntry &lhs, const std::string_view rhs) {
+        return std::string_view(key_data_ + lhs.key_offset_, lhs.key_length_) < rhs;
+    }));
+    if (key_entry == keys_end or std::string_view(key_data_ + key_entry->key_offset_, key_entry->key_length_) != key)
+        return nullptr;
+    return key_entry;
+}
+
+
+std::span<const RangeIndex::Range> RangeIndex::getRanges(const std::string_view key) const {
+    const KeyEntry * const key_entry(findKey(key));
+    if (key_entry == nullptr)
+        return std::span<const Range>();
+    return std::span<const Range>(ranges_ + key_entry->first_range_, key_entry->range_count_);
+}
+
+
+void RangeIndex::findOverlappingRanges(const uint32_t start, const uint32_t end, std::vector<KeyAndRange> * const keys_and_ranges) const {
+    keys_and_ranges->clear();
+
+    // The running maximum of the ends is non-decreasing, so no interval before the first one whose running maximum reaches
+    // "start" can overlap.  Neither can any interval that starts after "end".
+    const auto intervals_end(intervals_ + header_->range_count_);
+    const auto first_candidate(std::partition_point(intervals_, intervals_end,
+                                                    [start](const IntervalEntry &interval) { return interval.max_end_ < start; }));
+    const auto candidates_end(std::partition_point(first_candidate, intervals_end,
+                                                   [end](const IntervalEntry &interval) { return interval.range_.start_ <= end; }));
+    for (auto interval(first_candidate); interval != candidates_end; ++interval) {
+        if (interval->range_.end_ >= start) {
+            const KeyEntry &key_entry(keys_[interval->key_no_]);
+            keys_and_ranges->emplace_back(
+                KeyAndRange{ std::string_view(key_data_ + key_entry.key_offset_, key_entry.key_length_), interval->range_ });
+        }
+    }
+}
+
+
+std::string RangeIndex::toString(const Range &range) const {
+    return StringUtil::PadLeading(std::to_string(range.start_), header_->digit_count_, '0') + ":"
+           + StringUtil::PadLeading(std::to_string(range.end_), header_->digit_count_, '0');
+}
+
+
+bool RangeIndex::isUpToDate(const std::string &authority_path) const {
+    struct stat stat_buf;
+    if (::stat(authority_path.c_str(), &stat_buf) != 0)
+        return false;
+    return static_cast<uint64_t>(stat_buf.st_size) == header_->authority_file_size_ and stat_buf.st_mtime == header_->authority_file_mtime_;
+}
+
+
+void RangeIndex::Create(const std::string &index_path, const std::string &authority_path, const unsigned digit_count,
+                        const std::map<std::string, std::vector<Range>> &keys_and_ranges) {
+    std::vector<KeyEntry> key_entries;
+    key_entries.reserve(keys_and_ranges.size());
+    std::vector<Range> ranges;
+    std::vector<IntervalEntry> intervals;
+    std::string key_data;
+    for (const auto &[key, key_ranges] : keys_and_ranges) {
+        if (unlikely(key_data.size() + key.size() > UINT32_MAX or ranges.size() + key_ranges.size() > UINT32_MAX))
+            LOG_ERROR("too much data for \"" + index_path + "\"!");
+
+        KeyEntry key_entry{ static_cast<uint32_t>(key_data.size()), static_cast<uint32_t>(key.size()),
+                            static_cast<uint32_t>(ranges.size()), 0 };
+        key_data += key;
+
+        std::vector<Range> sorted_key_ranges(key_ranges);
+        std::sort(sorted_key_ranges.begin(), sorted_key_ranges.end());
+        sorted_key_ranges.erase(std::unique(sorted_key_ranges.begin(), sorted_key_ranges.end()), sorted_key_ranges.end());
+        for (const auto &range : sorted_key_ranges) {
+            if (unlikely(range.end_ < range.start_))
+                LOG_ERROR("bad range " + std::to_string(range.start_) + "-" + std::to_string(range.end_) + " for key \"" + key
+                          + "\"!");
+            ranges.emplace_back(range);
+            intervals.emplace_back(IntervalEntry{ range, 0, static_cast<uint32_t>(key_entries.size()) });
+        }
+        key_entry.range_count_ = sorted_key_ranges.size();
+        key_entries.emplace_back(key_entry);
+    }
+
+    std::sort(intervals.begin(), intervals.end(), [](const IntervalEntry &lhs, const IntervalEntry &rhs) {
+        return lhs.range_ < rhs.range_ or (lhs.range_ == rhs.range_ and lhs.key_no_ < rhs.key_no_);
+    });
+    uint32_t max_end(0);
+    for (auto &interval : intervals) {
+        max_end = std::max(max_end, interval.range_.end_);
+        interval.max_end_ = max_end;
+    }
+
+    key_data.resize((key_data.size() + 7u) & ~size_t(7u), '\0');
+
+    Header header;
+    std::memcpy(header.magic_, RANGE_INDEX_MAGIC, sizeof RANGE_INDEX_MAGIC);
+    header.key_count_ = key_entries.size();
+    header.range_count_ = ranges.size();
+    header.key_data_size_ = key_data.size();
+    header.digit_count_ = digit_count;
+
+    struct stat stat_buf;
+    if (unlikely(::stat(authority_path.c_str(), &stat_buf) != 0))
+        LOG_ERROR("failed to stat(2) \"" + authority_path + "\"!");
+    header.authority_file_size_ = stat_buf.st_size;
+    header.authority_file_mtime_ = stat_buf.st_mtime;
+
+    const std::string temp_index_path(index_path + ".tmp");
+    const auto index_file(FileUtil::OpenOutputFileOrDie(temp_index_path));
+    WriteOrDie(index_file.get(), &header, 1);
+    WriteOrDie(index_file.get(), key_entries.data(), key_entries.size());
+    WriteOrDie(index_file.get(), ranges.data(), ranges.size());
+    WriteOrDie(index_file.get(), intervals.data(), intervals.size());
+    WriteOrDie(index_file.get(), key_data.data(), key_data.size());
+    index_file->close();
+    FileUtil::RenameFileOrDie(temp_index_path, index_path, /* remove_target = */ true);
+
+    LOG_INFO("indexed " + std::to_string(header.range_count_) + " ranges of " + std::to_string(header.key_count_) + " keys from \""
+             + authority_path + "\".");
+}
+
+
+std::unique_ptr<RangeIndex> RangeIndex::OpenSidecar(const std::string &authority_path, const std::string &suffix) {
+    const std::string sidecar_path(authority_path + suffix);
+    if (not FileUtil::Exists(sidecar_path))
+        return nullptr;
+
+    std::unique_ptr<RangeIndex> range_index(new RangeIndex(sidecar_path));
+    if (not range_index->isUpToDate(authority_path)) {
+        LOG_WARNING("ignoring \"" + sidecar_path + "\" because it is out of date!");
+        return nullptr;
+    }
+
+    return range_index;
+}
+
+
 } // namespace RangeUtil
@@ -0,0 +1,305 @@
+/** \file    RecordLinkGraph.cc
+ *  \brief   Implementation of the RecordLinkGraph class.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecordLinkGraph.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Compiler.h"
+#include "FileUtil.h"
+#include "StringUtil.h"
+#include "util.h"
+
+
+// The graph file consists of a header, the node entries, sorted by PPN, the links, i.e. the node numbers of the link targets,
+// and finally the concatenated PPN's, padded to a multiple of 8 bytes.  The links of a node start w/ its superior works,
+// followed by its cross links.
+struct RecordLinkGraph::Header {
+    char magic_[8];
+    uint64_t record_count_;
+    uint64_t node_count_;
+    uint64_t link_count_;
+    uint64_t ppn_data_size_;
+};
+
+
+struct RecordLinkGraph::NodeEntry {
+    uint32_t ppn_offset_;
+    uint32_t first_link_;
+    uint32_t superior_count_;
+    uint32_t cross_link_count_;
+    uint16_t ppn_length_;
+    uint16_t publication_year_;
+    uint8_t flags_;
+    char bibliographic_level_;
+    char padding_[2];
+};
+
+
+namespace {
+
+
+constexpr char GRAPH_MAGIC[8] = { 'U', 'B', 'R', 'L', 'G', 'R', 'F', '1' };
+enum NodeFlags : uint8_t { IS_RECORD = 1u << 0u, IS_ELECTRONIC_RESOURCE = 1u << 1u };
+
+
+template <typename T>
+void WriteOrDie(File * const output, const T * const values, const size_t count) {
+    if (unlikely(output->write(values, count * sizeof(T)) != count * sizeof(T)))
+        LOG_ERROR("failed to write to \"" + output->getPath() + "\"!");
+}
+
+
+// What we need to know about a record while we're building the graph.
+struct RecordLinks {
+    uint16_t publication_year_;
+    bool is_electronic_resource_;
+    char bibliographic_level_;
+    std::vector<std::string> superior_ppns_;
+    std::vector<std::string> cross_link_ppns_;
+};
+
+
+uint16_t GetPublicationYear(const MARC::Record &record) {
+    const auto _008_field(record.findTag("008"));
+    if (_008_field == record.end())
+        return 0;
+
+    const std::string &_008_contents(_008_field->getContents());
+    if (_008_contents.length() < 11)
+        return 0;
+
+    uint16_t year(0);
+    for (unsigned i(7); i < 11; ++i) {
+        if (not StringUtil::IsDigit(_008_contents[i]))
+            return 0;
+        year = year * 10 + (_008_contents[i] - '0');
+    }
+
+    return year;
+}
+
+
+} // unnamed namespace
+
+
+std::string_view RecordLinkGraph::Node::getPPN() const {
+    return std::string_view(graph_->ppn_data_ + entry_->ppn_offset_, entry_->ppn_length_);
+}
+
+
+bool RecordLinkGraph::Node::isRecord() const {
+    return (entry_->flags_ & IS_RECORD) != 0;
+}
+
+
+bool RecordLinkGraph::Node::isElectronicResource() const {
+    return (entry_->flags_ & IS_ELECTRONIC_RESOURCE) != 0;
+}
+
+
+char RecordLinkGraph::Node::getBibliographicLevel() const {
+    return entry_->bibliographic_level_;
+}
+
+
+unsigned RecordLinkGraph::Node::getPublicationYear() const {
+    return entry_->publication_year_;
+}
+
+
+std::vector<std::string_view> RecordLinkGraph::Node::getSuperiorPPNs() const {
+    return getPPNs(entry_->first_link_, entry_->superior_count_);
+}
+
+
+std::vector<std::string_view> RecordLinkGraph::Node::getCrossLinkPPNs() const {
+    return getPPNs(entry_->first_link_ + entry_->superior_count_, entry_->cross_link_count_);
+}
+
+
+std::vector<std::string_view> RecordLinkGraph::Node::getPPNs(const uint32_t first_link, const uint32_t link_count) const {
+    std::vector<std::string_view> ppns;
+    ppns.reserve(link_count);
+    for (uint32_t link_no(first_link); link_no < first_link + link_count; ++link_no)
+        ppns.emplace_back(graph_->getNode(graph_->links_[link_no]).getPPN());
+    return ppns;
+}
+
+
+RecordLinkGraph::RecordLinkGraph(const std::string &graph_path): graph_path_(graph_path) {
+    const int fd(::open(graph_path.c_str(), O_RDONLY));
+    if (fd == -1)
+        LOG_ERROR("failed to open(2) \"" + graph_path + "\"!");
+
+    struct stat stat_buf;
+    if (unlikely(::fstat(fd, &stat_buf) != 0))
+        LOG_ERROR("failed to fstat(2) \"" + graph_path + "\"!");
+    map_size_ = stat_buf.st_size;
+    if (unlikely(map_size_ < sizeof(Header)))
+        LOG_ERROR("\"" + graph_path + "\" is too small to be a record link graph!");
+
+    map_start_ = static_cast<const char *>(::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+    if (map_start_ == MAP_FAILED or map_start_ == nullptr)
+        LOG_ERROR("failed to mmap(2) \"" + graph_path + "\"!");
+    ::close(fd);
+
+    header_ = reinterpret_cast<const Header *>(map_start_);
+    if (unlikely(std::memcmp(header_->magic_, GRAPH_MAGIC, sizeof GRAPH_MAGIC) != 0))
+        LOG_ERROR("\"" + graph_path + "\" is not a record link graph!");
+    if (unlikely(map_size_
+                 != sizeof(Header) + header_->node_count_ * sizeof(NodeEntry)
+                        + ((header_->link_count_ * sizeof(uint32_t) + 7u) & ~size_t(7u)) + header_->ppn_data_size_))
+        LOG_ERROR("\"" + graph_path + "\" is truncated or corrupt!");
+
+    nodes_ = reinterpret_cast<const NodeEntry *>(map_start_ + sizeof(Header));
+    links_ = reinterpret_cast<const uint32_t *>(nodes_ + header_->node_count_);
+    ppn_data_ = reinterpret_cast<const char *>(links_) + ((header_->link_count_ * sizeof(uint32_t) + 7u) & ~size_t(7u));
+}
+
+
+RecordLinkGraph::~RecordLinkGraph() {
+    if (unlikely(::munmap(const_cast<char *>(map_start_), map_size_) != 0))
+        LOG_ERROR("munmap(2) on \"" + graph_path_ + "\" failed!");
+}
+
+
+size_t RecordLinkGraph::getRecordCount() const {
+    return header_->record_count_;
+}
+
+
+size_t RecordLinkGraph::getNodeCount() const {
+    return header_->node_count_;
+}
+
+
+RecordLinkGraph::Node RecordLinkGraph::getNode(const size_t node_no) const {
+    return Node(this, nodes_ + node_no);
+}
+
+
+bool RecordLinkGraph::findRecord(const std::string_view ppn, Node * const node) const {
+    const auto nodes_end(nodes_ + header_->node_count_);
+    const auto node_entry(std::lower_bound(nodes_, nodes_end, ppn, [this](const NodeEntry &lhs, const std::string_view rhs) {
+        return std::string_view(ppn_data_ + lhs.ppn_offset_, lhs.ppn_length_) < rhs;
+    }));
+    if (node_entry == nodes_end or (node_entry->flags_ & IS_RECORD) == 0
+        or std::string_view(ppn_data_ + node_entry->ppn_offset_, node_entry->ppn_length_) != ppn)
+        return false;
+
+    *node = Node(this, node_entry);
+    return true;
+}
+
+
+void RecordLinkGraph::Create(MARC::Reader * const marc_reader, const std::string &graph_path) {
+    std::unordered_map<std::string, RecordLinks> ppns_to_record_links;
+    while (const auto record = marc_reader->read()) {
+        if (ppns_to_record_links.find(record.getControlNumber()) != ppns_to_record_links.end())
+            continue;
+
+        RecordLinks record_links;
+        record_links.publication_year_ = GetPublicationYear(record);
+        record_links.is_electronic_resource_ = record.isElectronicResource();
+        record_links.bibliographic_level_ = record.getLeader().length() > 7 ? record.getLeader()[7] : ' ';
+        const auto superior_ppns(record.getParentControlNumbers());
+        record_links.superior_ppns_.assign(superior_ppns.cbegin(), superior_ppns.cend());
+        std::sort(record_links.superior_ppns_.begin(), record_links.superior_ppns_.end());
+        const auto cross_link_ppns(MARC::ExtractCrossLinkPPNs(record));
+        record_links.cross_link_ppns_.assign(cross_link_ppns.cbegin(), cross_link_ppns.cend());
+        ppns_to_record_links.emplace(record.getControlNumber(), std::move(record_links));
+    }
+
+    // The nodes are the PPN's of the records as well as those of all link targets:
+    std::vector<std::string> ppns;
+    ppns.reserve(ppns_to_record_links.size());
+    for (const auto &[ppn, record_links] : ppns_to_record_links) {
+        ppns.emplace_back(ppn);
+        ppns.insert(ppns.end(), record_links.superior_ppns_.cbegin(), record_links.superior_ppns_.cend());
+        ppns.insert(ppns.end(), record_links.cross_link_ppns_.cbegin(), record_links.cross_link_ppns_.cend());
+    }
+    std::sort(ppns.begin(), ppns.end());
+    ppns.erase(std::unique(ppns.begin(), ppns.end()), ppns.end());
+    if (unlikely(ppns.size() > UINT32_MAX))
+        LOG_ERROR("too many PPN's in \"" + marc_reader->getPath() + "\"!");
+
+    const auto get_node_no([&ppns](const std::string &ppn) -> uint32_t {
+        return std::lower_bound(ppns.cbegin(), ppns.cend(), ppn) - ppns.cbegin();
+    });
+
+    std::vector<NodeEntry> node_entries;
+    node_entries.reserve(ppns.size());
+    std::vector<uint32_t> links;
+    std::string ppn_data;
+    for (const auto &ppn : ppns) {
+        if (unlikely(ppn.length() > UINT16_MAX or ppn_data.size() + ppn.length() > UINT32_MAX or links.size() > UINT32_MAX))
+            LOG_ERROR("too much data for \"" + graph_path + "\"!");
+
+        NodeEntry node_entry{};
+        node_entry.ppn_offset_ = ppn_data.size();
+        node_entry.ppn_length_ = ppn.length();
+        node_entry.first_link_ = links.size();
+        node_entry.bibliographic_level_ = ' ';
+        ppn_data += ppn;
+
+        const auto ppn_and_record_links(ppns_to_record_links.find(ppn));
+        if (ppn_and_record_links != ppns_to_record_links.end()) {
+            const RecordLinks &record_links(ppn_and_record_links->second);
+            node_entry.flags_ = IS_RECORD | (record_links.is_electronic_resource_ ? IS_ELECTRONIC_RESOURCE : 0);
+            node_entry.publication_year_ = record_links.publication_year_;
+            node_entry.bibliographic_level_ = record_links.bibliographic_level_;
+            node_entry.superior_count_ = record_links.superior_ppns_.size();
+            for (const auto &superior_ppn : record_links.superior_ppns_)
+                links.emplace_back(get_node_no(superior_ppn));
+            node_entry.cross_link_count_ = record_links.cross_link_ppns_.size();
+            for (const auto &cross_link_ppn : record_links.cross_link_ppns_)
+                links.emplace_back(get_node_no(cross_link_ppn));
+        }
+        node_entries.emplace_back(node_entry);
+    }
+
+    Header header;
+    std::memcpy(header.magic_, GRAPH_MAGIC, sizeof GRAPH_MAGIC);
+    header.record_count_ = ppns_to_record_links.size();
+    header.node_count_ = node_entries.size();
+    header.link_count_ = links.size();
+    if (links.size() % 2 != 0)
+        links.emplace_back(0); // Padding, so that the PPN data starts at a multiple of 8 bytes.
+    ppn_data.resize((ppn_data.size() + 7u) & ~size_t(7u), '\0');
+    header.ppn_data_size_ = ppn_data.size();
+
+    const std::string temp_graph_path(graph_path + ".tmp");
+    const auto graph_file(FileUtil::OpenOutputFileOrDie(temp_graph_path));
+    WriteOrDie(graph_file.get(), &header, 1);
+    WriteOrDie(graph_file.get(), node_entries.data(), node_entries.size());
+    WriteOrDie(graph_file.get(), links.data(), links.size());
+    WriteOrDie(graph_file.get(), ppn_data.data(), ppn_data.size());
+    graph_file->close();
+    FileUtil::RenameFileOrDie(temp_graph_path, graph_path, /* remove_target = */ true);
+
+    LOG_INFO("stored " + std::to_string(header.record_count_) + " records w/ " + std::to_string(header.link_count_) + " links to "
+             + std::to_string(header.node_count_ - header.record_count_) + " further PPN's from \"" + marc_reader->getPath()
+             + "\" in \"" + graph_path + "\".");
+}
@@ -18,6 +18,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "RegexMatcher.h"
+#include <algorithm>
 #include <unordered_map>
 #include "Compiler.h"
 #include "StringUtil.h"
@@ -80,8 +81,9 @@ bool CompileRegex(const std::string &pattern, const unsigned options, ::pcre **p
         return false;
     }
 
-    // Can't use PCRE_STUDY_JIT_COMPILE because it's not thread safe.
-    *pcre_extra_arg = ::pcre_study(*pcre_arg, 0, &errptr);
+    // We only use PCRE_STUDY_JIT_COMPILE on request.  JIT-compiled patterns can be shared by threads as long as no JIT stack
+    // gets assigned to them, which we never do, but each thread then needs up to 32K of its own stack per match.
+    *pcre_extra_arg = ::pcre_study(*pcre_arg, (options & ThreadSafeRegexMatcher::ENABLE_JIT) ? PCRE_STUDY_JIT_COMPILE : 0, &errptr);
     if (*pcre_extra_arg == nullptr and errptr != nullptr) {
         ::pcre_free(*pcre_arg);
         *pcre_arg = nullptr;
@@ -135,6 +137,18 @@ ThreadSafeRegexMatcher::MatchResult ThreadSafeRegexMatcher::match(const std::str
 }
 
 
+bool ThreadSafeRegexMatcher::matched(const std::string &subject) const {
+    int substr_indices[3];
+    const int retcode(::pcre_exec(pcre_data_->pcre_, pcre_data_->pcre_extra_, subject.data(), subject.length(), 0, 0, substr_indices,
+                                  sizeof(substr_indices) / sizeof(substr_indices[0])));
+    if (retcode >= 0)
+        return true;
+    if (unlikely(retcode != PCRE_ERROR_NOMATCH))
+        LOG_WARNING("PCRE error " + std::to_string(retcode) + " while matching pattern '" + pattern_ + "'!");
+    return false;
+}
+
+
 std::string ThreadSafeRegexMatcher::replaceAll(const std::string &subject, const std::string &replacement) const {
     if (not match(subject))
         return subject;
@@ -191,7 +205,7 @@ std::string InsertReplacement(const MatchedGroups &result, const std::string &re
 
 
 std::string ThreadSafeRegexMatcher::replaceWithBackreferences(const std::string &subject, const std::string &replacement,
-                                                              const bool global) {
+                                                              const bool global) const {
     if (not match(subject))
         return subject;
 
@@ -428,3 +442,467 @@ std::string RegexMatcher::operator[](const unsigned group) const {
     const unsigned substring_length(substr_vector_[first_index + 1] - substr_vector_[first_index]);
     return (substring_length == 0) ? "" : last_subject_.substr(substr_vector_[first_index], substring_length);
 }
+
+
+namespace {
+
+
+inline bool IsHexDigit(const char ch) {
+    return StringUtil::IsDigit(ch) or (ch >= 'a' and ch <= 'f') or (ch >= 'A' and ch <= 'F');
+}
+
+
+inline char ASCIIToLower(const char ch) {
+    return (ch >= 'A' and ch <= 'Z') ? ch + ('a' - 'A') : ch;
+}
+
+
+// Skips over "{...}" if "*pos" points at the opening brace.
+void SkipBracedArgument(const std::string &pattern, size_t * const pos) {
+    if (*pos < pattern.length() and pattern[*pos] == '{') {
+        const size_t closing_brace_pos(pattern.find('}', *pos));
+        *pos = (closing_brace_pos == std::string::npos) ? pattern.length() : closing_brace_pos + 1;
+    }
+}
+
+
+// Skips a backslash escape that does not stand for a literal character.  "*pos" must point at the character following the backslash.
+void SkipNonLiteralEscape(const std::string &pattern, size_t * const pos) {
+    const char escape_char(pattern[(*pos)++]);
+    switch (escape_char) {
+    case 'x':
+        if (*pos < pattern.length() and pattern[*pos] == '{')
+            SkipBracedArgument(pattern, pos);
+        else {
+            for (unsigned i(0); i < 2 and *pos < pattern.length() and IsHexDigit(pattern[*pos]); ++i)
+                ++*pos;
+        }
+        return;
+    case 'c':
+        if (*pos < pattern.length())
+            ++*pos;
+        return;
+    case 'p':
+    case 'P':
+        if (*pos < pattern.length() and pattern[*pos] == '{')
+            SkipBracedArgument(pattern, pos);
+        else if (*pos < pattern.length())
+            ++*pos;
+        return;
+    case 'g':
+    case 'k':
+        if (*pos < pattern.length() and (pattern[*pos] == '<' or pattern[*pos] == '\'')) {
+            const size_t closing_pos(pattern.find(pattern[*pos] == '<' ? '>' : '\'', *pos + 1));
+            *pos = (closing_pos == std::string::npos) ? pattern.length() : closing_pos + 1;
+            return;
+        }
+        if (*pos < pattern.length() and pattern[*pos] == '{') {
+            SkipBracedArgument(pattern, pos);
+            return;
+        }
+        if (*pos < pattern.length() and (pattern[*pos] == '-' or pattern[*pos] == '+'))
+            ++*pos;
+        while (*pos < pattern.length() and StringUtil::IsDigit(pattern[*pos]))
+            ++*pos;
+        return;
+    case 'o':
+    case 'N':
+        SkipBracedArgument(pattern, pos);
+        return;
+    default:
+        if (StringUtil::IsDigit(escape_char)) { // A back-reference or an octal character code.
+            while (*pos < pattern.length() and StringUtil::IsDigit(pattern[*pos]))
+                ++*pos;
+        }
+    }
+}
+
+
+// Skips a character class.  "*pos" must point at the opening bracket.
+void SkipCharacterClass(const std::string &pattern, size_t * const pos) {
+    ++*pos;
+    if (*pos < pattern.length() and pattern[*pos] == '^')
+        ++*pos;
+    if (*pos < pattern.length() and pattern[*pos] == ']')
+        ++*pos;
+    while (*pos < pattern.length()) {
+        if (pattern[*pos] == '\\')
+            *pos += 2;
+        else if (pattern.compare(*pos, 2, "[:") == 0) {
+            const size_t posix_class_end(pattern.find(":]", *pos + 2));
+            *pos = (posix_class_end == std::string::npos) ? *pos + 1 : posix_class_end + 2;
+        } else if (pattern[(*pos)++] == ']')
+            return;
+    }
+}
+
+
+// Skips a parenthesised group including all nested groups.  "*pos" must point at the opening parenthesis.
+// \return False if the parentheses are unbalanced.
+bool SkipGroup(const std::string &pattern, size_t * const pos) {
+    unsigned nesting_level(0);
+    while (*pos < pattern.length()) {
+        const char ch(pattern[*pos]);
+        if (ch == '\\') {
+            if (pattern.compare(*pos, 2, "\\Q") == 0) {
+                const size_t quote_end(pattern.find("\\E", *pos + 2));
+                *pos = (quote_end == std::string::npos) ? pattern.length() : quote_end + 2;
+            } else
+                *pos += 2;
+        } else if (ch == '[')
+            SkipCharacterClass(pattern, pos);
+        else {
+            ++*pos;
+            if (ch == '(')
+                ++nesting_level;
+            else if (ch == ')' and --nesting_level == 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+
+const int NO_QUANTIFIER(-1);
+
+
+// \return The minimum number of repetitions of the quantifier at "*pos" or NO_QUANTIFIER if there is none.
+int SkipQuantifier(const std::string &pattern, size_t * const pos) {
+    if (*pos >= pattern.length())
+        return NO_QUANTIFIER;
+
+    int min_count;
+    const char ch(pattern[*pos]);
+    if (ch == '*' or ch == '?') {
+        min_count = 0;
+        ++*pos;
+    } else if (ch == '+') {
+        min_count = 1;
+        ++*pos;
+    } else if (ch == '{') {
+        // Only "{n}", "{n,}" and "{n,m}" are quantifiers, anything else is a literal brace.
+        size_t scan_pos(*pos + 1);
+        while (scan_pos < pattern.length() and StringUtil::IsDigit(pattern[scan_pos]))
+            ++scan_pos;
+        if (scan_pos == *pos + 1)
+            return NO_QUANTIFIER;
+        min_count = StringUtil::ToUnsigned(pattern.substr(*pos + 1, scan_pos - *pos - 1)) > 0 ? 1 : 0;
+        if (scan_pos < pattern.length() and pattern[scan_pos] == ',') {
+            ++scan_pos;
+            while (scan_pos < pattern.length() and StringUtil::IsDigit(pattern[scan_pos]))
+                ++scan_pos;
+        }
+        if (scan_pos >= pattern.length() or pattern[scan_pos] != '}')
+            return NO_QUANTIFIER;
+        *pos = scan_pos + 1;
+    } else
+        return NO_QUANTIFIER;
+
+    // Lazy and possessive quantifiers:
+    if (*pos < pattern.length() and (pattern[*pos] == '?' or pattern[*pos] == '+'))
+        ++*pos;
+
+    return min_count;
+}
+
+
+// Looks for internal option settings like "(?i)" or "(?x:...)" anywhere in "pattern".
+void ScanInternalOptionSettings(const std::string &pattern, bool * const case_insensitive, bool * const extended) {
+    for (size_t pos(pattern.find("(?")); pos != std::string::npos; pos = pattern.find("(?", pos + 2)) {
+        size_t options_end(pos + 2);
+        while (options_end < pattern.length() and (StringUtil::IsAsciiLetter(pattern[options_end]) or pattern[options_end] == '-'))
+            ++options_end;
+        if (options_end == pos + 2 or options_end == pattern.length() or (pattern[options_end] != ')' and pattern[options_end] != ':'))
+            continue;
+        const std::string option_letters(pattern.substr(pos + 2, options_end - pos - 2));
+        if (option_letters.find('i') != std::string::npos)
+            *case_insensitive = true;
+        if (option_letters.find('x') != std::string::npos)
+            *extended = true;
+    }
+}
+
+
+} // unnamed namespace
+
+
+std::string RegexSet::ExtractRequiredLiteral(const std::string &pattern, const unsigned options, bool * const case_insensitive) {
+    *case_insensitive = options & ThreadSafeRegexMatcher::CASE_INSENSITIVE;
+    bool extended(false);
+    ScanInternalOptionSettings(pattern, case_insensitive, &extended);
+    if (extended) // Whitespace and comments would have to be ignored.
+        return "";
+
+    const bool utf8_enabled(options & ThreadSafeRegexMatcher::ENABLE_UTF8);
+    std::string current_literal, longest_literal;
+    const auto end_current_literal([&current_literal, &longest_literal]() {
+        if (current_literal.length() > longest_literal.length())
+            longest_literal.swap(current_literal);
+        current_literal.clear();
+    });
+
+    size_t pos(0);
+    while (pos < pattern.length()) {
+        const char ch(pattern[pos]);
+
+        // Determine the next atom, i.e. the thing that a following quantifier would refer to:
+        std::string literal_atom;
+        if (ch == '\\') {
+            if (pos + 1 == pattern.length())
+                return "";
+            const char escaped_char(pattern[pos + 1]);
+            if (escaped_char == 'Q') {
+                const size_t quote_end(pattern.find("\\E", pos + 2));
+                const size_t quoted_text_end(quote_end == std::string::npos ? pattern.length() : quote_end);
+                std::string quoted_text(pattern.substr(pos + 2, quoted_text_end - pos - 2));
+                pos = (quote_end == std::string::npos) ? pattern.length() : quote_end + 2;
+                if (quoted_text.empty())
+                    continue;
+
+                // A following quantifier only refers to the last character:
+                literal_atom = quoted_text.substr(quoted_text.length() - 1);
+                quoted_text.resize(quoted_text.length() - 1);
+                for (const char quoted_char : quoted_text) {
+                    if (*case_insensitive and (quoted_char & 0x80u or ASCIIToLower(quoted_char) == 'k' or ASCIIToLower(quoted_char) == 's'))
+                        end_current_literal();
+                    else
+                        current_literal += quoted_char;
+                }
+            } else if (StringUtil::IsAlphanumeric(escaped_char)) {
+                ++pos;
+                SkipNonLiteralEscape(pattern, &pos);
+            } else {
+                literal_atom = escaped_char;
+                pos += 2;
+            }
+        } else if (ch == '[')
+            SkipCharacterClass(pattern, &pos);
+        else if (ch == '(') {
+            if (not SkipGroup(pattern, &pos))
+                return "";
+        } else if (ch == '|') // Top-level alternation => no literal is required.
+            return "";
+        else if (ch == ')')
+            return "";
+        else if (ch == '.' or ch == '^' or ch == '$' or ch == '{' or ch == '*' or ch == '+' or ch == '?')
+            ++pos;
+        else if (utf8_enabled and (ch & 0x80u)) {
+            // A quantifier following a multibyte character refers to the entire character.
+            literal_atom = ch;
+            ++pos;
+            while (pos < pattern.length() and (pattern[pos] & 0xC0u) == 0x80u)
+                literal_atom += pattern[pos++];
+        } else {
+            literal_atom = ch;
+            ++pos;
+        }
+
+        const int min_repetition_count(SkipQuantifier(pattern, &pos));
+
+        // In case-insensitive UTF-8 mode PCRE also matches "k" and "s" against the Kelvin sign and the long s, and we don't know
+        // the case variants of non-ASCII characters here:
+        if (*case_insensitive and not literal_atom.empty()
+            and (literal_atom[0] & 0x80u or ASCIIToLower(literal_atom[0]) == 'k' or ASCIIToLower(literal_atom[0]) == 's'))
+            literal_atom.clear();
+
+        if (literal_atom.empty() or min_repetition_count == 0)
+            end_current_literal();
+        else {
+            current_literal += literal_atom;
+            if (min_repetition_count != NO_QUANTIFIER)
+                end_current_literal();
+        }
+    }
+    end_current_literal();
+
+    if (*case_insensitive) {
+        for (auto &literal_char : longest_literal)
+            literal_char = ASCIIToLower(literal_char);
+    }
+
+    return longest_literal;
+}
+
+
+// A classic Aho-Corasick automaton over bytes.
+class RegexSet::LiteralAutomaton {
+    static constexpr unsigned NO_TRANSITION = std::numeric_limits<unsigned>::max();
+    static constexpr unsigned ROOT = 0;
+
+    struct State {
+        std::vector<std::pair<unsigned char, unsigned>> transitions_; // Sorted by the first component.
+        unsigned failure_;
+        unsigned output_link_; // The closest state along the failure chain with non-empty "pattern_indices_" or ROOT.
+        std::vector<size_t> pattern_indices_;
+
+    public:
+        State(): failure_(ROOT), output_link_(ROOT) { }
+        unsigned getTransition(const unsigned char ch) const;
+    };
+
+    const bool case_insensitive_;
+    std::vector<State> states_;
+    unsigned root_transitions_[256];
+
+public:
+    explicit LiteralAutomaton(const bool case_insensitive): case_insensitive_(case_insensitive), states_(1) { }
+
+    void addLiteral(const std::string &literal, const size_t pattern_index);
+
+    // Must be called after the last call to addLiteral() and before the first call to scan().
+    void computeFailureLinks();
+
+    // Sets the entries of "pattern_index_flags" of all patterns whose literals occur in "subject".
+    void scan(const std::string &subject, std::vector<char> * const pattern_index_flags) const;
+};
+
+
+unsigned RegexSet::LiteralAutomaton::State::getTransition(const unsigned char ch) const {
+    const auto transition(std::lower_bound(transitions_.cbegin(), transitions_.cend(), ch,
+                                           [](const std::pair<unsigned char, unsigned> &lhs, const unsigned char rhs) {
+                                               return lhs.first < rhs;
+                                           }));
+    return (transition == transitions_.cend() or transition->first != ch) ? NO_TRANSITION : transition->second;
+}
+
+
+void RegexSet::LiteralAutomaton::addLiteral(const std::string &literal, const size_t pattern_index) {
+    unsigned state(ROOT);
+    for (const char ch : literal) {
+        const unsigned char uch(static_cast<unsigned char>(case_insensitive_ ? ASCIIToLower(ch) : ch));
+        unsigned next_state(states_[state].getTransition(uch));
+        if (next_state == NO_TRANSITION) {
+            next_state = states_.size();
+            auto &transitions(states_[state].transitions_);
+            transitions.emplace(std::lower_bound(transitions.begin(), transitions.end(), std::make_pair(uch, 0u)), uch, next_state);
+            states_.emplace_back();
+        }
+        state = next_state;
+    }
+    states_[state].pattern_indices_.emplace_back(pattern_index);
+}
+
+
+void RegexSet::LiteralAutomaton::computeFailureLinks() {
+    for (unsigned ch(0); ch < 256; ++ch) {
+        const unsigned next_state(states_[ROOT].getTransition(static_cast<unsigned char>(ch)));
+        root_transitions_[ch] = (next_state == NO_TRANSITION) ? ROOT : next_state;
+    }
+
+    // Breadth-first traversal, so that the failure links of all shallower states are known when we need them:
+    std::vector<unsigned> queue;
+    for (const auto &transition : states_[ROOT].transitions_)
+        queue.emplace_back(transition.second);
+    for (size_t queue_index(0); queue_index < queue.size(); ++queue_index) {
+        const unsigned state(queue[queue_index]);
+        for (const auto &[ch, next_state] : states_[state].transitions_) {
+            unsigned failure_candidate(states_[state].failure_);
+            while (failure_candidate != ROOT and states_[failure_candidate].getTransition(ch) == NO_TRANSITION)
+                failure_candidate = states_[failure_candidate].failure_;
+            const unsigned failure(failure_candidate == ROOT ? root_transitions_[ch] : states_[failure_candidate].getTransition(ch));
+            states_[next_state].failure_ = failure;
+            states_[next_state].output_link_ = states_[failure].pattern_indices_.empty() ? states_[failure].output_link_ : failure;
+            queue.emplace_back(next_state);
+        }
+    }
+}
+
+
+void RegexSet::LiteralAutomaton::scan(const std::string &subject, std::vector<char> * const pattern_index_flags) const {
+    unsigned state(ROOT);
+    for (const char ch : subject) {
+        const unsigned char uch(static_cast<unsigned char>(case_insensitive_ ? ASCIIToLower(ch) : ch));
+        for (;;) {
+            if (state == ROOT) {
+                state = root_transitions_[uch];
+                break;
+            }
+            const unsigned next_state(states_[state].getTransition(uch));
+            if (next_state != NO_TRANSITION) {
+                state = next_state;
+                break;
+            }
+            state = states_[state].failure_;
+        }
+
+        for (unsigned output_state(states_[state].pattern_indices_.empty() ? states_[state].output_link_ : state); output_state != ROOT;
+             output_state = states_[output_state].output_link_)
+        {
+            for (const auto pattern_index : states_[output_state].pattern_indices_)
+                (*pattern_index_flags)[pattern_index] = true;
+        }
+    }
+}
+
+
+RegexSet::RegexSet(const std::vector<std::string> &patterns, const unsigned options) {
+    std::shared_ptr<LiteralAutomaton> case_sensitive_automaton, case_insensitive_automaton;
+    for (const auto &pattern : patterns) {
+        const size_t pattern_index(matchers_.size());
+        matchers_.emplace_back(pattern, options);
+
+        bool case_insensitive;
+        const std::string literal(ExtractRequiredLiteral(pattern, options, &case_insensitive));
+        if (literal.empty()) {
+            unfiltered_pattern_indices_.emplace_back(pattern_index);
+            continue;
+        }
+
+        auto &automaton(case_insensitive ? case_insensitive_automaton : case_sensitive_automaton);
+        if (automaton == nullptr)
+            automaton.reset(new LiteralAutomaton(case_insensitive));
+        automaton->addLiteral(literal, pattern_index);
+    }
+
+    if (case_sensitive_automaton != nullptr) {
+        case_sensitive_automaton->computeFailureLinks();
+        case_sensitive_automaton_ = case_sensitive_automaton;
+    }
+    if (case_insensitive_automaton != nullptr) {
+        case_insensitive_automaton->computeFailureLinks();
+        case_insensitive_automaton_ = case_insensitive_automaton;
+    }
+}
+
+
+void RegexSet::getCandidates(const std::string &subject, std::vector<size_t> * const candidate_indices,
+                             const size_t first_pattern_index) const {
+    candidate_indices->clear();
+    if (first_pattern_index >= matchers_.size())
+        return;
+
+    std::vector<char> pattern_index_flags(matchers_.size(), false);
+    for (const auto pattern_index : unfiltered_pattern_indices_)
+        pattern_index_flags[pattern_index] = true;
+    if (case_sensitive_automaton_ != nullptr)
+        case_sensitive_automaton_->scan(subject, &pattern_index_flags);
+    if (case_insensitive_automaton_ != nullptr)
+        case_insensitive_automaton_->scan(subject, &pattern_index_flags);
+
+    for (size_t pattern_index(first_pattern_index); pattern_index < matchers_.size(); ++pattern_index) {
+        if (pattern_index_flags[pattern_index])
+            candidate_indices->emplace_back(pattern_index);
+    }
+}
+
+
+size_t RegexSet::findFirstMatch(const std::string &subject, const size_t first_pattern_index) const {
+    std::vector<size_t> candidate_indices;
+    getCandidates(subject, &candidate_indices, first_pattern_index);
+    for (const auto candidate_index : candidate_indices) {
+        if (matchers_[candidate_index].match(subject))
+            return candidate_index;
+    }
+
+    return NO_MATCH;
+}
+
+
+void RegexSet::match(const std::string &subject, std::vector<size_t> * const matched_pattern_indices) const {
+    getCandidates(subject, matched_pattern_indices);
+    const auto new_end(
+        std::remove_if(matched_pattern_indices->begin(), matched_pattern_indices->end(),
+                       [this, &subject](const size_t candidate_index) { return not matchers_[candidate_index].match(subject); }));
+    matched_pattern_indices->erase(new_end, matched_pattern_indices->end());
+}
@@ -1,4 +1,6 @@
 #include "Stemmer.h"
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -31,3 +33,102 @@ const Stemmer *Stemmer::StemmerFactory(const std::string &language_name_or_code)
 
     return new_stemmer;
 }
+
+
+ConcurrentStemmer::ConcurrentStemmer(const size_t max_cache_size)
+    : max_shard_size_(max_cache_size / SHARD_COUNT == 0 ? 1 : max_cache_size / SHARD_COUNT) {
+}
+
+
+std::string ConcurrentStemmer::stem(const std::string &language_name_or_code, const std::string &word) {
+    const Stemmer * const stemmer(getThreadLocalStemmer(language_name_or_code));
+    return (stemmer == nullptr) ? word : lookupOrStem(*stemmer, language_name_or_code, word);
+}
+
+
+bool ConcurrentStemmer::stem(const std::string &language_name_or_code, const std::vector<std::string> &words,
+                             std::vector<std::string> * const stemmed_words) {
+    stemmed_words->clear();
+    stemmed_words->reserve(words.size());
+
+    const Stemmer * const stemmer(getThreadLocalStemmer(language_name_or_code));
+    if (stemmer == nullptr) {
+        stemmed_words->insert(stemmed_words->end(), words.cbegin(), words.cend());
+        return false;
+    }
+
+    for (const auto &word : words)
+        stemmed_words->emplace_back(lookupOrStem(*stemmer, language_name_or_code, word));
+
+    return true;
+}
+
+
+void ConcurrentStemmer::clearCache() {
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex_);
+        shard.language_and_word_to_stem_map_.clear();
+    }
+}
+
+
+size_t ConcurrentStemmer::getCacheSize() {
+    size_t cache_size(0);
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex_);
+        cache_size += shard.language_and_word_to_stem_map_.size();
+    }
+
+    return cache_size;
+}
+
+
+ConcurrentStemmer &ConcurrentStemmer::GetDefaultInstance() {
+    static ConcurrentStemmer default_instance;
+    return default_instance;
+}
+
+
+const Stemmer *ConcurrentStemmer::getThreadLocalStemmer(const std::string &language_name_or_code) {
+    // Snowball stemmers keep their working buffer inside the sb_stemmer struct, hence one instance per thread and language.
+    // Unsupported languages are remembered as nullptr entries.
+    thread_local std::unordered_map<std::string, std::unique_ptr<Stemmer>> language_to_stemmer_map;
+
+    const auto language_and_stemmer(language_to_stemmer_map.find(language_name_or_code));
+    if (language_and_stemmer != language_to_stemmer_map.end())
+        return language_and_stemmer->second.get();
+
+    std::unique_ptr<Stemmer> new_stemmer;
+    try {
+        new_stemmer.reset(new Stemmer(language_name_or_code));
+    } catch (const std::exception &x) {
+    }
+
+    return (language_to_stemmer_map[language_name_or_code] = std::move(new_stemmer)).get();
+}
+
+
+std::string ConcurrentStemmer::lookupOrStem(const Stemmer &stemmer, const std::string &language_name_or_code, const std::string &word) {
+    // Language names and codes never contain a NUL, so this key is unambiguous:
+    std::string language_and_word;
+    language_and_word.reserve(language_name_or_code.length() + 1 + word.length());
+    language_and_word.append(language_name_or_code).append(1, '\0').append(word);
+
+    Shard &shard(shards_[std::hash<std::string>{}(language_and_word) % SHARD_COUNT]);
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.mutex_);
+        const auto language_and_word_and_stem(shard.language_and_word_to_stem_map_.find(language_and_word));
+        if (language_and_word_and_stem != shard.language_and_word_to_stem_map_.end())
+            return language_and_word_and_stem->second;
+    }
+
+    // We stem outside of the lock.  Should another thread stem the same word concurrently, both get the same result.
+    std::string stemmed_word(stemmer.stem(word));
+
+    std::lock_guard<std::mutex> shard_lock(shard.mutex_);
+    if (shard.language_and_word_to_stem_map_.size() >= max_shard_size_)
+        shard.language_and_word_to_stem_map_.clear();
+    shard.language_and_word_to_stem_map_.emplace(std::move(language_and_word), stemmed_word);
+
+    return stemmed_word;
+}
@@ -44,6 +44,7 @@
 #include <clocale>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 #include <alloca.h>
 #include <openssl/md5.h>
 #include <openssl/sha.h>
@@ -2193,6 +2194,124 @@ uint32_t SuperFastHash(const char *data, unsigned len) {
 }
 
 
+static inline uint64_t MurmurHash3FinalMix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDull;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+
+// A straight port of MurmurHash3_x64_128 from https://github.com/aappleby/smhasher which is in the public domain.
+void MurmurHash3_128(const void * const data, const size_t len, const uint64_t seed, uint64_t * const hash) {
+    const uint8_t * const bytes(reinterpret_cast<const uint8_t *>(data));
+    const size_t block_count(len / 16);
+    const uint64_t C1(0x87C37B91114253D5ull);
+    const uint64_t C2(0x4CF5AD432745937Full);
+
+    uint64_t h1(seed), h2(seed);
+    for (size_t block_no(0); block_no < block_count; ++block_no) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, bytes + block_no * 16, sizeof k1);
+        std::memcpy(&k2, bytes + block_no * 16 + 8, sizeof k2);
+
+        k1 *= C1;
+        k1 = (k1 << 31) | (k1 >> 33);
+        k1 *= C2;
+        h1 ^= k1;
+        h1 = (h1 << 27) | (h1 >> 37);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52DCE729;
+
+        k2 *= C2;
+        k2 = (k2 << 33) | (k2 >> 31);
+        k2 *= C1;
+        h2 ^= k2;
+        h2 = (h2 << 31) | (h2 >> 33);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    const uint8_t * const tail(bytes + block_count * 16);
+    uint64_t k1(0), k2(0);
+    switch (len & 15) {
+    case 15:
+        k2 ^= uint64_t(tail[14]) << 48;
+        [[fallthrough]];
+    case 14:
+        k2 ^= uint64_t(tail[13]) << 40;
+        [[fallthrough]];
+    case 13:
+        k2 ^= uint64_t(tail[12]) << 32;
+        [[fallthrough]];
+    case 12:
+        k2 ^= uint64_t(tail[11]) << 24;
+        [[fallthrough]];
+    case 11:
+        k2 ^= uint64_t(tail[10]) << 16;
+        [[fallthrough]];
+    case 10:
+        k2 ^= uint64_t(tail[9]) << 8;
+        [[fallthrough]];
+    case 9:
+        k2 ^= uint64_t(tail[8]);
+        k2 *= C2;
+        k2 = (k2 << 33) | (k2 >> 31);
+        k2 *= C1;
+        h2 ^= k2;
+        [[fallthrough]];
+    case 8:
+        k1 ^= uint64_t(tail[7]) << 56;
+        [[fallthrough]];
+    case 7:
+        k1 ^= uint64_t(tail[6]) << 48;
+        [[fallthrough]];
+    case 6:
+        k1 ^= uint64_t(tail[5]) << 40;
+        [[fallthrough]];
+    case 5:
+        k1 ^= uint64_t(tail[4]) << 32;
+        [[fallthrough]];
+    case 4:
+        k1 ^= uint64_t(tail[3]) << 24;
+        [[fallthrough]];
+    case 3:
+        k1 ^= uint64_t(tail[2]) << 16;
+        [[fallthrough]];
+    case 2:
+        k1 ^= uint64_t(tail[1]) << 8;
+        [[fallthrough]];
+    case 1:
+        k1 ^= uint64_t(tail[0]);
+        k1 *= C1;
+        k1 = (k1 << 31) | (k1 >> 33);
+        k1 *= C2;
+        h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = MurmurHash3FinalMix(h1);
+    h2 = MurmurHash3FinalMix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    hash[0] = h1;
+    hash[1] = h2;
+}
+
+
+std::string MurmurHash3_128(const std::string &s, const uint64_t seed) {
+    uint64_t hash[2];
+    MurmurHash3_128(s.data(), s.size(), seed, hash);
+    return std::string(reinterpret_cast<const char *>(hash), sizeof hash);
+}
+
+
 uint32_t Adler32(const char * const s, const size_t s_length) {
     const uint32_t MOD_ADLER(65521u);
     const uint8_t *data(reinterpret_cast<const uint8_t *>(s)); // Pointer to the data to be summed.
@@ -0,0 +1,221 @@
+/** \file    TextAnalysis.cc
+ *  \brief   Implementation of the keyword-extraction text analysis pipeline.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TextAnalysis.h"
+#include <cstring>
+#include <cwctype>
+#include "FileUtil.h"
+#include "Stemmer.h"
+#include "TextUtil.h"
+#include "util.h"
+
+
+namespace TextAnalysis {
+
+
+std::string_view TokenArena::store(const std::string_view s) {
+    if (unlikely(blocks_.empty() or used_in_current_block_ + s.size() > blocks_[current_block_no_].size_)) {
+        if (not blocks_.empty())
+            ++current_block_no_;
+        // Skip blocks that are too small for "s", e.g. because they were sized for the block size at the time:
+        while (current_block_no_ < blocks_.size() and blocks_[current_block_no_].size_ < s.size())
+            ++current_block_no_;
+        if (current_block_no_ == blocks_.size()) {
+            const size_t new_block_size(s.size() > block_size_ ? s.size() : block_size_);
+            blocks_.emplace_back(Block{ std::unique_ptr<char[]>(new char[new_block_size]), new_block_size });
+        }
+        used_in_current_block_ = 0;
+    }
+
+    char * const copy(blocks_[current_block_no_].data_.get() + used_in_current_block_);
+    std::memcpy(copy, s.data(), s.size());
+    used_in_current_block_ += s.size();
+
+    return std::string_view(copy, s.size());
+}
+
+
+namespace {
+
+
+// Decodes the code point starting at "*ch".  On success "*ch" is advanced past the code point, o/w by a single byte and we
+// return 0 so that invalid bytes act as separators.
+inline uint32_t GetNextCodePoint(const char **ch, const char * const end) {
+    const unsigned char lead(static_cast<unsigned char>(**ch));
+    if (lead < 0x80u) {
+        ++*ch;
+        return lead;
+    }
+
+    unsigned sequence_length;
+    uint32_t code_point;
+    if ((lead & 0xE0u) == 0xC0u)
+        sequence_length = 2, code_point = lead & 0x1Fu;
+    else if ((lead & 0xF0u) == 0xE0u)
+        sequence_length = 3, code_point = lead & 0x0Fu;
+    else if ((lead & 0xF8u) == 0xF0u)
+        sequence_length = 4, code_point = lead & 0x07u;
+    else {
+        ++*ch;
+        return 0;
+    }
+
+    if (unlikely(end - *ch < static_cast<std::ptrdiff_t>(sequence_length))) {
+        ++*ch;
+        return 0;
+    }
+    for (unsigned i(1); i < sequence_length; ++i) {
+        const unsigned char continuation(static_cast<unsigned char>((*ch)[i]));
+        if (unlikely((continuation & 0xC0u) != 0x80u)) {
+            ++*ch;
+            return 0;
+        }
+        code_point = (code_point << 6u) | (continuation & 0x3Fu);
+    }
+
+    *ch += sequence_length;
+    return code_point;
+}
+
+
+inline bool IsAlnum(const uint32_t code_point) {
+    if (code_point < 0x80u)
+        return (code_point >= 'a' and code_point <= 'z') or (code_point >= 'A' and code_point <= 'Z')
+               or (code_point >= '0' and code_point <= '9');
+    return std::iswalnum(static_cast<wint_t>(code_point));
+}
+
+
+inline bool IsDigit(const uint32_t code_point) {
+    return code_point < 0x80u ? (code_point >= '0' and code_point <= '9') : std::iswdigit(static_cast<wint_t>(code_point));
+}
+
+
+inline void AppendToken(const char * const word_start, const char *word_end, unsigned code_point_count,
+                        const unsigned min_word_length, std::vector<std::string_view> * const tokens) {
+    // Remove trailing hyphens and quotes:
+    while (word_end > word_start and (word_end[-1] == '-' or word_end[-1] == '\''))
+        --word_end, --code_point_count;
+
+    if (code_point_count >= min_word_length and word_end > word_start)
+        tokens->emplace_back(word_start, word_end - word_start);
+}
+
+
+} // unnamed namespace
+
+
+void Tokenise(const std::string_view text, std::vector<std::string_view> * const tokens, const unsigned min_word_length) {
+    tokens->clear();
+
+    const char *word_start(nullptr);
+    unsigned code_point_count(0);
+    bool is_number(false);
+
+    const char * const end(text.data() + text.size());
+    const char *ch(text.data());
+    while (ch != end) {
+        const char * const code_point_start(ch);
+        const uint32_t code_point(GetNextCodePoint(&ch, end));
+
+        if (word_start == nullptr) {
+            if (IsAlnum(code_point)) { // Leading hyphens and quotes are skipped.
+                word_start = code_point_start;
+                code_point_count = 1;
+                is_number = IsDigit(code_point);
+            }
+        } else if (IsAlnum(code_point) or code_point == '-' or code_point == '\'') {
+            ++code_point_count;
+            is_number = is_number and IsDigit(code_point);
+        } else if (code_point == '.' and is_number) { // Ordinals like "19." keep their period.
+            AppendToken(word_start, ch, code_point_count + 1, min_word_length, tokens);
+            word_start = nullptr;
+        } else {
+            AppendToken(word_start, code_point_start, code_point_count, min_word_length, tokens);
+            word_start = nullptr;
+        }
+    }
+
+    if (word_start != nullptr)
+        AppendToken(word_start, end, code_point_count, min_word_length, tokens);
+}
+
+
+void Pipeline::loadStopwords(const std::string &language_code, const std::string &stopwords_filename) {
+    auto &stopwords(language_codes_to_stopword_sets_[language_code]);
+
+    const auto input(FileUtil::OpenInputFileOrDie(stopwords_filename));
+    std::string lowercase_stopword;
+    while (not input->eof()) {
+        const std::string line(input->getline());
+        if (line.empty() or line[0] == ';') // Empty or comment line?
+            continue;
+
+        TextUtil::UTF8ToLower(line, &lowercase_stopword);
+        if (stopwords.find(lowercase_stopword) == stopwords.end())
+            stopwords.emplace(stopwords_arena_.store(lowercase_stopword));
+    }
+
+    LOG_INFO("Loaded " + std::to_string(stopwords.size()) + " stopwords for language \"" + language_code + "\".");
+}
+
+
+bool Pipeline::isStopword(const std::unordered_set<std::string_view> * const stopwords, const std::string_view token) const {
+    return stopwords != nullptr and stopwords->find(token) != stopwords->cend();
+}
+
+
+bool Pipeline::analyse(const std::string &text, const std::string &language_code, std::vector<std::string_view> * const tokens) {
+    tokens->clear();
+    token_arena_.clear();
+
+    if (unlikely(not TextUtil::UTF8ToLower(text, &lowercase_text_)))
+        return false;
+    Tokenise(lowercase_text_, &unfiltered_tokens_, min_word_length_);
+
+    const std::unordered_set<std::string_view> *stopwords(nullptr), *additional_stopwords(nullptr);
+    const auto language_code_and_stopwords(language_codes_to_stopword_sets_.find(language_code));
+    if (language_code_and_stopwords != language_codes_to_stopword_sets_.cend())
+        stopwords = &language_code_and_stopwords->second;
+    if (not additional_stopwords_language_code_.empty() and language_code != additional_stopwords_language_code_) {
+        const auto additional_language_code_and_stopwords(language_codes_to_stopword_sets_.find(additional_stopwords_language_code_));
+        if (additional_language_code_and_stopwords != language_codes_to_stopword_sets_.cend())
+            additional_stopwords = &additional_language_code_and_stopwords->second;
+    }
+
+    for (const auto token : unfiltered_tokens_) {
+        if (not isStopword(stopwords, token) and not isStopword(additional_stopwords, token))
+            tokens->emplace_back(token);
+    }
+
+    if (not stem_ or language_code.empty() or tokens->empty())
+        return true;
+
+    auto &stemmer(ConcurrentStemmer::GetDefaultInstance());
+    if (not stemmer.supportsLanguage(language_code))
+        return true;
+    for (auto &token : *tokens)
+        token = token_arena_.store(stemmer.stem(language_code, std::string(token)));
+
+    return true;
+}
+
+
+} // namespace TextAnalysis
@@ -33,6 +33,9 @@
 #include <cstdio>
 #include <cstring>
 #include <cwctype>
+#if defined(__x86_64__) or defined(__i386__)
+#include <immintrin.h>
+#endif
 #include "Compiler.h"
 #include "FileUtil.h"
 #include "HtmlParser.h"
@@ -102,6 +105,18 @@ std::unique_ptr<EncodingConverter> EncodingConverter::Factory(const std::string
     if (CanonizeCharset(from_encoding) == CanonizeCharset(to_encoding))
         return std::unique_ptr<IdentityConverter>(new IdentityConverter());
 
+    if (CanonizeCharset(to_encoding) == CANONICAL_UTF8_NAME) {
+        const std::string canonical_from_encoding(CanonizeCharset(from_encoding));
+        if (canonical_from_encoding == "iso88591" or canonical_from_encoding == "latin1" or canonical_from_encoding == "l1") {
+            error_message->clear();
+            return std::unique_ptr<EncodingConverter>(new SingleByteToUTF8Converter(from_encoding, to_encoding, /* latin9 = */ false));
+        }
+        if (canonical_from_encoding == "iso885915" or canonical_from_encoding == "latin9") {
+            error_message->clear();
+            return std::unique_ptr<EncodingConverter>(new SingleByteToUTF8Converter(from_encoding, to_encoding, /* latin9 = */ true));
+        }
+    }
+
     const iconv_t iconv_handle(::iconv_open(to_encoding.c_str(), from_encoding.c_str()));
     if (unlikely(iconv_handle == (iconv_t)-1)) {
         *error_message = "can't create an encoding converter for conversion from \"" + from_encoding + "\" to \"" + to_encoding + "\"!";
@@ -142,6 +157,16 @@ bool EncodingConverter::convert(const std::string &input, std::string * const ou
 }
 
 
+bool SingleByteToUTF8Converter::convert(const std::string &input, std::string * const output) {
+    if (latin9_)
+        Latin9ToUTF8(input.data(), input.size(), output);
+    else
+        Latin1ToUTF8(input.data(), input.size(), output);
+
+    return true;
+}
+
+
 EncodingConverter::~EncodingConverter() {
     if (iconv_handle_ != (iconv_t)-1 and unlikely(::iconv_close(iconv_handle_) == -1))
         LOG_ERROR("iconv_close(3) failed!");
@@ -299,25 +324,496 @@ bool WCharToUTF8String(const wchar_t wchar, std::string *utf8_string) {
 static std::locale DEFAULT_LOCALE("");
 
 
-bool UTF8ToLower(const std::string &utf8_string, std::string * const lowercase_utf8_string) {
-    std::wstring wchar_string;
-    if (not UTF8ToWCharString(utf8_string, &wchar_string))
+namespace {
+
+
+inline char ASCIIToLower(const char ch) {
+    return (ch >= 'A' and ch <= 'Z') ? static_cast<char>(ch + ('a' - 'A')) : ch;
+}
+
+
+inline char ASCIIToUpper(const char ch) {
+    return (ch >= 'a' and ch <= 'z') ? static_cast<char>(ch - ('a' - 'A')) : ch;
+}
+
+
+/** \brief Decodes the UTF-8 sequence starting at "*cp" and advances "*cp" past it.
+ *  \return False if the sequence is truncated, overlong, encodes a surrogate or a code point beyond U+10FFFF.
+ */
+inline bool DecodeUTF8CodePoint(const char **cp, const char * const end, uint32_t * const code_point) {
+    const unsigned char lead(static_cast<unsigned char>(**cp));
+    if (lead < 0x80u) {
+        *code_point = lead;
+        ++*cp;
+        return true;
+    }
+
+    unsigned continuation_byte_count;
+    uint32_t min_code_point;
+    if ((lead & 0b11100000u) == 0b11000000u) {
+        continuation_byte_count = 1;
+        min_code_point = 0x80;
+        *code_point = lead & 0b00011111u;
+    } else if ((lead & 0b11110000u) == 0b11100000u) {
+        continuation_byte_count = 2;
+        min_code_point = 0x800;
+        *code_point = lead & 0b00001111u;
+    } else if ((lead & 0b11111000u) == 0b11110000u) {
+        continuation_byte_count = 3;
+        min_code_point = 0x10000;
+        *code_point = lead & 0b00000111u;
+    } else
         return false;
 
-    // Lowercase the wide character string:
-    std::wstring lowercase_wide_string;
-    for (const auto wide_ch : wchar_string) {
-        if (std::iswupper(wide_ch))
-            lowercase_wide_string += std::tolower(wide_ch, DEFAULT_LOCALE);
-        else
-            lowercase_wide_string += wide_ch;
+    if (unlikely(end - *cp <= continuation_byte_count))
+        return false;
+    for (unsigned i(1); i <= continuation_byte_count; ++i) {
+        const unsigned char continuation_byte(static_cast<unsigned char>((*cp)[i]));
+        if (unlikely((continuation_byte & 0b11000000u) != 0b10000000u))
+            return false;
+        *code_point = (*code_point << 6u) | (continuation_byte & 0b00111111u);
+    }
+    if (unlikely(*code_point < min_code_point or *code_point > 0x10FFFFu or (*code_point >= 0xD800u and *code_point <= 0xDFFFu)))
+        return false;
+
+    *cp += 1 + continuation_byte_count;
+    return true;
+}
+
+
+// Like TextUtil::UTF32ToUTF8 but appends to "utf8_string" instead of allocating a new string.
+inline void AppendUTF8(const uint32_t code_point, std::string * const utf8_string) {
+    if (code_point <= 0x7Fu)
+        *utf8_string += static_cast<char>(code_point);
+    else if (code_point <= 0x7FFu) {
+        *utf8_string += static_cast<char>(0b11000000u | (code_point >> 6u));
+        *utf8_string += static_cast<char>(0b10000000u | (code_point & 0b00111111u));
+    } else if (code_point <= 0xFFFFu) {
+        *utf8_string += static_cast<char>(0b11100000u | (code_point >> 12u));
+        *utf8_string += static_cast<char>(0b10000000u | ((code_point >> 6u) & 0b00111111u));
+        *utf8_string += static_cast<char>(0b10000000u | (code_point & 0b00111111u));
+    } else
+        utf8_string->append(UTF32ToUTF8(code_point));
+}
+
+
+/** \brief Precomputed lowercase and uppercase mappings for the Basic Multilingual Plane.
+ *  \note  The tables are filled from the same locale-based conversions that we used to call for every character.  Code
+ *         points outside of the BMP and the very few BMP characters that would map outside of it are passed through.
+ */
+class CaseMappingTables {
+    static constexpr uint32_t TABLE_SIZE = 0x10000;
+    std::unique_ptr<uint16_t[]> to_lower_, to_upper_;
+
+public:
+    CaseMappingTables();
+    inline uint32_t toLower(const uint32_t code_point) const { return code_point < TABLE_SIZE ? to_lower_[code_point] : code_point; }
+    inline uint32_t toUpper(const uint32_t code_point) const { return code_point < TABLE_SIZE ? to_upper_[code_point] : code_point; }
+};
+
+
+CaseMappingTables::CaseMappingTables(): to_lower_(new uint16_t[TABLE_SIZE]), to_upper_(new uint16_t[TABLE_SIZE]) {
+    for (uint32_t code_point(0); code_point < TABLE_SIZE; ++code_point) {
+        const wchar_t wide_ch(static_cast<wchar_t>(code_point));
+
+        uint32_t lowercase_code_point(code_point);
+        if (std::iswupper(static_cast<wint_t>(wide_ch)))
+            lowercase_code_point = static_cast<uint32_t>(std::tolower(wide_ch, DEFAULT_LOCALE));
+        to_lower_[code_point] = static_cast<uint16_t>(lowercase_code_point < TABLE_SIZE ? lowercase_code_point : code_point);
+
+        uint32_t uppercase_code_point(code_point);
+        if (std::iswlower(static_cast<wint_t>(wide_ch)))
+            uppercase_code_point = static_cast<uint32_t>(std::towupper(static_cast<wint_t>(wide_ch)));
+        to_upper_[code_point] = static_cast<uint16_t>(uppercase_code_point < TABLE_SIZE ? uppercase_code_point : code_point);
+    }
+}
+
+
+const CaseMappingTables &GetCaseMappingTables() {
+    static const CaseMappingTables case_mapping_tables;
+    return case_mapping_tables;
+}
+
+
+// Decodes "utf8_string", maps each code point with "mapper" and appends the UTF-8 encoded result to "*mapped_utf8_string".
+template <typename CodePointMapper>
+bool MapUTF8CodePoints(const std::string &utf8_string, std::string * const mapped_utf8_string, const CodePointMapper &mapper) {
+    mapped_utf8_string->clear();
+    mapped_utf8_string->reserve(utf8_string.size());
+
+    const char *cp(utf8_string.data());
+    const char * const end(cp + utf8_string.size());
+    while (cp != end) {
+        if (IsASCIIChar(*cp)) {
+            *mapped_utf8_string += static_cast<char>(mapper(static_cast<uint32_t>(*cp)));
+            ++cp;
+            continue;
+        }
+
+        uint32_t code_point;
+        if (unlikely(not DecodeUTF8CodePoint(&cp, end, &code_point)))
+            return false;
+        AppendUTF8(mapper(code_point), mapped_utf8_string);
     }
 
-    return WCharToUTF8String(lowercase_wide_string, lowercase_utf8_string);
+    return true;
+}
+
+
+// \return The number of ASCII characters at the start of the "length" bytes starting at "data".
+inline size_t CountLeadingASCIIChars(const char * const data, const size_t length) {
+    size_t offset(0);
+#ifdef __SSE2__
+    for (/* Intentionally empty! */; offset + 16 <= length; offset += 16) {
+        const int high_bits(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + offset))));
+        if (high_bits != 0)
+            return offset + __builtin_ctz(static_cast<unsigned>(high_bits));
+    }
+#endif
+    while (offset < length and IsASCIIChar(data[offset]))
+        ++offset;
+    return offset;
+}
+
+
+// \return The offset of the first byte that is not part of a valid UTF-8 sequence or "length" if there is none.
+size_t FindFirstInvalidUTF8Byte(const char * const data, const size_t length) {
+    const char *cp(data);
+    const char * const end(data + length);
+    for (;;) {
+        cp += CountLeadingASCIIChars(cp, end - cp);
+        if (cp == end)
+            return length;
+        uint32_t code_point;
+        if (unlikely(not DecodeUTF8CodePoint(&cp, end, &code_point)))
+            return cp - data;
+    }
+}
+
+
+#if defined(__x86_64__) or defined(__i386__)
+
+
+/* Vectorised UTF-8 validation following John Keiser and Daniel Lemire, "Validating UTF-8 In Less Than One Instruction
+   Per Byte", Software: Practice and Experience 51(5), 2021.  Three 16-entry table lookups, indexed by the high and low
+   nibbles of the previous byte and the high nibble of the current byte, classify every pair of adjacent bytes.  A
+   non-zero AND of the three lookups flags an error.  Missing or surplus continuation bytes for 3- and 4-byte sequences
+   are detected by looking back 2 and 3 bytes. */
+
+
+constexpr uint8_t TOO_SHORT(1u << 0u);      // 11______ 0_______ or 11______ 11______
+constexpr uint8_t TOO_LONG(1u << 1u);       // 0_______ 10______
+constexpr uint8_t OVERLONG_3(1u << 2u);     // 11100000 100_____
+constexpr uint8_t TOO_LARGE(1u << 3u);      // 11110100 1001____ etc.
+constexpr uint8_t SURROGATE(1u << 4u);      // 11101101 101_____
+constexpr uint8_t OVERLONG_2(1u << 5u);     // 1100000_ 10______
+constexpr uint8_t TOO_LARGE_1000(1u << 6u); // 11110101 1000____ etc.
+constexpr uint8_t OVERLONG_4(1u << 6u);     // 11110000 1000____
+constexpr uint8_t TWO_CONTS(1u << 7u);      // 10______ 10______
+constexpr uint8_t CARRY(TOO_SHORT | TOO_LONG | TWO_CONTS);
+
+
+// Indexed by the high nibble of the previous byte.
+alignas(16) constexpr uint8_t BYTE_1_HIGH_TABLE[16]{
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, // 0_______
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,                                     // 10______
+    TOO_SHORT | OVERLONG_2,                                                         // 1100____
+    TOO_SHORT,                                                                      // 1101____
+    TOO_SHORT | OVERLONG_3 | SURROGATE,                                             // 1110____
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4                             // 1111____
+};
+
+
+// Indexed by the low nibble of the previous byte.
+alignas(16) constexpr uint8_t BYTE_1_LOW_TABLE[16]{
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,    // ____0000
+    CARRY | OVERLONG_2,                              // ____0001
+    CARRY,                                           // ____0010
+    CARRY,                                           // ____0011
+    CARRY | TOO_LARGE,                               // ____0100
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____0101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____0110
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____0111
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1000
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1001
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1010
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1011
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1100
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,  // ____1101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,              // ____1110
+    CARRY | TOO_LARGE | TOO_LARGE_1000               // ____1111
+};
+
+
+// Indexed by the high nibble of the current byte.
+alignas(16) constexpr uint8_t BYTE_2_HIGH_TABLE[16]{
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, // 0_______
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,          // 1000____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,                            // 1001____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                              // 1010____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,                              // 1011____
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT                                              // 11______
+};
+
+
+// Used to detect a sequence that is cut off by the end of the input: the last byte must be < 0xC0, the next-to-last < 0xE0
+// and the one before that < 0xF0.
+alignas(32) constexpr uint8_t INCOMPLETE_SEQUENCE_THRESHOLDS[32]{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+
+#define SSE4_TARGET __attribute__((target("sse4.1")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+
+SSE4_TARGET inline __m128i CheckUTF8Block(const __m128i input, const __m128i previous_input) {
+    const __m128i nibble_mask(_mm_set1_epi8(0x0F));
+    const __m128i previous1(_mm_alignr_epi8(input, previous_input, 16 - 1));
+    const __m128i byte_1_high(_mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(BYTE_1_HIGH_TABLE)),
+                                               _mm_and_si128(_mm_srli_epi16(previous1, 4), nibble_mask)));
+    const __m128i byte_1_low(
+        _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(BYTE_1_LOW_TABLE)), _mm_and_si128(previous1, nibble_mask)));
+    const __m128i byte_2_high(_mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i *>(BYTE_2_HIGH_TABLE)),
+                                               _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask)));
+    const __m128i special_cases(_mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high));
+
+    const __m128i previous2(_mm_alignr_epi8(input, previous_input, 16 - 2));
+    const __m128i previous3(_mm_alignr_epi8(input, previous_input, 16 - 3));
+    const __m128i is_third_byte(_mm_subs_epu8(previous2, _mm_set1_epi8(static_cast<char>(0xE0u - 0x80u))));
+    const __m128i is_fourth_byte(_mm_subs_epu8(previous3, _mm_set1_epi8(static_cast<char>(0xF0u - 0x80u))));
+    const __m128i must_be_continuation(_mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80u))));
+
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+
+SSE4_TARGET bool IsValidUTF8SSE4(const char * const data, const size_t length) {
+    const __m128i incomplete_sequence_thresholds(_mm_load_si128(reinterpret_cast<const __m128i *>(INCOMPLETE_SEQUENCE_THRESHOLDS + 16)));
+    __m128i error(_mm_setzero_si128()), previous_input(_mm_setzero_si128()), previous_incomplete(_mm_setzero_si128());
+
+    size_t offset(0);
+    alignas(16) char last_block[16];
+    while (offset < length) {
+        __m128i input;
+        if (offset + 16 <= length)
+            input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + offset));
+        else {
+            std::memset(last_block, 0, sizeof(last_block));
+            std::memcpy(last_block, data + offset, length - offset);
+            input = _mm_load_si128(reinterpret_cast<const __m128i *>(last_block));
+        }
+        offset += 16;
+
+        if (_mm_movemask_epi8(input) == 0) // Pure ASCII block.
+            error = _mm_or_si128(error, previous_incomplete);
+        else {
+            error = _mm_or_si128(error, CheckUTF8Block(input, previous_input));
+            previous_incomplete = _mm_subs_epu8(input, incomplete_sequence_thresholds);
+        }
+        previous_input = input;
+    }
+    error = _mm_or_si128(error, previous_incomplete);
+
+    return _mm_testz_si128(error, error) == 1;
+}
+
+
+AVX2_TARGET inline __m256i AlignRight256(const __m256i input, const __m256i previous_input, const int shift) {
+    // Combines the upper lane of "previous_input" with the lower lane of "input" so that we can shift across lanes.
+    const __m256i straddle(_mm256_permute2x128_si256(previous_input, input, 0x21));
+    switch (shift) {
+    case 1:
+        return _mm256_alignr_epi8(input, straddle, 16 - 1);
+    case 2:
+        return _mm256_alignr_epi8(input, straddle, 16 - 2);
+    default:
+        return _mm256_alignr_epi8(input, straddle, 16 - 3);
+    }
+}
+
+
+AVX2_TARGET inline __m256i Load16ByteTableTwice(const uint8_t * const table) {
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(table)));
+}
+
+
+AVX2_TARGET inline __m256i CheckUTF8Block(const __m256i input, const __m256i previous_input) {
+    const __m256i nibble_mask(_mm256_set1_epi8(0x0F));
+    const __m256i previous1(AlignRight256(input, previous_input, 1));
+    const __m256i byte_1_high(
+        _mm256_shuffle_epi8(Load16ByteTableTwice(BYTE_1_HIGH_TABLE), _mm256_and_si256(_mm256_srli_epi16(previous1, 4), nibble_mask)));
+    const __m256i byte_1_low(_mm256_shuffle_epi8(Load16ByteTableTwice(BYTE_1_LOW_TABLE), _mm256_and_si256(previous1, nibble_mask)));
+    const __m256i byte_2_high(
+        _mm256_shuffle_epi8(Load16ByteTableTwice(BYTE_2_HIGH_TABLE), _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask)));
+    const __m256i special_cases(_mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high));
+
+    const __m256i previous2(AlignRight256(input, previous_input, 2));
+    const __m256i previous3(AlignRight256(input, previous_input, 3));
+    const __m256i is_third_byte(_mm256_subs_epu8(previous2, _mm256_set1_epi8(static_cast<char>(0xE0u - 0x80u))));
+    const __m256i is_fourth_byte(_mm256_subs_epu8(previous3, _mm256_set1_epi8(static_cast<char>(0xF0u - 0x80u))));
+    const __m256i must_be_continuation(
+        _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80u))));
+
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+
+AVX2_TARGET bool IsValidUTF8AVX2(const char * const data, const size_t length) {
+    const __m256i incomplete_sequence_thresholds(_mm256_load_si256(reinterpret_cast<const __m256i *>(INCOMPLETE_SEQUENCE_THRESHOLDS)));
+    __m256i error(_mm256_setzero_si256()), previous_input(_mm256_setzero_si256()), previous_incomplete(_mm256_setzero_si256());
+
+    size_t offset(0);
+    alignas(32) char last_block[32];
+    while (offset < length) {
+        __m256i input;
+        if (offset + 32 <= length)
+            input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + offset));
+        else {
+            std::memset(last_block, 0, sizeof(last_block));
+            std::memcpy(last_block, data + offset, length - offset);
+            input = _mm256_load_si256(reinterpret_cast<const __m256i *>(last_block));
+        }
+        offset += 32;
+
+        if (_mm256_movemask_epi8(input) == 0) // Pure ASCII block.
+            error = _mm256_or_si256(error, previous_incomplete);
+        else {
+            error = _mm256_or_si256(error, CheckUTF8Block(input, previous_input));
+            previous_incomplete = _mm256_subs_epu8(input, incomplete_sequence_thresholds);
+        }
+        previous_input = input;
+    }
+    error = _mm256_or_si256(error, previous_incomplete);
+
+    return _mm256_testz_si256(error, error) == 1;
+}
+
+
+#undef SSE4_TARGET
+#undef AVX2_TARGET
+
+
+#endif // defined(__x86_64__) or defined(__i386__)
+
+
+bool IsValidUTF8Scalar(const char * const data, const size_t length) {
+    return FindFirstInvalidUTF8Byte(data, length) == length;
+}
+
+
+using UTF8Validator = bool (*)(const char * const data, const size_t length);
+
+
+UTF8Validator SelectUTF8Validator() {
+#if defined(__x86_64__) or defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return IsValidUTF8AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return IsValidUTF8SSE4;
+#endif
+    return IsValidUTF8Scalar;
+}
+
+
+const UTF8Validator utf8_validator(SelectUTF8Validator());
+
+
+// Precomputed UTF-8 encodings of all ISO-8859-1 or ISO-8859-15 characters with the high bit set.
+class HighHalfToUTF8Table {
+    char utf8_[128][3];
+    uint8_t lengths_[128];
+
+public:
+    explicit HighHalfToUTF8Table(const bool latin9);
+    inline void append(const char ch, std::string * const utf8_string) const {
+        const unsigned index(static_cast<unsigned char>(ch) - 0x80u);
+        utf8_string->append(utf8_[index], lengths_[index]);
+    }
+};
+
+
+HighHalfToUTF8Table::HighHalfToUTF8Table(const bool latin9) {
+    for (unsigned ch(0x80); ch <= 0xFF; ++ch) {
+        const std::string utf8(latin9 ? StringUtil::ISO8859_15ToUTF8(static_cast<char>(ch)) : UTF32ToUTF8(ch));
+        std::memcpy(utf8_[ch - 0x80], utf8.data(), utf8.size());
+        lengths_[ch - 0x80] = static_cast<uint8_t>(utf8.size());
+    }
+}
+
+
+void SingleByteToUTF8(const HighHalfToUTF8Table &high_half_to_utf8_table, const char *data, const size_t length,
+                      std::string * const utf8_string) {
+    utf8_string->clear();
+    utf8_string->reserve(length + length / 8);
+
+    const char * const end(data + length);
+    while (data != end) {
+        const size_t ascii_run_length(CountLeadingASCIIChars(data, end - data));
+        utf8_string->append(data, ascii_run_length);
+        data += ascii_run_length;
+        if (data != end)
+            high_half_to_utf8_table.append(*data++, utf8_string);
+    }
+}
+
+
+} // unnamed namespace
+
+
+bool IsASCII(const char *data, const size_t length) {
+    const char * const end(data + length);
+#ifdef __SSE2__
+    for (/* Intentionally empty! */; end - data >= 64; data += 64) {
+        const __m128i chunk1(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)));
+        const __m128i chunk2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16)));
+        const __m128i chunk3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32)));
+        const __m128i chunk4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48)));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(chunk1, chunk2), _mm_or_si128(chunk3, chunk4))) != 0)
+            return false;
+    }
+    for (/* Intentionally empty! */; end - data >= 16; data += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data))) != 0)
+            return false;
+    }
+#else
+    for (/* Intentionally empty! */; end - data >= 8; data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        if ((word & 0x8080808080808080ull) != 0)
+            return false;
+    }
+#endif
+    for (/* Intentionally empty! */; data != end; ++data) {
+        if (not IsASCIIChar(*data))
+            return false;
+    }
+
+    return true;
+}
+
+
+bool UTF8ToLower(const std::string &utf8_string, std::string * const lowercase_utf8_string) {
+    if (IsASCII(utf8_string)) {
+        lowercase_utf8_string->resize(utf8_string.size());
+        std::transform(utf8_string.cbegin(), utf8_string.cend(), lowercase_utf8_string->begin(), ASCIIToLower);
+        return true;
+    }
+
+    const CaseMappingTables &case_mapping_tables(GetCaseMappingTables());
+    return MapUTF8CodePoints(utf8_string, lowercase_utf8_string,
+                             [&case_mapping_tables](const uint32_t code_point) { return case_mapping_tables.toLower(code_point); });
 }
 
 
 std::string UTF8ToLower(std::string * const utf8_string) {
+    if (IsASCII(*utf8_string)) {
+        std::transform(utf8_string->begin(), utf8_string->end(), utf8_string->begin(), ASCIIToLower);
+        return *utf8_string;
+    }
+
     std::string converted_string;
     if (unlikely(not UTF8ToLower(*utf8_string, &converted_string)))
         throw std::runtime_error("in TextUtil::UTF8ToLower: failed to convert a string \"" + CStyleEscape(*utf8_string)
@@ -329,24 +825,24 @@ std::string UTF8ToLower(std::string * const utf8_string) {
 
 
 bool UTF8ToUpper(const std::string &utf8_string, std::string * const uppercase_utf8_string) {
-    std::wstring wchar_string;
-    if (not UTF8ToWCharString(utf8_string, &wchar_string))
-        return false;
-
-    // Uppercase the wide character string:
-    std::wstring uppercase_wide_string;
-    for (const auto wide_ch : wchar_string) {
-        if (std::iswlower(static_cast<wint_t>(wide_ch)))
-            uppercase_wide_string += std::towupper(static_cast<wint_t>(wide_ch));
-        else
-            uppercase_wide_string += wide_ch;
+    if (IsASCII(utf8_string)) {
+        uppercase_utf8_string->resize(utf8_string.size());
+        std::transform(utf8_string.cbegin(), utf8_string.cend(), uppercase_utf8_string->begin(), ASCIIToUpper);
+        return true;
     }
 
-    return WCharToUTF8String(uppercase_wide_string, uppercase_utf8_string);
+    const CaseMappingTables &case_mapping_tables(GetCaseMappingTables());
+    return MapUTF8CodePoints(utf8_string, uppercase_utf8_string,
+                             [&case_mapping_tables](const uint32_t code_point) { return case_mapping_tables.toUpper(code_point); });
 }
 
 
 std::string UTF8ToUpper(std::string * const utf8_string) {
+    if (IsASCII(*utf8_string)) {
+        std::transform(utf8_string->begin(), utf8_string->end(), utf8_string->begin(), ASCIIToUpper);
+        return *utf8_string;
+    }
+
     std::string converted_string;
     if (unlikely(not UTF8ToUpper(*utf8_string, &converted_string)))
         throw std::runtime_error("in TextUtil::UTF8ToUpper: failed to convert a string to lowercase!");
@@ -534,37 +1030,30 @@ bool ChopIntoWords(const std::string &text, std::vector<std::string> * const wor
 
 
 // See https://en.wikipedia.org/wiki/UTF-8 in order to understand the implementation.
+bool IsValidUTF8(const char * const data, const size_t length) {
+    return utf8_validator(data, length);
+}
+
+
 bool IsValidUTF8(const std::string &utf8_candidate) {
-    for (std::string::const_iterator ch(utf8_candidate.begin()); ch != utf8_candidate.end(); ++ch) {
-        const unsigned char uch(static_cast<unsigned char>(*ch));
-        unsigned sequence_length;
-        if ((uch & 0b10000000) == 0b00000000)
-            sequence_length = 0;
-        else if ((uch & 0b11100000) == 0b11000000)
-            sequence_length = 1;
-        else if ((uch & 0b11110000) == 0b11100000)
-            sequence_length = 2;
-        else if ((uch & 0b11111000) == 0b11110000)
-            sequence_length = 3;
-        else {
-            LOG_DEBUG("bad sequence start character: 0x" + StringUtil::ToHexString(uch));
-            return false;
-        }
+    if (likely(utf8_validator(utf8_candidate.data(), utf8_candidate.size())))
+        return true;
 
-        for (unsigned i(0); i < sequence_length; ++i) {
-            ++ch;
-            if (unlikely(ch == utf8_candidate.end())) {
-                LOG_DEBUG("premature string end in the middle of a UTF8 byte sequence!");
-                return false;
-            }
-            if (unlikely((static_cast<unsigned char>(*ch) & 0b11000000) != 0b10000000)) {
-                LOG_DEBUG("unexpected upper-bit pattern in a UFT8 sequence: 0x" + StringUtil::ToHexString(static_cast<uint8_t>(*ch)));
-                return false;
-            }
-        }
-    }
+    LOG_DEBUG("invalid UTF-8 sequence at byte offset " + std::to_string(FindFirstInvalidUTF8Byte(utf8_candidate.data(), utf8_candidate.size()))
+              + "!");
+    return false;
+}
 
-    return true;
+
+void Latin1ToUTF8(const char * const data, const size_t length, std::string * const utf8_string) {
+    static const HighHalfToUTF8Table latin1_high_half_to_utf8_table(/* latin9 = */ false);
+    SingleByteToUTF8(latin1_high_half_to_utf8_table, data, length, utf8_string);
+}
+
+
+void Latin9ToUTF8(const char * const data, const size_t length, std::string * const utf8_string) {
+    static const HighHalfToUTF8Table latin9_high_half_to_utf8_table(/* latin9 = */ true);
+    SingleByteToUTF8(latin9_high_half_to_utf8_table, data, length, utf8_string);
 }
 
 
@@ -1147,7 +1636,27 @@ const std::unordered_set<uint32_t> UNICODE_WHITESPACE{ 0x0009, 0x000A, 0x000B, 0
 
 
 static std::string &CollapseWhitespaceHelper(std::string * const utf8_string, const bool last_char_was_whitespace_initial_state) {
+    // Pure ASCII strings can be collapsed in place:
+    if (IsASCII(*utf8_string)) {
+        bool last_char_was_whitespace(last_char_was_whitespace_initial_state);
+        auto out(utf8_string->begin());
+        for (const char ch : *utf8_string) {
+            if (isspace(ch)) {
+                if (not last_char_was_whitespace) {
+                    last_char_was_whitespace = true;
+                    *out++ = ' ';
+                }
+            } else {
+                last_char_was_whitespace = false;
+                *out++ = ch;
+            }
+        }
+        utf8_string->erase(out, utf8_string->end());
+        return *utf8_string;
+    }
+
     std::string collapsed_string;
+    collapsed_string.reserve(utf8_string->size());
 
     UTF8ToUTF32Decoder utf8_to_utf32_decoder;
     bool last_char_was_whitespace(last_char_was_whitespace_initial_state);
@@ -1171,12 +1680,7 @@ static std::string &CollapseWhitespaceHelper(std::string * const utf8_string, co
                         collapsed_string += ' ';
                     }
                 } else {
-                    std::string utf8;
-                    if (unlikely(not WCharToUTF8String(utf32_char, &utf8))) {
-                        LOG_WARNING("WCharToUTF8String failed! (Character was " + std::to_string(utf32_char) + ")");
-                        return *utf8_string;
-                    }
-                    collapsed_string += utf8;
+                    AppendUTF8(utf32_char, &collapsed_string);
                     last_char_was_whitespace = false;
                 }
             }
@@ -1587,19 +2091,17 @@ bool IsSomeKindOfDash(const uint32_t ch) {
 
 
 std::string &NormaliseDashes(std::string * const s) {
-    std::vector<uint32_t> utf32_string;
-    if (unlikely(not UTF8ToUTF32(*s, &utf32_string)))
+    // All dashes other than the ASCII minus sign are non-ASCII characters:
+    if (IsASCII(*s))
+        return *s;
+
+    std::string normalised_string;
+    if (unlikely(not MapUTF8CodePoints(*s, &normalised_string, [](const uint32_t code_point) {
+            return IsSomeKindOfDash(code_point) ? static_cast<uint32_t>('-') /* ASCII minus sign */ : code_point;
+        })))
         LOG_ERROR("can't convert from UTF-8 to UTF-32!");
 
-    for (auto &utf32_char : utf32_string) {
-        if (IsSomeKindOfDash(utf32_char))
-            utf32_char = '-'; // ASCII minus sign.
-    }
-
-    s->clear();
-    for (const auto utf32_char : utf32_string)
-        s->append(UTF32ToUTF8(utf32_char));
-
+    s->swap(normalised_string);
     return *s;
 }
 
@@ -1657,29 +2159,49 @@ static const std::map<wchar_t, wchar_t> char_with_diacritics_to_char_without_dia
 };
 
 
+// A flat version of char_with_diacritics_to_char_without_diarcritics_map, indexed by code point.
+static const std::vector<wchar_t> &GetDiacriticsRemovalTable() {
+    static const std::vector<wchar_t> diacritics_removal_table([] {
+        std::vector<wchar_t> table(static_cast<size_t>(char_with_diacritics_to_char_without_diarcritics_map.crbegin()->first) + 1);
+        for (size_t code_point(0); code_point < table.size(); ++code_point)
+            table[code_point] = static_cast<wchar_t>(code_point);
+        for (const auto &[char_with_diacritics, char_without_diacritics] : char_with_diacritics_to_char_without_diarcritics_map)
+            table[static_cast<size_t>(char_with_diacritics)] = char_without_diacritics;
+        return table;
+    }());
+
+    return diacritics_removal_table;
+}
+
+
+static inline wchar_t RemoveDiacritics(const std::vector<wchar_t> &diacritics_removal_table, const wchar_t wchar) {
+    return static_cast<size_t>(wchar) < diacritics_removal_table.size() ? diacritics_removal_table[static_cast<size_t>(wchar)] : wchar;
+}
+
+
 std::wstring RemoveDiacritics(const std::wstring &string) {
+    const auto &diacritics_removal_table(GetDiacriticsRemovalTable());
+
     std::wstring wstring_without_diacritics;
-    for (const auto wchar : string) {
-        const auto char_with_and_without_diacritics(char_with_diacritics_to_char_without_diarcritics_map.find(wchar));
-        if (likely(char_with_and_without_diacritics == char_with_diacritics_to_char_without_diarcritics_map.cend()))
-            wstring_without_diacritics += wchar;
-        else
-            wstring_without_diacritics += char_with_and_without_diacritics->second;
-    }
+    wstring_without_diacritics.reserve(string.size());
+    for (const auto wchar : string)
+        wstring_without_diacritics += RemoveDiacritics(diacritics_removal_table, wchar);
 
     return wstring_without_diacritics;
 }
 
 
 std::string RemoveDiacritics(const std::string &utf8_string) {
-    std::wstring wstring;
-    if (unlikely(not UTF8ToWCharString(utf8_string, &wstring)))
-        LOG_ERROR("failed to convert a UTF8 string to a wide character string!");
+    // None of the characters w/ diacritics is an ASCII character:
+    if (IsASCII(utf8_string))
+        return utf8_string;
 
-    const auto wstring_without_diacritics(RemoveDiacritics(wstring));
+    const auto &diacritics_removal_table(GetDiacriticsRemovalTable());
     std::string utf8_without_diacritics;
-    if (unlikely(not WCharToUTF8String(wstring_without_diacritics, &utf8_without_diacritics)))
-        LOG_ERROR("failed to convert a wide character string to a UTF8 string!");
+    if (unlikely(not MapUTF8CodePoints(utf8_string, &utf8_without_diacritics, [&diacritics_removal_table](const uint32_t code_point) {
+            return static_cast<uint32_t>(RemoveDiacritics(diacritics_removal_table, static_cast<wchar_t>(code_point)));
+        })))
+        LOG_ERROR("failed to convert a UTF8 string to a wide character string!");
 
     return utf8_without_diacritics;
 }
@@ -33,6 +33,7 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <cstdio>
@@ -202,7 +203,137 @@ time_t StringToTimeT(const std::string &time_str, const std::string &format) {
 }
 
 
+namespace {
+
+
+// \return The number of days between 1970-01-01 and the given date of the proleptic Gregorian calendar.  "day" may be outside
+//         of the range of valid days of "month", in which case we count from the first day of "month".
+// \note   See http://howardhinnant.github.io/date_algorithms.html#days_from_civil for an explanation of the algorithm.
+inline int64_t DaysFromCivil(int64_t year, const unsigned month, const int64_t day) {
+    year -= month <= 2;
+    const int64_t era((year >= 0 ? year : year - 399) / 400);
+    const int64_t year_of_era(year - era * 400);
+    const int64_t day_of_year((153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1);
+    const int64_t day_of_era(year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year);
+    return era * 146097 + day_of_era - 719468;
+}
+
+
+// Parses exactly "digit_count" digits.
+inline bool ParseFixedWidthNumber(const char *&cp, const char * const end, const unsigned digit_count, unsigned * const number) {
+    if (unlikely(end - cp < static_cast<ptrdiff_t>(digit_count)))
+        return false;
+
+    *number = 0;
+    for (const char * const number_end(cp + digit_count); cp != number_end; ++cp) {
+        if (unlikely(not StringUtil::IsDigit(*cp)))
+            return false;
+        *number = *number * 10 + (*cp - '0');
+    }
+
+    return true;
+}
+
+
+inline bool ParseFixedWidthNumber(const char *&cp, const char * const end, const unsigned digit_count, const unsigned min_value,
+                                  const unsigned max_value, int * const number) {
+    unsigned unsigned_number;
+    if (not ParseFixedWidthNumber(cp, end, digit_count, &unsigned_number) or unsigned_number < min_value
+        or unsigned_number > max_value)
+        return false;
+    *number = static_cast<int>(unsigned_number);
+    return true;
+}
+
+
+/** \brief  An allocation- and locale-free replacement of strptime(3) for formats that only consist of literal characters and
+ *          the conversions %Y, %y, %m, %d, %H, %M, %S and %T.
+ *  \return A pointer to the first character after the parsed input or nullptr if the input didn't match.
+ *  \note   Each conversion has to match the number of digits that strftime(3) would produce and the same value ranges as glibc's
+ *          strptime(3) apply, so that if we succeed, strptime(3) would have produced the same result.  Whitespace in the format
+ *          has to match literally.  The fields of "*tm" that don't correspond to a conversion are left alone.  Like glibc's
+ *          strptime(3) we also set tm_wday and tm_yday if the format has a year, a month and a day.
+ */
+const char *ParseNumericDateAndTime(const char *cp, const char * const end, const std::string_view format, struct tm * const tm) {
+    bool have_year(false), have_month(false), have_day(false);
+    for (auto format_ch(format.cbegin()); format_ch != format.cend(); ++format_ch) {
+        if (*format_ch != '%') {
+            if (cp == end or *cp != *format_ch)
+                return nullptr;
+            ++cp;
+            continue;
+        }
+
+        if (unlikely(++format_ch == format.cend()))
+            return nullptr;
+        switch (*format_ch) {
+        case 'Y':
+            if (not ParseFixedWidthNumber(cp, end, 4, 0, 9999, &tm->tm_year))
+                return nullptr;
+            tm->tm_year -= 1900;
+            have_year = true;
+            break;
+        case 'y':
+            if (not ParseFixedWidthNumber(cp, end, 2, 0, 99, &tm->tm_year))
+                return nullptr;
+            if (tm->tm_year < 69)
+                tm->tm_year += 100;
+            have_year = true;
+            break;
+        case 'm':
+            if (not ParseFixedWidthNumber(cp, end, 2, 1, 12, &tm->tm_mon))
+                return nullptr;
+            --tm->tm_mon;
+            have_month = true;
+            break;
+        case 'd':
+            if (not ParseFixedWidthNumber(cp, end, 2, 1, 31, &tm->tm_mday))
+                return nullptr;
+            have_day = true;
+            break;
+        case 'H':
+            if (not ParseFixedWidthNumber(cp, end, 2, 0, 23, &tm->tm_hour))
+                return nullptr;
+            break;
+        case 'M':
+            if (not ParseFixedWidthNumber(cp, end, 2, 0, 59, &tm->tm_min))
+                return nullptr;
+            break;
+        case 'S':
+            if (not ParseFixedWidthNumber(cp, end, 2, 0, 61, &tm->tm_sec))
+                return nullptr;
+            break;
+        case 'T':
+            if (not ParseFixedWidthNumber(cp, end, 2, 0, 23, &tm->tm_hour) or cp == end or *cp++ != ':'
+                or not ParseFixedWidthNumber(cp, end, 2, 0, 59, &tm->tm_min) or cp == end or *cp++ != ':'
+                or not ParseFixedWidthNumber(cp, end, 2, 0, 61, &tm->tm_sec))
+                return nullptr;
+            break;
+        default:
+            return nullptr;
+        }
+    }
+
+    if (have_year and have_month and have_day) {
+        const int64_t days(DaysFromCivil(tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday));
+        tm->tm_wday = static_cast<int>(((days + 4 /* 1970-01-01 was a Thursday */) % 7 + 7) % 7);
+        tm->tm_yday = static_cast<int>(days - DaysFromCivil(tm->tm_year + 1900, 1, 1));
+    }
+
+    return cp;
+}
+
+
+} // unnamed namespace
+
+
+// N.B. Unless the month is out of range we calculate the result ourselves because switching the time zone is expensive and
+// not thread-safe.  The result is the same, mktime(3) in UTC normalises all other fields linearly, just like we do.
 time_t TimeGm(const struct tm &tm) {
+    if (likely(tm.tm_mon >= 0 and tm.tm_mon <= 11))
+        return DaysFromCivil(tm.tm_year + int64_t(1900), tm.tm_mon + 1, tm.tm_mday) * 86400 + tm.tm_hour * int64_t(3600)
+               + tm.tm_min * int64_t(60) + tm.tm_sec;
+
     const char * const saved_time_zone(::getenv("TZ"));
 
     // Set the time zone to UTC:
@@ -308,7 +439,7 @@ static void CorrectForSymbolicTimeZone(struct tm * const tm, const std::string &
 //        So, we need to override the behaviour on our end.
 //      - "%z" does not support a colon in the time zone offset on CentOS.
 //        So, we need to strip it out before we pass it to the function.
-static bool StringToStructTmHelper(std::string date_str, std::string optional_strptime_format, struct tm * const tm) {
+static bool GenericStringToStructTmHelper(std::string date_str, std::string optional_strptime_format, struct tm * const tm) {
     if (optional_strptime_format.empty()) {
         const auto unix_time(WebUtil::ParseWebDateAndTime(date_str));
         if (unix_time == TimeUtil::BAD_TIME_T)
@@ -364,6 +495,31 @@ static bool StringToStructTmHelper(std::string date_str, std::string optional_st
 }
 
 
+// Purely numeric formats w/ a date don't depend on the locale and can be handled by ParseNumericDateAndTime() if the date and
+// time components have their canonical widths, e.g. "%y%m%d" for the date in 008/00-05 or ISO_8601_FORMAT.  Everything else
+// we leave to GenericStringToStructTmHelper().
+static bool StringToStructTmHelper(const std::string &date_str, const std::string &optional_strptime_format, struct tm * const tm) {
+    std::string_view format(optional_strptime_format);
+    if (not format.empty() and format[0] == '(') { // Skip over the locale specification(s).
+        const size_t closing_paren_pos(format.find(')', 1));
+        if (closing_paren_pos != std::string_view::npos)
+            format.remove_prefix(closing_paren_pos + 1);
+    }
+
+    if (format.find('|') == std::string_view::npos and format.find("%d") != std::string_view::npos
+        and format.find("%m") != std::string_view::npos
+        and (format.find("%Y") != std::string_view::npos or format.find("%y") != std::string_view::npos))
+    {
+        std::memset(tm, 0, sizeof(*tm));
+        const char * const end(date_str.data() + date_str.size());
+        if (ParseNumericDateAndTime(date_str.data(), end, format, tm) == end)
+            return true;
+    }
+
+    return GenericStringToStructTmHelper(date_str, optional_strptime_format, tm);
+}
+
+
 bool ConvertFormat(const std::string &from_format, const std::string &to_format, std::string * const datetime, const TimeZone time_zone) {
     struct tm tm;
     if (not StringToStructTmHelper(*datetime, from_format, &tm))
@@ -379,10 +535,69 @@ bool ConvertFormat(const std::string &from_format, const std::string &to_format,
 }
 
 
+// Handles the forms that StringToBrokenDownTime() supports if all components have their canonical widths and are in range.
+// \return The same as StringToBrokenDownTime() or 0 if "possible_date" has to be left to sscanf(3).
+static unsigned CanonicalStringToBrokenDownTime(const std::string &possible_date, unsigned * const year, unsigned * const month,
+                                                unsigned * const day, unsigned * const hour, unsigned * const minute,
+                                                unsigned * const second, int * const hour_offset, int * const minute_offset,
+                                                bool * const is_definitely_zulu_time) {
+    const size_t length(possible_date.length());
+    if (length != 10 and length != 19 and length != 20 and length != 25)
+        return 0;
+
+    struct tm tm;
+    const char *cp(possible_date.data());
+    const char * const end(cp + length);
+    if ((cp = ParseNumericDateAndTime(cp, end, "%Y-%m-%d", &tm)) == nullptr)
+        return 0;
+    *year = tm.tm_year + 1900;
+    *month = tm.tm_mon + 1;
+    *day = tm.tm_mday;
+    if (length == 10) {
+        *hour = *minute = *second = 0;
+        *is_definitely_zulu_time = false;
+        return 3;
+    }
+
+    const char date_time_separator(*cp++);
+    if (date_time_separator != 'T' and date_time_separator != 't' and (date_time_separator != ' ' or length != 19))
+        return 0;
+    if ((cp = ParseNumericDateAndTime(cp, end, "%T", &tm)) == nullptr)
+        return 0;
+    *hour = tm.tm_hour;
+    *minute = tm.tm_min;
+    *second = tm.tm_sec;
+
+    if (length == 19) {
+        *is_definitely_zulu_time = false;
+        return 7;
+    }
+
+    *is_definitely_zulu_time = true;
+    if (length == 20)
+        return (*cp == 'Z' or *cp == 'z') ? 6 : 0;
+
+    const char plus_or_minus(*cp++);
+    unsigned unsigned_hour_offset, unsigned_minute_offset;
+    if ((plus_or_minus != '+' and plus_or_minus != '-') or not ParseFixedWidthNumber(cp, end, 2, &unsigned_hour_offset)
+        or *cp++ != ':' or not ParseFixedWidthNumber(cp, end, 2, &unsigned_minute_offset))
+        return 0;
+    *hour_offset = plus_or_minus == '-' ? -static_cast<int>(unsigned_hour_offset) : static_cast<int>(unsigned_hour_offset);
+    *minute_offset = plus_or_minus == '-' ? -static_cast<int>(unsigned_minute_offset) : static_cast<int>(unsigned_minute_offset);
+    return 9;
+}
+
+
 unsigned StringToBrokenDownTime(const std::string &possible_date, unsigned * const year, unsigned * const month, unsigned * const day,
                                 unsigned * const hour, unsigned * const minute, unsigned * const second, int * const hour_offset,
                                 int * const minute_offset, bool * const is_definitely_zulu_time) {
     *hour_offset = *minute_offset = 0;
+    const unsigned canonical_match_count(CanonicalStringToBrokenDownTime(possible_date, year, month, day, hour, minute, second,
+                                                                         hour_offset, minute_offset, is_definitely_zulu_time));
+    if (canonical_match_count != 0)
+        return canonical_match_count;
+    *hour_offset = *minute_offset = 0;
+
     char plus_or_minus[1 + 1];
     char space_or_t[1 + 1];
 
@@ -458,7 +673,7 @@ bool Iso8601StringToTimeT(const std::string &iso_time, time_t * const converted_
         tm_struct.tm_hour = hour - hour_offset;
         tm_struct.tm_min = minute - minute_offset;
         tm_struct.tm_sec = second;
-        *converted_time = ::timegm(&tm_struct);
+        *converted_time = TimeGm(tm_struct);
         if (*converted_time == static_cast<time_t>(-1)) {
             *err_msg = "cannot convert '" + iso_time + "' to a time_t!";
             return false;
@@ -479,7 +694,7 @@ bool Iso8601StringToTimeT(const std::string &iso_time, time_t * const converted_
         tm_struct.tm_hour = hour;
         tm_struct.tm_min = minute;
         tm_struct.tm_sec = second;
-        *converted_time = ::timegm(&tm_struct);
+        *converted_time = TimeGm(tm_struct);
         if (*converted_time == static_cast<time_t>(-1)) {
             *err_msg = "cannot convert '" + iso_time + "' to a time_t!";
             return false;
@@ -526,7 +741,7 @@ bool Iso8601StringToTimeT(const std::string &iso_time, time_t * const converted_
             if (unlikely(errno != 0))
                 LOG_ERROR("bad time conversion! (3)");
         } else
-            *converted_time = ::timegm(&tm_struct);
+            *converted_time = TimeGm(tm_struct);
         if (*converted_time == static_cast<time_t>(-1)) {
             *err_msg = "cannot convert '" + iso_time + "' to a time_t!";
             return false;
@@ -1032,9 +1247,83 @@ static bool ZoneAdjustment(const std::string &rfc822_zone, time_t * const adjust
 }
 
 
+// Handles "[Www,] D[D] Mmm YY[YY] hh:mm[:ss] (+hhmm|-hhmm|hhmm|ZONE)" w/o regexes and strptime(3).
+// \return False if "date_time_candidate" has to be left to the generic code in ParseRFC1123DateTime().
+static bool ParseCanonicalRFC1123DateTime(const std::string &date_time_candidate, time_t * const date_time) {
+    const char *cp(date_time_candidate.c_str());
+    const char *end(cp + date_time_candidate.length());
+    const char * const first_comma(reinterpret_cast<const char *>(std::memchr(cp, ',', end - cp)));
+    if (first_comma != nullptr)
+        cp = first_comma + 1;
+    while (cp != end and StringUtil::IsWhitespace(*cp))
+        ++cp;
+    while (cp != end and StringUtil::IsWhitespace(end[-1]))
+        --end;
+
+    struct tm tm;
+    std::memset(&tm, 0, sizeof tm);
+    if (end - cp < 2 or not StringUtil::IsDigit(*cp))
+        return false;
+    tm.tm_mday = *cp++ - '0';
+    if (StringUtil::IsDigit(*cp))
+        tm.tm_mday = tm.tm_mday * 10 + (*cp++ - '0');
+    if (tm.tm_mday < 1 or tm.tm_mday > 31 or cp == end or *cp++ != ' ')
+        return false;
+
+    static const char * const MONTH_NAMES[] = { "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec" };
+    if (end - cp < 4 or cp[3] != ' ')
+        return false;
+    tm.tm_mon = 0;
+    while (tm.tm_mon < 12 and ::strncasecmp(cp, MONTH_NAMES[tm.tm_mon], 3) != 0)
+        ++tm.tm_mon;
+    if (tm.tm_mon == 12)
+        return false;
+    cp += 4;
+
+    unsigned year;
+    if (ParseFixedWidthNumber(cp, end, 4, &year))
+        tm.tm_year = year - 1900;
+    else if (ParseFixedWidthNumber(cp, end, 2, &year))
+        tm.tm_year = (year < 69) ? year + 100 : year;
+    else
+        return false;
+    if (cp == end or *cp++ != ' ')
+        return false;
+
+    if (not ParseFixedWidthNumber(cp, end, 2, 0, 23, &tm.tm_hour) or cp == end or *cp++ != ':'
+        or not ParseFixedWidthNumber(cp, end, 2, 0, 59, &tm.tm_min))
+        return false;
+    if (cp != end and *cp == ':' and (++cp, not ParseFixedWidthNumber(cp, end, 2, 0, 61, &tm.tm_sec)))
+        return false;
+
+    // The time zone, either as "+hhmm" w/ an optional sign and optional leading spaces or as exactly one space followed by a name:
+    const char * const time_end(cp);
+    while (cp != end and *cp == ' ')
+        ++cp;
+    time_t local_differential_offset;
+    if (end - cp >= 4 and StringUtil::IsDigit(end[-1]) and StringUtil::IsDigit(end[-2]) and StringUtil::IsDigit(end[-3])
+        and StringUtil::IsDigit(end[-4]) and (end - cp == 4 or (end - cp == 5 and (*cp == '+' or *cp == '-'))))
+    {
+        local_differential_offset = ((end[-4] - '0') * 600 + (end[-3] - '0') * 60 + (end[-2] - '0') * 10 + (end[-1] - '0')) * 60;
+        if (*cp == '-')
+            local_differential_offset = -local_differential_offset;
+    } else if (cp == time_end + 1 and cp != end and std::find(cp, end, ' ') == end) {
+        if (not ZoneAdjustment(std::string(cp, end), &local_differential_offset))
+            return false;
+    } else
+        return false;
+
+    *date_time = TimeGm(tm) + local_differential_offset;
+    return true;
+}
+
+
 // In order to understand this insanity, have a look at section 5.1 of RFC822.  Please note that we also support 4-digit
 // years as specified by RFC1123.
 bool ParseRFC1123DateTime(const std::string &date_time_candidate, time_t * const date_time) {
+    if (ParseCanonicalRFC1123DateTime(date_time_candidate, date_time))
+        return true;
+
     const auto first_comma_pos(date_time_candidate.find(','));
     const std::string::size_type start_pos(first_comma_pos == std::string::npos ? 0 : first_comma_pos + 1);
     std::string simplified_candidate(StringUtil::TrimWhite(date_time_candidate.substr(start_pos)));
@@ -1101,17 +1390,24 @@ bool ParseRFC1123DateTime(const std::string &date_time_candidate, time_t * const
 
 
 bool ParseRFC3339DateTime(const std::string &date_time_candidate, time_t * const date_time) {
-    // Convert possible lowercase t and z to uppercase:
-    const std::string normalised_date_time_candidate(StringUtil::ASCIIToUpper(date_time_candidate));
-
     struct tm tm;
     std::memset(&tm, '\0', sizeof tm);
-    time_t rounded_second_offset;
-    const char *cp(::strptime(normalised_date_time_candidate.c_str(), "%Y-%m-%dT%H:%M:%S", &tm));
-    if (cp == nullptr) {
-        *date_time = BAD_TIME_T;
-        return false;
+    const char *cp(ParseNumericDateAndTime(date_time_candidate.c_str(), date_time_candidate.c_str() + date_time_candidate.length(),
+                                           "%Y-%m-%dT%H:%M:%S", &tm));
+    if (cp == nullptr) { // Not in canonical form, let strptime(3) have a go.
+        // Convert a possible lowercase t to uppercase:
+        const std::string normalised_date_time_candidate(StringUtil::ASCIIToUpper(date_time_candidate));
+
+        std::memset(&tm, '\0', sizeof tm);
+        const char * const normalised_cp(::strptime(normalised_date_time_candidate.c_str(), "%Y-%m-%dT%H:%M:%S", &tm));
+        if (normalised_cp == nullptr) {
+            *date_time = BAD_TIME_T;
+            return false;
+        }
+        cp = date_time_candidate.c_str() + (normalised_cp - normalised_date_time_candidate.c_str());
     }
+
+    time_t rounded_second_offset;
     if (*cp != '.')
         rounded_second_offset = 0;
     else { // Handle optional single-digit fractional second.
@@ -1126,7 +1422,7 @@ bool ParseRFC3339DateTime(const std::string &date_time_candidate, time_t * const
     }
 
     // If the input format is correct cp now either points to the final Z or the sign of the optional time offset.
-    if (*cp == 'Z') {
+    if (*cp == 'Z' or *cp == 'z') {
         *date_time = TimeGm(tm) + rounded_second_offset;
         return true;
     } else if (*cp == '+' or *cp == '-') {
@@ -1157,7 +1453,7 @@ std::string StructTmToString(const struct tm &tm) {
 }
 
 
-struct tm StringToStructTm(std::string date_str, std::string optional_strptime_format) {
+struct tm StringToStructTm(const std::string &date_str, const std::string &optional_strptime_format) {
     struct tm tm;
     if (likely(StringToStructTmHelper(date_str, optional_strptime_format, &tm)))
         return tm;
@@ -1166,7 +1462,7 @@ struct tm StringToStructTm(std::string date_str, std::string optional_strptime_f
 }
 
 
-bool StringToStructTm(struct tm * const tm, std::string date_str, std::string optional_strptime_format) {
+bool StringToStructTm(struct tm * const tm, const std::string &date_str, const std::string &optional_strptime_format) {
     return StringToStructTmHelper(date_str, optional_strptime_format, tm);
 }
 
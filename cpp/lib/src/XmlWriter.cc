@@ -27,6 +27,9 @@
 
 #include "XmlWriter.h"
 #include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "Compiler.h"
 #include "StringUtil.h"
 
@@ -278,25 +281,25 @@ XmlWriter &XmlWriter::endl(XmlWriter &xml_writer) {
 std::string XmlWriter::XmlEscape(const std::string &s, const TextConversionType text_conversion_type,
                                  const std::string &additional_escapes) {
     std::string escaped_string;
-
-    // for performance, set this here so empty() doesn't have to be checked all the time:
-    const bool additional(not additional_escapes.empty());
-
-    for (const auto ch : s) {
-        if (ch == '<')
-            escaped_string += "&lt;";
-        else if (ch == '>')
-            escaped_string += "&gt;";
-        else if (ch == '&')
-            escaped_string += "&amp;";
-        else if (ch == '"')
-            escaped_string += "&quot;";
-        else if (ch == '\'')
-            escaped_string += "&apos;";
-        else if (additional and additional_escapes.find(ch) != std::string::npos)
-            escaped_string += StringUtil::Format("&#%04d;", ch);
-        else
-            escaped_string += ch;
+    if (additional_escapes.empty())
+        AppendXmlEscaped(s, &escaped_string);
+    else {
+        for (const auto ch : s) {
+            if (ch == '<')
+                escaped_string += "&lt;";
+            else if (ch == '>')
+                escaped_string += "&gt;";
+            else if (ch == '&')
+                escaped_string += "&amp;";
+            else if (ch == '"')
+                escaped_string += "&quot;";
+            else if (ch == '\'')
+                escaped_string += "&apos;";
+            else if (additional_escapes.find(ch) != std::string::npos)
+                escaped_string += StringUtil::Format("&#%04d;", ch);
+            else
+                escaped_string += ch;
+        }
     }
 
     if (text_conversion_type == XmlWriter::ConvertFromIso8859_15)
@@ -304,3 +307,66 @@ std::string XmlWriter::XmlEscape(const std::string &s, const TextConversionType
     else
         return escaped_string;
 }
+
+
+namespace {
+
+
+inline bool IsXmlMetacharacter(const char ch) {
+    return ch == '<' or ch == '>' or ch == '&' or ch == '"' or ch == '\'';
+}
+
+
+// \return The first XML metacharacter in [text, end) or "end" if there is none.
+inline const char *FindXmlMetacharacter(const char *text, const char * const end) {
+#ifdef __SSE2__
+    const __m128i less_than(_mm_set1_epi8('<')), greater_than(_mm_set1_epi8('>')), ampersand(_mm_set1_epi8('&')),
+        double_quote(_mm_set1_epi8('"')), single_quote(_mm_set1_epi8('\''));
+    for (/* Intentionally empty! */; end - text >= 16; text += 16) {
+        const __m128i chunk(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text)));
+        const __m128i angle_brackets(_mm_or_si128(_mm_cmpeq_epi8(chunk, less_than), _mm_cmpeq_epi8(chunk, greater_than)));
+        const __m128i quotes(_mm_or_si128(_mm_cmpeq_epi8(chunk, double_quote), _mm_cmpeq_epi8(chunk, single_quote)));
+        const int matches(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(angle_brackets, quotes), _mm_cmpeq_epi8(chunk, ampersand))));
+        if (matches != 0)
+            return text + __builtin_ctz(static_cast<unsigned>(matches));
+    }
+#endif
+    for (/* Intentionally empty! */; text != end; ++text) {
+        if (IsXmlMetacharacter(*text))
+            return text;
+    }
+    return end;
+}
+
+
+} // unnamed namespace
+
+
+void XmlWriter::AppendXmlEscaped(const std::string_view unescaped_text, std::string * const output) {
+    const char *text(unescaped_text.data());
+    const char * const end(text + unescaped_text.size());
+    for (;;) {
+        const char * const metacharacter(FindXmlMetacharacter(text, end));
+        output->append(text, metacharacter - text);
+        if (metacharacter == end)
+            return;
+
+        switch (*metacharacter) {
+        case '<':
+            output->append("&lt;");
+            break;
+        case '>':
+            output->append("&gt;");
+            break;
+        case '&':
+            output->append("&amp;");
+            break;
+        case '"':
+            output->append("&quot;");
+            break;
+        default:
+            output->append("&apos;");
+        }
+        text = metacharacter + 1;
+    }
+}
@@ -356,7 +356,7 @@ bool FilterEmptyAndCommentLines(std::string str) {
 const std::string AUTHOR_NAME_BLACKLIST(UBTools::GetTuelibPath() + "zotero-enhancement-maps/author_name_blacklist.txt");
 
 
-ThreadSafeRegexMatcher InitializeBlacklistedAuthorTokenMatcher() {
+std::vector<std::string> LoadEscapedBlacklistedAuthorTokens() {
     std::unordered_set<std::string> blacklisted_tokens, filtered_blacklisted_tokens;
     auto string_data(FileUtil::ReadStringOrDie(AUTHOR_NAME_BLACKLIST));
     StringUtil::Split(string_data, '\n', &blacklisted_tokens, /* suppress_empty_components = */ true);
@@ -364,28 +364,46 @@ ThreadSafeRegexMatcher InitializeBlacklistedAuthorTokenMatcher() {
     StlHelpers::Functional::Filter(blacklisted_tokens.begin(), blacklisted_tokens.end(), filtered_blacklisted_tokens,
                                    FilterEmptyAndCommentLines);
 
-    std::string match_pattern("\\b(");
-    bool is_first_token(true);
-    for (const auto &blacklisted_token : filtered_blacklisted_tokens) {
-        if (not is_first_token)
-            match_pattern += "|";
-        else
-            is_first_token = false;
-        match_pattern += RegexMatcher::Escape(blacklisted_token);
-    }
-    match_pattern += ")\\b";
+    std::vector<std::string> escaped_blacklisted_tokens;
+    for (const auto &blacklisted_token : filtered_blacklisted_tokens)
+        escaped_blacklisted_tokens.emplace_back(RegexMatcher::Escape(blacklisted_token));
+    return escaped_blacklisted_tokens;
+}
+
+
+const std::vector<std::string> ESCAPED_BLACKLISTED_AUTHOR_TOKENS(LoadEscapedBlacklistedAuthorTokens());
+const unsigned BLACKLISTED_AUTHOR_TOKEN_MATCHER_OPTIONS(ThreadSafeRegexMatcher::ENABLE_UTF8 | ThreadSafeRegexMatcher::ENABLE_UCP
+                                                        | ThreadSafeRegexMatcher::CASE_INSENSITIVE);
+
 
-    return ThreadSafeRegexMatcher(
-        match_pattern, ThreadSafeRegexMatcher::ENABLE_UTF8 | ThreadSafeRegexMatcher::ENABLE_UCP | ThreadSafeRegexMatcher::CASE_INSENSITIVE);
+ThreadSafeRegexMatcher InitializeBlacklistedAuthorTokenMatcher() {
+    return ThreadSafeRegexMatcher("\\b(" + StringUtil::Join(ESCAPED_BLACKLISTED_AUTHOR_TOKENS, '|') + ")\\b",
+                                  BLACKLISTED_AUTHOR_TOKEN_MATCHER_OPTIONS);
 }
 
 
 const ThreadSafeRegexMatcher BLACKLISTED_AUTHOR_TOKEN_MATCHER(InitializeBlacklistedAuthorTokenMatcher());
 
 
+// Most names contain none of the blacklisted tokens.  The literal prefilter of this set lets us skip the
+// BLACKLISTED_AUTHOR_TOKEN_MATCHER alternation for those.
+RegexSet InitializeBlacklistedAuthorTokenSet() {
+    std::vector<std::string> patterns;
+    for (const auto &escaped_blacklisted_token : ESCAPED_BLACKLISTED_AUTHOR_TOKENS)
+        patterns.emplace_back("\\b" + escaped_blacklisted_token + "\\b");
+    return RegexSet(patterns, BLACKLISTED_AUTHOR_TOKEN_MATCHER_OPTIONS);
+}
+
+
+const RegexSet BLACKLISTED_AUTHOR_TOKEN_SET(InitializeBlacklistedAuthorTokenSet());
+
+
 void StripBlacklistedTokensFromAuthorName(std::string * const first_name, std::string * const last_name) {
-    std::string first_name_buffer(BLACKLISTED_AUTHOR_TOKEN_MATCHER.replaceAll(*first_name, "")),
-        last_name_buffer(BLACKLISTED_AUTHOR_TOKEN_MATCHER.replaceAll(*last_name, ""));
+    std::string first_name_buffer(BLACKLISTED_AUTHOR_TOKEN_SET.matchAny(*first_name)
+                                      ? BLACKLISTED_AUTHOR_TOKEN_MATCHER.replaceAll(*first_name, "")
+                                      : *first_name),
+        last_name_buffer(BLACKLISTED_AUTHOR_TOKEN_SET.matchAny(*last_name) ? BLACKLISTED_AUTHOR_TOKEN_MATCHER.replaceAll(*last_name, "")
+                                                                            : *last_name);
 
     StringUtil::TrimWhite(&first_name_buffer);
     StringUtil::TrimWhite(&last_name_buffer);
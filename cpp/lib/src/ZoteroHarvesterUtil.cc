@@ -127,10 +127,10 @@ void ZoteroLogger::flushBufferAndPrintProgressImpl(const unsigned num_active_tas
 
 
 void ZoteroLogger::writeToBackingLog(const std::string &msg) {
+    // Goes through the asynchronous writer when it is enabled.  Our error() ends in ::Logger::error() which switches back to
+    // synchronous mode and thereby drains everything that was queued up to that point.
     std::lock_guard<std::mutex> locker(mutex_);
-    if (::write(getFileDescriptor(), msg.data(), msg.length()) != static_cast<ssize_t>(msg.length()))
-        LOG_ERROR("write(2) failed!");
-    ::fsync(getFileDescriptor());
+    ::Logger::writeString("", msg, /* format_message = */ false);
 }
 
 
@@ -229,7 +229,7 @@ void ZoteroLogger::info(const std::string &msg) {
 void ZoteroLogger::debug(const std::string &msg) {
     if (fatal_error_all_stop_.load())
         return;
-    else if ((min_log_level_ < LL_DEBUG) and (MiscUtil::SafeGetEnv("UTIL_LOG_DEBUG") != "true"))
+    else if ((min_log_level_ < LL_DEBUG) and not debug_environment_override_)
         return;
 
     const auto context(TASKLET_CONTEXT_MANAGER.getThreadLocalContext());
@@ -20,14 +20,20 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <thread>
 #include <cctype>
 #include <cerrno>
 #include <csignal>
 #include <cstdlib>
 #include <execinfo.h>
+#include <pthread.h>
 #include <signal.h>
 #include "Compiler.h"
 #include "FileLocker.h"
@@ -66,10 +72,294 @@ void HUPHandler(int /* signal_number*/) {
 char *progname; // Must be set in main() with "progname = argv[0];";
 
 
+// Writes "msg" to our log file descriptor with a single write(2) call.
+static void WriteToLogFileDescriptor(const std::string &msg) {
+    FileLocker file_locker(log_fd, FileLocker::READ_WRITE, 20 /* seconds */);
+    SignalUtil::SignalBlocker signal_blocker(SIGHUP);
+    if (unlikely(::write(log_fd, reinterpret_cast<const void *>(msg.data()), msg.size()) == -1)) {
+        const std::string error_message("in WriteToLogFileDescriptor(util.cc): write to file descriptor " + std::to_string(log_fd)
+                                        + " failed! (errno = " + std::to_string(errno) + ")");
+#pragma GCC diagnostic ignored "-Wunused-result"
+        ::write(STDERR_FILENO, error_message.data(), error_message.size());
+#pragma GCC diagnostic warning "-Wunused-result"
+        _exit(EXIT_FAILURE);
+    }
+}
+
+
+namespace {
+
+
+/** \brief A bounded single-producer/single-consumer queue of formatted log messages.
+ *  \note  The producer is the thread that owns the ring, the consumer is the asynchronous writer thread.  Neither side
+ *         ever takes a lock.
+ */
+class LogMessageRing {
+public:
+    struct Entry {
+        uint64_t sequence_no_;
+        std::string message_;
+    };
+
+private:
+    static constexpr size_t CAPACITY = 1024; // Must be a power of 2!
+    Entry entries_[CAPACITY];
+    alignas(64) std::atomic<size_t> head_; // Next entry to be consumed.
+    alignas(64) std::atomic<size_t> tail_; // Next entry to be produced.
+
+public:
+    std::atomic_bool owner_has_exited_;
+
+public:
+    LogMessageRing(): head_(0), tail_(0), owner_has_exited_(false) { }
+
+    inline bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+    inline bool isMoreThanHalfFull() const {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed) > CAPACITY / 2;
+    }
+
+    // May only be called by the owning thread.
+    bool tryPush(const uint64_t sequence_no, std::string * const message);
+
+    // May only be called by the writer thread.
+    void drain(std::vector<Entry> * const entries);
+};
+
+
+bool LogMessageRing::tryPush(const uint64_t sequence_no, std::string * const message) {
+    const size_t tail(tail_.load(std::memory_order_relaxed));
+    if (tail - head_.load(std::memory_order_acquire) == CAPACITY)
+        return false;
+
+    Entry &entry(entries_[tail & (CAPACITY - 1)]);
+    entry.sequence_no_ = sequence_no;
+    entry.message_.swap(*message);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+
+void LogMessageRing::drain(std::vector<Entry> * const entries) {
+    const size_t tail(tail_.load(std::memory_order_acquire));
+    size_t head(head_.load(std::memory_order_relaxed));
+    for (/* Intentionally empty! */; head != tail; ++head) {
+        Entry &entry(entries_[head & (CAPACITY - 1)]);
+        entries->emplace_back(Entry{ entry.sequence_no_, std::string() });
+        entries->back().message_.swap(entry.message_);
+    }
+    head_.store(tail, std::memory_order_release);
+}
+
+
+/** \brief Owns the per-thread rings and the background thread that writes their contents in batches.
+ *  \note  Instances are never deleted because threads may still log while static objects are being destroyed.
+ */
+class AsyncLogWriter {
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<LogMessageRing>> rings_;
+    std::mutex wakeup_mutex_;
+    std::condition_variable wakeup_condition_;
+    std::atomic_bool stop_requested_, wakeup_requested_;
+    std::atomic<uint64_t> next_sequence_no_, last_written_sequence_no_;
+    std::thread *writer_thread_;
+
+public:
+    AsyncLogWriter()
+        : stop_requested_(false), wakeup_requested_(false), next_sequence_no_(1), last_written_sequence_no_(0),
+          writer_thread_(nullptr) { }
+
+    void start();
+
+    // Stops the writer thread after it has written all pending messages.
+    void stop();
+
+    // Waits until all messages that were queued before this call have been written.
+    void flush();
+
+    void enqueue(std::string * const message);
+
+private:
+    void wakeup();
+    void run();
+
+    // \return True if at least one message was written.
+    bool writeBatch(std::vector<LogMessageRing::Entry> * const batch, std::string * const output_buffer);
+};
+
+
+// Registers the calling thread's ring with the writer and marks it as orphaned when the thread exits so that the writer
+// can discard it after writing the remaining messages.
+struct ThreadLocalRing {
+    std::shared_ptr<LogMessageRing> ring_;
+
+public:
+    ~ThreadLocalRing() {
+        if (ring_ != nullptr)
+            ring_->owner_has_exited_.store(true);
+    }
+};
+
+
+thread_local ThreadLocalRing thread_local_ring;
+AsyncLogWriter *async_log_writer;
+std::mutex async_log_writer_mutex;
+
+// The number of threads that are between checking for ASYNCHRONOUS mode and queueing their message.  Logger::setMode() waits
+// for them before it stops the writer thread, o/w their messages might arrive after the final batch has been written.
+std::atomic<unsigned> async_log_producer_count(0);
+
+
+void AsyncLogWriter::start() {
+    if (writer_thread_ != nullptr)
+        return;
+
+    stop_requested_.store(false);
+    writer_thread_ = new std::thread(&AsyncLogWriter::run, this);
+}
+
+
+void AsyncLogWriter::stop() {
+    if (writer_thread_ == nullptr)
+        return;
+
+    stop_requested_.store(true);
+    wakeup();
+    writer_thread_->join();
+    delete writer_thread_;
+    writer_thread_ = nullptr;
+
+    // Pick up anything that was queued while the writer thread was shutting down:
+    std::vector<LogMessageRing::Entry> batch;
+    std::string output_buffer;
+    writeBatch(&batch, &output_buffer);
+}
+
+
+void AsyncLogWriter::flush() {
+    if (writer_thread_ == nullptr)
+        return;
+
+    const uint64_t target_sequence_no(next_sequence_no_.load() - 1);
+    while (last_written_sequence_no_.load() < target_sequence_no) {
+        wakeup();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+
+void AsyncLogWriter::enqueue(std::string * const message) {
+    if (unlikely(thread_local_ring.ring_ == nullptr)) {
+        thread_local_ring.ring_ = std::make_shared<LogMessageRing>();
+        std::lock_guard<std::mutex> rings_locker(rings_mutex_);
+        rings_.emplace_back(thread_local_ring.ring_);
+    }
+
+    LogMessageRing &ring(*thread_local_ring.ring_);
+    const uint64_t sequence_no(next_sequence_no_.fetch_add(1));
+    while (not ring.tryPush(sequence_no, message)) {
+        // The writer thread can't keep up, we have to wait.
+        wakeup();
+        std::this_thread::yield();
+    }
+
+    if (ring.isMoreThanHalfFull())
+        wakeup();
+}
+
+
+void AsyncLogWriter::wakeup() {
+    wakeup_requested_.store(true);
+    wakeup_condition_.notify_one();
+}
+
+
+void AsyncLogWriter::run() {
+    std::vector<LogMessageRing::Entry> batch;
+    std::string output_buffer;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> wakeup_locker(wakeup_mutex_);
+            wakeup_condition_.wait_for(wakeup_locker, std::chrono::milliseconds(100),
+                                       [this] { return wakeup_requested_.load() or stop_requested_.load(); });
+            wakeup_requested_.store(false);
+        }
+
+        const bool stop_requested(stop_requested_.load());
+        while (writeBatch(&batch, &output_buffer))
+            /* Intentionally empty! */;
+        if (stop_requested)
+            return;
+    }
+}
+
+
+bool AsyncLogWriter::writeBatch(std::vector<LogMessageRing::Entry> * const batch, std::string * const output_buffer) {
+    const uint64_t last_sequence_no_before_draining(next_sequence_no_.load() - 1);
+
+    batch->clear();
+    {
+        std::lock_guard<std::mutex> rings_locker(rings_mutex_);
+        for (auto ring(rings_.begin()); ring != rings_.end();) {
+            const bool owner_has_exited((*ring)->owner_has_exited_.load());
+            (*ring)->drain(batch);
+            if (owner_has_exited and (*ring)->empty())
+                ring = rings_.erase(ring);
+            else
+                ++ring;
+        }
+    }
+
+    if (batch->empty()) {
+        last_written_sequence_no_.store(std::max(last_written_sequence_no_.load(), last_sequence_no_before_draining));
+        return false;
+    }
+
+    // Restore the global order in which the messages were logged:
+    std::sort(batch->begin(), batch->end(), [](const LogMessageRing::Entry &lhs, const LogMessageRing::Entry &rhs) {
+        return lhs.sequence_no_ < rhs.sequence_no_;
+    });
+
+    output_buffer->clear();
+    for (const auto &entry : *batch)
+        output_buffer->append(entry.message_);
+    WriteToLogFileDescriptor(*output_buffer);
+
+    if (last_written_sequence_no_.load() < batch->back().sequence_no_)
+        last_written_sequence_no_.store(batch->back().sequence_no_);
+    return true;
+}
+
+
+void StopAsyncLoggingAtExit() {
+    if (logger != nullptr)
+        logger->setMode(Logger::SYNCHRONOUS);
+}
+
+
+// Threads do not survive a fork(2), so the child has to fall back to writing synchronously.  We also abandon the
+// parent's queued messages as the parent is still going to write those itself.
+void ResetAsyncLoggingInChild() {
+    if (async_log_writer == nullptr)
+        return;
+
+    new (&async_log_writer_mutex) std::mutex();
+    async_log_writer = nullptr;
+    async_log_producer_count.store(0);
+    thread_local_ring.ring_.reset();
+    if (logger != nullptr)
+        logger->setMode(Logger::SYNCHRONOUS);
+}
+
+
+} // unnamed namespace
+
+
 const std::string Logger::FUNCTION_NAME_SEPARATOR(" --> ");
 
 
-Logger::Logger(): log_process_pids_(false), log_no_decorations_(false), log_strip_call_site_(false), min_log_level_(LL_INFO) {
+Logger::Logger()
+    : log_process_pids_(false), log_no_decorations_(false), log_strip_call_site_(false),
+      debug_environment_override_(MiscUtil::SafeGetEnv("UTIL_LOG_DEBUG") == "true"), min_log_level_(LL_INFO), mode_(SYNCHRONOUS) {
     log_fd = STDERR_FILENO;
     log_path = FileUtil::GetPathFromFileDescriptor(log_fd);
     SignalUtil::InstallHandler(SIGHUP, HUPHandler);
@@ -86,6 +376,49 @@ Logger::Logger(): log_process_pids_(false), log_no_decorations_(false), log_stri
         if (std::strstr(logger_format, "strip_call_site") != nullptr)
             log_strip_call_site_ = true;
     }
+
+    const char * const logger_mode(::getenv("LOGGER_MODE"));
+    if (logger_mode != nullptr and std::strcmp(logger_mode, "async") == 0)
+        setMode(ASYNCHRONOUS);
+}
+
+
+Logger::~Logger() {
+    setMode(SYNCHRONOUS);
+}
+
+
+void Logger::setMode(const Mode new_mode) {
+    std::lock_guard<std::mutex> async_log_writer_locker(async_log_writer_mutex);
+    if (new_mode == mode_.load())
+        return;
+
+    if (new_mode == ASYNCHRONOUS) {
+        if (async_log_writer == nullptr) {
+            async_log_writer = new AsyncLogWriter();
+            static std::once_flag exit_and_fork_handlers_installed;
+            std::call_once(exit_and_fork_handlers_installed, [] {
+                std::atexit(StopAsyncLoggingAtExit);
+                ::pthread_atfork(nullptr, nullptr, ResetAsyncLoggingInChild);
+            });
+        }
+        async_log_writer->start();
+        mode_.store(ASYNCHRONOUS);
+    } else {
+        mode_.store(SYNCHRONOUS);
+        if (async_log_writer != nullptr) {
+            while (async_log_producer_count.load() != 0)
+                std::this_thread::yield();
+            async_log_writer->stop();
+        }
+    }
+}
+
+
+void Logger::flush() {
+    std::lock_guard<std::mutex> async_log_writer_locker(async_log_writer_mutex);
+    if (mode_.load() == ASYNCHRONOUS)
+        async_log_writer->flush();
 }
 
 
@@ -96,12 +429,14 @@ void Logger::redirectOutput(const int new_fd) {
 
 
 void Logger::error(const std::string &msg) {
-    std::lock_guard<std::mutex> mutex_locker(mutex_);
-
     std::string error_message_string;
     if (errno != 0)
         error_message_string = " (last errno error code: " + std::string(std::strerror(errno)) + ")";
 
+    // Make sure that everything that was logged before the error makes it out before we terminate:
+    setMode(SYNCHRONOUS);
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+
     writeString("SEVERE", msg + error_message_string);
     if (::getenv("BACKTRACE") != nullptr) {
         const bool saved_log_no_decorations(log_no_decorations_);
@@ -120,8 +455,7 @@ void Logger::warning(const std::string &msg) {
     if (min_log_level_ < LL_WARNING)
         return;
 
-    std::lock_guard<std::mutex> mutex_locker(mutex_);
-    writeString("WARN", msg);
+    queueOrWriteString("WARN", msg);
 }
 
 
@@ -129,17 +463,26 @@ void Logger::info(const std::string &msg) {
     if (min_log_level_ < LL_INFO)
         return;
 
-    std::lock_guard<std::mutex> mutex_locker(mutex_);
-    writeString("INFO", msg);
+    queueOrWriteString("INFO", msg);
 }
 
 
 void Logger::debug(const std::string &msg) {
-    if ((min_log_level_ < LL_DEBUG) and (MiscUtil::SafeGetEnv("UTIL_LOG_DEBUG") != "true"))
+    if ((min_log_level_ < LL_DEBUG) and not debug_environment_override_)
         return;
 
-    std::lock_guard<std::mutex> mutex_locker(mutex_);
-    writeString("DEBUG", msg);
+    queueOrWriteString("DEBUG", msg);
+}
+
+
+void Logger::queueOrWriteString(const std::string &level, const std::string &msg) {
+    // In asynchronous mode the per-thread rings take care of the synchronisation.
+    if (mode_.load(std::memory_order_relaxed) == ASYNCHRONOUS)
+        writeString(level, msg);
+    else {
+        std::lock_guard<std::mutex> mutex_locker(mutex_);
+        writeString(level, msg);
+    }
 }
 
 
@@ -199,15 +542,15 @@ void Logger::writeString(const std::string &level, std::string msg, const bool f
     if (format_message)
         formatMessage(level, &msg);
 
-    FileLocker file_locker(log_fd, FileLocker::READ_WRITE, 20 /* seconds */);
-    SignalUtil::SignalBlocker signal_blocker(SIGHUP);
-    if (unlikely(::write(log_fd, reinterpret_cast<const void *>(msg.data()), msg.size()) == -1)) {
-        const std::string error_message("in Logger::writeString(util.cc): write to file descriptor " + std::to_string(log_fd)
-                                        + " failed! (errno = " + std::to_string(errno) + ")");
-#pragma GCC diagnostic ignored "-Wunused-result"
-        ::write(STDERR_FILENO, error_message.data(), error_message.size());
-#pragma GCC diagnostic warning "-Wunused-result"
-        _exit(EXIT_FAILURE);
+    // The sequentially consistent increment and mode check pair up w/ the mode change and the check of the count in setMode():
+    // either we see SYNCHRONOUS mode or setMode() waits for us.
+    ++async_log_producer_count;
+    if (mode_.load() == ASYNCHRONOUS) {
+        async_log_writer->enqueue(&msg);
+        --async_log_producer_count;
+    } else {
+        --async_log_producer_count;
+        WriteToLogFileDescriptor(msg);
     }
 }
 
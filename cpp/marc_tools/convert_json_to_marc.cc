@@ -46,6 +46,8 @@ namespace {
     ::Usage(
         "[--create-unique-id-db|--ignore-unique-id-dups|--extract-and-count-issns-only] config_file json_input [unmapped_issn_list "
         "marc_output]\n"
+        "\tjson_input: Either a JSON document or, if it has a \".jsonl\" extension, a JSON Lines document.  In the latter case\n"
+        "\t            \"root_path\" gets resolved for each line.\n"
         "\t--create-unique-id-db: This flag has to be specified the first time this program will be executed only.\n"
         "\t--ignore-unique-id-dups: If specified MARC records will be created for unique ID's which we have encountered\n"
         "\t                         before.  The unique ID database will still be updated.\n"
@@ -837,7 +839,10 @@ bool GenerateSingleMARCRecordFromJSON(
 }
 
 
-void GenerateMARCFromJSON(const std::shared_ptr<const JSON::JSONNode> &object_or_array_root,
+// Generates MARC records from the object or the elements of the array that "root_path" references.  The objects get parsed
+// one at a time, so we never hold more than a single one in memory.  For JSON Lines input "root_path" gets resolved for each
+// line.
+void GenerateMARCFromJSON(JSON::PullParser * const json_parser, const std::string &root_path,
                           const JSONNodeToBibliographicLevelMapper &json_node_to_bibliographic_level_mapper,
                           const std::vector<FieldDescriptor> &field_descriptors,
                           const std::unordered_map<std::string, JournalTitlePPNAndOnlineISSN> &issns_to_journal_titles_ppns_and_issns_map,
@@ -845,33 +850,45 @@ void GenerateMARCFromJSON(const std::shared_ptr<const JSON::JSONNode> &object_or
                           std::unordered_map<std::string, unsigned> * const issns_to_counts_map, const bool ignore_unique_id_dups,
                           KeyValueDB * const unique_id_to_date_map) {
     unsigned created_count(0), duplicate_skipped_count(0);
-
-    switch (object_or_array_root->getType()) {
-    case JSON::JSONNode::OBJECT_NODE:
-        if (GenerateSingleMARCRecordFromJSON(JSON::JSONNode::CastToObjectNodeOrDie("object_or_array_root", object_or_array_root),
-                                             json_node_to_bibliographic_level_mapper, field_descriptors,
+    const auto generate_record([&](const JSON::PullParser::EventType object_start_event, const std::string &node_name) {
+        const auto object(JSON::JSONNode::CastToObjectNodeOrDie(node_name, json_parser->parseValue(object_start_event)));
+        if (GenerateSingleMARCRecordFromJSON(object, json_node_to_bibliographic_level_mapper, field_descriptors,
                                              issns_to_journal_titles_ppns_and_issns_map, marc_writer, extract_and_count_issns_only,
                                              issns_to_counts_map, ignore_unique_id_dups, unique_id_to_date_map))
             ++created_count;
         else
             ++duplicate_skipped_count;
-        break;
-    case JSON::JSONNode::ARRAY_NODE: {
-        const auto array_node(JSON::JSONNode::CastToArrayNodeOrDie("object_or_array_root", object_or_array_root));
-        for (const auto &array_element : *array_node) {
-            if (GenerateSingleMARCRecordFromJSON(JSON::JSONNode::CastToObjectNodeOrDie("array_element", array_element),
-                                                 json_node_to_bibliographic_level_mapper, field_descriptors,
-                                                 issns_to_journal_titles_ppns_and_issns_map, marc_writer, extract_and_count_issns_only,
-                                                 issns_to_counts_map, ignore_unique_id_dups, unique_id_to_date_map))
-                ++created_count;
-            else
-                ++duplicate_skipped_count;
+    });
+
+    do {
+        JSON::PullParser::EventType root_start_event;
+        if (not json_parser->descend(root_path, &root_start_event)) {
+            if (json_parser->isJSONLines())
+                LOG_ERROR("\"root_path\" in section \"Global\" not found on line " + std::to_string(json_parser->getLineNumber())
+                          + " of \"" + json_parser->getPath() + "\"!");
+            LOG_ERROR("\"root_path\" in section \"Global\" not found in \"" + json_parser->getPath() + "\"!");
         }
-        break;
-    }
-    default:
-        LOG_ERROR("\"root_path\" in section \"Gobal\" does not reference a JSON object or array!");
-    }
+        if (root_start_event == JSON::PullParser::END_OF_DOCUMENT)
+            break;
+
+        switch (root_start_event) {
+        case JSON::PullParser::OBJECT_START:
+            generate_record(root_start_event, "object_or_array_root");
+            break;
+        case JSON::PullParser::ARRAY_START: {
+            JSON::PullParser::EventType element_start_event;
+            while (json_parser->getNextElement(&element_start_event))
+                generate_record(element_start_event, "array_element");
+            break;
+        }
+        default:
+            LOG_ERROR("\"root_path\" in section \"Gobal\" does not reference a JSON object or array!");
+        }
+
+        // Skip whatever follows "root_path" in the current line or document:
+        while (json_parser->getDepth() > 0)
+            json_parser->getNextEvent();
+    } while (json_parser->isJSONLines());
 
     LOG_INFO("created " + std::to_string(created_count) + " MARC record(s) and skipped " + std::to_string(duplicate_skipped_count)
              + " duplicate(s).");
@@ -927,20 +944,14 @@ int Main(int argc, char **argv) {
     std::unique_ptr<JSONNodeToBibliographicLevelMapper> json_node_to_bibliographic_level_mapper;
     const auto field_descriptors(LoadFieldDescriptors(argv[1], &root_path, &json_node_to_bibliographic_level_mapper));
 
-    const std::string json_file_path(argv[2]);
-    const auto json_source(FileUtil::ReadStringOrDie(json_file_path));
-    JSON::Parser parser(json_source);
-    std::shared_ptr<JSON::JSONNode> tree_root;
-    if (not parser.parse(&tree_root))
-        LOG_ERROR("Failed to parse the contents of \"" + json_file_path + "\": " + parser.getErrorMessage());
-    const auto object_or_array_root(JSON::LookupNode(root_path, tree_root));
+    JSON::PullParser json_parser(argv[2]);
 
     const auto unmatched_issns_file(extract_and_count_issns_only ? nullptr : FileUtil::OpenOutputFileOrDie(argv[3]));
 
     KeyValueDB unique_id_to_date_map(UNIQUE_ID_TO_DATE_MAP_PATH);
     std::unordered_map<std::string, unsigned> issns_to_counts_map;
     const std::unique_ptr<MARC::Writer> marc_writer(extract_and_count_issns_only ? nullptr : MARC::Writer::Factory(argv[4]));
-    GenerateMARCFromJSON(object_or_array_root, *json_node_to_bibliographic_level_mapper, field_descriptors,
+    GenerateMARCFromJSON(&json_parser, root_path, *json_node_to_bibliographic_level_mapper, field_descriptors,
                          issns_to_journal_titles_ppns_and_issns_map, marc_writer.get(), extract_and_count_issns_only, &issns_to_counts_map,
                          ignore_unique_id_dups, &unique_id_to_date_map);
 
@@ -0,0 +1,39 @@
+/** \file    create_marc_tag_index.cc
+ *  \brief   Generates a tag index for a MARC file, c.f. MarcTagIndex.h.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <cstdlib>
+#include "MARC.h"
+#include "MarcTagIndex.h"
+#include "util.h"
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 2 and argc != 3)
+        ::Usage("marc_file [index_file]\n"
+                "If \"index_file\" has not been specified, the sidecar index, e.g. \"x.mrc.tag_index\" for \"x.mrc\", will be\n"
+                "created which will then be picked up automatically by the tools that support tag indices.");
+
+    const std::string marc_path(argv[1]);
+    const auto marc_reader(MARC::Reader::Factory(marc_path));
+    MarcTagIndex::Create(marc_reader.get(), argc == 3 ? argv[2] : MarcTagIndex::GetSidecarPath(marc_path));
+
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include "MARC.h"
+#include "MarcTagIndex.h"
 #include "util.h"
 
 
@@ -36,6 +37,22 @@ namespace {
 }
 
 
+void ListNonStandardTags(const unsigned record_count, const std::unordered_set<std::string> &non_standard_tags) {
+    std::cout << "Data set contains " << record_count << " MARC record(s) w/ the following " << non_standard_tags.size()
+              << " non-standard tags:\n";
+
+    std::vector<std::string> sorted_non_standard_tag;
+    sorted_non_standard_tag.reserve(non_standard_tags.size());
+
+    for (const auto &non_standard_tag : non_standard_tags)
+        sorted_non_standard_tag.emplace_back(non_standard_tag);
+
+    std::sort(sorted_non_standard_tag.begin(), sorted_non_standard_tag.end());
+    for (const auto &tag : sorted_non_standard_tag)
+        std::cout << tag << '\n';
+}
+
+
 void ProcessRecords(MARC::Reader * const marc_reader) {
     unsigned record_count(0);
     std::unordered_set<std::string> non_standard_tags;
@@ -49,18 +66,19 @@ void ProcessRecords(MARC::Reader * const marc_reader) {
         }
     }
 
-    std::cout << "Data set contains " << record_count << " MARC record(s) w/ the following " << non_standard_tags.size()
-              << " non-standard tags:\n";
+    ListNonStandardTags(record_count, non_standard_tags);
+}
 
-    std::vector<std::string> sorted_non_standard_tag;
-    sorted_non_standard_tag.reserve(non_standard_tags.size());
 
-    for (const auto &non_standard_tag : non_standard_tags)
-        sorted_non_standard_tag.emplace_back(non_standard_tag);
+// The sidecar tag index already knows all tags, so we don't have to read a single record.
+void ProcessTagIndex(const MarcTagIndex &tag_index) {
+    std::unordered_set<std::string> non_standard_tags;
+    for (const auto &tag : tag_index.getTags()) {
+        if (not MARC::IsStandardTag(tag))
+            non_standard_tags.emplace(tag.toString());
+    }
 
-    std::sort(sorted_non_standard_tag.begin(), sorted_non_standard_tag.end());
-    for (const auto &tag : sorted_non_standard_tag)
-        std::cout << tag << '\n';
+    ListNonStandardTags(tag_index.getRecordCount(), non_standard_tags);
 }
 
 
@@ -71,8 +89,14 @@ int Main(int argc, char *argv[]) {
     if (argc != 2)
         Usage();
 
-    auto marc_reader(MARC::Reader::Factory(argv[1]));
-    ProcessRecords(marc_reader.get());
+    const std::string marc_path(argv[1]);
+    const auto tag_index(MarcTagIndex::OpenSidecar(marc_path));
+    if (tag_index != nullptr)
+        ProcessTagIndex(*tag_index);
+    else {
+        auto marc_reader(MARC::Reader::Factory(marc_path));
+        ProcessRecords(marc_reader.get());
+    }
 
     return EXIT_SUCCESS;
 }
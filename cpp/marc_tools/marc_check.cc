@@ -38,8 +38,9 @@ namespace {
 [[noreturn]] void Usage() {
     ::Usage(
         "[--do-not-abort-on-empty-subfields] [--do-not-abort-on-invalid-repeated-fields] [--check-rule-violations-only]"
-        " [--write-data=output_filename] marc_data [rules violated_rules_control_number_list]\n"
-        "       If \"--write-data\" has been specified, the read records will be written out again.\n");
+        " [--write-data=output_filename] [--validate-utf8] marc_data [rules violated_rules_control_number_list]\n"
+        "       If \"--write-data\" has been specified, the read records will be written out again.\n"
+        "       If \"--validate-utf8\" has been specified, we abort on the first MARC-21 record that is not valid UTF-8.\n");
     std::exit(EXIT_FAILURE);
 }
 
@@ -381,6 +382,8 @@ int Main(int argc, char *argv[]) {
         --argc, ++argv;
     }
 
+    const bool validate_utf8(MARC::GetOptionalValidateUTF8Flag(&argc, &argv, 1));
+
     if (argc != 2 and argc != 4)
         Usage();
 
@@ -391,7 +394,7 @@ int Main(int argc, char *argv[]) {
         rule_violation_list = FileUtil::OpenOutputFileOrDie(argv[3]);
     }
 
-    std::unique_ptr<MARC::Reader> marc_reader(MARC::Reader::Factory(argv[1]));
+    std::unique_ptr<MARC::Reader> marc_reader(MARC::Reader::Factory(argv[1], MARC::FileType::AUTO, validate_utf8));
 
     std::unique_ptr<MARC::Writer> marc_writer;
     if (not output_filename.empty())
@@ -34,14 +34,16 @@ namespace {
 
 [[noreturn]] void Usage() {
     std::cerr << "Usage: " << ::progname
-              << " [--quiet] [--limit max_no_of_records] [--output-individual-files] marc_input marc_output [CTLN_1 CTLN_2 .. CTLN_N]\n"
+              << " [--quiet] [--limit max_no_of_records] [--output-individual-files] [--validate-utf8] marc_input marc_output\n"
+              << "       [CTLN_1 CTLN_2 .. CTLN_N]\n"
               << "       Autoconverts the MARC format of \"marc_input\" to \"marc_output\".\n"
               << "       Supported extensions are \"xml\", \"mrc\", \"marc\" and \"raw\".\n"
               << "       All extensions except for \"xml\" are assumed to imply MARC-21.\n"
               << "       If a control number list has been specified only those records will\n"
               << "       be extracted or converted.\n"
               << "       If --output-individual-files is specified marc_output must be a writable directory\n"
-              << "       and files are named from the control numbers and written as XML\n\n";
+              << "       and files are named from the control numbers and written as XML\n"
+              << "       If --validate-utf8 is specified we abort on the first MARC-21 input record that is not valid UTF-8.\n\n";
     std::exit(EXIT_FAILURE);
 }
 
@@ -114,6 +116,8 @@ int main(int argc, char *argv[]) {
         --argc, ++argv;
     }
 
+    const bool validate_utf8(MARC::GetOptionalValidateUTF8Flag(&argc, &argv, 1));
+
     if (argc < 3)
         Usage();
 
@@ -121,7 +125,7 @@ int main(int argc, char *argv[]) {
     const std::string output_file_or_directory(argv[2]);
 
     try {
-        std::unique_ptr<MARC::Reader> marc_reader(MARC::Reader::Factory(input_filename));
+        std::unique_ptr<MARC::Reader> marc_reader(MARC::Reader::Factory(input_filename, MARC::FileType::AUTO, validate_utf8));
 
         std::set<std::string> control_numbers;
         for (int arg_no(3); arg_no < argc; ++arg_no)
@@ -20,13 +20,21 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include "FileUtil.h"
 #include "MARC.h"
+#include "StringUtil.h"
+#include "ThreadUtil.h"
 #include "util.h"
 
 
@@ -34,7 +42,11 @@ namespace {
 
 
 [[noreturn]] void Usage() {
-    std::cerr << "Usage: " << ::progname << " [--verbose] marc_collection1 marc_collection2\n";
+    std::cerr << "Usage: " << ::progname << " [--verbose] [--use-checksum-lists [--thread-count=count]] marc_collection1 marc_collection2\n"
+              << "       With \"--use-checksum-lists\" a checksum of each record is calculated on \"count\" threads and only records w/\n"
+              << "       differing checksums are compared field by field.  The checksums of each collection are stored in a file w/ the\n"
+              << "       collection's name and a \".checksums\" suffix which will be reused as long as the collection is unchanged.\n"
+              << "       The thread count defaults to the number of CPU cores.\n";
     std::exit(EXIT_FAILURE);
 }
 
@@ -139,6 +151,225 @@ void EmitDifferenceReport(const bool verbose, const std::unordered_map<std::stri
 }
 
 
+// Two records have the same checksum if and only if RecordsDiffer() considers them to be equal, i.e. the leaders are ignored, the
+// order of the tags matters, but the order of the contents of repeated fields doesn't.
+std::string CalcDiffChecksum(const MARC::Record &record) {
+    std::string blob;
+    std::vector<const std::string *> repeated_contents;
+    for (auto field(record.begin()); field != record.end();) {
+        const MARC::Tag tag(field->getTag());
+        repeated_contents.clear();
+        for (; field != record.end() and field->getTag() == tag; ++field)
+            repeated_contents.emplace_back(&field->getContents());
+        std::sort(repeated_contents.begin(), repeated_contents.end(),
+                  [](const std::string * const contents1, const std::string * const contents2) { return *contents1 < *contents2; });
+
+        for (const auto contents : repeated_contents) {
+            blob.append(tag.c_str(), MARC::Record::TAG_LENGTH);
+            blob += *contents;
+            blob += '\x1E'; // Field terminator.
+        }
+    }
+
+    return StringUtil::MurmurHash3_128(blob);
+}
+
+
+struct ChecksumListEntry {
+    std::string control_number_;
+    off_t offset_;
+    std::string checksum_;
+
+public:
+    ChecksumListEntry() = default;
+    ChecksumListEntry(const std::string &control_number, const off_t offset): control_number_(control_number), offset_(offset) { }
+    ChecksumListEntry(const std::string &control_number, const off_t offset, const std::string &checksum)
+        : control_number_(control_number), offset_(offset), checksum_(checksum) { }
+};
+
+
+const size_t RECORDS_PER_BATCH(1000);
+const size_t MAX_QUEUED_BATCHES_PER_THREAD(4);
+
+
+typedef std::vector<std::pair<off_t, MARC::Record>> RecordBatch;
+
+
+// Sorts "checksum_list" by control number.  Like CollectRecordOffsets() we only keep the last of several records w/ the same
+// control number.
+void SortChecksumList(std::vector<ChecksumListEntry> * const checksum_list) {
+    std::sort(checksum_list->begin(), checksum_list->end(), [](const ChecksumListEntry &entry1, const ChecksumListEntry &entry2) {
+        return entry1.control_number_ < entry2.control_number_
+               or (entry1.control_number_ == entry2.control_number_ and entry1.offset_ > entry2.offset_);
+    });
+    checksum_list->erase(std::unique(checksum_list->begin(), checksum_list->end(),
+                                     [](const ChecksumListEntry &entry1, const ChecksumListEntry &entry2) {
+                                         return entry1.control_number_ == entry2.control_number_;
+                                     }),
+                         checksum_list->end());
+}
+
+
+void CalcChecksumList(MARC::Reader * const marc_reader, const unsigned thread_count, std::vector<ChecksumListEntry> * const checksum_list) {
+    ThreadUtil::BoundedQueue<RecordBatch> record_batch_queue(thread_count * MAX_QUEUED_BATCHES_PER_THREAD);
+    std::mutex checksum_list_mutex;
+    std::vector<std::thread> threads;
+    for (unsigned thread_no(0); thread_no < thread_count; ++thread_no) {
+        threads.emplace_back([&record_batch_queue, &checksum_list_mutex, checksum_list] {
+            RecordBatch batch;
+            std::vector<ChecksumListEntry> entries;
+            while (record_batch_queue.pop(&batch)) {
+                entries.clear();
+                for (const auto &[offset, record] : batch)
+                    entries.emplace_back(record.getControlNumber(), offset, CalcDiffChecksum(record));
+
+                std::lock_guard<std::mutex> mutex_locker(checksum_list_mutex);
+                for (auto &entry : entries)
+                    checksum_list->emplace_back(std::move(entry));
+            }
+        });
+    }
+
+    RecordBatch batch;
+    for (;;) {
+        const off_t offset(marc_reader->tell());
+        MARC::Record record(marc_reader->read());
+        if (not record)
+            break;
+        batch.emplace_back(offset, std::move(record));
+        if (batch.size() == RECORDS_PER_BATCH) {
+            record_batch_queue.push(std::move(batch));
+            batch = RecordBatch();
+        }
+    }
+    if (not batch.empty())
+        record_batch_queue.push(std::move(batch));
+    record_batch_queue.close();
+    for (auto &thread : threads)
+        thread.join();
+
+    SortChecksumList(checksum_list);
+}
+
+
+const std::string CHECKSUM_LIST_MAGIC("marc_diff checksum list v2");
+
+
+std::string GetChecksumListPath(const std::string &marc_path) {
+    return marc_path + ".checksums";
+}
+
+
+// \return "<file size> <modification time>" of "marc_path", which we use to detect outdated checksum lists.
+std::string GetFileSignature(const std::string &marc_path) {
+    struct stat stat_buf;
+    if (unlikely(::stat(marc_path.c_str(), &stat_buf) != 0))
+        LOG_ERROR("failed to stat(2) \"" + marc_path + "\"!");
+    return std::to_string(stat_buf.st_size) + " " + std::to_string(stat_buf.st_mtime);
+}
+
+
+// The checksum list consists of a header line w/ CHECKSUM_LIST_MAGIC and the file signature of the MARC collection, followed by a
+// line for each record w/ the control number, the offset and the hex-encoded checksum separated by tabs, sorted by control number.
+// \return False if there is no checksum list for "marc_path" or if it is out of date, o/w true.
+bool LoadChecksumList(const std::string &marc_path, std::vector<ChecksumListEntry> * const checksum_list) {
+    const std::string checksum_list_path(GetChecksumListPath(marc_path));
+    if (not FileUtil::Exists(checksum_list_path))
+        return false;
+
+    const auto input(FileUtil::OpenInputFileOrDie(checksum_list_path));
+    if (input->getline() != CHECKSUM_LIST_MAGIC + " " + GetFileSignature(marc_path)) {
+        LOG_WARNING("ignoring \"" + checksum_list_path + "\" because it is out of date!");
+        return false;
+    }
+
+    std::string line;
+    std::vector<std::string> columns;
+    while (not input->eof()) {
+        input->getline(&line);
+        if (line.empty())
+            continue;
+
+        unsigned long long offset;
+        if (unlikely(StringUtil::SplitThenTrimWhite(line, '\t', &columns) != 3 or not StringUtil::ToUnsignedLongLong(columns[1], &offset)))
+            LOG_ERROR("malformed line in \"" + checksum_list_path + "\": \"" + line + "\"!");
+        checksum_list->emplace_back(columns[0], static_cast<off_t>(offset), StringUtil::FromHexString(columns[2]));
+    }
+
+    LOG_INFO("loaded " + std::to_string(checksum_list->size()) + " checksums from \"" + checksum_list_path + "\".");
+    return true;
+}
+
+
+void WriteChecksumList(const std::string &marc_path, const std::vector<ChecksumListEntry> &checksum_list) {
+    const std::string checksum_list_path(GetChecksumListPath(marc_path));
+    const std::string temp_checksum_list_path(checksum_list_path + ".tmp");
+    const auto output(FileUtil::OpenOutputFileOrDie(temp_checksum_list_path));
+    *output << CHECKSUM_LIST_MAGIC << ' ' << GetFileSignature(marc_path) << '\n';
+    for (const auto &entry : checksum_list)
+        *output << entry.control_number_ << '\t' << entry.offset_ << '\t' << StringUtil::ToHexString(entry.checksum_) << '\n';
+    output->close();
+    FileUtil::RenameFileOrDie(temp_checksum_list_path, checksum_list_path, /* remove_target = */ true);
+}
+
+
+// \return The checksum list of "marc_path" sorted by control number, if possible the stored one.
+std::vector<ChecksumListEntry> GetChecksumList(const std::string &marc_path, const unsigned thread_count) {
+    std::vector<ChecksumListEntry> checksum_list;
+    if (LoadChecksumList(marc_path, &checksum_list))
+        return checksum_list;
+
+    const auto marc_reader(MARC::Reader::Factory(marc_path));
+    CalcChecksumList(marc_reader.get(), thread_count, &checksum_list);
+    WriteChecksumList(marc_path, checksum_list);
+    LOG_INFO("calculated " + std::to_string(checksum_list.size()) + " checksums for \"" + marc_path + "\".");
+    return checksum_list;
+}
+
+
+// Only compares records w/ identical control numbers but different checksums in detail.
+void EmitChecksumDifferenceReport(const bool verbose, const std::vector<ChecksumListEntry> &checksum_list1,
+                                  const std::vector<ChecksumListEntry> &checksum_list2, MARC::Reader * const reader1,
+                                  MARC::Reader * const reader2) {
+    if (verbose)
+        std::cout << "Records w/ identical control numbers but differing contents:\n";
+
+    unsigned differ_count(0);
+    auto entry1(checksum_list1.cbegin());
+    auto entry2(checksum_list2.cbegin());
+    while (entry1 != checksum_list1.cend() and entry2 != checksum_list2.cend()) {
+        if (entry1->control_number_ < entry2->control_number_) {
+            ++entry1;
+            continue;
+        }
+        if (entry2->control_number_ < entry1->control_number_) {
+            ++entry2;
+            continue;
+        }
+
+        if (entry1->checksum_ != entry2->checksum_) {
+            if (unlikely(not reader1->seek(entry1->offset_)))
+                LOG_ERROR("seek in collection 1 failed!");
+            const MARC::Record record1(reader1->read());
+
+            if (unlikely(not reader2->seek(entry2->offset_)))
+                LOG_ERROR("seek in collection 2 failed!");
+            const MARC::Record record2(reader2->read());
+
+            std::string difference;
+            if (RecordsDiffer(record1, record2, &difference)) {
+                ++differ_count;
+                if (verbose)
+                    std::cout << '\t' << record1.getControlNumber() << " (fields: " << difference << ")\n";
+            }
+        }
+        ++entry1, ++entry2;
+    }
+
+    std::cout << differ_count << " record(s) have identical control numbers but different contents.\n";
+}
+
+
 inline void InitSortedControlNumbersList(const std::unordered_map<std::string, off_t> &control_number_to_offset_map,
                                          std::vector<std::string> * const sorted_control_numbers) {
     sorted_control_numbers->clear();
@@ -149,16 +380,18 @@ inline void InitSortedControlNumbersList(const std::unordered_map<std::string, o
 }
 
 
-void EmitStandardReport(const bool verbose, const std::string &collection1_name, const std::string &collection2_name,
-                        const unsigned collection1_size, const unsigned collection2_size,
-                        const std::unordered_map<std::string, off_t> &control_number_to_offset_map1,
-                        const std::unordered_map<std::string, off_t> &control_number_to_offset_map2) {
-    std::vector<std::string> sorted_control_numbers1;
-    InitSortedControlNumbersList(control_number_to_offset_map1, &sorted_control_numbers1);
+inline void InitSortedControlNumbersList(const std::vector<ChecksumListEntry> &sorted_checksum_list,
+                                         std::vector<std::string> * const sorted_control_numbers) {
+    sorted_control_numbers->clear();
+    sorted_control_numbers->reserve(sorted_checksum_list.size());
+    for (const auto &entry : sorted_checksum_list)
+        sorted_control_numbers->emplace_back(entry.control_number_);
+}
 
-    std::vector<std::string> sorted_control_numbers2;
-    InitSortedControlNumbersList(control_number_to_offset_map2, &sorted_control_numbers2);
 
+void EmitStandardReport(const bool verbose, const std::string &collection1_name, const std::string &collection2_name,
+                        const unsigned collection1_size, const unsigned collection2_size,
+                        const std::vector<std::string> &sorted_control_numbers1, const std::vector<std::string> &sorted_control_numbers2) {
     std::unordered_set<std::string> in_map1_only, in_map2_only;
 
     auto control_number1(sorted_control_numbers1.cbegin());
@@ -210,6 +443,18 @@ int Main(int argc, char *argv[]) {
     if (verbose)
         --argc, ++argv;
 
+    bool use_checksum_lists(false);
+    unsigned thread_count(std::max(std::thread::hardware_concurrency(), 1u));
+    if (argc > 1 and std::strcmp(argv[1], "--use-checksum-lists") == 0) {
+        use_checksum_lists = true;
+        --argc, ++argv;
+        if (argc > 1 and StringUtil::StartsWith(argv[1], "--thread-count=")) {
+            if (not StringUtil::ToUnsigned(argv[1] + __builtin_strlen("--thread-count="), &thread_count) or thread_count == 0)
+                LOG_ERROR("bad thread count: \"" + std::string(argv[1]) + "\"!");
+            --argc, ++argv;
+        }
+    }
+
     if (argc != 3)
         Usage();
 
@@ -218,16 +463,35 @@ int Main(int argc, char *argv[]) {
     std::unique_ptr<MARC::Reader> marc_reader1(MARC::Reader::Factory(collection1_name));
     std::unique_ptr<MARC::Reader> marc_reader2(MARC::Reader::Factory(collection2_name));
 
-    std::unordered_map<std::string, off_t> control_number_to_offset_map1;
-    const size_t collection1_size(MARC::CollectRecordOffsets(marc_reader1.get(), &control_number_to_offset_map1));
+    std::vector<std::string> sorted_control_numbers1, sorted_control_numbers2;
+    if (use_checksum_lists) {
+        // Both collections are read concurrently, each w/ its own checksumming threads:
+        std::vector<ChecksumListEntry> checksum_list2;
+        std::thread collection2_thread(
+            [&collection2_name, thread_count, &checksum_list2] { checksum_list2 = GetChecksumList(collection2_name, thread_count); });
+        const std::vector<ChecksumListEntry> checksum_list1(GetChecksumList(collection1_name, thread_count));
+        collection2_thread.join();
+
+        EmitChecksumDifferenceReport(verbose, checksum_list1, checksum_list2, marc_reader1.get(), marc_reader2.get());
+
+        InitSortedControlNumbersList(checksum_list1, &sorted_control_numbers1);
+        InitSortedControlNumbersList(checksum_list2, &sorted_control_numbers2);
+    } else {
+        std::unordered_map<std::string, off_t> control_number_to_offset_map1;
+        MARC::CollectRecordOffsets(marc_reader1.get(), &control_number_to_offset_map1);
 
-    std::unordered_map<std::string, off_t> control_number_to_offset_map2;
-    const unsigned collection2_size(MARC::CollectRecordOffsets(marc_reader2.get(), &control_number_to_offset_map2));
+        std::unordered_map<std::string, off_t> control_number_to_offset_map2;
+        MARC::CollectRecordOffsets(marc_reader2.get(), &control_number_to_offset_map2);
 
-    EmitDifferenceReport(verbose, control_number_to_offset_map1, control_number_to_offset_map2, marc_reader1.get(), marc_reader2.get());
+        EmitDifferenceReport(verbose, control_number_to_offset_map1, control_number_to_offset_map2, marc_reader1.get(),
+                             marc_reader2.get());
+
+        InitSortedControlNumbersList(control_number_to_offset_map1, &sorted_control_numbers1);
+        InitSortedControlNumbersList(control_number_to_offset_map2, &sorted_control_numbers2);
+    }
 
-    EmitStandardReport(verbose, collection1_name, collection2_name, collection1_size, collection2_size, control_number_to_offset_map1,
-                       control_number_to_offset_map2);
+    EmitStandardReport(verbose, collection1_name, collection2_name, sorted_control_numbers1.size(), sorted_control_numbers2.size(),
+                       sorted_control_numbers1, sorted_control_numbers2);
 
     return EXIT_SUCCESS;
 }
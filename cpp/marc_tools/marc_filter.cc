@@ -72,6 +72,7 @@ void Usage() {
               << "           --replace subfield_specs map_file\n"
               << "               every line in \"map_file\" must either start with a hash character in which case it is\n"
               << "               ignored or lines that look like \"regex->replacement\" followed by a newline.\n"
+              << "               The regexes are applied in the order in which they appear in \"map_file\".\n"
               << "           --replace-strings subfield_specs map_file\n"
               << "               every line in \"map_file\" must either start with a hash character in which case it is\n"
               << "               ignored or lines that look like \"string1|string2|...|stringN->replacement\" followed by a newline.\n"
@@ -82,6 +83,7 @@ void Usage() {
               << "           --globally-substitute subfield_specs maps\n"
               << "               every line in \"map_file\" must either start with a hash character in which case it is\n"
               << "               ignored or lines that look like \"regex->replacement\" followed by a newline.\n"
+              << "               The regexes are applied in the order in which they appear in \"map_file\".\n"
               << "               Unlike --replace only the matched parts will be replaced.  This works like se s/.../.../g.\n"
               << "             or\n"
               << "       --filter-chars and --translate character sets may contain any of the following escapes:\n"
@@ -360,10 +362,10 @@ private:
     mutable unsigned count_;
     unsigned max_count_;
     TranslateMap *translate_map_;
-    RegexMatcher *regex_matcher_;
+    RegexSet *regex_set_;
     std::unordered_map<std::string, std::string> originals_to_replacements_map_;
-    std::vector<StringFragmentOrBackreference> string_fragments_and_back_references_;
-    std::string replacement_;
+    std::vector<std::vector<StringFragmentOrBackreference>> string_fragments_and_back_references_;
+    std::vector<std::string> replacements_;
 
 public:
     inline FilterType getFilterType() const { return filter_type_; }
@@ -385,8 +387,8 @@ public:
     /** \note Only call this if the filter type is TRANSLATE! */
     inline const TranslateMap &getTranslateMap() const { return *translate_map_; }
 
-    /** \note Only call this if the filter type is REPLACE! */
-    inline RegexMatcher &getRegexMatcher() const { return *regex_matcher_; }
+    /** \note Only call this if the filter type is REPLACE or GLOBAL_SUBSTITUTION! */
+    inline const RegexSet &getRegexSet() const { return *regex_set_; }
 
     /** \note Only call this if the filter type is MAP_S! */
     inline const std::unordered_map<std::string, std::string> &getOriginalsToReplacementsMap() const {
@@ -394,11 +396,12 @@ public:
     }
 
     /** \note Only call this if the filter type is REPLACE! */
-    inline const std::vector<StringFragmentOrBackreference> &getStringFragmentsAndBackreferences() const {
-        return string_fragments_and_back_references_;
+    inline const std::vector<StringFragmentOrBackreference> &getStringFragmentsAndBackreferences(const size_t pattern_index) const {
+        return string_fragments_and_back_references_[pattern_index];
     }
 
-    inline const std::string &getReplacement() const { return replacement_; }
+    /** \note Only call this if the filter type is GLOBAL_SUBSTITUTION! */
+    inline const std::string &getReplacement(const size_t pattern_index) const { return replacements_[pattern_index]; }
 
     inline static FilterDescriptor MakeDropFilter(const std::vector<CompiledPattern *> &compiled_patterns) {
         return FilterDescriptor(FilterType::DROP, compiled_patterns);
@@ -435,9 +438,9 @@ public:
         return FilterDescriptor(subfield_specs, translate_map);
     }
 
-    inline static FilterDescriptor MakeReplacementFilter(const std::vector<std::string> &subfield_specs, const std::string &regex,
-                                                         const std::string &replacement) {
-        return FilterDescriptor(FilterType::REPLACE, subfield_specs, regex, replacement);
+    inline static FilterDescriptor MakeReplacementFilter(const std::vector<std::string> &subfield_specs,
+                                                         const std::vector<std::pair<std::string, std::string>> &regexes_and_replacements) {
+        return FilterDescriptor(FilterType::REPLACE, subfield_specs, regexes_and_replacements);
     }
 
     inline static FilterDescriptor MakeStringReplacementFilter(
@@ -445,26 +448,26 @@ public:
         return FilterDescriptor(subfield_specs, originals_to_replacements_map);
     }
 
-    inline static FilterDescriptor MakeGlobalSubstitutionFilter(const std::vector<std::string> &subfield_specs, const std::string &regex,
-                                                                const std::string &replacement) {
-        return FilterDescriptor(FilterType::GLOBAL_SUBSTITUTION, subfield_specs, regex, replacement);
+    inline static FilterDescriptor MakeGlobalSubstitutionFilter(
+        const std::vector<std::string> &subfield_specs, const std::vector<std::pair<std::string, std::string>> &regexes_and_replacements) {
+        return FilterDescriptor(FilterType::GLOBAL_SUBSTITUTION, subfield_specs, regexes_and_replacements);
     }
 
 private:
     FilterDescriptor(const FilterType filter_type, const std::vector<CompiledPattern *> &compiled_patterns)
-        : filter_type_(filter_type), compiled_patterns_(compiled_patterns), translate_map_(nullptr), regex_matcher_(nullptr) { }
+        : filter_type_(filter_type), compiled_patterns_(compiled_patterns), translate_map_(nullptr), regex_set_(nullptr) { }
     FilterDescriptor(const std::vector<std::string> &subfield_specs, const std::string &chars_to_delete)
         : filter_type_(FilterType::FILTER_CHARS), subfield_specs_(subfield_specs), chars_to_delete_(chars_to_delete),
-          translate_map_(nullptr), regex_matcher_(nullptr) { }
+          translate_map_(nullptr), regex_set_(nullptr) { }
     FilterDescriptor(const FilterType filter_type, const std::string &biblio_levels)
-        : filter_type_(filter_type), biblio_levels_(biblio_levels), regex_matcher_(nullptr) { }
+        : filter_type_(filter_type), biblio_levels_(biblio_levels), regex_set_(nullptr) { }
     FilterDescriptor(const unsigned max_count)
-        : filter_type_(FilterType::MAX_COUNT), count_(0), max_count_(max_count), translate_map_(nullptr), regex_matcher_(nullptr) { }
+        : filter_type_(FilterType::MAX_COUNT), count_(0), max_count_(max_count), translate_map_(nullptr), regex_set_(nullptr) { }
     FilterDescriptor(const std::vector<std::string> &subfield_specs, const TranslateMap &translate_map)
         : filter_type_(FilterType::TRANSLATE), subfield_specs_(subfield_specs), translate_map_(translate_map.clone()),
-          regex_matcher_(nullptr) { }
-    FilterDescriptor(const FilterType filter_type, const std::vector<std::string> &subfield_specs, const std::string &regex,
-                     const std::string &replacement);
+          regex_set_(nullptr) { }
+    FilterDescriptor(const FilterType filter_type, const std::vector<std::string> &subfield_specs,
+                     const std::vector<std::pair<std::string, std::string>> &regexes_and_replacements);
     FilterDescriptor(const std::vector<std::string> &subfield_specs,
                      const std::unordered_map<std::string, std::string> &originals_to_replacements_map)
         : filter_type_(FilterType::MAP_STRING_TO_STRING), subfield_specs_(subfield_specs),
@@ -506,21 +509,23 @@ void ParseReplacementString(const std::string &replacement,
 }
 
 
-FilterDescriptor::FilterDescriptor(const FilterType filter_type, const std::vector<std::string> &subfield_specs, const std::string &regex,
-                                   const std::string &replacement)
+FilterDescriptor::FilterDescriptor(const FilterType filter_type, const std::vector<std::string> &subfield_specs,
+                                   const std::vector<std::pair<std::string, std::string>> &regexes_and_replacements)
     : filter_type_(filter_type), subfield_specs_(subfield_specs), translate_map_(nullptr) {
     if (filter_type != FilterType::REPLACE and filter_type != FilterType::GLOBAL_SUBSTITUTION)
         LOG_ERROR("filter_type must be either REPLACEMENT or GLOBAL_SUBSTITUTION!");
 
-    std::string err_msg;
-    if ((regex_matcher_ = RegexMatcher::RegexMatcherFactory(regex, &err_msg)) == nullptr)
-        LOG_ERROR("failed to compile regex \"" + regex + "\"! (" + err_msg + ")");
-    if (filter_type == FilterType::REPLACE)
-        ParseReplacementString(replacement, &string_fragments_and_back_references_);
-    else if (filter_type == FilterType::GLOBAL_SUBSTITUTION)
-        replacement_ = replacement;
-    else
-        LOG_ERROR("unknown filter type " + std::to_string(static_cast<int>(filter_type)) + "!");
+    std::vector<std::string> regexes;
+    for (const auto &[regex, replacement] : regexes_and_replacements) {
+        regexes.emplace_back(regex);
+
+        if (filter_type == FilterType::REPLACE) {
+            string_fragments_and_back_references_.emplace_back();
+            ParseReplacementString(replacement, &string_fragments_and_back_references_.back());
+        } else
+            replacements_.emplace_back(replacement);
+    }
+    regex_set_ = new RegexSet(regexes, /* options = */ 0);
 }
 
 
@@ -594,54 +599,92 @@ bool TranslateCharacters(const std::vector<std::string> &subfield_specs, const T
 }
 
 
-bool ReplaceSubfields(const std::vector<std::string> &subfield_specs, RegexMatcher &matcher,
-                      const std::vector<StringFragmentOrBackreference> &string_fragments_and_back_references, MARC::Record * const record) {
+std::string GenerateReplacement(const ThreadSafeRegexMatcher::MatchResult &match_result,
+                                const std::vector<StringFragmentOrBackreference> &string_fragments_and_back_references) {
+    const unsigned no_of_match_groups(match_result.size() - 1);
+    std::string replacement;
+    for (const auto &string_fragment_or_back_reference : string_fragments_and_back_references) {
+        if (string_fragment_or_back_reference.type_ == StringFragmentOrBackreference::STRING_FRAGMENT)
+            replacement += string_fragment_or_back_reference.string_fragment_;
+        else { // We're dealing w/ a back-reference.
+            if (unlikely(string_fragment_or_back_reference.back_reference_ > no_of_match_groups))
+                LOG_ERROR("can't satisfy back-reference \\" + std::to_string(string_fragment_or_back_reference.back_reference_) + "!");
+            replacement += match_result[string_fragment_or_back_reference.back_reference_];
+        }
+    }
+
+    return replacement;
+}
+
+
+/** \brief Applies the patterns of "regex_set" in order to "*subfield_value", each one to the result of its predecessors.
+ *  \param apply_pattern  Gets called w/ the index of a pattern that may match and has to return true if it changed "*subfield_value".
+ *  \return True if "*subfield_value" has been modified, else false.
+ *  \note  Only the candidates that survive the literal prefilter of "regex_set" will be passed to "apply_pattern".
+ */
+template <typename PatternApplicator>
+bool ApplyPatternsInOrder(const RegexSet &regex_set, std::string * const subfield_value, PatternApplicator apply_pattern) {
+    bool modified(false);
+    std::vector<size_t> candidate_indices;
+    regex_set.getCandidates(*subfield_value, &candidate_indices);
+    auto candidate_index(candidate_indices.cbegin());
+    while (candidate_index != candidate_indices.cend()) {
+        const size_t pattern_index(*candidate_index++);
+        if (apply_pattern(pattern_index)) {
+            modified = true;
+
+            // The literals of the remaining patterns may have appeared in or vanished from the new value:
+            regex_set.getCandidates(*subfield_value, &candidate_indices, pattern_index + 1);
+            candidate_index = candidate_indices.cbegin();
+        }
+    }
+
+    return modified;
+}
+
+
+bool ReplaceSubfields(const FilterDescriptor &filter, MARC::Record * const record) {
+    const RegexSet &regex_set(filter.getRegexSet());
     std::vector<size_t> indices_of_deleted_fields;
-    std::set<std::string> tags_of_deleted_fields;
+    std::set<std::string> tags_of_deleted_fields, regexes_leading_to_deleted_fields;
     bool modified_at_least_one_field(false);
     for (auto field(record->begin()); field != record->end(); ++field) {
-        const std::string subfield_codes(GetSubfieldCodes(field->getTag(), subfield_specs));
+        const std::string subfield_codes(GetSubfieldCodes(field->getTag(), filter.getSubfieldSpecs()));
         if (subfield_codes.empty())
             continue;
 
-        bool modified_at_least_one_subfield(false);
+        std::set<std::string> applied_regexes;
         MARC::Subfields subfields(field->getSubfields());
         for (auto &subfield : subfields) {
             if (subfield_codes.find(subfield.code_) == std::string::npos)
                 continue;
 
-            if (matcher.matched(subfield.value_)) {
-                const unsigned no_of_match_groups(matcher.getNoOfGroups());
-                std::string replacement;
-                for (const auto &string_fragment_or_back_reference : string_fragments_and_back_references) {
-                    if (string_fragment_or_back_reference.type_ == StringFragmentOrBackreference::STRING_FRAGMENT)
-                        replacement += string_fragment_or_back_reference.string_fragment_;
-                    else { // We're dealing w/ a back-reference.
-                        if (unlikely(string_fragment_or_back_reference.back_reference_ > no_of_match_groups))
-                            LOG_ERROR("can't satisfy back-reference \\" + std::to_string(string_fragment_or_back_reference.back_reference_)
-                                      + "!");
-                        replacement += matcher[string_fragment_or_back_reference.back_reference_];
-                    }
-                }
-                subfield.value_ = replacement;
-                modified_at_least_one_subfield = true;
-            }
+            ApplyPatternsInOrder(regex_set, &subfield.value_, [&](const size_t pattern_index) {
+                const auto match_result(regex_set.getMatcher(pattern_index).match(subfield.value_));
+                if (not match_result)
+                    return false;
+                subfield.value_ = GenerateReplacement(match_result, filter.getStringFragmentsAndBackreferences(pattern_index));
+                applied_regexes.emplace(regex_set.getPattern(pattern_index));
+                return true;
+            });
         }
 
-        if (modified_at_least_one_subfield) {
+        if (not applied_regexes.empty()) {
             modified_at_least_one_field = true;
             field->setContents(std::string(1, field->getIndicator1()) + std::string(1, field->getIndicator2()) + subfields.toString());
             if (unlikely(field->empty())) {
                 indices_of_deleted_fields.emplace_back(field - record->begin());
                 tags_of_deleted_fields.insert(field->getTag().toString());
+                regexes_leading_to_deleted_fields.insert(applied_regexes.cbegin(), applied_regexes.cend());
             }
         }
     }
 
     // Did we generate completely empty fields?
     if (unlikely(not indices_of_deleted_fields.empty())) {
-        LOG_WARNING("regex \"" + matcher.getPattern() + "\" led to empty fields in the record w/ control number "
-                    + record->getControlNumber() + " and field(s) " + StringUtil::Join(tags_of_deleted_fields, ',') + "!");
+        LOG_WARNING("regex(es) \"" + StringUtil::Join(regexes_leading_to_deleted_fields, "\", \"")
+                    + "\" led to empty fields in the record w/ control number " + record->getControlNumber() + " and field(s) "
+                    + StringUtil::Join(tags_of_deleted_fields, ',') + "!");
         record->deleteFields(indices_of_deleted_fields);
     }
 
@@ -649,11 +692,11 @@ bool ReplaceSubfields(const std::vector<std::string> &subfield_specs, RegexMatch
 }
 
 
-bool SubstituteWithinSubfields(const std::vector<std::string> &subfield_specs, RegexMatcher &matcher, const std::string &replacement,
-                               MARC::Record * const record) {
+bool SubstituteWithinSubfields(const FilterDescriptor &filter, MARC::Record * const record) {
+    const RegexSet &regex_set(filter.getRegexSet());
     bool modified_at_least_one_field(false);
     for (auto &field : *record) {
-        const std::string subfield_codes(GetSubfieldCodes(field.getTag(), subfield_specs));
+        const std::string subfield_codes(GetSubfieldCodes(field.getTag(), filter.getSubfieldSpecs()));
         if (subfield_codes.empty())
             continue;
 
@@ -663,11 +706,16 @@ bool SubstituteWithinSubfields(const std::vector<std::string> &subfield_specs, R
             if (subfield_codes.find(subfield.code_) == std::string::npos)
                 continue;
 
-            auto new_field_contents(matcher.replaceWithBackreferences(subfield.value_, replacement, /* global = */ true));
-            if (new_field_contents != subfield.value_) {
-                subfield.value_.swap(new_field_contents);
+            if (ApplyPatternsInOrder(regex_set, &subfield.value_, [&filter, &regex_set, &subfield](const size_t pattern_index) {
+                    auto new_subfield_value(regex_set.getMatcher(pattern_index)
+                                                .replaceWithBackreferences(subfield.value_, filter.getReplacement(pattern_index),
+                                                                           /* global = */ true));
+                    if (new_subfield_value == subfield.value_)
+                        return false;
+                    subfield.value_.swap(new_subfield_value);
+                    return true;
+                }))
                 modified_at_least_one_subfield = true;
-            }
         }
 
         if (modified_at_least_one_subfield) {
@@ -689,23 +737,12 @@ bool ReplaceStringsWithStrings(const std::vector<std::string> &subfield_specs,
         if (subfield_codes.empty())
             continue;
 
-        bool modified_at_least_one_subfield(false);
-        MARC::Subfields subfields(field.getSubfields());
-        for (auto &subfield : subfields) {
-            if (subfield_codes.find(subfield.code_) == std::string::npos)
-                continue;
-
-            const auto original_and_replacement(originals_to_replacements_map.find(subfield.value_));
-            if (original_and_replacement != originals_to_replacements_map.cend()) {
-                subfield.value_ = original_and_replacement->second;
-                modified_at_least_one_subfield = true;
-            }
-        }
-
-        if (modified_at_least_one_subfield) {
+        const auto lookup_replacement([&originals_to_replacements_map](const std::string_view value) -> const std::string * {
+            const auto original_and_replacement(originals_to_replacements_map.find(std::string(value)));
+            return (original_and_replacement == originals_to_replacements_map.cend()) ? nullptr : &original_and_replacement->second;
+        });
+        if (field.replaceSubfieldValues(subfield_codes, lookup_replacement))
             modified_at_least_one_field = true;
-            field.setContents(std::string(1, field.getIndicator1()) + std::string(1, field.getIndicator2()) + subfields.toString());
-        }
     }
 
     return modified_at_least_one_field;
@@ -757,13 +794,12 @@ void Filter(const std::vector<FilterDescriptor> &filters, MARC::Reader * const m
                     continue;
                 }
             } else if (filter.getFilterType() == FilterType::REPLACE) {
-                if (ReplaceSubfields(filter.getSubfieldSpecs(), filter.getRegexMatcher(), filter.getStringFragmentsAndBackreferences(),
-                                     &record)) {
+                if (ReplaceSubfields(filter, &record)) {
                     modified_record = true;
                     continue;
                 }
             } else if (filter.getFilterType() == FilterType::GLOBAL_SUBSTITUTION) {
-                if (SubstituteWithinSubfields(filter.getSubfieldSpecs(), filter.getRegexMatcher(), filter.getReplacement(), &record)) {
+                if (SubstituteWithinSubfields(filter, &record)) {
                     modified_record = true;
                     continue;
                 }
@@ -903,7 +939,8 @@ void ExtractSubfieldSpecs(const std::string &command, char ***argvp, std::vector
 }
 
 
-void LoadReplaceMapFile(const std::string &map_filename, std::unordered_map<std::string, std::string> * const regexes_to_replacements_map) {
+void LoadReplaceMapFile(const std::string &map_filename,
+                        std::vector<std::pair<std::string, std::string>> * const regexes_and_replacements) {
     std::unique_ptr<File> input(FileUtil::OpenInputFileOrDie(map_filename));
     unsigned line_no(0);
     while (not input->eof()) {
@@ -921,7 +958,7 @@ void LoadReplaceMapFile(const std::string &map_filename, std::unordered_map<std:
             LOG_ERROR("bad line #" + std::to_string(line_no) + ": missing regex before \"->\" in \"" + map_filename + "\"!");
         if (unlikely(arrow_start + 1 == line.length()))
             LOG_ERROR("bad line #" + std::to_string(line_no) + ": missing replacement text after \"->\" in \"" + map_filename + "\"!");
-        regexes_to_replacements_map->emplace(std::make_pair(line.substr(0, arrow_start), line.substr(arrow_start + 2)));
+        regexes_and_replacements->emplace_back(line.substr(0, arrow_start), line.substr(arrow_start + 2));
     }
 }
 
@@ -934,14 +971,12 @@ void ProcessReplaceCommand(char ***argvp, std::vector<FilterDescriptor> * const
     const std::string regex_or_map_filename(**argvp);
     ++*argvp;
     if (**argvp == nullptr or StringUtil::StartsWith(**argvp, "--")) {
-        std::unordered_map<std::string, std::string> regexes_to_replacements_map;
-        LoadReplaceMapFile(regex_or_map_filename, &regexes_to_replacements_map);
-        for (const auto &regex_and_replacement : regexes_to_replacements_map)
-            filters->emplace_back(
-                FilterDescriptor::MakeReplacementFilter(subfield_specs, regex_and_replacement.first, regex_and_replacement.second));
+        std::vector<std::pair<std::string, std::string>> regexes_and_replacements;
+        LoadReplaceMapFile(regex_or_map_filename, &regexes_and_replacements);
+        filters->emplace_back(FilterDescriptor::MakeReplacementFilter(subfield_specs, regexes_and_replacements));
     } else {
         const std::string replacement(**argvp);
-        filters->emplace_back(FilterDescriptor::MakeReplacementFilter(subfield_specs, regex_or_map_filename, replacement));
+        filters->emplace_back(FilterDescriptor::MakeReplacementFilter(subfield_specs, { { regex_or_map_filename, replacement } }));
         ++*argvp;
     }
 }
@@ -955,15 +990,13 @@ void ProcessGloballySubstituteCommand(char ***argvp, std::vector<FilterDescripto
     const std::string regex_or_map_filename(**argvp);
     ++*argvp;
     if (**argvp == nullptr or StringUtil::StartsWith(**argvp, "--")) {
-        std::unordered_map<std::string, std::string> regexes_to_replacements_map;
-        LoadReplaceMapFile(regex_or_map_filename, &regexes_to_replacements_map);
-        for (const auto &regex_and_replacement : regexes_to_replacements_map)
-            filters->emplace_back(
-                FilterDescriptor::MakeGlobalSubstitutionFilter(subfield_specs, regex_and_replacement.first, regex_and_replacement.second));
+        std::vector<std::pair<std::string, std::string>> regexes_and_replacements;
+        LoadReplaceMapFile(regex_or_map_filename, &regexes_and_replacements);
+        filters->emplace_back(FilterDescriptor::MakeGlobalSubstitutionFilter(subfield_specs, regexes_and_replacements));
     } else {
         const std::string replacement(**argvp);
         ++*argvp;
-        filters->emplace_back(FilterDescriptor::MakeGlobalSubstitutionFilter(subfield_specs, regex_or_map_filename, replacement));
+        filters->emplace_back(FilterDescriptor::MakeGlobalSubstitutionFilter(subfield_specs, { { regex_or_map_filename, replacement } }));
     }
 }
 
@@ -18,13 +18,24 @@
  */
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <thread>
 #include <cstdlib>
 #include <cstring>
 #include "Compiler.h"
+#include "CompressedFile.h"
+#include "FileUtil.h"
 #include "MARC.h"
+#include "MarcTagIndex.h"
 #include "RegexMatcher.h"
 #include "StringUtil.h"
+#include "ThreadUtil.h"
 #include "util.h"
 
 
@@ -33,7 +44,7 @@ namespace {
 
 [[noreturn]] void Usage() {
     ::Usage(
-        "--query=query --output=field_and_or_subfield_list [--output-format=output_format] marc_file1 [marc_file2 .. marc_fileN]\n"
+        "[--thread-count=N] [--index=tag_index] --query=query --output=field_and_or_subfield_list marc_file1 [marc_file2 .. marc_fileN]\n"
         "Queries have the following syntax:\n"
         "expression → term {OR term}\n"
         "term       → factor {AND factor}\n"
@@ -41,7 +52,11 @@ namespace {
         "factor     → NOT factor\n"
         "factor     → '(' expression ')'\n"
         "\'field_and_or_subfield_list\" is a semicolon-separated list of field or subfield references.  The special \"list\" is\n"
-        "the assterisk which implies that an entire record will be output.");
+        "the assterisk which implies that an entire record will be output.\n"
+        "The records are processed by \"N\" threads, by default one per CPU core.  The output is in input order, nonetheless.\n"
+        "\"tag_index\" has to have been generated by create_marc_tag_index for the single MARC file.  It will then be used to only\n"
+        "read records that contain at least one of the tags that the query requires.  W/o --index we use the sidecar tag\n"
+        "indices of the MARC files, e.g. \"x.mrc.tag_index\" for \"x.mrc\", if they exist and are up to date.");
     std::exit(EXIT_FAILURE);
 }
 
@@ -256,8 +271,17 @@ class Query {
     public:
         virtual ~Node() = 0;
         virtual NodeType getNodeType() const = 0;
-        virtual bool eval(const MARC::Record &record) const = 0;
+        inline bool eval(const MARC::Record &record) const { return matches(record) != invert_; }
         inline void toggleInvert() { invert_ = not invert_; }
+
+        /** \brief Sets "candidate_tags" such that only records that contain at least one of them could possibly be matched.
+         *  \return False if we can't rule out any records based on their tags alone.
+         */
+        virtual bool getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const = 0;
+
+    protected:
+        //* \return The result, ignoring any inversion.
+        virtual bool matches(const MARC::Record &record) const = 0;
     };
 
     class AndNode final : public Node {
@@ -270,7 +294,10 @@ class Query {
                 delete child_node;
         }
         virtual NodeType getNodeType() const override { return AND_NODE; }
-        virtual bool eval(const MARC::Record &record) const override;
+        virtual bool getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const override;
+
+    protected:
+        virtual bool matches(const MARC::Record &record) const override;
     };
 
     class OrNode final : public Node {
@@ -283,7 +310,10 @@ class Query {
                 delete child_node;
         }
         virtual NodeType getNodeType() const override { return OR_NODE; }
-        virtual bool eval(const MARC::Record &record) const override;
+        virtual bool getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const override;
+
+    protected:
+        virtual bool matches(const MARC::Record &record) const override;
     };
 
     class StringComparisonNode final : public Node {
@@ -302,26 +332,32 @@ class Query {
         }
         virtual ~StringComparisonNode() override final = default;
         virtual NodeType getNodeType() const override { return STRING_COMPARISON_NODE; }
-        virtual bool eval(const MARC::Record &record) const override;
+        virtual bool getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const override;
+
+    protected:
+        virtual bool matches(const MARC::Record &record) const override;
     };
 
     class RegexComparisonNode final : public Node {
         MARC::Tag field_tag_;
         char subfield_code_;
-        RegexMatcher *regex_;
+        const ThreadSafeRegexMatcher regex_;
 
     public:
-        RegexComparisonNode(const std::string &field_or_subfield_reference, RegexMatcher * const regex, const bool invert)
+        RegexComparisonNode(const std::string &field_or_subfield_reference, const std::string &pattern, const bool invert)
             : field_tag_(field_or_subfield_reference.substr(0, MARC::Record::TAG_LENGTH)),
               subfield_code_(field_or_subfield_reference.length() > MARC::Record::TAG_LENGTH
                                  ? field_or_subfield_reference[MARC::Record::TAG_LENGTH]
                                  : '\0'),
-              regex_(regex) {
+              regex_(pattern, ThreadSafeRegexMatcher::ENABLE_JIT) {
             invert_ = invert;
         }
-        virtual ~RegexComparisonNode() override final { delete regex_; }
-        virtual NodeType getNodeType() const override { return STRING_COMPARISON_NODE; }
-        virtual bool eval(const MARC::Record &record) const override;
+        virtual ~RegexComparisonNode() override final = default;
+        virtual NodeType getNodeType() const override { return REGEX_COMPARISON_NODE; }
+        virtual bool getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const override;
+
+    protected:
+        virtual bool matches(const MARC::Record &record) const override;
     };
 
     class FunctionCallNode final : public Node {
@@ -332,7 +368,10 @@ class Query {
         FunctionCallNode(const FunctionDesc * const function_desc, const std::vector<std::string> &args)
             : function_desc_(function_desc), args_(args) { }
         virtual NodeType getNodeType() const override { return FUNC_CALL_NODE; }
-        virtual bool eval(const MARC::Record &record) const override;
+        virtual bool getCandidateTags(std::set<MARC::Tag> * const /*candidate_tags*/) const override { return false; }
+
+    protected:
+        virtual bool matches(const MARC::Record &record) const override;
     };
 
     Tokenizer tokenizer_;
@@ -342,8 +381,14 @@ public:
     explicit Query(const std::string &query, const std::vector<FunctionDesc *> &function_descriptors);
     ~Query() { delete root_; }
 
+    //* \note Thread-safe.
     bool matched(const MARC::Record &record) const;
 
+    /** \brief Sets "candidate_tags" such that only records that contain at least one of them could possibly be matched.
+     *  \return False if we can't rule out any records based on their tags alone.
+     */
+    bool getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const;
+
 private:
     Node *parseExpression();
     Node *parseTerm();
@@ -357,36 +402,71 @@ Query::Node::~Node() {
 }
 
 
-bool Query::AndNode::eval(const MARC::Record &record) const {
+bool Query::AndNode::matches(const MARC::Record &record) const {
     for (const auto child_node : children_) {
         if (not child_node->eval(record))
-            return invert_ ? true : false;
+            return false;
     }
 
     return true;
 }
 
 
-bool Query::OrNode::eval(const MARC::Record &record) const {
+bool Query::AndNode::getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const {
+    if (invert_)
+        return false;
+
+    // The candidate tags of any child will do, so we pick the smallest set:
+    bool found_candidate_tags(false);
+    for (const auto child_node : children_) {
+        std::set<MARC::Tag> child_candidate_tags;
+        if (child_node->getCandidateTags(&child_candidate_tags)
+            and (not found_candidate_tags or child_candidate_tags.size() < candidate_tags->size()))
+        {
+            candidate_tags->swap(child_candidate_tags);
+            found_candidate_tags = true;
+        }
+    }
+
+    return found_candidate_tags;
+}
+
+
+bool Query::OrNode::matches(const MARC::Record &record) const {
     for (const auto child_node : children_) {
         if (child_node->eval(record))
-            return invert_ ? false : true;
+            return true;
     }
 
     return false;
 }
 
 
-bool Query::StringComparisonNode::eval(const MARC::Record &record) const {
+bool Query::OrNode::getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const {
+    if (invert_)
+        return false;
+
+    for (const auto child_node : children_) {
+        std::set<MARC::Tag> child_candidate_tags;
+        if (not child_node->getCandidateTags(&child_candidate_tags))
+            return false;
+        candidate_tags->insert(child_candidate_tags.cbegin(), child_candidate_tags.cend());
+    }
+
+    return true;
+}
+
+
+bool Query::StringComparisonNode::matches(const MARC::Record &record) const {
     for (const auto &field : record.getTagRange(field_tag_)) {
         if (subfield_code_ == '\0') {
             if (field.getContents() == string_const_)
-                return not invert_;
+                return true;
         } else {
             const MARC::Subfields subfields(field.getSubfields());
             for (const auto &value_and_code : subfields) {
                 if (value_and_code.code_ == subfield_code_ and value_and_code.value_ == string_const_)
-                    return not invert_;
+                    return true;
             }
         }
     }
@@ -395,16 +475,25 @@ bool Query::StringComparisonNode::eval(const MARC::Record &record) const {
 }
 
 
-bool Query::RegexComparisonNode::eval(const MARC::Record &record) const {
+bool Query::StringComparisonNode::getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const {
+    if (invert_)
+        return false;
+
+    candidate_tags->emplace(field_tag_);
+    return true;
+}
+
+
+bool Query::RegexComparisonNode::matches(const MARC::Record &record) const {
     for (const auto &field : record.getTagRange(field_tag_)) {
         if (subfield_code_ == '\0') {
-            if (regex_->matched(field.getContents()))
-                return not invert_;
+            if (regex_.matched(field.getContents()))
+                return true;
         } else {
             const MARC::Subfields subfields(field.getSubfields());
             for (const auto &value_and_code : subfields) {
-                if (value_and_code.code_ == subfield_code_ and regex_->matched(value_and_code.value_))
-                    return not invert_;
+                if (value_and_code.code_ == subfield_code_ and regex_.matched(value_and_code.value_))
+                    return true;
             }
         }
     }
@@ -413,7 +502,16 @@ bool Query::RegexComparisonNode::eval(const MARC::Record &record) const {
 }
 
 
-bool Query::FunctionCallNode::eval(const MARC::Record &record) const {
+bool Query::RegexComparisonNode::getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const {
+    if (invert_)
+        return false;
+
+    candidate_tags->emplace(field_tag_);
+    return true;
+}
+
+
+bool Query::FunctionCallNode::matches(const MARC::Record &record) const {
     return function_desc_->eval(record, args_);
 }
 
@@ -431,6 +529,12 @@ bool Query::matched(const MARC::Record &record) const {
 }
 
 
+bool Query::getCandidateTags(std::set<MARC::Tag> * const candidate_tags) const {
+    candidate_tags->clear();
+    return root_->getCandidateTags(candidate_tags);
+}
+
+
 Query::Node *Query::parseExpression() {
     std::vector<Node *> children;
     children.emplace_back(parseTerm());
@@ -493,10 +597,9 @@ Query::Node *Query::parseFactor() {
             throw std::runtime_error("expected a string constant or a regex after " + Tokenizer::TokenTypeToString(equality_operator)
                                      + ", found " + Tokenizer::TokenTypeToString(token) + " instead! (" + tokenizer_.getLastErrorMessage()
                                      + ")");
-        if (token == REGEX) {
-            RegexMatcher * const regex_matcher(RegexMatcher::RegexMatcherFactoryOrDie(tokenizer_.getLastString()));
-            return new RegexComparisonNode(field_or_subfield_reference, regex_matcher, equality_operator == NOT_EQUALS);
-        } else
+        if (token == REGEX)
+            return new RegexComparisonNode(field_or_subfield_reference, tokenizer_.getLastString(), equality_operator == NOT_EQUALS);
+        else
             return new StringComparisonNode(field_or_subfield_reference, tokenizer_.getLastString(), equality_operator == NOT_EQUALS);
     }
 
@@ -514,7 +617,13 @@ Query::Node *Query::parseFactor() {
                                          + function_descriptor.getName() + ", instead we found " + Tokenizer::TokenTypeToString(token) + "!"
                                          + std::string(token == ERROR ? " (" + tokenizer_.getLastErrorMessage() + ")" : ""));
             args.emplace_back(tokenizer_.getLastString());
+            token = tokenizer_.getNextToken();
+            if (token == COMMA)
+                token = tokenizer_.getNextToken();
         }
+        if (args.size() != function_descriptor.getArity())
+            throw std::runtime_error(function_descriptor.getName() + " expects " + std::to_string(function_descriptor.getArity())
+                                     + " argument(s) but was called w/ " + std::to_string(args.size()) + "!");
 
         return new FunctionCallNode(&function_descriptor, args);
     }
@@ -558,12 +667,10 @@ inline void ExtractRefsToSingleField(std::vector<std::string>::const_iterator &r
 }
 
 
-void GenerateOutput(const std::string &prefix, const MARC::Record::Field &field,
-                    const std::vector<std::string>::const_iterator &range_start,
-                    const std::vector<std::string>::const_iterator &range_end) {
-    std::cout << prefix;
+void GenerateOutput(const MARC::Record::Field &field, const std::vector<std::string>::const_iterator &range_start,
+                    const std::vector<std::string>::const_iterator &range_end, std::string * const output) {
     if (*range_start == "*" or range_start->length() == MARC::Record::TAG_LENGTH)
-        std::cout << StringUtil::Map(field.getContents(), '\x1F', '$') << '\n';
+        *output += StringUtil::Map(field.getContents(), '\x1F', '$') + '\n';
     else {
         const MARC::Subfields subfields(field.getSubfields());
         auto subfield(subfields.begin());
@@ -576,51 +683,417 @@ void GenerateOutput(const std::string &prefix, const MARC::Record::Field &field,
             else if (subfield_ref_code < subfield->code_)
                 ++subfield_ref;
             else {
-                std::cout << '"' << subfield->value_ << '"';
+                *output += '"' + subfield->value_ + '"';
                 if (found_at_least_one)
                     found_at_least_one = false;
                 else
-                    std::cout << ';';
+                    *output += ';';
                 ++subfield;
                 ++subfield_ref;
             }
         }
         if (not found_at_least_one)
-            std::cout << '\n';
+            *output += '\n';
+    }
+}
+
+
+void GenerateOutput(const MARC::Record &record, const std::vector<std::string> &field_and_subfield_output_list,
+                    std::string * const output) {
+    if (field_and_subfield_output_list.front() == "*") {
+        for (const auto &field : record)
+            GenerateOutput(field, field_and_subfield_output_list.cbegin(), field_and_subfield_output_list.cend(), output);
+        return;
+    }
+
+    auto range_start(field_and_subfield_output_list.cbegin());
+    auto range_end(range_start);
+    ExtractRefsToSingleField(range_start, range_end, field_and_subfield_output_list.cend());
+    auto field(record.begin());
+    while (field != record.end() and range_start != field_and_subfield_output_list.cend()) {
+        if (field->getTag() == range_start->substr(0, MARC::Record::TAG_LENGTH)) {
+            GenerateOutput(*field, range_start, range_end, output);
+            ++field;
+        } else if (field->getTag() > range_start->substr(0, MARC::Record::TAG_LENGTH)) {
+            range_start = range_end;
+            while (range_start != field_and_subfield_output_list.cend()
+                   and field->getTag() > range_start->substr(0, MARC::Record::TAG_LENGTH))
+                ++range_start;
+            if (range_start != field_and_subfield_output_list.cend())
+                ExtractRefsToSingleField(range_start, range_end, field_and_subfield_output_list.cend());
+        } else
+            ++field;
+    }
+}
+
+
+inline unsigned ToUnsigned(const char *cp, unsigned count) {
+    unsigned retval(0);
+    while (count-- > 0)
+        retval = retval * 10 + (*cp++ - '0');
+    return retval;
+}
+
+
+inline uint32_t TagToKey(const char * const tag) {
+    return (uint32_t(uint8_t(tag[0])) << 16) | (uint32_t(uint8_t(tag[1])) << 8) | uint8_t(tag[2]);
+}
+
+
+// Calls "entry_processor" w/ a pointer to each directory entry of a binary MARC record until it returns false.
+template <typename EntryProcessor>
+void ScanDirectory(const std::string &raw_record, EntryProcessor entry_processor) {
+    const size_t base_address_of_data(ToUnsigned(raw_record.data() + 12, 5));
+    if (unlikely(base_address_of_data > raw_record.size()))
+        LOG_ERROR("bad base address of data in a raw MARC record!");
+
+    // The directory is terminated by a field terminator:
+    for (size_t entry_start(MARC::Record::LEADER_LENGTH); entry_start + MARC::Record::DIRECTORY_ENTRY_LENGTH < base_address_of_data;
+         entry_start += MARC::Record::DIRECTORY_ENTRY_LENGTH)
+    {
+        if (not entry_processor(raw_record.data() + entry_start))
+            return;
+    }
+}
+
+
+// \return True if the directory of the binary MARC record "raw_record" has an entry w/ one of the tags in "sorted_tag_keys".
+bool DirectoryContainsAnyTag(const std::string &raw_record, const std::vector<uint32_t> &sorted_tag_keys) {
+    bool found(false);
+    ScanDirectory(raw_record, [&sorted_tag_keys, &found](const char * const entry) {
+        found = std::binary_search(sorted_tag_keys.cbegin(), sorted_tag_keys.cend(), TagToKey(entry));
+        return not found;
+    });
+    return found;
+}
+
+
+std::string_view GetControlNumber(const std::string &raw_record) {
+    std::string_view control_number;
+    ScanDirectory(raw_record, [&raw_record, &control_number](const char * const entry) {
+        if (std::memcmp(entry, "001", MARC::Record::TAG_LENGTH) != 0)
+            return true;
+
+        const unsigned field_length(ToUnsigned(entry + 3, 4)), field_start(ToUnsigned(entry + 7, 5));
+        const size_t base_address_of_data(ToUnsigned(raw_record.data() + 12, 5));
+        if (likely(field_length > 0 and base_address_of_data + field_start + field_length <= raw_record.size()))
+            control_number = std::string_view(raw_record.data() + base_address_of_data + field_start, field_length - 1);
+        return false;
+    });
+    return control_number;
+}
+
+
+// Reads binary MARC records w/o parsing them.
+class RawRecordReader {
+    std::unique_ptr<File> input_;
+
+public:
+    explicit RawRecordReader(const std::string &path);
+
+    //* \return False if we hit EOF, o/w true.
+    bool read(std::string * const raw_record);
+};
+
+
+RawRecordReader::RawRecordReader(const std::string &path) {
+    if (CompressedFile::GuessCodec(path) == CompressedFile::Codec::NONE)
+        input_ = FileUtil::OpenInputFileOrDie(path);
+    else {
+        input_.reset(new File(path, "ru"));
+        if (input_->fail())
+            LOG_ERROR("can't open \"" + path + "\" for reading!");
+    }
+}
+
+
+bool RawRecordReader::read(std::string * const raw_record) {
+    raw_record->resize(MARC::Record::RECORD_LENGTH_FIELD_LENGTH);
+    const size_t bytes_read(input_->read(raw_record->data(), MARC::Record::RECORD_LENGTH_FIELD_LENGTH));
+    if (bytes_read == 0)
+        return false;
+    if (unlikely(bytes_read != MARC::Record::RECORD_LENGTH_FIELD_LENGTH))
+        LOG_ERROR("failed to read a record length from \"" + input_->getPath() + "\"!");
+
+    const unsigned record_length(ToUnsigned(raw_record->data(), MARC::Record::RECORD_LENGTH_FIELD_LENGTH));
+    if (unlikely(record_length <= MARC::Record::LEADER_LENGTH))
+        LOG_ERROR("bad record length in \"" + input_->getPath() + "\"!");
+    raw_record->resize(record_length);
+    if (unlikely(input_->read(raw_record->data() + MARC::Record::RECORD_LENGTH_FIELD_LENGTH,
+                              record_length - MARC::Record::RECORD_LENGTH_FIELD_LENGTH)
+                 != record_length - MARC::Record::RECORD_LENGTH_FIELD_LENGTH))
+        LOG_ERROR("failed to read a record from \"" + input_->getPath() + "\", the file may be truncated!");
+
+    return true;
+}
+
+
+constexpr size_t BATCH_SIZE(500); // records
+constexpr unsigned MAX_QUEUED_BATCHES_PER_THREAD(2);
+constexpr unsigned MAX_CONCURRENTLY_READ_FILES(4);
+
+
+struct RecordBatch {
+    // Binary MARC records will only be parsed by the worker threads.  A logical record may consist of several physical
+    // records w/ the same control number, "logical_record_starts_" holds the index of the first physical record of each.
+    std::vector<std::string> raw_records_;
+    std::vector<size_t> logical_record_starts_;
+
+    // Used for MARC-XML and when reading via a tag index.
+    std::vector<MARC::Record> records_;
+
+    std::string output_;
+    unsigned record_count_, matched_count_;
+    bool processed_;
+
+public:
+    RecordBatch(): record_count_(0), matched_count_(0), processed_(false) { }
+    inline size_t size() const { return logical_record_starts_.size() + records_.size(); }
+};
+
+
+// Hands out batches of records to the worker threads and returns the processed batches of each input file in input order.
+class BatchQueue {
+    const size_t max_batches_per_file_;
+    std::vector<std::deque<std::shared_ptr<RecordBatch>>> files_and_batches_;
+    std::vector<bool> files_and_completion_flags_;
+    unsigned completed_file_count_;
+    ThreadUtil::BoundedQueue<std::shared_ptr<RecordBatch>> unprocessed_batches_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+
+public:
+    BatchQueue(const size_t max_batches_per_file, const size_t file_count)
+        : max_batches_per_file_(max_batches_per_file), files_and_batches_(file_count), files_and_completion_flags_(file_count),
+          completed_file_count_(0), unprocessed_batches_(max_batches_per_file * file_count) { }
+
+    //* \note Blocks if too many batches of "file_no" are waiting.
+    void push(const unsigned file_no, const std::shared_ptr<RecordBatch> &batch);
+
+    //* \brief Signals that no more batches of "file_no" will be pushed.
+    void markFileAsComplete(const unsigned file_no);
+
+    //* \return The next batch that a worker thread should process or nullptr if all input has been processed.
+    std::shared_ptr<RecordBatch> getUnprocessedBatch();
+
+    void markBatchAsProcessed(RecordBatch * const batch);
+
+    //* \return The next processed batch of "file_no" or nullptr if all batches of "file_no" have been returned.
+    std::shared_ptr<RecordBatch> popProcessedBatch(const unsigned file_no);
+};
+
+
+void BatchQueue::push(const unsigned file_no, const std::shared_ptr<RecordBatch> &batch) {
+    {
+        std::unique_lock<std::mutex> mutex_locker(mutex_);
+        condition_.wait(mutex_locker, [this, file_no] { return files_and_batches_[file_no].size() < max_batches_per_file_; });
+        files_and_batches_[file_no].emplace_back(batch);
+    }
+    unprocessed_batches_.push(std::shared_ptr<RecordBatch>(batch));
+}
+
+
+void BatchQueue::markFileAsComplete(const unsigned file_no) {
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+    files_and_completion_flags_[file_no] = true;
+    if (++completed_file_count_ == files_and_batches_.size())
+        unprocessed_batches_.close();
+    condition_.notify_all();
+}
+
+
+std::shared_ptr<RecordBatch> BatchQueue::getUnprocessedBatch() {
+    std::shared_ptr<RecordBatch> batch;
+    return unprocessed_batches_.pop(&batch) ? batch : nullptr;
+}
+
+
+void BatchQueue::markBatchAsProcessed(RecordBatch * const batch) {
+    std::lock_guard<std::mutex> mutex_locker(mutex_);
+    batch->processed_ = true;
+    condition_.notify_all();
+}
+
+
+std::shared_ptr<RecordBatch> BatchQueue::popProcessedBatch(const unsigned file_no) {
+    auto &batches(files_and_batches_[file_no]);
+    std::unique_lock<std::mutex> mutex_locker(mutex_);
+    condition_.wait(mutex_locker, [this, &batches, file_no] {
+        return (not batches.empty() and batches.front()->processed_) or (batches.empty() and files_and_completion_flags_[file_no]);
+    });
+    if (batches.empty())
+        return nullptr;
+
+    const auto batch(batches.front());
+    batches.pop_front();
+    condition_.notify_all();
+    return batch;
+}
+
+
+// Splits a binary MARC file into batches of raw records.
+void ReadRawRecords(const std::string &marc_path, const unsigned file_no, BatchQueue * const batch_queue) {
+    RawRecordReader raw_record_reader(marc_path);
+    auto batch(std::make_shared<RecordBatch>());
+    std::string raw_record, last_control_number;
+    while (raw_record_reader.read(&raw_record)) {
+        // Physical records w/ the same control number as their predecessor will be merged w/ it, just like MARC::Reader does.
+        const std::string_view control_number(GetControlNumber(raw_record));
+        if (batch->size() == 0 or control_number != last_control_number) {
+            if (batch->size() == BATCH_SIZE) {
+                batch_queue->push(file_no, batch);
+                batch = std::make_shared<RecordBatch>();
+            }
+            batch->logical_record_starts_.emplace_back(batch->raw_records_.size());
+            last_control_number = control_number;
+        }
+        batch->raw_records_.emplace_back(std::move(raw_record));
     }
+    if (batch->size() > 0)
+        batch_queue->push(file_no, batch);
+
+    batch_queue->markFileAsComplete(file_no);
 }
 
 
-void ProcessRecords(const Query &query, MARC::Reader * const marc_reader, const std::vector<std::string> &field_and_subfield_output_list) {
-    unsigned record_count(0), matched_count(0);
-    while (const MARC::Record record = marc_reader->read()) {
-        ++record_count;
+// Reads MARC-XML, or, if we have a tag index, only the records that contain at least one of "candidate_tags".
+void ReadRecords(const std::string &marc_path, const unsigned file_no, const MarcTagIndex * const tag_index,
+                 const std::set<MARC::Tag> &candidate_tags, BatchQueue * const batch_queue) {
+    const auto marc_reader(MARC::Reader::Factory(marc_path));
+    auto batch(std::make_shared<RecordBatch>());
+    const auto push_record([&batch, batch_queue, file_no](MARC::Record &&record) {
+        batch->records_.emplace_back(std::move(record));
+        if (batch->size() == BATCH_SIZE) {
+            batch_queue->push(file_no, batch);
+            batch = std::make_shared<RecordBatch>();
+        }
+    });
+
+    if (tag_index == nullptr) {
+        while (MARC::Record record = marc_reader->read())
+            push_record(std::move(record));
+    } else {
+        std::vector<uint32_t> record_ordinals;
+        tag_index->getRecordsWithAnyTag(candidate_tags, &record_ordinals);
+        size_t next_record_ordinal(0);
+        for (const auto record_ordinal : record_ordinals) {
+            if (record_ordinal != next_record_ordinal and unlikely(not marc_reader->seek(tag_index->getRecordOffset(record_ordinal))))
+                LOG_ERROR("failed to seek to record #" + std::to_string(record_ordinal) + " in \"" + marc_path + "\"!");
+            MARC::Record record(marc_reader->read());
+            if (unlikely(not record))
+                LOG_ERROR("unexpected EOF in \"" + marc_path + "\", the tag index may be out of date!");
+            push_record(std::move(record));
+            next_record_ordinal = record_ordinal + 1;
+        }
+    }
+    if (batch->size() > 0)
+        batch_queue->push(file_no, batch);
+
+    batch_queue->markFileAsComplete(file_no);
+}
+
 
-        if (not query.matched(record))
+void ProcessBatch(const Query &query, const std::vector<uint32_t> &candidate_tag_keys,
+                  const std::vector<std::string> &field_and_subfield_output_list, RecordBatch * const batch) {
+    const auto process_record([&query, &field_and_subfield_output_list, batch](const MARC::Record &record) {
+        if (query.matched(record)) {
+            ++batch->matched_count_;
+            GenerateOutput(record, field_and_subfield_output_list, &batch->output_);
+        }
+    });
+
+    for (auto logical_record_start(batch->logical_record_starts_.cbegin()); logical_record_start != batch->logical_record_starts_.cend();
+         ++logical_record_start)
+    {
+        ++batch->record_count_;
+        const auto raw_records_begin(batch->raw_records_.cbegin() + *logical_record_start);
+        const auto raw_records_end(logical_record_start + 1 == batch->logical_record_starts_.cend()
+                                       ? batch->raw_records_.cend()
+                                       : batch->raw_records_.cbegin() + *(logical_record_start + 1));
+
+        // Skip records that lack all candidate tags w/o parsing them:
+        if (not candidate_tag_keys.empty()
+            and std::none_of(raw_records_begin, raw_records_end, [&candidate_tag_keys](const std::string &raw_record) {
+                    return DirectoryContainsAnyTag(raw_record, candidate_tag_keys);
+                }))
             continue;
-        ++matched_count;
-
-        auto range_start(field_and_subfield_output_list.cbegin());
-        auto range_end(range_start);
-        ExtractRefsToSingleField(range_start, range_end, field_and_subfield_output_list.cend());
-        auto field(record.begin());
-        while (field != record.end() and range_start != field_and_subfield_output_list.cend()) {
-            if (field->getTag() == range_start->substr(0, MARC::Record::TAG_LENGTH)) {
-                GenerateOutput("", *field, range_start, range_end);
-                ++field;
-            } else if (field->getTag() > range_start->substr(0, MARC::Record::TAG_LENGTH)) {
-                range_start = range_end;
-                while (range_start != field_and_subfield_output_list.cend()
-                       and field->getTag() > range_start->substr(0, MARC::Record::TAG_LENGTH))
-                    ++range_start;
-                if (range_start != field_and_subfield_output_list.cend())
-                    ExtractRefsToSingleField(range_start, range_end, field_and_subfield_output_list.cend());
-            } else
-                ++field;
+
+        MARC::Record record(raw_records_begin->size(), raw_records_begin->data());
+        for (auto raw_record(raw_records_begin + 1); raw_record != raw_records_end; ++raw_record)
+            record.merge(MARC::Record(raw_record->size(), raw_record->data()));
+        record.sortFieldTags(record.begin(), record.end());
+        process_record(record);
+    }
+
+    for (const auto &record : batch->records_) {
+        ++batch->record_count_;
+        process_record(record);
+    }
+
+    // We may have to wait a while until our output will be needed, so we release the memory of the input right away:
+    std::vector<std::string>().swap(batch->raw_records_);
+    std::vector<MARC::Record>().swap(batch->records_);
+}
+
+
+// "tag_indices" has an entry for each of "marc_paths" which may be nullptr.
+void ProcessFiles(const Query &query, const std::vector<std::string> &marc_paths,
+                  const std::vector<std::unique_ptr<MarcTagIndex>> &tag_indices,
+                  const std::vector<std::string> &field_and_subfield_output_list, const unsigned thread_count) {
+    std::set<MARC::Tag> candidate_tags;
+    if (not query.getCandidateTags(&candidate_tags))
+        candidate_tags.clear();
+    std::vector<uint32_t> candidate_tag_keys;
+    for (const auto &candidate_tag : candidate_tags)
+        candidate_tag_keys.emplace_back(TagToKey(candidate_tag.c_str()));
+    std::sort(candidate_tag_keys.begin(), candidate_tag_keys.end());
+
+    BatchQueue batch_queue(thread_count * MAX_QUEUED_BATCHES_PER_THREAD, marc_paths.size());
+    std::vector<std::thread> worker_threads;
+    for (unsigned thread_no(0); thread_no < thread_count; ++thread_no) {
+        worker_threads.emplace_back([&query, &candidate_tag_keys, &field_and_subfield_output_list, &batch_queue] {
+            std::shared_ptr<RecordBatch> batch;
+            while ((batch = batch_queue.getUnprocessedBatch()) != nullptr) {
+                ProcessBatch(query, candidate_tag_keys, field_and_subfield_output_list, batch.get());
+                batch_queue.markBatchAsProcessed(batch.get());
+            }
+        });
+    }
+
+    std::vector<std::thread> reader_threads(marc_paths.size());
+    const auto start_reader([&](const unsigned file_no) {
+        const std::string &marc_path(marc_paths[file_no]);
+        const MarcTagIndex * const tag_index(candidate_tags.empty() ? nullptr : tag_indices[file_no].get());
+        if (tag_index == nullptr and MARC::GuessFileType(marc_path) == MARC::FileType::BINARY)
+            reader_threads[file_no] = std::thread(ReadRawRecords, marc_path, file_no, &batch_queue);
+        else
+            reader_threads[file_no] = std::thread(ReadRecords, marc_path, file_no, tag_index, std::cref(candidate_tags), &batch_queue);
+    });
+
+    for (unsigned file_no(0); file_no < std::min<size_t>(MAX_CONCURRENTLY_READ_FILES, marc_paths.size()); ++file_no)
+        start_reader(file_no);
+
+    for (unsigned file_no(0); file_no < marc_paths.size(); ++file_no) {
+        unsigned record_count(0), matched_count(0);
+        std::shared_ptr<RecordBatch> batch;
+        while ((batch = batch_queue.popProcessedBatch(file_no)) != nullptr) {
+            std::cout << batch->output_;
+            record_count += batch->record_count_;
+            matched_count += batch->matched_count_;
         }
+        reader_threads[file_no].join();
+        if (file_no + MAX_CONCURRENTLY_READ_FILES < marc_paths.size())
+            start_reader(file_no + MAX_CONCURRENTLY_READ_FILES);
+
+        if (not candidate_tags.empty() and tag_indices[file_no] != nullptr)
+            std::cerr << "Matched " << matched_count << " of " << record_count << " candidate records out of "
+                      << tag_indices[file_no]->getRecordCount() << " records.\n";
+        else
+            std::cerr << "Matched " << matched_count << " of " << record_count << " records.\n";
     }
 
-    std::cerr << "Matched " << matched_count << " of " << record_count << " records.\n";
+    for (auto &worker_thread : worker_threads)
+        worker_thread.join();
 }
 
 
@@ -661,6 +1134,24 @@ public:
 
 
 int Main(int argc, char *argv[]) {
+    if (argc < 4)
+        Usage();
+
+    unsigned thread_count(std::max(1u, std::thread::hardware_concurrency()));
+    if (StringUtil::StartsWith(argv[1], "--thread-count=")) {
+        if (not StringUtil::ToUnsigned(argv[1] + __builtin_strlen("--thread-count="), &thread_count) or thread_count == 0)
+            LOG_ERROR("bad thread count: \"" + std::string(argv[1] + __builtin_strlen("--thread-count=")) + "\"!");
+        --argc;
+        ++argv;
+    }
+
+    std::string index_path;
+    if (StringUtil::StartsWith(argv[1], "--index=")) {
+        index_path = argv[1] + __builtin_strlen("--index=");
+        --argc;
+        ++argv;
+    }
+
     if (argc < 4)
         Usage();
 
@@ -677,10 +1168,26 @@ int Main(int argc, char *argv[]) {
     if (not ParseOutputList(argv[2] + OUTPUT_PREFIX.length(), &field_and_subfield_output_list))
         LOG_ERROR("bad output specification: \"" + std::string(argv[2] + OUTPUT_PREFIX.length()));
 
-    for (int arg_no(3); arg_no < argc; ++arg_no) {
-        auto marc_reader(MARC::Reader::Factory(argv[arg_no]));
-        ProcessRecords(query, marc_reader.get(), field_and_subfield_output_list);
+    const std::vector<std::string> marc_paths(argv + 3, argv + argc);
+
+    // Unless we have been given an explicit tag index, we use the sidecar indices of the MARC files if they exist.
+    std::vector<std::unique_ptr<MarcTagIndex>> tag_indices;
+    if (not index_path.empty()) {
+        if (marc_paths.size() != 1)
+            LOG_ERROR("--index can only be used w/ a single MARC file!");
+        tag_indices.emplace_back(new MarcTagIndex(index_path));
+        if (not tag_indices.front()->isUpToDate(marc_paths.front()))
+            LOG_ERROR("\"" + index_path + "\" is out of date w/ respect to \"" + marc_paths.front() + "\"!");
+    } else {
+        for (const auto &marc_path : marc_paths)
+            tag_indices.emplace_back(MarcTagIndex::OpenSidecar(marc_path));
     }
 
+    std::set<MARC::Tag> candidate_tags;
+    if (not index_path.empty() and not query.getCandidateTags(&candidate_tags))
+        LOG_WARNING("the query can't make use of \"" + index_path + "\"!");
+
+    ProcessFiles(query, marc_paths, tag_indices, field_and_subfield_output_list, thread_count);
+
     return EXIT_SUCCESS;
 }
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <set>
 #include <stdexcept>
 #include <unordered_set>
 #include <vector>
@@ -27,7 +28,9 @@
 #include <cstdlib>
 #include "FileUtil.h"
 #include "MARC.h"
+#include "MarcTagIndex.h"
 #include "MiscUtil.h"
+#include "StringUtil.h"
 #include "util.h"
 
 
@@ -35,7 +38,9 @@ namespace {
 
 
 [[noreturn]] void Usage() {
-    ::Usage("[--summarize-tags] [--verbose] marc_data");
+    ::Usage("[--summarize-tags] [--verbose] [--records-with-tags=tag1[,tag2...]] marc_data\n"
+            "With \"--records-with-tags\" only the number of records w/ at least one of the tags will be reported.  If there is an\n"
+            "up-to-date sidecar tag index for \"marc_data\" no record will be read at all.");
 }
 
 
@@ -138,6 +143,29 @@ void ProcessRecords(const bool verbose, const bool summarize_tags, MARC::Reader
 }
 
 
+// With an up-to-date sidecar tag index we don't have to read a single record.
+void CountRecordsWithTags(const std::string &marc_path, const std::set<MARC::Tag> &tags) {
+    size_t matched_count(0);
+    const auto tag_index(MarcTagIndex::OpenSidecar(marc_path));
+    if (tag_index != nullptr) {
+        std::vector<uint32_t> record_ordinals;
+        tag_index->getRecordsWithAnyTag(tags, &record_ordinals);
+        matched_count = record_ordinals.size();
+    } else {
+        auto marc_reader(MARC::Reader::Factory(marc_path));
+        TaggedRecordReader tagged_record_reader(marc_reader.get(), tags);
+        while (tagged_record_reader.read())
+            ++matched_count;
+    }
+
+    std::vector<std::string> tags_as_strings;
+    for (const auto &tag : tags)
+        tags_as_strings.emplace_back(tag.toString());
+    std::cout << matched_count << " record(s) contain at least one of the following tags: " << StringUtil::Join(tags_as_strings, ", ")
+              << '\n';
+}
+
+
 } // unnamed namespace
 
 
@@ -153,14 +181,33 @@ int Main(int argc, char *argv[]) {
     if (verbose)
         --argc, ++argv;
 
+    std::set<MARC::Tag> tags;
+    if (argc > 1 and StringUtil::StartsWith(argv[1], "--records-with-tags=")) {
+        std::vector<std::string> tags_as_strings;
+        StringUtil::Split(std::string(argv[1] + __builtin_strlen("--records-with-tags=")), ',', &tags_as_strings,
+                          /* suppress_empty_components = */ true);
+        for (const auto &tag : tags_as_strings) {
+            if (tag.length() != MARC::Record::TAG_LENGTH)
+                LOG_ERROR("bad tag: \"" + tag + "\"!");
+            tags.emplace(tag);
+        }
+        if (tags.empty())
+            Usage();
+        --argc, ++argv;
+    }
+
     if (argc < 2)
         Usage();
 
     for (int arg_no(1); arg_no < argc; ++arg_no) {
         const std::string filename(argv[arg_no]);
         std::cout << "Stats for " << filename << '\n';
-        auto marc_reader(MARC::Reader::Factory(filename));
-        ProcessRecords(verbose, summarize_tags, marc_reader.get());
+        if (not tags.empty())
+            CountRecordsWithTags(filename, tags);
+        else {
+            auto marc_reader(MARC::Reader::Factory(filename));
+            ProcessRecords(verbose, summarize_tags, marc_reader.get());
+        }
         if (arg_no < argc - 1)
             std::cout << "\n\n";
     }
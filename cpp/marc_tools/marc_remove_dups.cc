@@ -80,8 +80,10 @@ void DropDups(const bool use_checksums, MARC::Reader * const marc_reader, MARC::
     while (const MARC::Record record = marc_reader->read()) {
         ++total_count;
 
-        const std::string checksum(
-            use_checksums ? CalcChecksum(record, /* excluded_fields = */ { "001" }, /* suppress_local_fields = */ false) : "");
+        // The checksums are only compared within this run, so we don't need SHA-1:
+        const std::string checksum(use_checksums ? CalcChecksum(record, /* excluded_fields = */ { "001" },
+                                                                /* suppress_local_fields = */ false, MARC::ChecksumType::FAST)
+                                                 : "");
 
         ChecksumAndControlNumber new_checksum_and_control_number(checksum, record.getControlNumber());
         const auto iter(previously_seen->find(new_checksum_and_control_number));
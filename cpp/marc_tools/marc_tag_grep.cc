@@ -21,8 +21,11 @@
  */
 
 #include <iostream>
+#include <memory>
+#include <set>
 #include <cstdlib>
 #include "MARC.h"
+#include "MarcTagIndex.h"
 #include "RegexMatcher.h"
 #include "util.h"
 
@@ -41,9 +44,24 @@ void TagGrep(const std::string &regex, const std::string &input_filename) {
     if (unlikely(matcher == nullptr))
         logger->error("bad regex: " + err_msg);
 
-    unsigned count(0), field_matched_count(0), record_matched_count(0);
-    while (const MARC::Record record = marc_reader->read()) {
-        ++count;
+    // If we have a sidecar tag index we only need to look at the records that contain at least one matching tag:
+    std::unique_ptr<TaggedRecordReader> tagged_record_reader;
+    unsigned count(0);
+    const auto tag_index(MarcTagIndex::OpenSidecar(input_filename));
+    if (tag_index != nullptr) {
+        std::set<MARC::Tag> matching_tags;
+        for (const auto &tag : tag_index->getTags()) {
+            if (matcher->matched(tag.toString()))
+                matching_tags.emplace(tag);
+        }
+        tagged_record_reader.reset(new TaggedRecordReader(marc_reader.get(), matching_tags));
+        count = tag_index->getRecordCount();
+    }
+
+    unsigned field_matched_count(0), record_matched_count(0);
+    while (const MARC::Record record = tagged_record_reader != nullptr ? tagged_record_reader->read() : marc_reader->read()) {
+        if (tagged_record_reader == nullptr)
+            ++count;
         bool at_least_one_field_matched(false);
         for (const auto &field : record) {
             if (matcher->matched(field.getTag().toString())) {
@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include "ControlNumberGuesser.h"
 #include "MARC.h"
 #include "util.h"
@@ -29,9 +30,17 @@
 namespace {
 
 
-void ProcessRecords(MARC::Reader * const marc_reader, MARC::Writer * const marc_writer) {
+[[noreturn]] void Usage() {
+    ::Usage("[--fuzzy-title-matching] marc_input marc_output\n"
+            "When \"--fuzzy-title-matching\" has been specified, titles that are very similar to a known title count as a match.");
+}
+
+
+void ProcessRecords(const bool fuzzy_title_matching, MARC::Reader * const marc_reader, MARC::Writer * const marc_writer) {
     unsigned record_count(0), dropped_record_count(0);
-    ControlNumberGuesser control_number_guesser;
+    ControlNumberGuesser control_number_guesser(ControlNumberGuesser::IN_MEMORY_INDEX);
+    if (fuzzy_title_matching)
+        control_number_guesser.enableFuzzyTitleMatching();
 
     while (const MARC::Record record = marc_reader->read()) {
         ++record_count;
@@ -53,12 +62,19 @@ void ProcessRecords(MARC::Reader * const marc_reader, MARC::Writer * const marc_
 
 
 int Main(int argc, char *argv[]) {
+    bool fuzzy_title_matching(false);
+    if (argc > 1 and std::strcmp(argv[1], "--fuzzy-title-matching") == 0) {
+        fuzzy_title_matching = true;
+        --argc;
+        ++argv;
+    }
+
     if (argc != 3)
-        ::Usage("marc_input marc_output");
+        Usage();
 
     const auto marc_reader(MARC::Reader::Factory(argv[1]));
     const auto marc_writer(MARC::Writer::Factory(argv[2]));
-    ProcessRecords(marc_reader.get(), marc_writer.get());
+    ProcessRecords(fuzzy_title_matching, marc_reader.get(), marc_writer.get());
 
     return EXIT_SUCCESS;
 }
@@ -20,8 +20,10 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <functional>
 #include <iostream>
 #include <map>
+#include <set>
 #include <stdexcept>
 #include <unordered_set>
 #include <cassert>
@@ -42,16 +44,22 @@ namespace {
 
 [[noreturn]] void Usage() {
     ::Usage(
-        "[--min-log-level=log_level] [--keep-intermediate-files] input_directory "
-        "difference_archive output_directory\n"
-        "       Log levels are DEBUG, INFO, WARNING and ERROR with INFO being the default.\n");
+        "[--min-log-level=log_level] [--keep-intermediate-files] input_directory_or_archive "
+        "difference_archive output_directory_or_archive\n"
+        "       Log levels are DEBUG, INFO, WARNING and ERROR with INFO being the default.\n"
+        "       The members of the archives are read directly, nothing gets unpacked.  If \"output_directory_or_archive\"\n"
+        "       ends in \".tar.gz\" an archive will be created, o/w a directory.  --keep-intermediate-files is only accepted\n"
+        "       for backwards compatibility.\n");
 }
 
 
-void CopyAndCollectPPNs(LocalDataDB * const local_data_db, MARC::Reader * const reader, MARC::Writer * const writer,
-                        std::unordered_set<std::string> * const authority_ppns_in_delta,
-                        const std::unordered_set<std::string> &authority_ppns_in_input, bool check_input_ppns = false) {
+// \return The number of records read from "reader".
+unsigned CopyAndCollectPPNs(LocalDataDB * const local_data_db, MARC::Reader * const reader, MARC::Writer * const writer,
+                            std::unordered_set<std::string> * const authority_ppns_in_delta,
+                            const std::unordered_set<std::string> &authority_ppns_in_input, bool check_input_ppns = false) {
+    unsigned record_count(0);
     while (auto record = reader->read()) {
+        ++record_count;
         const auto PPN(record.getControlNumber());
         if (authority_ppns_in_delta->find(PPN) == authority_ppns_in_delta->end()) {
             const auto first_local_field(record.findTag("LOK"));
@@ -71,48 +79,59 @@ void CopyAndCollectPPNs(LocalDataDB * const local_data_db, MARC::Reader * const
                 writer->write(record);
         }
     }
-}
 
+    return record_count;
+}
 
-void CopySelectedTypes(LocalDataDB * const local_data_db, const std::vector<std::string> &archive_members, MARC::Writer * const writer,
-                       const std::set<BSZUtil::ArchiveType> &selected_types,
-                       std::unordered_set<std::string> * const authority_ppns_in_delta,
-                       const std::unordered_set<std::string> &authority_ppns_in_input, bool check_input_ppns = false) {
-    for (const auto &archive_member : archive_members) {
-        if (selected_types.find(BSZUtil::GetArchiveType(archive_member)) != selected_types.cend()) {
-            const auto reader(MARC::Reader::Factory(archive_member, MARC::FileType::BINARY));
 
-            // only check if delta records are present in source record if it is a sekkor file, not if TA file etc
-            bool really_check_input_ppns = check_input_ppns and StringUtil::Contains(FileUtil::GetBasename(archive_member), "sekkor");
+// Calls "member_processor" for each MARC member of "directory_or_archive" whose type is one of "selected_types".
+void ProcessSelectedMembers(const std::string &directory_or_archive, const std::set<BSZUtil::ArchiveType> &selected_types,
+                            const std::function<void(MARC::Reader * const reader)> &member_processor) {
+    if (not FileUtil::IsDirectory(directory_or_archive)) {
+        BSZUtil::ProcessArchiveMembers(directory_or_archive, selected_types, member_processor);
+        return;
+    }
 
-            CopyAndCollectPPNs(local_data_db, reader.get(), writer, authority_ppns_in_delta, authority_ppns_in_input,
-                               really_check_input_ppns);
+    std::vector<std::string> member_filenames;
+    FileUtil::GetFileNameList(".(raw|mrc)$", &member_filenames, directory_or_archive);
+    for (const auto &member_filename : member_filenames) {
+        if (selected_types.find(BSZUtil::GetArchiveType(member_filename)) != selected_types.cend()) {
+            const auto reader(MARC::Reader::Factory(directory_or_archive + "/" + member_filename, MARC::FileType::BINARY));
+            member_processor(reader.get());
         }
     }
 }
 
 
-void PreFetchPPNSOfInput(const std::vector<std::string> &archive_members, const std::set<BSZUtil::ArchiveType> &selected_types,
-                         std::unordered_set<std::string> * const authority_ppns_in_input) {
-    for (const auto &archive_member : archive_members) {
-        if (selected_types.find(BSZUtil::GetArchiveType(archive_member)) != selected_types.cend()) {
-            const auto reader(MARC::Reader::Factory(archive_member, MARC::FileType::BINARY));
-            while (auto record = reader->read())
-                authority_ppns_in_input->emplace(record.getControlNumber());
-        }
-    }
+// \return The number of records read from members of the selected types.
+unsigned CopySelectedTypes(LocalDataDB * const local_data_db, const std::string &directory_or_archive, MARC::Writer * const writer,
+                           const std::set<BSZUtil::ArchiveType> &selected_types,
+                           std::unordered_set<std::string> * const authority_ppns_in_delta,
+                           const std::unordered_set<std::string> &authority_ppns_in_input, bool check_input_ppns = false) {
+    unsigned record_count(0);
+    ProcessSelectedMembers(directory_or_archive, selected_types, [&](MARC::Reader * const reader) {
+        // only check if delta records are present in source record if it is a sekkor file, not if TA file etc
+        bool really_check_input_ppns = check_input_ppns and StringUtil::Contains(FileUtil::GetBasename(reader->getPath()), "sekkor");
+
+        record_count +=
+            CopyAndCollectPPNs(local_data_db, reader, writer, authority_ppns_in_delta, authority_ppns_in_input, really_check_input_ppns);
+    });
+
+    return record_count;
 }
 
 
-void PatchArchiveMembersAndCreateOutputArchive(LocalDataDB * const local_data_db,
-                                               const std::vector<std::string> &input_left_archive_members,
-                                               const std::vector<std::string> &input_right_archive_members,
-                                               const std::string &output_directory) {
-    if (input_left_archive_members.empty())
-        LOG_ERROR("no input archive members!");
-    if (input_right_archive_members.empty())
-        LOG_WARNING("no difference archive members!");
+void PreFetchPPNSOfInput(const std::string &directory_or_archive, const std::set<BSZUtil::ArchiveType> &selected_types,
+                         std::unordered_set<std::string> * const authority_ppns_in_input) {
+    ProcessSelectedMembers(directory_or_archive, selected_types, [authority_ppns_in_input](MARC::Reader * const reader) {
+        while (auto record = reader->read())
+            authority_ppns_in_input->emplace(record.getControlNumber());
+    });
+}
+
 
+void PatchArchiveMembersAndCreateOutputArchive(LocalDataDB * const local_data_db, const std::string &input_directory_or_archive,
+                                               const std::string &difference_archive, const std::string &output_directory) {
     std::unordered_set<std::string> title_ppns_in_delta;
     std::unordered_set<std::string> authority_ppns_in_delta;
     std::unordered_set<std::string> authority_ppns_in_input;
@@ -122,37 +141,29 @@ void PatchArchiveMembersAndCreateOutputArchive(LocalDataDB * const local_data_db
     //
 
     const auto title_writer(MARC::Writer::Factory(output_directory + "/tit.mrc", MARC::FileType::BINARY));
-    CopySelectedTypes(local_data_db, input_right_archive_members, title_writer.get(), { BSZUtil::TITLE_RECORDS, BSZUtil::SUPERIOR_TITLES },
-                      &title_ppns_in_delta, authority_ppns_in_input, false);
-    CopySelectedTypes(local_data_db, input_left_archive_members, title_writer.get(), { BSZUtil::TITLE_RECORDS, BSZUtil::SUPERIOR_TITLES },
-                      &title_ppns_in_delta, authority_ppns_in_input, false);
+    if (CopySelectedTypes(local_data_db, difference_archive, title_writer.get(), { BSZUtil::TITLE_RECORDS, BSZUtil::SUPERIOR_TITLES },
+                          &title_ppns_in_delta, authority_ppns_in_input, false)
+        == 0)
+        LOG_WARNING("no title records in \"" + difference_archive + "\"!");
+    if (CopySelectedTypes(local_data_db, input_directory_or_archive, title_writer.get(),
+                          { BSZUtil::TITLE_RECORDS, BSZUtil::SUPERIOR_TITLES }, &title_ppns_in_delta, authority_ppns_in_input, false)
+        == 0)
+        LOG_ERROR("no title records in \"" + input_directory_or_archive + "\"!");
 
     const auto authority_writer(MARC::Writer::Factory(output_directory + "/aut.mrc", MARC::FileType::BINARY));
-    PreFetchPPNSOfInput(input_left_archive_members, { BSZUtil::AUTHORITY_RECORDS }, &authority_ppns_in_input);
-    CopySelectedTypes(local_data_db, input_right_archive_members, authority_writer.get(), { BSZUtil::AUTHORITY_RECORDS },
+    PreFetchPPNSOfInput(input_directory_or_archive, { BSZUtil::AUTHORITY_RECORDS }, &authority_ppns_in_input);
+    CopySelectedTypes(local_data_db, difference_archive, authority_writer.get(), { BSZUtil::AUTHORITY_RECORDS },
                       &authority_ppns_in_delta, authority_ppns_in_input, true);
-    CopySelectedTypes(local_data_db, input_left_archive_members, authority_writer.get(), { BSZUtil::AUTHORITY_RECORDS },
+    CopySelectedTypes(local_data_db, input_directory_or_archive, authority_writer.get(), { BSZUtil::AUTHORITY_RECORDS },
                       &authority_ppns_in_delta, authority_ppns_in_input, false);
 }
 
 
-void GetDirectoryContentsWithRelativepath(const std::string &archive_name, std::vector<std::string> * const archive_members) {
-    const std::string directory_name(archive_name);
-    FileUtil::GetFileNameList(".(raw|mrc)$", archive_members, directory_name);
-    for (auto &archive_member : *archive_members)
-        archive_member = directory_name + "/" + archive_member;
-}
-
-
-std::string RemoveSuffix(const std::string &s, const std::string &suffix) {
-    if (unlikely(not StringUtil::EndsWith(s, suffix)))
-        LOG_ERROR("\"" + s + "\" does not end w/ \"" + suffix + "\"!");
-    return s.substr(0, s.length() - suffix.length());
-}
-
-
-inline std::string StripTarGz(const std::string &archive_filename) {
-    return RemoveSuffix(archive_filename, ".tar.gz");
+// A tar archive needs the size of each member before its data, therefore we have to write the members to disk first.
+void CreateOutputArchive(const std::string &output_archive, const std::string &members_directory) {
+    Archive::Writer archive_writer(output_archive);
+    for (const std::string member_name : { "tit.mrc", "aut.mrc" })
+        archive_writer.add(members_directory + "/" + member_name, member_name);
 }
 
 
@@ -163,37 +174,39 @@ int Main(int argc, char *argv[]) {
     if (argc < 4)
         Usage();
 
-    bool keep_intermediate_files(false);
-    if (std::strcmp(argv[1], "--keep-intermediate-files") == 0) {
-        keep_intermediate_files = true;
+    if (std::strcmp(argv[1], "--keep-intermediate-files") == 0)
         --argc, ++argv;
-    }
 
     if (argc != 4)
         Usage();
 
-    const std::string input_directory(FileUtil::MakeAbsolutePath(argv[1]));
+    const std::string input_directory_or_archive(FileUtil::MakeAbsolutePath(argv[1]));
     const std::string difference_archive(FileUtil::MakeAbsolutePath(argv[2]));
-    const std::string output_directory(FileUtil::MakeAbsolutePath(argv[3]));
+    const std::string output_directory_or_archive(FileUtil::MakeAbsolutePath(argv[3]));
 
-    if (input_directory == difference_archive or input_directory == output_directory or difference_archive == output_directory)
+    if (input_directory_or_archive == difference_archive or input_directory_or_archive == output_directory_or_archive
+        or difference_archive == output_directory_or_archive)
         LOG_ERROR("all archive names must be distinct!");
 
+    const bool create_output_archive(StringUtil::EndsWith(output_directory_or_archive, ".tar.gz"));
     std::unique_ptr<FileUtil::AutoTempDirectory> working_directory;
-    const std::string difference_directory(StripTarGz(difference_archive));
-    Archive::UnpackArchive(difference_archive, difference_directory);
-    if (not FileUtil::MakeDirectory(output_directory))
-        LOG_ERROR("failed to create directory: \"" + output_directory + "\"!");
-
-    std::vector<std::string> input_archive_members, difference_archive_members;
-    GetDirectoryContentsWithRelativepath(input_directory, &input_archive_members);
-    GetDirectoryContentsWithRelativepath(StripTarGz(difference_archive), &difference_archive_members);
+    std::string output_directory;
+    if (create_output_archive) {
+        working_directory.reset(new FileUtil::AutoTempDirectory(output_directory_or_archive + "."));
+        output_directory = working_directory->getDirectoryPath();
+    } else {
+        output_directory = output_directory_or_archive;
+        if (not FileUtil::MakeDirectory(output_directory))
+            LOG_ERROR("failed to create directory: \"" + output_directory + "\"!");
+    }
 
-    LocalDataDB local_data_db(LocalDataDB::READ_WRITE);
-    PatchArchiveMembersAndCreateOutputArchive(&local_data_db, input_archive_members, difference_archive_members, output_directory);
+    {
+        LocalDataDB local_data_db(LocalDataDB::READ_WRITE);
+        PatchArchiveMembersAndCreateOutputArchive(&local_data_db, input_directory_or_archive, difference_archive, output_directory);
+    }
 
-    if (not keep_intermediate_files and not FileUtil::RemoveDirectory(difference_directory))
-        LOG_ERROR("failed to remove directory: \"" + difference_directory + "\"!");
+    if (create_output_archive)
+        CreateOutputArchive(output_directory_or_archive, output_directory);
 
     return EXIT_SUCCESS;
 }
@@ -84,13 +84,13 @@ void ProcessAuthorityRecords(MARC::Reader * const authority_reader, MARC::Writer
         std::string gnd_number;
         if (MARC::GetGNDCode(record, &gnd_number)) {
             for (const auto &beacon_file : beacon_files) {
-                const auto beacon_entry(beacon_file.find(gnd_number));
-                if (beacon_entry == beacon_file.end())
+                BeaconFile::Entry beacon_entry;
+                if (not beacon_file.find(gnd_number, &beacon_entry))
                     continue;
 
                 ++gnd_tagged_count;
                 std::string beacon_file_filename(beacon_file.getFileName());
-                std::string beacon_url(beacon_file.getURL(*beacon_entry));
+                std::string beacon_url(beacon_file.getURL(beacon_entry));
 
                 // special substiutions due to individual beacon configurations
                 StringUtil::ReplaceString("deutsche-biographie.de/pnd", "deutsche-biographie.de/", &beacon_url);
@@ -24,6 +24,7 @@
 #include "Compiler.h"
 #include "FileUtil.h"
 #include "MARC.h"
+#include "RecordLinkGraph.h"
 #include "StringUtil.h"
 #include "util.h"
 
@@ -32,8 +33,11 @@ namespace {
 
 
 [[noreturn]] void Usage() {
-    std::cerr << "Usage: " << ::progname << " [--min-log-level=min_verbosity] [--generate-dangling-log] marc_input marc_output\n"
-              << "            If \"--generate-dangling-log\" has been specified an addition \"dangling.log\" file will be generated.\n\n";
+    std::cerr << "Usage: " << ::progname
+              << " [--min-log-level=min_verbosity] [--generate-dangling-log] [--link-graph=record_link_graph] marc_input marc_output\n"
+              << "            If \"--generate-dangling-log\" has been specified an addition \"dangling.log\" file will be generated.\n"
+              << "            If a record link graph, see generate_record_link_graph, for the records of \"marc_input\" is provided,\n"
+              << "            \"marc_input\" will only be read once.\n\n";
     std::exit(EXIT_FAILURE);
 }
 
@@ -44,6 +48,15 @@ void CollectRecordTypes(MARC::Reader * const reader, std::unordered_map<std::str
 }
 
 
+void CollectRecordTypes(const RecordLinkGraph &record_link_graph, std::unordered_map<std::string, bool> * const ppn_to_is_electronic_map) {
+    for (size_t node_no(0); node_no < record_link_graph.getNodeCount(); ++node_no) {
+        const auto node(record_link_graph.getNode(node_no));
+        if (node.isRecord())
+            ppn_to_is_electronic_map->emplace(node.getPPN(), node.isElectronicResource());
+    }
+}
+
+
 void TagCrossLinks(const bool generate_dangling_log, MARC::Reader * const reader, MARC::Writer * const writer,
                    const std::unordered_map<std::string, bool> &ppn_to_is_electronic_map) {
     std::unique_ptr<File> dangling_log;
@@ -92,23 +105,33 @@ void TagCrossLinks(const bool generate_dangling_log, MARC::Reader * const reader
 
 
 int Main(int argc, char *argv[]) {
-    if (argc != 3 and argc != 4)
+    if (argc < 3)
         Usage();
 
     bool generate_dangling_log(false);
-    if (argc == 4) {
-        if (std::strcmp(argv[1], "--generate-dangling-log") != 0)
-            Usage();
+    if (std::strcmp(argv[1], "--generate-dangling-log") == 0) {
         generate_dangling_log = true;
         --argc, ++argv;
     }
 
+    std::string record_link_graph_path;
+    if (StringUtil::StartsWith(argv[1], "--link-graph=")) {
+        record_link_graph_path = argv[1] + __builtin_strlen("--link-graph=");
+        --argc, ++argv;
+    }
+
+    if (argc != 3)
+        Usage();
+
     auto marc_reader(MARC::Reader::Factory(argv[1]));
     auto marc_writer(MARC::Writer::Factory(argv[2]));
 
     std::unordered_map<std::string, bool> ppn_to_is_electronic_map;
-    CollectRecordTypes(marc_reader.get(), &ppn_to_is_electronic_map);
-    marc_reader->rewind();
+    if (record_link_graph_path.empty()) {
+        CollectRecordTypes(marc_reader.get(), &ppn_to_is_electronic_map);
+        marc_reader->rewind();
+    } else
+        CollectRecordTypes(RecordLinkGraph(record_link_graph_path), &ppn_to_is_electronic_map);
 
     TagCrossLinks(generate_dangling_log, marc_reader.get(), marc_writer.get(), ppn_to_is_electronic_map);
 
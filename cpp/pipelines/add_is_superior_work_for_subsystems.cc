@@ -29,6 +29,8 @@
 #include <unordered_map>
 #include <cstdlib>
 #include "MARC.h"
+#include "RecordLinkGraph.h"
+#include "StringUtil.h"
 #include "UBTools.h"
 #include "VuFind.h"
 #include "util.h"
@@ -37,10 +39,16 @@
 namespace {
 
 
-void CollectSubsystemInfo(MARC::Reader * const marc_reader,
-                          std::unordered_map<std::string, std::set<std::string>> * const superior_ppns_to_subsystem_types) {
-    const std::string INSTALLATION_TYPE(VuFind::GetTueFindFlavourOrDie() == "ixtheo" ? "IXT" : "KRI");
+[[noreturn]] void Usage() {
+    ::Usage("[--link-graph=record_link_graph] marc_input marc_output\n"
+            "If a record link graph, see generate_record_link_graph, for the records of \"marc_input\" is provided and this is\n"
+            "a KrimDok installation, \"marc_input\" will only be read once.  IxTheo installations need the subsystem tags of all\n"
+            "inferior works and ignore the record link graph.");
+}
 
+
+void CollectSubsystemInfo(const std::string &installation_type, MARC::Reader * const marc_reader,
+                          std::unordered_map<std::string, std::set<std::string>> * const superior_ppns_to_subsystem_types) {
     unsigned record_count(0);
     while (MARC::Record record = marc_reader->read()) {
         ++record_count;
@@ -48,10 +56,10 @@ void CollectSubsystemInfo(MARC::Reader * const marc_reader,
         for (const auto &superior_ppn : record.getParentControlNumbers()) {
             auto superior_ppn_and_subsystem_types(superior_ppns_to_subsystem_types->find(superior_ppn));
             if (superior_ppn_and_subsystem_types == superior_ppns_to_subsystem_types->end()) {
-                const std::set<std::string> new_set{ INSTALLATION_TYPE };
+                const std::set<std::string> new_set{ installation_type };
                 superior_ppn_and_subsystem_types = superior_ppns_to_subsystem_types->emplace(superior_ppn, new_set).first;
             }
-            if (INSTALLATION_TYPE == "KRI")
+            if (installation_type == "KRI")
                 continue;
 
             /*if (record.hasSubfieldWithValue("SUB", 'a', "BIB"))*/
@@ -70,6 +78,22 @@ void CollectSubsystemInfo(MARC::Reader * const marc_reader,
 }
 
 
+// Only suitable for KrimDok where the superior works are tagged w/ the installation type only.
+void CollectSubsystemInfo(const std::string &installation_type, const RecordLinkGraph &record_link_graph,
+                          std::unordered_map<std::string, std::set<std::string>> * const superior_ppns_to_subsystem_types) {
+    for (size_t node_no(0); node_no < record_link_graph.getNodeCount(); ++node_no) {
+        const auto node(record_link_graph.getNode(node_no));
+        if (not node.isRecord())
+            continue;
+
+        for (const auto &superior_ppn : node.getSuperiorPPNs())
+            superior_ppns_to_subsystem_types->emplace(superior_ppn, std::set<std::string>{ installation_type });
+    }
+
+    LOG_INFO("Loaded " + std::to_string(record_link_graph.getRecordCount()) + " record(s) from the record link graph.");
+}
+
+
 void PatchSPRFields(MARC::Reader * const marc_reader, MARC::Writer * const marc_writer,
                     const std::unordered_map<std::string, std::set<std::string>> &superior_ppns_to_subsystem_types) {
     unsigned augmented_count(0);
@@ -112,8 +136,17 @@ void PatchSPRFields(MARC::Reader * const marc_reader, MARC::Writer * const marc_
 
 
 int Main(int argc, char **argv) {
+    if (argc < 2)
+        Usage();
+
+    std::string record_link_graph_path;
+    if (StringUtil::StartsWith(argv[1], "--link-graph=")) {
+        record_link_graph_path = argv[1] + __builtin_strlen("--link-graph=");
+        --argc, ++argv;
+    }
+
     if (argc != 3)
-        ::Usage("marc_input marc_output");
+        Usage();
 
     const std::string marc_input_filename(argv[1]);
     const std::string marc_output_filename(argv[2]);
@@ -123,9 +156,13 @@ int Main(int argc, char **argv) {
     auto marc_reader(MARC::Reader::Factory(marc_input_filename));
     auto marc_writer(MARC::Writer::Factory(marc_output_filename));
 
+    const std::string installation_type(VuFind::GetTueFindFlavourOrDie() == "ixtheo" ? "IXT" : "KRI");
     std::unordered_map<std::string, std::set<std::string>> superior_ppns_to_subsystem_types;
-    CollectSubsystemInfo(marc_reader.get(), &superior_ppns_to_subsystem_types);
-    marc_reader->rewind();
+    if (record_link_graph_path.empty() or installation_type != "KRI") {
+        CollectSubsystemInfo(installation_type, marc_reader.get(), &superior_ppns_to_subsystem_types);
+        marc_reader->rewind();
+    } else
+        CollectSubsystemInfo(installation_type, RecordLinkGraph(record_link_graph_path), &superior_ppns_to_subsystem_types);
     PatchSPRFields(marc_reader.get(), marc_writer.get(), superior_ppns_to_subsystem_types);
 
     return EXIT_SUCCESS;
@@ -58,7 +58,7 @@ void ProcessRecords(const LocalDataDB &local_data_db, MARC::Reader * const reade
         std::set<std::string> local_data_ppns{ record.getControlNumber() };
 
         for (const auto &zwi_field : record.getTagRange("ZWI")) {
-            for (const auto &sub_field_code_and_value : zwi_field.getSubfields()) {
+            for (const auto sub_field_code_and_value : zwi_field.getSubfieldsView()) {
                 if (sub_field_code_and_value.code_ == 'b')
                     local_data_ppns.emplace(sub_field_code_and_value.value_);
             }
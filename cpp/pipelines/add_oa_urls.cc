@@ -23,8 +23,8 @@
 #include <iostream>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include "Compiler.h"
-#include "FileUtil.h"
 #include "JSON.h"
 #include "MARC.h"
 #include "util.h"
@@ -45,27 +45,27 @@ public:
 
 
 [[noreturn]] void Usage() {
-    std::cerr << "Usage: " << ::progname << " doi_to_url_map.json marc_input marc_output\n";
+    std::cerr << "Usage: " << ::progname << " doi_to_url_map.json|doi_to_url_map.jsonl marc_input marc_output\n";
     std::exit(EXIT_FAILURE);
 }
 
 
+// Streams the entries of "map_filename", which is either a JSON array or, w/ a ".jsonl" extension, a JSON Lines file.
 void CreateDoiToUrlMap(const std::string &map_filename, std::unordered_map<std::string, oadoi_info> * const doi_to_oainfo) {
-    std::string json_document;
-    if (not FileUtil::ReadString(map_filename, &json_document))
-        LOG_ERROR("Could not read in " + map_filename);
-
-    JSON::Parser json_parser(json_document);
-    std::shared_ptr<JSON::JSONNode> entries;
-    if (not json_parser.parse(&entries))
-        LOG_ERROR("Could not properly parse \"" + map_filename + ": " + json_parser.getErrorMessage());
-
-    std::shared_ptr<JSON::ArrayNode> entry_array(JSON::JSONNode::CastToArrayNodeOrDie("", entries));
-    for (const auto &entry : *entry_array) {
-        const std::string doi(LookupString("/doi", entry));
-        const std::string url(LookupString("/best_oa_location/url", entry));
-        const std::string evidence(LookupString("/best_oa_location/evidence", entry));
-        const std::string host_type(LookupString("/best_oa_location/host_type", entry));
+    JSON::PullParser json_parser(map_filename);
+    if (not json_parser.isJSONLines() and json_parser.getNextEvent() != JSON::PullParser::ARRAY_START)
+        LOG_ERROR("\"" + map_filename + "\" does not contain a JSON array!");
+
+    static const std::vector<std::string> EXTRACTION_PATHS{ "/doi", "/best_oa_location/url", "/best_oa_location/evidence",
+                                                            "/best_oa_location/host_type" };
+    JSON::PullParser::EventType entry_start_event;
+    std::vector<std::string> values;
+    while (json_parser.getNextElement(&entry_start_event)) {
+        json_parser.extractStrings(entry_start_event, EXTRACTION_PATHS, &values);
+        const std::string &doi(values[0]);
+        const std::string &url(values[1]);
+        const std::string &evidence(values[2]);
+        const std::string &host_type(values[3]);
 
         // Workaround for erroneous SWBplus entries that are no full texts
         static const auto swbplus_matcher(ThreadSafeRegexMatcher("^https?://swbplus.bsz-bw.de/.*"));
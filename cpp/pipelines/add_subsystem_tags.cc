@@ -23,9 +23,13 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <cstdlib>
 #include "Compiler.h"
@@ -34,12 +38,20 @@
 #include "MARC.h"
 #include "RegexMatcher.h"
 #include "StringUtil.h"
+#include "ThreadUtil.h"
+#include "WallClockTimer.h"
 #include "util.h"
 
 
 namespace {
 
 
+[[noreturn]] void Usage() {
+    ::Usage("[--thread-count=count] (ixtheo|krimdok) title_input authority_input title_output authority_output\n"
+            "The title records are examined on \"count\" threads which defaults to the number of CPU cores.");
+}
+
+
 // See https://github.com/ubtue/tuefind/wiki/Daten-Abzugskriterien#abzugskriterien-bibelwissenschaften, both entries Nr. 6 in order
 // to understand this implementation.
 void CollectGNDNumbers(MARC::Reader * const authority_reader, std::unordered_set<std::string> * const bible_studies_gnd_numbers,
@@ -81,7 +93,9 @@ bool HasRelBibSSGN(const MARC::Record &record) {
 bool HasRelBibIxTheoNotation(const MARC::Record &record) {
     // Integrate IxTheo Notations A*.B*,T*,V*,X*,Z*
     static const std::string RELBIB_IXTHEO_NOTATION_PATTERN("^[ABTVXZ][A-Z].*|.*:[ABTVXZ][A-Z].*");
-    static RegexMatcher * const relbib_ixtheo_notations_matcher(RegexMatcher::RegexMatcherFactory(RELBIB_IXTHEO_NOTATION_PATTERN));
+    // RegexMatcher's are not thread-safe and we're called from several threads, hence one matcher per thread.
+    thread_local const std::unique_ptr<RegexMatcher> relbib_ixtheo_notations_matcher(
+        RegexMatcher::RegexMatcherFactory(RELBIB_IXTHEO_NOTATION_PATTERN));
     for (const auto &field : record.getTagRange("652")) {
         for (const auto &subfield_a : field.getSubfields().extractSubfields("a")) {
             if (relbib_ixtheo_notations_matcher->matched(subfield_a))
@@ -95,7 +109,8 @@ bool HasRelBibIxTheoNotation(const MARC::Record &record) {
 bool HasPlausibleDDCPrefix(const std::string &ddc_string) {
     // Exclude records that where the entry in the DCC field is not plausible
     static const std::string PLAUSIBLE_DDC_PREFIX_PATTERN("^\\d\\d");
-    static RegexMatcher * const plausible_ddc_prefix_matcher(RegexMatcher::RegexMatcherFactoryOrDie(PLAUSIBLE_DDC_PREFIX_PATTERN));
+    thread_local const std::unique_ptr<RegexMatcher> plausible_ddc_prefix_matcher(
+        RegexMatcher::RegexMatcherFactoryOrDie(PLAUSIBLE_DDC_PREFIX_PATTERN));
     return plausible_ddc_prefix_matcher->matched(ddc_string);
 }
 
@@ -103,7 +118,8 @@ bool HasPlausibleDDCPrefix(const std::string &ddc_string) {
 // Additional criteria that prevent the exclusion of a record that has a 220-289 field
 bool HasAdditionalRelbibAdmissionDDC(const MARC::Record &record) {
     static const std::string RELBIB_ADMIT_DDC_PATTERN("^([12][01][0-9]|2[9][0-9]|[3-9][0-9][0-9]).*$");
-    static RegexMatcher * const relbib_admit_ddc_range_matcher(RegexMatcher::RegexMatcherFactoryOrDie(RELBIB_ADMIT_DDC_PATTERN));
+    thread_local const std::unique_ptr<RegexMatcher> relbib_admit_ddc_range_matcher(
+        RegexMatcher::RegexMatcherFactoryOrDie(RELBIB_ADMIT_DDC_PATTERN));
     for (const auto &field : record.getTagRange("082")) {
         for (const auto &subfield_a : field.getSubfields().extractSubfields("a")) {
             if (HasPlausibleDDCPrefix(subfield_a) and relbib_admit_ddc_range_matcher->matched(subfield_a))
@@ -119,7 +135,8 @@ bool HasRelBibExcludeDDC(const MARC::Record &record) {
         return true;
     // Exclude DDC 220-289
     static const std::string RELBIB_EXCLUDE_DDC_RANGE_PATTERN("^2[2-8][0-9](/|\\.){0,2}[^.]*$");
-    static RegexMatcher * const relbib_exclude_ddc_range_matcher(RegexMatcher::RegexMatcherFactoryOrDie(RELBIB_EXCLUDE_DDC_RANGE_PATTERN));
+    thread_local const std::unique_ptr<RegexMatcher> relbib_exclude_ddc_range_matcher(
+        RegexMatcher::RegexMatcherFactoryOrDie(RELBIB_EXCLUDE_DDC_RANGE_PATTERN));
 
     // Make sure we have 082-fields to examine
     if (not record.hasTag("082"))
@@ -138,7 +155,7 @@ bool HasRelBibExcludeDDC(const MARC::Record &record) {
 
     // Exclude item if it has only a 400 or 800 DDC notation
     static const std::string RELBIB_EXCLUDE_DDC_CATEGORIES_PATTERN("^[48][0-9][0-9]$");
-    static RegexMatcher * const relbib_exclude_ddc_categories_matcher(
+    thread_local const std::unique_ptr<RegexMatcher> relbib_exclude_ddc_categories_matcher(
         RegexMatcher::RegexMatcherFactoryOrDie(RELBIB_EXCLUDE_DDC_CATEGORIES_PATTERN));
     for (const auto &field : record.getTagRange("082")) {
         for (const auto &subfield_a : field.getSubfields().extractSubfields('a')) {
@@ -214,7 +231,8 @@ inline bool IsRelBibRecord(const MARC::Record &record) {
 
 
 // See https://github.com/ubtue/tuefind/wiki/Daten-Abzugskriterien#abzugskriterien-bibelwissenschaften for the documentation.
-bool IsBibleStudiesRecord(const MARC::Record &record, const std::unordered_set<std::string> &bible_studies_gnd_numbers) {
+bool IsBibleStudiesRecord(const MARC::Record &record, const std::set<std::string> &gnd_references,
+                          const std::unordered_set<std::string> &bible_studies_gnd_numbers) {
     // 1. Abrufzeichen
     for (const auto &field : record.getTagRange("935")) {
         if (field.hasSubfieldWithValue('a', "BIIN") or field.hasSubfieldWithValue('a', "BiBIL"))
@@ -263,7 +281,6 @@ bool IsBibleStudiesRecord(const MARC::Record &record, const std::unordered_set<s
     }
 
     // 6. Titel, die mit einem Normsatz verknüpft sind, der die GND Systematik enthält
-    const auto gnd_references(record.getReferencedGNDNumbers());
     for (const auto &gnd_reference : gnd_references) {
         if (bible_studies_gnd_numbers.find(gnd_reference) != bible_studies_gnd_numbers.cend())
             return true;
@@ -302,7 +319,8 @@ void CollectSuperiorOrParallelWorks(const MARC::Record &record, std::unordered_s
 
 // See https://github.com/ubtue/tuefind/wiki/Daten-Abzugs--und-Selektionskriterien#selektionskriterium-f%C3%BCr-das-subsystem-kirchenrecht
 // for the documentation.
-bool IsCanonLawRecord(const MARC::Record &record, const std::unordered_set<std::string> &canon_law_gnd_numbers) {
+bool IsCanonLawRecord(const MARC::Record &record, const std::set<std::string> &gnd_references,
+                      const std::unordered_set<std::string> &canon_law_gnd_numbers) {
     // 1. Abrufzeichen
     for (const auto &field : record.getTagRange("935")) {
         if (field.hasSubfieldWithValue('a', "KALD") or field.hasSubfieldWithValue('a', "DAKR"))
@@ -353,7 +371,6 @@ bool IsCanonLawRecord(const MARC::Record &record, const std::unordered_set<std::
     }
 
     // 6. Titel, die mit einem Normsatz verknüpft sind, der die GND Systematik enthält
-    const auto gnd_references(record.getReferencedGNDNumbers());
     for (const auto &gnd_reference : gnd_references) {
         if (canon_law_gnd_numbers.find(gnd_reference) != canon_law_gnd_numbers.cend())
             return true;
@@ -366,28 +383,136 @@ bool IsCanonLawRecord(const MARC::Record &record, const std::unordered_set<std::
 enum SubSystem { RELBIB, BIBSTUDIES, CANON_LAW, NUM_OF_SUBSYSTEMS };
 
 
-// Get set of immediately belonging or superior or parallel records
-void GetSubsystemPPNSet(MARC::Reader * const title_reader, const std::unordered_set<std::string> &bible_studies_gnd_numbers,
-                        const std::unordered_set<std::string> &canon_law_gnd_numbers,
-                        std::vector<std::unordered_set<std::string>> * const subsystem_sets) {
-    while (const MARC::Record record = title_reader->read()) {
-        if (IsRelBibRecord(record)) {
-            ((*subsystem_sets)[RELBIB]).emplace(record.getControlNumber());
-            CollectSuperiorOrParallelWorks(record, &((*subsystem_sets)[RELBIB]));
-        }
-        if (IsBibleStudiesRecord(record, bible_studies_gnd_numbers)) {
-            ((*subsystem_sets)[BIBSTUDIES]).emplace(record.getControlNumber());
-            CollectSuperiorOrParallelWorks(record, &((*subsystem_sets)[BIBSTUDIES]));
-        }
-        if (IsCanonLawRecord(record, canon_law_gnd_numbers)) {
-            ((*subsystem_sets)[CANON_LAW]).emplace(record.getControlNumber());
-            CollectSuperiorOrParallelWorks(record, &((*subsystem_sets)[CANON_LAW]));
+const size_t RECORDS_PER_BATCH(1000);
+const size_t MAX_QUEUED_BATCHES_PER_THREAD(4);
+
+
+// Everything that we need to know about the title records in order to tag the title and authority records.
+struct TitleScanResults {
+    // The PPN's of the records of each subsystem as well as those of their superior or parallel works.
+    std::vector<std::unordered_set<std::string>> subsystem_sets_;
+
+    // Maps author PPN's to the number of titles per subsystem.
+    std::unordered_map<std::string, std::map<std::string, int>> authors_;
+
+    TitleScanResults(): subsystem_sets_(NUM_OF_SUBSYSTEMS) { }
+
+    void merge(const TitleScanResults &other);
+};
+
+
+void TitleScanResults::merge(const TitleScanResults &other) {
+    for (unsigned subsystem(0); subsystem < NUM_OF_SUBSYSTEMS; ++subsystem)
+        subsystem_sets_[subsystem].insert(other.subsystem_sets_[subsystem].cbegin(), other.subsystem_sets_[subsystem].cend());
+
+    for (const auto &[author_id, other_instances] : other.authors_) {
+        auto &instances(authors_[author_id]);
+        for (const auto &[subsystem, count] : other_instances)
+            instances[subsystem] += count;
+    }
+}
+
+
+// Increments the counts for "subsystems" of each author of "record".
+void CountAuthors(const MARC::Record &record, const std::vector<std::string> &subsystems,
+                  std::unordered_map<std::string, std::map<std::string, int>> * const authors) {
+    static const std::vector<std::string> tags_to_check{ "100", "110", "111", "700", "710", "711" };
+    for (const auto &tag_to_check : tags_to_check) {
+        for (const auto &field : record.getTagRange(tag_to_check)) {
+            const std::string author(field.getFirstSubfieldWithCodeAndPrefix('0', "(DE-627)"));
+            if (likely(not author.empty())) {
+                auto &instances((*authors)[author.substr(__builtin_strlen("(DE-627)"))]);
+                for (const auto &subsystem : subsystems)
+                    ++instances[subsystem];
+            }
         }
     }
+}
+
+
+// Evaluates all subsystem predicates for "record" once and records the results for the tagging of titles as well as authors.
+void ExamineTitleIxtheo(const MARC::Record &record, const std::unordered_set<std::string> &bible_studies_gnd_numbers,
+                        const std::unordered_set<std::string> &canon_law_gnd_numbers, TitleScanResults * const results) {
+    const auto gnd_references(record.getReferencedGNDNumbers());
+    const bool is_relbib_record(IsRelBibRecord(record));
+    const bool is_biblestudies_record(IsBibleStudiesRecord(record, gnd_references, bible_studies_gnd_numbers));
+    const bool is_canonlaw_record(IsCanonLawRecord(record, gnd_references, canon_law_gnd_numbers));
+
+    std::vector<std::string> author_subsystems;
+    if (is_relbib_record) {
+        results->subsystem_sets_[RELBIB].emplace(record.getControlNumber());
+        CollectSuperiorOrParallelWorks(record, &results->subsystem_sets_[RELBIB]);
+        author_subsystems.emplace_back("r");
+    }
+    if (is_biblestudies_record) {
+        results->subsystem_sets_[BIBSTUDIES].emplace(record.getControlNumber());
+        CollectSuperiorOrParallelWorks(record, &results->subsystem_sets_[BIBSTUDIES]);
+        author_subsystems.emplace_back("b");
+    }
+    if (is_canonlaw_record) {
+        results->subsystem_sets_[CANON_LAW].emplace(record.getControlNumber());
+        CollectSuperiorOrParallelWorks(record, &results->subsystem_sets_[CANON_LAW]);
+        author_subsystems.emplace_back("c");
+    }
+    author_subsystems.emplace_back("i");
+
+    CountAuthors(record, author_subsystems, &results->authors_);
+}
+
+
+void ExamineTitleKrimdok(const MARC::Record &record, TitleScanResults * const results) {
+    static const std::vector<std::string> author_subsystems{ "k" };
+    CountAuthors(record, author_subsystems, &results->authors_);
+}
+
+
+// Reads all title records once and hands them to "examine_title" on "thread_count" threads.
+void ScanTitles(MARC::Reader * const title_reader, const unsigned thread_count,
+                const std::function<void(const MARC::Record &, TitleScanResults * const)> &examine_title,
+                TitleScanResults * const results) {
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+
+    ThreadUtil::BoundedQueue<std::vector<MARC::Record>> record_batch_queue(thread_count * MAX_QUEUED_BATCHES_PER_THREAD);
+    std::vector<TitleScanResults> thread_results(thread_count);
+    std::vector<std::thread> threads;
+    for (unsigned thread_no(0); thread_no < thread_count; ++thread_no) {
+        threads.emplace_back([&record_batch_queue, &examine_title, &thread_results, thread_no] {
+            std::vector<MARC::Record> batch;
+            while (record_batch_queue.pop(&batch)) {
+                for (const auto &record : batch)
+                    examine_title(record, &thread_results[thread_no]);
+            }
+        });
+    }
 
-    LOG_INFO("collected " + std::to_string((*subsystem_sets)[RELBIB].size()) + " RelBib PPN's.");
-    LOG_INFO("collected " + std::to_string((*subsystem_sets)[BIBSTUDIES].size()) + " BibStudies PPN's.");
-    LOG_INFO("collected " + std::to_string((*subsystem_sets)[CANON_LAW].size()) + " CanonLaw PPN's.");
+    unsigned record_count(0);
+    std::vector<MARC::Record> batch;
+    while (auto record = title_reader->read()) {
+        ++record_count;
+        batch.emplace_back(std::move(record));
+        if (batch.size() == RECORDS_PER_BATCH) {
+            record_batch_queue.push(std::move(batch));
+            batch = std::vector<MARC::Record>();
+        }
+    }
+    if (not batch.empty())
+        record_batch_queue.push(std::move(batch));
+    record_batch_queue.close();
+    for (auto &thread : threads)
+        thread.join();
+
+    *results = std::move(thread_results[0]);
+    for (unsigned thread_no(1); thread_no < thread_count; ++thread_no)
+        results->merge(thread_results[thread_no]);
+
+    timer.stop();
+    LOG_INFO("Examined " + std::to_string(record_count) + " title record(s) on " + std::to_string(thread_count) + " thread(s) in "
+             + StringUtil::ToString(timer.getTime(), 1) + " s.");
+    LOG_INFO("collected " + std::to_string(results->subsystem_sets_[RELBIB].size()) + " RelBib PPN's.");
+    LOG_INFO("collected " + std::to_string(results->subsystem_sets_[BIBSTUDIES].size()) + " BibStudies PPN's.");
+    LOG_INFO("collected " + std::to_string(results->subsystem_sets_[CANON_LAW].size()) + " CanonLaw PPN's.");
+    LOG_INFO("collected " + std::to_string(results->authors_.size()) + " author PPN's.");
 }
 
 
@@ -442,62 +567,6 @@ void TagTitlesKrimdok(MARC::Reader * const title_reader, MARC::Writer * const ti
 }
 
 
-void ExtractAuthorsIxtheo(MARC::Reader * const title_reader, std::unordered_map<std::string, std::map<std::string, int>> * const authors,
-                          const std::unordered_set<std::string> &bible_studies_gnd_numbers,
-                          const std::unordered_set<std::string> &canon_law_gnd_numbers) {
-    static std::vector<std::string> tags_to_check{ "100", "110", "111", "700", "710", "711" };
-    while (const MARC::Record record = title_reader->read()) {
-        bool is_relbib_record = IsRelBibRecord(record);
-        bool is_canonlaw_record = IsCanonLawRecord(record, canon_law_gnd_numbers);
-        bool is_biblestudies_record = IsBibleStudiesRecord(record, bible_studies_gnd_numbers);
-
-        for (auto tag_to_check : tags_to_check) {
-            for (auto &field : record.getTagRange(tag_to_check)) {
-                const std::string author(field.getFirstSubfieldWithCodeAndPrefix('0', "(DE-627)"));
-                if (likely(not author.empty())) {
-                    std::string author_id(author.substr(std::string("(DE-627)").length()));
-                    std::map<std::string, int> instances;
-                    auto it_author = authors->emplace(author_id, instances).first;
-                    if (is_relbib_record) {
-                        auto it_author_count = it_author->second.emplace("r", 0).first;
-                        (it_author_count->second)++;
-                    }
-                    if (is_canonlaw_record) {
-                        auto it_author_count = it_author->second.emplace("c", 0).first;
-                        (it_author_count->second)++;
-                    }
-                    if (is_biblestudies_record) {
-                        auto it_author_count = it_author->second.emplace("b", 0).first;
-                        (it_author_count->second)++;
-                    }
-                    auto it_author_count = it_author->second.emplace("i", 0).first;
-                    (it_author_count->second)++;
-                }
-            }
-        }
-    }
-}
-
-
-void ExtractAuthorsKrimdok(MARC::Reader * const title_reader, std::unordered_map<std::string, std::map<std::string, int>> * const authors) {
-    static std::vector<std::string> tags_to_check{ "100", "110", "111", "700", "710", "711" };
-    while (const MARC::Record record = title_reader->read()) {
-        for (auto tag_to_check : tags_to_check) {
-            for (auto &field : record.getTagRange(tag_to_check)) {
-                const std::string author(field.getFirstSubfieldWithCodeAndPrefix('0', "(DE-627)"));
-                if (likely(not author.empty())) {
-                    std::string author_id(author.substr(std::string("(DE-627)").length()));
-                    std::map<std::string, int> instances;
-                    auto it_author = authors->emplace(author_id, instances).first;
-                    auto it_author_count = it_author->second.emplace("k", 0).first;
-                    (it_author_count->second)++;
-                }
-            }
-        }
-    }
-}
-
-
 void TagAuthorsIxtheo(MARC::Reader * const authority_reader, MARC::Writer * const authority_writer,
                       std::unordered_map<std::string, std::map<std::string, int>> &authors) {
     while (MARC::Record record = authority_reader->read()) {
@@ -550,8 +619,18 @@ void TagAuthorsKrimdok(MARC::Reader * const authority_reader, MARC::Writer * con
 
 
 int Main(int argc, char **argv) {
+    if (argc < 2)
+        Usage();
+
+    unsigned thread_count(std::max(std::thread::hardware_concurrency(), 1u));
+    if (StringUtil::StartsWith(argv[1], "--thread-count=")) {
+        if (not StringUtil::ToUnsigned(argv[1] + __builtin_strlen("--thread-count="), &thread_count) or thread_count == 0)
+            Usage();
+        --argc, ++argv;
+    }
+
     if (argc != 6)
-        ::Usage("[ixtheo|krimdok] title_input authority_input title_output authority_output");
+        Usage();
 
     const std::string system_type(argv[1]);
     const std::string title_input_filename(argv[2]);
@@ -565,35 +644,46 @@ int Main(int argc, char **argv) {
 
     std::unique_ptr<MARC::Reader> authority_reader(MARC::Reader::Factory(authority_input_filename));
     std::unique_ptr<MARC::Reader> title_reader(MARC::Reader::Factory(title_input_filename));
-    std::vector<std::unordered_set<std::string>> subsystem_sets(NUM_OF_SUBSYSTEMS);
-    std::unordered_map<std::string, std::map<std::string, int>> authors;
+    TitleScanResults title_scan_results;
+    WallClockTimer phase_timer(WallClockTimer::NON_CUMULATIVE);
 
     if (system_type == "ixtheo") {
+        phase_timer.start();
         std::unordered_set<std::string> bible_studies_gnd_numbers, canon_law_gnd_numbers;
         CollectGNDNumbers(authority_reader.get(), &bible_studies_gnd_numbers, &canon_law_gnd_numbers);
         authority_reader->rewind();
-        ExtractAuthorsIxtheo(title_reader.get(), &authors, bible_studies_gnd_numbers, canon_law_gnd_numbers);
-        title_reader->rewind();
-        GetSubsystemPPNSet(title_reader.get(), bible_studies_gnd_numbers, canon_law_gnd_numbers, &subsystem_sets);
-        title_reader->rewind();
-    } else if (system_type == "krimdok") {
-        ExtractAuthorsKrimdok(title_reader.get(), &authors);
-        title_reader->rewind();
-    }
-
+        phase_timer.stop();
+        LOG_INFO("Collected the GND numbers in " + StringUtil::ToString(phase_timer.getTime(), 1) + " s.");
+
+        ScanTitles(
+            title_reader.get(), thread_count,
+            [&bible_studies_gnd_numbers, &canon_law_gnd_numbers](const MARC::Record &record, TitleScanResults * const results) {
+                ExamineTitleIxtheo(record, bible_studies_gnd_numbers, canon_law_gnd_numbers, results);
+            },
+            &title_scan_results);
+    } else if (system_type == "krimdok")
+        ScanTitles(title_reader.get(), thread_count, ExamineTitleKrimdok, &title_scan_results);
+    title_reader->rewind();
+
+    phase_timer.start();
     std::unique_ptr<MARC::Writer> title_writer(MARC::Writer::Factory(title_output_filename));
 
     if (system_type == "ixtheo")
-        TagTitlesIxtheo(title_reader.get(), title_writer.get(), subsystem_sets);
+        TagTitlesIxtheo(title_reader.get(), title_writer.get(), title_scan_results.subsystem_sets_);
     else if (system_type == "krimdok")
         TagTitlesKrimdok(title_reader.get(), title_writer.get());
+    phase_timer.stop();
+    LOG_INFO("Tagged the title records in " + StringUtil::ToString(phase_timer.getTime(), 1) + " s.");
 
+    phase_timer.start();
     std::unique_ptr<MARC::Writer> authority_writer(MARC::Writer::Factory(authority_output_filename));
 
     if (system_type == "ixtheo")
-        TagAuthorsIxtheo(authority_reader.get(), authority_writer.get(), authors);
+        TagAuthorsIxtheo(authority_reader.get(), authority_writer.get(), title_scan_results.authors_);
     else if (system_type == "krimdok")
-        TagAuthorsKrimdok(authority_reader.get(), authority_writer.get(), authors);
+        TagAuthorsKrimdok(authority_reader.get(), authority_writer.get(), title_scan_results.authors_);
+    phase_timer.stop();
+    LOG_INFO("Tagged the authority records in " + StringUtil::ToString(phase_timer.getTime(), 1) + " s.");
 
     return EXIT_SUCCESS;
 }
@@ -25,12 +25,14 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <cstdlib>
 #include <cstring>
 #include "Compiler.h"
 #include "MARC.h"
+#include "MarcTagIndex.h"
 #include "RegexMatcher.h"
 #include "StringUtil.h"
 #include "Zeder.h"
@@ -49,7 +51,9 @@ namespace {
 
 
 void LoadSuperiorPPNs(MARC::Reader * const marc_reader, std::unordered_set<std::string> * const superior_ppns) {
-    while (const MARC::Record record = marc_reader->read()) {
+    const std::set<MARC::Tag> up_link_tags(MARC::UP_LINK_FIELD_TAGS.cbegin(), MARC::UP_LINK_FIELD_TAGS.cend());
+    TaggedRecordReader tagged_record_reader(marc_reader, up_link_tags);
+    while (const MARC::Record record = tagged_record_reader.read()) {
         for (const auto &ppn : record.getParentControlNumbers())
             superior_ppns->emplace(ppn);
     }
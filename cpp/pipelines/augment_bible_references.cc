@@ -30,6 +30,7 @@
 #include <utility>
 #include <cstdlib>
 #include <cstring>
+#include "FileUtil.h"
 #include "MARC.h"
 #include "MapUtil.h"
 #include "RangeUtil.h"
@@ -277,8 +278,9 @@ bool GetBibleRanges(const std::string &field_tag, const MARC::Record &record, co
    ranges and will in a later processing phase be added to title data.  We also extract pericopes which will be
    saved to a file that maps periope names to bible ranges. */
 void LoadNormData(const std::unordered_map<std::string, std::string> &bible_book_to_code_map, MARC::Reader * const authority_reader,
-                  std::unordered_map<std::string, std::set<std::pair<std::string, std::string>>> * const gnd_codes_to_bible_ref_codes_map) {
-    gnd_codes_to_bible_ref_codes_map->clear();
+                  const std::string &pericopes_map_filename,
+                  std::map<std::string, std::vector<RangeUtil::RangeIndex::Range>> * const gnd_codes_to_bible_ranges_map) {
+    gnd_codes_to_bible_ranges_map->clear();
     LOG_INFO("Starting loading of norm data.");
 
     std::unordered_set<std::string> books_of_the_bible;
@@ -302,12 +304,15 @@ void LoadNormData(const std::unordered_map<std::string, std::string> &bible_book
             ++pericope_count;
         }
 
-        gnd_codes_to_bible_ref_codes_map->emplace(gnd_code, ranges);
+        std::vector<RangeUtil::RangeIndex::Range> bible_ranges;
+        for (const auto &range : ranges)
+            bible_ranges.emplace_back(StringUtil::ToUnsigned(range.first), StringUtil::ToUnsigned(range.second));
+        gnd_codes_to_bible_ranges_map->emplace(gnd_code, bible_ranges);
         ++bible_ref_count;
     }
 
-    LOG_INFO("About to write \"pericopes_to_codes.map\".");
-    MapUtil::SerialiseMap("pericopes_to_codes.map", pericopes_to_ranges_map);
+    LOG_INFO("About to write \"" + pericopes_map_filename + "\".");
+    MapUtil::SerialiseMap(pericopes_map_filename, pericopes_to_ranges_map);
 
     LOG_INFO("Read " + std::to_string(count) + " norm data record(s).");
     LOG_INFO("Found " + std::to_string(unknown_book_count) + " records w/ unknown bible books.");
@@ -316,8 +321,39 @@ void LoadNormData(const std::unordered_map<std::string, std::string> &bible_book
 }
 
 
-bool FindGndCodes(const std::string &tags, const MARC::Record &record,
-                  const std::unordered_map<std::string, std::set<std::pair<std::string, std::string>>> &gnd_codes_to_bible_ref_codes_map,
+// The pericopes map is stored next to the authority data so that it can be reused along w/ the range index.
+const std::string PERICOPES_MAP_SUFFIX(".pericopes_to_codes.map");
+
+
+/* Opens the bible range index of "authority_filename" and regenerates it, as well as the pericopes map, if either is
+   missing or the index is out of date.  Either way, a copy of the pericopes map ends up in "pericopes_to_codes.map". */
+std::unique_ptr<RangeUtil::RangeIndex> GetBibleRangeIndex(const std::string &authority_filename) {
+    const std::string pericopes_map_filename(authority_filename + PERICOPES_MAP_SUFFIX);
+    auto range_index(RangeUtil::RangeIndex::OpenSidecar(authority_filename, RangeUtil::BIBLE_RANGE_INDEX_SUFFIX));
+    if (range_index != nullptr and FileUtil::Exists(pericopes_map_filename))
+        LOG_INFO("Reusing the bible range index of \"" + authority_filename + "\".");
+    else {
+        const std::string books_of_the_bible_to_code_map_filename(UBTools::GetTuelibPath() + "bibleRef/books_of_the_bible_to_code.map");
+        std::unordered_map<std::string, std::string> books_of_the_bible_to_code_map;
+        MapUtil::DeserialiseMap(books_of_the_bible_to_code_map_filename, &books_of_the_bible_to_code_map);
+
+        auto authority_reader(MARC::Reader::Factory(authority_filename));
+        std::map<std::string, std::vector<RangeUtil::RangeIndex::Range>> gnd_codes_to_bible_ranges_map;
+        LoadNormData(books_of_the_bible_to_code_map, authority_reader.get(), pericopes_map_filename, &gnd_codes_to_bible_ranges_map);
+
+        const std::string range_index_filename(authority_filename + RangeUtil::BIBLE_RANGE_INDEX_SUFFIX);
+        RangeUtil::RangeIndex::Create(range_index_filename, authority_filename,
+                                      RangeUtil::BOOK_CODE_LENGTH + RangeUtil::MAX_CHAPTER_LENGTH + RangeUtil::MAX_VERSE_LENGTH,
+                                      gnd_codes_to_bible_ranges_map);
+        range_index.reset(new RangeUtil::RangeIndex(range_index_filename));
+    }
+
+    FileUtil::CopyOrDie(pericopes_map_filename, "pericopes_to_codes.map");
+    return range_index;
+}
+
+
+bool FindGndCodes(const std::string &tags, const MARC::Record &record, const RangeUtil::RangeIndex &bible_range_index,
                   std::set<std::string> * const ranges) {
     ranges->clear();
 
@@ -326,11 +362,11 @@ bool FindGndCodes(const std::string &tags, const MARC::Record &record,
 
     bool found_at_least_one(false);
     for (const auto &gnd_code : record.getReferencedGNDNumbers(individual_tags)) {
-        const auto gnd_code_and_ranges(gnd_codes_to_bible_ref_codes_map.find(gnd_code));
-        if (gnd_code_and_ranges != gnd_codes_to_bible_ref_codes_map.end()) {
+        const auto bible_ranges(bible_range_index.getRanges(gnd_code));
+        if (not bible_ranges.empty()) {
             found_at_least_one = true;
-            for (const auto &range : gnd_code_and_ranges->second)
-                ranges->insert(range.first + ":" + range.second);
+            for (const auto &range : bible_ranges)
+                ranges->insert(bible_range_index.toString(range));
         } else
             LOG_DEBUG(record.getControlNumber() + ": GND code \"" + gnd_code + "\" was not found in our map.");
     }
@@ -341,9 +377,7 @@ bool FindGndCodes(const std::string &tags, const MARC::Record &record,
 
 /* Augments MARC title records that contain bible references by pointing at bible reference norm data records
    by adding a new MARC field with tag BIB_REF_RANGE_TAG.  This field is filled in with bible ranges. */
-void AugmentBibleRefs(
-    MARC::Reader * const marc_reader, MARC::Writer * const marc_writer,
-    const std::unordered_map<std::string, std::set<std::pair<std::string, std::string>>> &gnd_codes_to_bible_ref_codes_map) {
+void AugmentBibleRefs(MARC::Reader * const marc_reader, MARC::Writer * const marc_writer, const RangeUtil::RangeIndex &bible_range_index) {
     LOG_INFO("Starting augmentation of title records.");
 
     unsigned total_count(0), augment_count(0);
@@ -358,7 +392,7 @@ void AugmentBibleRefs(
                 LOG_ERROR("We need another bible reference tag than \"" + RangeUtil::BIB_REF_RANGE_TAG + "\"!");
 
             std::set<std::string> ranges;
-            if (FindGndCodes("600:610:611:630:648:651:655:689", record, gnd_codes_to_bible_ref_codes_map, &ranges)) {
+            if (FindGndCodes("600:610:611:630:648:651:655:689", record, bible_range_index, &ranges)) {
                 ++augment_count;
                 std::string range_string;
                 for (auto &range : ranges) {
@@ -397,17 +431,11 @@ int Main(int argc, char **argv) {
     if (unlikely(authority_input_filename == title_output_filename))
         LOG_ERROR("Norm data input file name equals title output file name!");
 
+    const auto bible_range_index(GetBibleRangeIndex(authority_input_filename));
+
     auto title_reader(MARC::Reader::Factory(title_input_filename));
-    auto authority_reader(MARC::Reader::Factory(authority_input_filename));
     auto title_writer(MARC::Writer::Factory(title_output_filename));
-
-    const std::string books_of_the_bible_to_code_map_filename(UBTools::GetTuelibPath() + "bibleRef/books_of_the_bible_to_code.map");
-    std::unordered_map<std::string, std::string> books_of_the_bible_to_code_map;
-    MapUtil::DeserialiseMap(books_of_the_bible_to_code_map_filename, &books_of_the_bible_to_code_map);
-
-    std::unordered_map<std::string, std::set<std::pair<std::string, std::string>>> gnd_codes_to_bible_ref_codes_map;
-    LoadNormData(books_of_the_bible_to_code_map, authority_reader.get(), &gnd_codes_to_bible_ref_codes_map);
-    AugmentBibleRefs(title_reader.get(), title_writer.get(), gnd_codes_to_bible_ref_codes_map);
+    AugmentBibleRefs(title_reader.get(), title_writer.get(), *bible_range_index);
 
     return EXIT_SUCCESS;
 }
@@ -21,8 +21,9 @@
 */
 
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <cstdlib>
 #include <strings.h>
 #include "Compiler.h"
@@ -57,29 +58,46 @@ Codex DetermineCodex(const std::string &subfield_codex, const std::string &subfi
 
 
 // To understand this code read https://github.com/ubtue/tuefind/wiki/Codices
-std::string FieldToCanonLawCode(const std::string &ppn, const Codex codex, const std::string &subfield_part) {
+bool FieldToCanonLawRange(const std::string &ppn, const Codex codex, const std::string &subfield_part,
+                          RangeUtil::RangeIndex::Range * const canon_law_range) {
     unsigned range_start, range_end;
     if (subfield_part.empty()) {
         range_start = 0;
         range_end = 99999999;
     } else if (not RangeUtil::ParseCanonLawRanges(subfield_part, &range_start, &range_end)) {
         LOG_WARNING("don't know how to parse codex parts \"" + subfield_part + "\"! (PPN: " + ppn + ")");
-        return "";
+        return false;
     }
 
     switch (codex) {
     case CIC1917:
-        return StringUtil::ToString(100000000 + range_start) + "_" + StringUtil::ToString(100000000 + range_end);
+        *canon_law_range = RangeUtil::RangeIndex::Range(100000000 + range_start, 100000000 + range_end);
+        return true;
     case CIC1983:
-        return StringUtil::ToString(200000000 + range_start) + "_" + StringUtil::ToString(200000000 + range_end);
+        *canon_law_range = RangeUtil::RangeIndex::Range(200000000 + range_start, 200000000 + range_end);
+        return true;
     case CCEO:
-        return StringUtil::ToString(300000000 + range_start) + "_" + StringUtil::ToString(300000000 + range_end);
+        *canon_law_range = RangeUtil::RangeIndex::Range(300000000 + range_start, 300000000 + range_end);
+        return true;
     default:
         LOG_ERROR("unknown codex: " + std::to_string(codex));
     }
 }
 
 
+inline std::string CanonLawRangeToCode(const RangeUtil::RangeIndex::Range &canon_law_range) {
+    return StringUtil::ToString(canon_law_range.start_) + "_" + StringUtil::ToString(canon_law_range.end_);
+}
+
+
+std::string FieldToCanonLawCode(const std::string &ppn, const Codex codex, const std::string &subfield_part) {
+    RangeUtil::RangeIndex::Range canon_law_range;
+    if (not FieldToCanonLawRange(ppn, codex, subfield_part, &canon_law_range))
+        return "";
+    return CanonLawRangeToCode(canon_law_range);
+}
+
+
 std::string CodexToPrefix(const Codex codex) {
     switch (codex) {
     case CIC1917:
@@ -94,9 +112,9 @@ std::string CodexToPrefix(const Codex codex) {
 }
 
 
-void LoadAuthorityData(MARC::Reader * const reader,
-                       std::unordered_map<std::string, std::string> * const authority_ppns_to_canon_law_codes_map) {
-    const auto aliases_file(FileUtil::OpenOutputFileOrDie(UBTools::GetTuelibPath() + "canon_law_aliases.map"));
+void LoadAuthorityData(MARC::Reader * const reader, const std::string &aliases_map_filename,
+                       std::map<std::string, std::vector<RangeUtil::RangeIndex::Range>> * const authority_ppns_to_canon_law_ranges_map) {
+    const auto aliases_file(FileUtil::OpenOutputFileOrDie(aliases_map_filename));
 
     unsigned total_count(0);
     while (auto record = reader->read()) {
@@ -112,11 +130,13 @@ void LoadAuthorityData(MARC::Reader * const reader,
             continue;
 
         const Codex codex(DetermineCodex(t_subfield, _110_field->getFirstSubfieldWithCode('f'), record.getControlNumber()));
-        const auto canon_law_code(FieldToCanonLawCode(record.getControlNumber(), codex, _110_field->getFirstSubfieldWithCode('p')));
-        if (unlikely(canon_law_code.empty()))
+        RangeUtil::RangeIndex::Range canon_law_range;
+        if (unlikely(
+                not FieldToCanonLawRange(record.getControlNumber(), codex, _110_field->getFirstSubfieldWithCode('p'), &canon_law_range)))
             continue;
 
-        (*authority_ppns_to_canon_law_codes_map)[record.getControlNumber()] = canon_law_code;
+        (*authority_ppns_to_canon_law_ranges_map)[record.getControlNumber()] = { canon_law_range };
+        const std::string canon_law_code(CanonLawRangeToCode(canon_law_range));
 
         for (const auto &_140_field : record.getTagRange("410")) {
             const auto p_subfield(_140_field.getFirstSubfieldWithCode('p'));
@@ -125,11 +145,38 @@ void LoadAuthorityData(MARC::Reader * const reader,
         }
     }
 
-    LOG_INFO("found " + std::to_string(authority_ppns_to_canon_law_codes_map->size()) + " canon law records among "
+    LOG_INFO("found " + std::to_string(authority_ppns_to_canon_law_ranges_map->size()) + " canon law records among "
              + std::to_string(total_count) + " authority records.");
 }
 
 
+// The aliases map is stored next to the authority data so that it can be reused along w/ the range index.
+const std::string ALIASES_MAP_SUFFIX(".canon_law_aliases.map");
+
+
+/* Opens the canon law range index of "authority_filename" and regenerates it, as well as the aliases map, if either is
+   missing or the index is out of date.  Either way, the aliases map gets installed as "canon_law_aliases.map". */
+std::unique_ptr<RangeUtil::RangeIndex> GetCanonLawRangeIndex(const std::string &authority_filename) {
+    const std::string aliases_map_filename(authority_filename + ALIASES_MAP_SUFFIX);
+    auto range_index(RangeUtil::RangeIndex::OpenSidecar(authority_filename, RangeUtil::CANON_LAW_RANGE_INDEX_SUFFIX));
+    if (range_index != nullptr and FileUtil::Exists(aliases_map_filename))
+        LOG_INFO("reusing the canon law range index of \"" + authority_filename + "\".");
+    else {
+        auto authority_reader(MARC::Reader::Factory(authority_filename));
+        std::map<std::string, std::vector<RangeUtil::RangeIndex::Range>> authority_ppns_to_canon_law_ranges_map;
+        LoadAuthorityData(authority_reader.get(), aliases_map_filename, &authority_ppns_to_canon_law_ranges_map);
+
+        const std::string range_index_filename(authority_filename + RangeUtil::CANON_LAW_RANGE_INDEX_SUFFIX);
+        RangeUtil::RangeIndex::Create(range_index_filename, authority_filename, /* digit_count = */ 9,
+                                      authority_ppns_to_canon_law_ranges_map);
+        range_index.reset(new RangeUtil::RangeIndex(range_index_filename));
+    }
+
+    FileUtil::CopyOrDie(aliases_map_filename, UBTools::GetTuelibPath() + "canon_law_aliases.map");
+    return range_index;
+}
+
+
 void CollectAuthorityPPNs(const MARC::Record &record, const MARC::Tag &linking_field, std::vector<std::string> * const authority_ppns) {
     for (const auto &field : record.getTagRange(linking_field)) {
         const MARC::Subfields subfields(field.getSubfields());
@@ -141,8 +188,7 @@ void CollectAuthorityPPNs(const MARC::Record &record, const MARC::Tag &linking_f
 }
 
 
-void ProcessRecords(MARC::Reader * const reader, MARC::Writer * const writer,
-                    const std::unordered_map<std::string, std::string> &authority_ppns_to_canon_law_codes_map) {
+void ProcessRecords(MARC::Reader * const reader, MARC::Writer * const writer, const RangeUtil::RangeIndex &canon_law_range_index) {
     static const std::vector<std::string> CANONES_GND_LINKING_TAGS{ "689", "655", "610" };
 
     unsigned total_count(0), augmented_count(0);
@@ -158,9 +204,8 @@ void ProcessRecords(MARC::Reader * const reader, MARC::Writer * const writer,
 
             if (not authority_ppns.empty()) {
                 for (const auto &authority_ppn : authority_ppns) {
-                    const auto ppn_and_canon_law_code(authority_ppns_to_canon_law_codes_map.find(authority_ppn));
-                    if (ppn_and_canon_law_code != authority_ppns_to_canon_law_codes_map.cend()) {
-                        ranges_to_insert.emplace_back(ppn_and_canon_law_code->second);
+                    for (const auto &canon_law_range : canon_law_range_index.getRanges(authority_ppn)) {
+                        ranges_to_insert.emplace_back(CanonLawRangeToCode(canon_law_range));
                         ++reference_counts[linking_tag];
                     }
                 }
@@ -225,13 +270,11 @@ int Main(int argc, char **argv) {
     if (unlikely(title_output_filename == authority_filename))
         LOG_ERROR("Title output file name equals authority file name!");
 
-    auto authority_reader(MARC::Reader::Factory(authority_filename));
-    std::unordered_map<std::string, std::string> authority_ppns_to_canon_law_codes_map;
-    LoadAuthorityData(authority_reader.get(), &authority_ppns_to_canon_law_codes_map);
+    const auto canon_law_range_index(GetCanonLawRangeIndex(authority_filename));
 
     auto title_reader(MARC::Reader::Factory(title_input_filename));
     auto title_writer(MARC::Writer::Factory(title_output_filename));
-    ProcessRecords(title_reader.get(), title_writer.get(), authority_ppns_to_canon_law_codes_map);
+    ProcessRecords(title_reader.get(), title_writer.get(), *canon_law_range_index);
 
     return EXIT_SUCCESS;
 }
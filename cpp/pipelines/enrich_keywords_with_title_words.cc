@@ -22,6 +22,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <cassert>
 #include <cstdlib>
@@ -30,6 +31,7 @@
 #include "RegexMatcher.h"
 #include "Stemmer.h"
 #include "StringUtil.h"
+#include "TextAnalysis.h"
 #include "TextUtil.h"
 #include "util.h"
 
@@ -47,40 +49,6 @@ namespace {
 }
 
 
-void LoadStopwords(File * const input, const std::string &language_code, std::unordered_set<std::string> * const stopwords_set) {
-    LOG_INFO("Starting loading of stopwords for language: " + language_code);
-
-    unsigned count(0);
-    while (not input->eof()) {
-        const std::string line(input->getline());
-        if (line.empty() or line[0] == ';') // Empty or comment line?
-            continue;
-
-        std::string word(TextUtil::UTF8ToLower(line));
-        stopwords_set->insert(TextUtil::UTF8ToLower(line));
-        ++count;
-    }
-
-    LOG_INFO("Read " + std::to_string(count) + " stopwords.");
-}
-
-
-void FilterOutStopwords(const std::unordered_set<std::string> &stopwords, std::vector<std::string> * const words) {
-    std::vector<std::string> filtered_words;
-    filtered_words.reserve(words->size());
-
-    bool removed_at_least_one_word(false);
-    for (const auto &word : *words) {
-        if (stopwords.find(word) == stopwords.end())
-            filtered_words.emplace_back(word);
-        else
-            removed_at_least_one_word = true;
-    }
-    if (removed_at_least_one_word)
-        words->swap(filtered_words);
-}
-
-
 auto constexpr MIN_WORD_LENGTH(3); // At least this many characters have to be in a word for to consider it
                                    // to be "interesting".
 
@@ -96,7 +64,7 @@ inline std::string FilterOutNonwordChars(const std::string &phrase) {
 // "stemmed_keyword_to_stemmed_keyphrases_map" and "stemmed_keyphrases_to_unstemmed_keyphrases_map".
 // The former maps from each individual stemmed word to the entire cleaned up and stemmed key phrase and the
 // latter maps from the cleaned up and stemmed key phrase to the original key phrase.
-void ProcessKeywordPhrase(const std::string &keyword_phrase, const Stemmer * const stemmer,
+void ProcessKeywordPhrase(const std::string &keyword_phrase, const std::string &language_code,
                           std::unordered_map<std::string, std::set<std::string>> * const stemmed_keyword_to_stemmed_keyphrases_map,
                           std::unordered_map<std::string, std::string> * const stemmed_keyphrases_to_unstemmed_keyphrases_map) {
     std::string cleaned_up_phrase(keyword_phrase);
@@ -109,7 +77,8 @@ void ProcessKeywordPhrase(const std::string &keyword_phrase, const Stemmer * con
 
     cleaned_up_phrase = FilterOutNonwordChars(cleaned_up_phrase);
 
-    const std::string stemmed_phrase(stemmer == nullptr ? cleaned_up_phrase : stemmer->stem(cleaned_up_phrase));
+    const std::string stemmed_phrase(language_code.empty() ? cleaned_up_phrase
+                                                           : ConcurrentStemmer::GetDefaultInstance().stem(language_code, cleaned_up_phrase));
     std::string lowercase_stemmed_phrase;
     TextUtil::UTF8ToLower(stemmed_phrase, &lowercase_stemmed_phrase);
     (*stemmed_keyphrases_to_unstemmed_keyphrases_map)[lowercase_stemmed_phrase] = keyword_phrase;
@@ -143,7 +112,7 @@ std::string CanonizeCentury(const std::string &century_candidate) {
 
 
 size_t ExtractKeywordsFromKeywordChainFields(
-    const MARC::Record &record, const Stemmer * const stemmer,
+    const MARC::Record &record, const std::string &language_code,
     std::unordered_map<std::string, std::set<std::string>> * const stemmed_keyword_to_stemmed_keyphrases_map,
     std::unordered_map<std::string, std::string> * const stemmed_keyphrases_to_unstemmed_keyphrases_map) {
     size_t keyword_count(0);
@@ -156,7 +125,7 @@ size_t ExtractKeywordsFromKeywordChainFields(
             const std::string subfield_c_value(subfields.getFirstSubfieldWithCode('c'));
             if (not subfield_c_value.empty())
                 keyphrase += " " + subfield_c_value;
-            ProcessKeywordPhrase(CanonizeCentury(keyphrase), stemmer, stemmed_keyword_to_stemmed_keyphrases_map,
+            ProcessKeywordPhrase(CanonizeCentury(keyphrase), language_code, stemmed_keyword_to_stemmed_keyphrases_map,
                                  stemmed_keyphrases_to_unstemmed_keyphrases_map);
             ++keyword_count;
         }
@@ -170,9 +139,8 @@ size_t ExtractAllKeywords(const MARC::Record &record,
                           std::unordered_map<std::string, std::set<std::string>> * const stemmed_keyword_to_stemmed_keyphrases_map,
                           std::unordered_map<std::string, std::string> * const stemmed_keyphrases_to_unstemmed_keyphrases_map) {
     const std::string language_code(MARC::GetLanguageCode(record));
-    const Stemmer * const stemmer(language_code.empty() ? nullptr : Stemmer::StemmerFactory(language_code));
 
-    size_t extracted_count(ExtractKeywordsFromKeywordChainFields(record, stemmer, stemmed_keyword_to_stemmed_keyphrases_map,
+    size_t extracted_count(ExtractKeywordsFromKeywordChainFields(record, language_code, stemmed_keyword_to_stemmed_keyphrases_map,
                                                                  stemmed_keyphrases_to_unstemmed_keyphrases_map));
     return extracted_count;
 }
@@ -225,10 +193,11 @@ void AugmentRecordsWithTitleKeywords(
     MARC::Reader * const marc_reader, MARC::Writer * const marc_writer,
     const std::unordered_map<std::string, std::set<std::string>> &stemmed_keyword_to_stemmed_keyphrases_map,
     const std::unordered_map<std::string, std::string> &stemmed_keyphrases_to_unstemmed_keyphrases_map,
-    const std::map<std::string, std::unordered_set<std::string>> &language_codes_to_stopword_sets) {
+    TextAnalysis::Pipeline * const text_analysis_pipeline) {
     LOG_INFO("Starting augmentation of stopwords.");
 
     unsigned total_count(0), augmented_record_count(0);
+    std::vector<std::string_view> title_tokens;
     while (MARC::Record record = marc_reader->read()) {
         ++total_count;
 
@@ -254,32 +223,15 @@ void AugmentRecordsWithTitleKeywords(
         }
         assert(not title.empty());
 
-        std::string lowercase_title;
-        TextUtil::UTF8ToLower(title, &lowercase_title);
-        std::vector<std::string> title_words;
-        TextUtil::ChopIntoWords(lowercase_title, &title_words, MIN_WORD_LENGTH);
-
-        // Remove language-appropriate stop words from the title words:
+        // Lowercase and tokenise the title, remove language-appropriate stop words and, if we have an appropriate
+        // stemmer, stem the remaining title words:
         const std::string language_code(MARC::GetLanguageCode(record));
-        const auto code_and_stopwords(language_codes_to_stopword_sets.find(language_code));
-        if (code_and_stopwords != language_codes_to_stopword_sets.end())
-            FilterOutStopwords(code_and_stopwords->second, &title_words);
-        if (language_code != "eng") // Hack because people suck at cataloging!
-            FilterOutStopwords(language_codes_to_stopword_sets.find("eng")->second, &title_words);
-
-        if (title_words.empty()) {
+        text_analysis_pipeline->analyse(title, language_code, &title_tokens);
+        if (title_tokens.empty()) {
             marc_writer->write(record);
             continue;
         }
-
-        // If we have an appropriate stemmer, replace the title words w/ stemmed title words:
-        const Stemmer * const stemmer(language_code.empty() ? nullptr : Stemmer::StemmerFactory(language_code));
-        if (stemmer != nullptr) {
-            std::vector<std::string> stemmed_title_words;
-            for (const auto &title_word : title_words)
-                stemmed_title_words.emplace_back(stemmer->stem(title_word));
-            title_words.swap(stemmed_title_words);
-        }
+        const std::vector<std::string> title_words(title_tokens.cbegin(), title_tokens.cend());
 
         std::unordered_map<std::string, std::set<std::string>> local_stemmed_keyword_to_stemmed_keyphrases_map;
         std::unordered_map<std::string, std::string> local_stemmed_keyphrases_to_unstemmed_keyphrases_map;
@@ -342,32 +294,27 @@ int Main(int argc, char **argv) {
     std::unique_ptr<MARC::Writer> marc_writer(MARC::Writer::Factory(marc_output_filename, MARC::FileType::BINARY));
 
     // Read optional stopword lists:
-    std::map<std::string, std::unordered_set<std::string>> language_codes_to_stopword_sets;
+    TextAnalysis::Pipeline text_analysis_pipeline(MIN_WORD_LENGTH, /* stem = */ true);
     for (int arg_no(3); arg_no < argc; ++arg_no) {
         RegexMatcher * const matcher(RegexMatcher::RegexMatcherFactory("stopwords\\....$"));
         const std::string stopwords_filename(argv[arg_no]);
         std::string err_msg;
         if (not matcher->matched(stopwords_filename, &err_msg))
             LOG_ERROR("Invalid stopwords filename \"" + stopwords_filename + "\"!");
-        const std::string language_code(stopwords_filename.substr(stopwords_filename.length() - 3));
-        File stopwords(stopwords_filename, "r");
-        if (not stopwords)
-            LOG_ERROR("can't open \"" + stopwords_filename + "\" for reading!");
-        std::unordered_set<std::string> stopwords_set;
-        LoadStopwords(&stopwords, language_code, &stopwords_set);
-        language_codes_to_stopword_sets[language_code] = stopwords_set;
+        text_analysis_pipeline.loadStopwords(stopwords_filename.substr(stopwords_filename.length() - 3), stopwords_filename);
     }
 
     // We always need English because librarians suck at specifying English:
-    if (language_codes_to_stopword_sets.find("eng") == language_codes_to_stopword_sets.end())
+    if (not text_analysis_pipeline.hasStopwords("eng"))
         LOG_ERROR("You always need to provide \"stopwords.eng\"!");
+    text_analysis_pipeline.setAdditionalStopwordsLanguage("eng"); // Hack because people suck at cataloging!
 
     std::unordered_map<std::string, std::set<std::string>> stemmed_keyword_to_stemmed_keyphrases_map;
     std::unordered_map<std::string, std::string> stemmed_keyphrases_to_unstemmed_keyphrases_map;
     ExtractStemmedKeywords(marc_reader.get(), &stemmed_keyword_to_stemmed_keyphrases_map, &stemmed_keyphrases_to_unstemmed_keyphrases_map);
     marc_reader->rewind();
     AugmentRecordsWithTitleKeywords(marc_reader.get(), marc_writer.get(), stemmed_keyword_to_stemmed_keyphrases_map,
-                                    stemmed_keyphrases_to_unstemmed_keyphrases_map, language_codes_to_stopword_sets);
+                                    stemmed_keyphrases_to_unstemmed_keyphrases_map, &text_analysis_pipeline);
 
     return EXIT_SUCCESS;
 }
@@ -18,9 +18,11 @@
  */
 
 #include <iostream>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include "MARC.h"
+#include "MarcTagIndex.h"
 
 
 namespace {
@@ -34,7 +36,11 @@ namespace {
 
 void CollectArticleCollectionPPNs(MARC::Reader * const reader, std::unordered_set<std::string> * const article_collection_ppns) {
     article_collection_ppns->clear();
-    while (const MARC::Record record = reader->read()) {
+
+    std::set<MARC::Tag> parent_link_tags(MARC::UP_LINK_FIELD_TAGS.cbegin(), MARC::UP_LINK_FIELD_TAGS.cend());
+    parent_link_tags.emplace("776");
+    TaggedRecordReader tagged_record_reader(reader, parent_link_tags);
+    while (const MARC::Record record = tagged_record_reader.read()) {
         if (record.isArticle()) {
             const std::string parent_ppn(record.getParentControlNumber(/* additional_tags=*/{ "776" }));
             if (not parent_ppn.empty())
@@ -29,6 +29,7 @@
 #include <cstring>
 #include "Compiler.h"
 #include "MARC.h"
+#include "MarcTagIndex.h"
 #include "RegexMatcher.h"
 #include "util.h"
 
@@ -66,7 +67,9 @@ void LoadDE21AndTADPPNs(MARC::Reader * const marc_reader, RegexMatcher * const t
                         std::unordered_set<std::string> * const de21_superior_ppns, RegexMatcher * const tad_sigil_matcher,
                         std::unordered_set<std::string> * const tad_superior_ppns, unsigned * const extracted_count,
                         unsigned * const extracted_tad_count) {
-    while (const MARC::Record record = marc_reader->read())
+    // Only superior works are of interest here:
+    TaggedRecordReader tagged_record_reader(marc_reader, { "SPR" });
+    while (const MARC::Record record = tagged_record_reader.read())
         ProcessSuperiorRecord(record, tue_sigil_matcher, de21_superior_ppns, tad_sigil_matcher, tad_superior_ppns, extracted_count,
                               extracted_tad_count);
 
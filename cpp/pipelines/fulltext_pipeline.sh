@@ -98,7 +98,7 @@ wait
 
 
 StartPhase "Create Match DB"
-(create_match_db GesamtTiteldaten-augmented-"${date}".mrc
+(create_match_db --bulk-load GesamtTiteldaten-augmented-"${date}".mrc
     >> "${log}" 2>&1 && \
 EndPhase || Abort) &
 wait
@@ -0,0 +1,50 @@
+/** \file    generate_record_link_graph.cc
+ *  \brief   Stores the links between the title records of a MARC collection in a RecordLinkGraph.
+ */
+
+/*
+ *  Copyright 2026 Universitätsbibliothek Tübingen.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include "MARC.h"
+#include "RecordLinkGraph.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("marc_titles record_link_graph\n"
+            "Extracts the PPN's, superior works, cross links, publication years and bibliographic levels of all records of\n"
+            "\"marc_titles\".  Pipeline phases that need these for all records before they can process the first one can then load\n"
+            "\"record_link_graph\" instead of reading the title data twice.");
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 3)
+        Usage();
+
+    const auto marc_reader(MARC::Reader::Factory(argv[1]));
+    RecordLinkGraph::Create(marc_reader.get(), argv[2]);
+
+    return EXIT_SUCCESS;
+}
@@ -29,10 +29,12 @@ CleanUp
 OVERALL_START=$(date +%s.%N)
 
 
-StartPhase "Check Record Integrity at the Beginning of the Pipeline"
+StartPhase "Check Record Integrity at the Beginning of the Pipeline, Generate Record Link Graph and GND Name Index"
 (marc_check --do-not-abort-on-empty-subfields --do-not-abort-on-invalid-repeated-fields \
             --write-data=GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc GesamtTiteldaten-"${date}".mrc
     >> "${log}" 2>&1 && \
+generate_record_link_graph GesamtTiteldaten-"${date}".mrc record_link_graph-"${date}".bin >> "${log}" 2>&1 && \
+create_gnd_name_index Normdaten-"${date}".mrc >> "${log}" 2>&1 && \
 EndPhase || Abort) &
 wait
 
@@ -53,7 +55,8 @@ fi
 
 
 StartPhase "Remove Dangling References"
-(remove_dangling_references GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
+(remove_dangling_references --link-graph=record_link_graph-"${date}".bin \
+                            GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
                             GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc >> "${log}" \
                             dangling_references.log 2>&1 && \
 EndPhase || Abort) &
@@ -427,7 +430,7 @@ wait
 
 
 StartPhase "Cross-link Type Tagging"
-(add_cross_link_type GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
+(add_cross_link_type --link-graph=record_link_graph-"${date}".bin GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
     GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc >> "${log}" 2>&1 && \
 EndPhase || Abort) &
 wait
@@ -453,6 +456,7 @@ for p in $(seq 0 "$((PHASE-2))"); do
     rm -f GesamtTiteldaten-post-phase"$p"-??????.mrc
 done
 rm -f Normdaten-partially-augmented?-??????.mrc
+rm -f record_link_graph-??????.bin
 rm -f child_refs child_titles parent_refs
 EndPhase
 
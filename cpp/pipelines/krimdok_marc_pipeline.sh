@@ -37,10 +37,12 @@ CreateTemporaryNullDevice
 OVERALL_START=$(date +%s.%N)
 
 
-StartPhase "Check Record Integrity at the Beginning of the Pipeline"
+StartPhase "Check Record Integrity at the Beginning of the Pipeline, Generate Record Link Graph and GND Name Index"
 (marc_check --do-not-abort-on-empty-subfields --do-not-abort-on-invalid-repeated-fields \
             --write-data=GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc GesamtTiteldaten-"${date}".mrc \
     >> "${log}" 2>&1 && \
+generate_record_link_graph GesamtTiteldaten-"${date}".mrc record_link_graph-"${date}".bin >> "${log}" 2>&1 && \
+create_gnd_name_index Normdaten-"${date}".mrc >> "${log}" 2>&1 && \
 EndPhase || Abort) &
 wait
 
@@ -157,7 +159,8 @@ wait
 
 
 StartPhase "Tags Which Subsystems have Inferior Records in Superior Works Records"
-(add_is_superior_work_for_subsystems GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
+(add_is_superior_work_for_subsystems --link-graph=record_link_graph-"${date}".bin \
+    GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
     GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc >> "${log}" 2>&1 && \
 EndPhase || Abort) &
 wait
@@ -173,14 +176,15 @@ wait
 
 
 StartPhase "Cross-link Type Tagging"
-(add_cross_link_type GesamtTiteldaten-post-phase"$((PHASE-2))"-"${date}".mrc \
+(add_cross_link_type --link-graph=record_link_graph-"${date}".bin GesamtTiteldaten-post-phase"$((PHASE-2))"-"${date}".mrc \
     GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc >> "${log}" 2>&1 && \
 EndPhase || Abort) &
 wait
 
 
 StartPhase "Remove Dangling References"
-(remove_dangling_references GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
+(remove_dangling_references --link-graph=record_link_graph-"${date}".bin \
+                            GesamtTiteldaten-post-phase"$((PHASE-1))"-"${date}".mrc \
                             GesamtTiteldaten-post-phase"$PHASE"-"${date}".mrc >> "${log}" \
                             dangling_references.log 2>&1 && \
 EndPhase || Abort) &
@@ -226,6 +230,7 @@ for p in $(seq "$((PHASE-1))"); do
     rm -f GesamtTiteldaten-post-phase"$p"-??????.mrc
 done
 rm -f Normdaten-partially-augmented?-??????.mrc
+rm -f record_link_graph-??????.bin
 rm -f full_text.db
 EndPhase
 
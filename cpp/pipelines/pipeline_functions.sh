@@ -42,6 +42,7 @@ function EndPhase {
 
 function CleanUp {
     rm -f GesamtTiteldaten-post-phase*.mrc
+    rm -f /usr/local/var/lib/tuelib/gnd_names.index.tmp # Left behind if create_gnd_name_index was aborted.
 }
 
 
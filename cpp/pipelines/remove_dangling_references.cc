@@ -23,6 +23,7 @@
 #include "Compiler.h"
 #include "FileUtil.h"
 #include "MARC.h"
+#include "RecordLinkGraph.h"
 #include "StringUtil.h"
 #include "TimeUtil.h"
 #include "util.h"
@@ -32,7 +33,9 @@ namespace {
 
 
 [[noreturn]] void Usage() {
-    ::Usage("marc_input marc_output missing_log");
+    ::Usage("[--link-graph=record_link_graph] marc_input marc_output missing_log\n"
+            "If a record link graph, see generate_record_link_graph, for the records of \"marc_input\" is provided, \"marc_input\"\n"
+            "will only be read once.");
 }
 
 
@@ -51,6 +54,16 @@ void CollectAllPPNs(MARC::Reader * const reader, std::unordered_map<std::string,
 }
 
 
+void CollectAllPPNs(const RecordLinkGraph &record_link_graph, std::unordered_map<std::string, bool> * const all_ppns_suppress_record) {
+    const unsigned next_year(std::stoi(TimeUtil::GetCurrentYear()) + 1);
+    for (size_t node_no(0); node_no < record_link_graph.getNodeCount(); ++node_no) {
+        const auto node(record_link_graph.getNode(node_no));
+        if (node.isRecord()) // exclude records that will be published in 2 years or later
+            all_ppns_suppress_record->emplace(node.getPPN(), node.getPublicationYear() > next_year + 1);
+    }
+}
+
+
 void EliminateDanglingCrossReferences(MARC::Reader * const reader, MARC::Writer * const writer, File * const log_file,
                                       const std::unordered_map<std::string, bool> &all_ppns_suppress_record) {
     unsigned modified_count(0);
@@ -60,9 +73,9 @@ void EliminateDanglingCrossReferences(MARC::Reader * const reader, MARC::Writer
         const auto first_field(record.begin());
         for (auto field(first_field); field != record.end(); ++field) {
             if (field->isCrossLinkField()) {
-                for (const auto &subfield : field->getSubfields()) {
-                    if (subfield.code_ == 'w' and StringUtil::StartsWith(subfield.value_, "(DE-627)")) {
-                        const auto bsz_ppn(subfield.value_.substr(__builtin_strlen("(DE-627)")));
+                for (const auto subfield : field->getSubfieldsView()) {
+                    if (subfield.code_ == 'w' and subfield.value_.starts_with("(DE-627)")) {
+                        const std::string bsz_ppn(subfield.value_.substr(__builtin_strlen("(DE-627)")));
                         auto bsz_ppn_elem = all_ppns_suppress_record.find(bsz_ppn);
                         if (unlikely(bsz_ppn_elem == all_ppns_suppress_record.cend())) {
                             field_indices_to_be_deleted.emplace_back(field - first_field);
@@ -95,6 +108,15 @@ void EliminateDanglingCrossReferences(MARC::Reader * const reader, MARC::Writer
 
 
 int Main(int argc, char *argv[]) {
+    if (argc < 2)
+        Usage();
+
+    std::string record_link_graph_path;
+    if (StringUtil::StartsWith(argv[1], "--link-graph=")) {
+        record_link_graph_path = argv[1] + __builtin_strlen("--link-graph=");
+        --argc, ++argv;
+    }
+
     if (argc != 4)
         Usage();
 
@@ -103,9 +125,12 @@ int Main(int argc, char *argv[]) {
     const auto log_file(FileUtil::OpenOutputFileOrDie(argv[3]));
 
     std::unordered_map<std::string, bool> all_ppns_suppress_record;
-    CollectAllPPNs(marc_reader.get(), &all_ppns_suppress_record);
+    if (record_link_graph_path.empty()) {
+        CollectAllPPNs(marc_reader.get(), &all_ppns_suppress_record);
+        marc_reader->rewind();
+    } else
+        CollectAllPPNs(RecordLinkGraph(record_link_graph_path), &all_ppns_suppress_record);
 
-    marc_reader->rewind();
     EliminateDanglingCrossReferences(marc_reader.get(), marc_writer.get(), log_file.get(), all_ppns_suppress_record);
 
     return EXIT_SUCCESS;
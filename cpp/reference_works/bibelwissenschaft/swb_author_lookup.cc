@@ -49,13 +49,6 @@ const std::string author_swb_lookup_url_krimdok(
     "SHRTST=50&IKT0=3040&ACT1=-&IKT1=8991&TRM1=1[0%2C1%2C2%2C3%2C4%2C5%2C6%2C7%2C8][0%2C1%2C2%2C3%2C4%2C5%2C6%2C7%2C8%2C9]"
     "[0%2C1%2C2%2C3%2C4%2C5%2C6%2C7%2C8%2C9]&TRM0=");
 
-const std::string author_swb_lookup_url_no_restrictions(
-    "https://swb.bsz-bw.de/DB=2.104/SET=1/TTL=1/"
-    "CMD?RETRACE=0&TRM_OLD=&ACT=SRCHA&IKT=1&SRT=RLV&"
-    "&MATCFILTER=N&MATCSET=N&NOABS=Y&SHRTST=50&TRM="
-
-);
-
 [[noreturn]] void Usage() {
     ::Usage("[--sloppy-filter|--krimdok|--no-restrictions] [--all-matches] author");
 }
@@ -76,7 +69,7 @@ std::string LookupAuthor(const std::string &author, author_lookup_filter filter,
         author_swb_lookup_url = author_swb_lookup_url_krimdok;
         break;
     case NO_RESTRICTIONS:
-        author_swb_lookup_url = author_swb_lookup_url_no_restrictions;
+        author_swb_lookup_url = BSZUtil::UNFILTERED_AUTHOR_LOOKUP_BASE_URL;
         break;
     default:
         LOG_ERROR("Unknown lookup filter");
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include "StringUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+[[noreturn]] void Usage() {
+    std::cerr << "usage: " << ::progname << " (--sync|--async) thread_count messages_per_thread\n";
+    std::cerr << "       Logs \"messages_per_thread\" messages from each of \"thread_count\" threads and reports the elapsed\n";
+    std::cerr << "       time on stdout.\n";
+    std::exit(EXIT_FAILURE);
+}
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 4)
+        Usage();
+
+    Logger::Mode mode;
+    if (std::strcmp(argv[1], "--sync") == 0)
+        mode = Logger::SYNCHRONOUS;
+    else if (std::strcmp(argv[1], "--async") == 0)
+        mode = Logger::ASYNCHRONOUS;
+    else
+        Usage();
+
+    unsigned thread_count, messages_per_thread;
+    if (not StringUtil::ToUnsigned(argv[2], &thread_count) or thread_count == 0
+        or not StringUtil::ToUnsigned(argv[3], &messages_per_thread))
+        Usage();
+
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+
+    logger->setMode(mode);
+    std::vector<std::thread> threads;
+    for (unsigned thread_no(0); thread_no < thread_count; ++thread_no)
+        threads.emplace_back([thread_no, messages_per_thread] {
+            for (unsigned message_no(0); message_no < messages_per_thread; ++message_no)
+                LOG_INFO("thread " + std::to_string(thread_no) + ", message " + std::to_string(message_no));
+        });
+    for (auto &thread : threads)
+        thread.join();
+    logger->flush();
+
+    timer.stop();
+    std::cout << "Logged " << (thread_count * messages_per_thread) << " messages in " << timer.getTimeInMilliseconds() << " ms.\n";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+/** \brief Stems a word list with several threads via ConcurrentStemmer and compares the results against Stemmer. */
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include "FileUtil.h"
+#include "Stemmer.h"
+#include "StringUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+[[noreturn]] void Usage() {
+    ::Usage("word_list language_name_or_code thread_count\n"
+            "Stems the words in \"word_list\", one per line, \"thread_count\" times in parallel and reports the elapsed time.");
+}
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 4)
+        Usage();
+
+    const auto words(FileUtil::ReadLines::ReadOrDie(argv[1]));
+    const std::string language_name_or_code(argv[2]);
+    unsigned thread_count;
+    if (not StringUtil::ToUnsigned(argv[3], &thread_count) or thread_count == 0)
+        Usage();
+
+    const Stemmer * const reference_stemmer(Stemmer::StemmerFactory(language_name_or_code));
+    if (reference_stemmer == nullptr)
+        LOG_ERROR("unsupported language \"" + language_name_or_code + "\"!");
+
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+
+    ConcurrentStemmer concurrent_stemmer;
+    std::vector<std::vector<std::string>> stemmed_words_per_thread(thread_count);
+    std::vector<std::thread> threads;
+    for (unsigned thread_no(0); thread_no < thread_count; ++thread_no)
+        threads.emplace_back([&, thread_no] {
+            concurrent_stemmer.stem(language_name_or_code, words, &stemmed_words_per_thread[thread_no]);
+        });
+    for (auto &thread : threads)
+        thread.join();
+
+    timer.stop();
+
+    unsigned mismatch_count(0);
+    for (const auto &stemmed_words : stemmed_words_per_thread) {
+        for (size_t i(0); i < words.size(); ++i) {
+            if (stemmed_words[i] != reference_stemmer->stem(words[i]))
+                ++mismatch_count;
+        }
+    }
+
+    std::cout << "Stemmed " << (words.size() * thread_count) << " words in " << timer.getTimeInMilliseconds() << " ms, "
+              << concurrent_stemmer.getCacheSize() << " distinct stems cached, " << mismatch_count << " mismatches.\n";
+
+    return mismatch_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,84 @@
+/** \brief Measures the throughput of the TimeUtil date parsers on a file w/ one date string per line. */
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "FileUtil.h"
+#include "StringUtil.h"
+#include "TimeUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("date_strings_file [repeat_count]\n"
+            "Reads one date string per line from \"date_strings_file\" and reports how long the TimeUtil parsers take to process\n"
+            "them.  Strings in formats that a parser doesn't support are timed as well.");
+}
+
+
+void Benchmark(const std::string &description, const std::vector<std::string> &date_strings, const unsigned repeat_count,
+               const std::function<bool(const std::string &)> &parser) {
+    size_t success_count(0);
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+    for (unsigned i(0); i < repeat_count; ++i) {
+        for (const auto &date_string : date_strings) {
+            if (parser(date_string))
+                ++success_count;
+        }
+    }
+    timer.stop();
+
+    const double call_count(static_cast<double>(date_strings.size()) * repeat_count);
+    std::cout << description << ": " << timer.getTimeInMilliseconds() << " ms, "
+              << (call_count == 0.0 ? 0.0 : timer.getTime() * 1.0e9 / call_count) << " ns/string, "
+              << (repeat_count == 0 ? 0 : success_count / repeat_count) << " parsed\n";
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 2 and argc != 3)
+        Usage();
+
+    unsigned repeat_count(10);
+    if (argc == 3 and not StringUtil::ToUnsigned(argv[2], &repeat_count))
+        Usage();
+
+    std::vector<std::string> date_strings;
+    for (const auto &line : FileUtil::ReadLines::ReadOrDie(argv[1], FileUtil::ReadLines::DO_NOT_TRIM)) {
+        if (not line.empty())
+            date_strings.emplace_back(line);
+    }
+    std::cout << "Loaded " << date_strings.size() << " date strings.\n";
+
+    Benchmark("ParseRFC3339DateTime", date_strings, repeat_count, [](const std::string &date_string) {
+        time_t date_time;
+        return TimeUtil::ParseRFC3339DateTime(date_string, &date_time);
+    });
+    Benchmark("ParseRFC1123DateTime", date_strings, repeat_count, [](const std::string &date_string) {
+        time_t date_time;
+        return TimeUtil::ParseRFC1123DateTime(date_string, &date_time);
+    });
+    Benchmark("Iso8601StringToTimeT (UTC)", date_strings, repeat_count, [](const std::string &date_string) {
+        time_t date_time;
+        std::string err_msg;
+        return TimeUtil::Iso8601StringToTimeT(date_string, &date_time, &err_msg, TimeUtil::UTC);
+    });
+    Benchmark("StringToStructTm (ISO 8601)", date_strings, repeat_count, [](const std::string &date_string) {
+        struct tm tm;
+        return TimeUtil::StringToStructTm(&tm, date_string, TimeUtil::ISO_8601_FORMAT);
+    });
+    Benchmark("StringToStructTm (008 date)", date_strings, repeat_count, [](const std::string &date_string) {
+        struct tm tm;
+        return TimeUtil::StringToStructTm(&tm, date_string, "%y%m%d");
+    });
+
+    return EXIT_SUCCESS;
+}
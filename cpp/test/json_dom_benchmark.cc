@@ -0,0 +1,97 @@
+/** \brief Compares the JSONNode tree w/ the arena-allocated JSON::Document on captured API responses. */
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include "FileUtil.h"
+#include "JSON.h"
+#include "JSONDocument.h"
+#include "StringUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("[--repeat-count=N] lookup_path json_file1 [json_file2 .. json_fileN]\n"
+            "Parses each of the JSON files and looks up \"lookup_path\" w/ both JSON DOMs and reports how long that takes.");
+}
+
+
+void Benchmark(const std::string &description, const std::vector<std::string> &json_documents, const unsigned repeat_count,
+               const std::function<void(const std::string &)> &parse_and_lookup) {
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+    for (unsigned i(0); i < repeat_count; ++i) {
+        for (const auto &json_document : json_documents)
+            parse_and_lookup(json_document);
+    }
+    timer.stop();
+
+    const double call_count(static_cast<double>(json_documents.size()) * repeat_count);
+    std::cout << description << ": " << timer.getTimeInMilliseconds() << " ms, "
+              << (call_count == 0.0 ? 0.0 : timer.getTime() * 1.0e6 / call_count) << " µs/document\n";
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc < 3)
+        Usage();
+
+    unsigned repeat_count(10);
+    if (StringUtil::StartsWith(argv[1], "--repeat-count=")) {
+        if (not StringUtil::ToUnsigned(argv[1] + __builtin_strlen("--repeat-count="), &repeat_count))
+            Usage();
+        --argc, ++argv;
+        if (argc < 3)
+            Usage();
+    }
+
+    const std::string lookup_path(argv[1]);
+    std::vector<std::string> json_documents;
+    size_t total_size(0);
+    for (int arg_no(2); arg_no < argc; ++arg_no) {
+        json_documents.emplace_back(FileUtil::ReadStringOrDie(argv[arg_no]));
+        total_size += json_documents.back().size();
+    }
+    std::cout << "Loaded " << json_documents.size() << " document(s) w/ a total size of " << total_size << " bytes.\n";
+
+    // Make sure that both DOMs agree before we time them:
+    size_t found_count(0);
+    for (const auto &json_document : json_documents) {
+        JSON::Parser parser(json_document);
+        std::shared_ptr<JSON::JSONNode> tree_root;
+        if (not parser.parse(&tree_root))
+            LOG_ERROR("JSON::Parser failed: " + parser.getErrorMessage());
+        JSON::Document document;
+        if (not document.parse(json_document))
+            LOG_ERROR("JSON::Document::parse failed: " + document.getErrorMessage());
+        const std::string tree_value(JSON::LookupString(lookup_path, tree_root, ""));
+        if (JSON::LookupString(lookup_path, document.getRoot(), "") != tree_value)
+            LOG_ERROR("the two DOMs disagree on the value of \"" + lookup_path + "\"!");
+        if (not tree_value.empty())
+            ++found_count;
+    }
+    std::cout << "Found \"" << lookup_path << "\" in " << found_count << " document(s).\n";
+
+    Benchmark("JSON::Parser", json_documents, repeat_count, [&lookup_path](const std::string &json_document) {
+        JSON::Parser parser(json_document);
+        std::shared_ptr<JSON::JSONNode> tree_root;
+        parser.parse(&tree_root);
+        JSON::LookupString(lookup_path, tree_root, "");
+    });
+
+    JSON::Document document;
+    Benchmark("JSON::Document", json_documents, repeat_count, [&lookup_path, &document](const std::string &json_document) {
+        document.parse(json_document);
+        JSON::LookupString(lookup_path, document.getRoot(), "");
+    });
+
+    return EXIT_SUCCESS;
+}
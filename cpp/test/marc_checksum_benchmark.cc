@@ -0,0 +1,81 @@
+/** \brief Compares the SHA-1 and the fast record checksums of MARC::CalcChecksum() on a MARC collection. */
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include <cstdlib>
+#include "MARC.h"
+#include "StringUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("marc_input [repeat_count]\n"
+            "Loads the records from \"marc_input\" and reports how long it takes to calculate their checksums w/ each ChecksumType.");
+}
+
+
+void Benchmark(const std::string &description, const std::vector<MARC::Record> &records, const unsigned repeat_count,
+               const std::function<void(const MARC::Record &)> &routine) {
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+    for (unsigned i(0); i < repeat_count; ++i) {
+        for (const auto &record : records)
+            routine(record);
+    }
+    timer.stop();
+
+    const double call_count(static_cast<double>(records.size()) * repeat_count);
+    std::cout << description << ": " << timer.getTimeInMilliseconds() << " ms, "
+              << (call_count == 0.0 ? 0.0 : timer.getTime() * 1.0e9 / call_count) << " ns/record\n";
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 2 and argc != 3)
+        Usage();
+
+    unsigned repeat_count(3);
+    if (argc == 3 and not StringUtil::ToUnsigned(argv[2], &repeat_count))
+        Usage();
+
+    std::vector<MARC::Record> records;
+    const auto marc_reader(MARC::Reader::Factory(argv[1]));
+    while (MARC::Record record = marc_reader->read())
+        records.emplace_back(std::move(record));
+    std::cout << "Loaded " << records.size() << " records.\n";
+
+    // Both checksum types should partition the records into the same sets of duplicates:
+    std::unordered_map<std::string, std::string> sha1_to_fast_checksum_map;
+    std::unordered_map<std::string, std::string> fast_to_sha1_checksum_map;
+    for (const auto &record : records) {
+        const std::string sha1_checksum(MARC::CalcChecksum(record, { "001" }, false, MARC::ChecksumType::SHA1));
+        const std::string fast_checksum(MARC::CalcChecksum(record, { "001" }, false, MARC::ChecksumType::FAST));
+        if (sha1_to_fast_checksum_map.emplace(sha1_checksum, fast_checksum).first->second != fast_checksum
+            or fast_to_sha1_checksum_map.emplace(fast_checksum, sha1_checksum).first->second != sha1_checksum)
+            LOG_ERROR("the checksum types disagree on whether record " + record.getControlNumber() + " is a duplicate!");
+    }
+    std::cout << sha1_to_fast_checksum_map.size() << " distinct checksums.\n";
+
+    Benchmark("CalcChecksum (SHA1)", records, repeat_count,
+              [](const MARC::Record &record) { MARC::CalcChecksum(record, { "001" }, false, MARC::ChecksumType::SHA1); });
+    Benchmark("CalcChecksum (FAST)", records, repeat_count,
+              [](const MARC::Record &record) { MARC::CalcChecksum(record, { "001" }, false, MARC::ChecksumType::FAST); });
+    Benchmark("Field::getHash (SHA1)", records, repeat_count, [](const MARC::Record &record) {
+        for (const auto &field : record)
+            field.getHash(MARC::ChecksumType::SHA1);
+    });
+    Benchmark("Field::getHash (FAST)", records, repeat_count, [](const MARC::Record &record) {
+        for (const auto &field : record)
+            field.getHash(MARC::ChecksumType::FAST);
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/** \brief Compares the per-tool title word extraction with TextAnalysis::Pipeline. */
+#include <iostream>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include <cstdlib>
+#include "FileUtil.h"
+#include "MARC.h"
+#include "StringUtil.h"
+#include "TextAnalysis.h"
+#include "TextUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("marc_input stopwords_file language_code [repeat_count]\n"
+            "Extracts the titles from \"marc_input\" and reports how long it takes to turn them into stopword-filtered words.");
+}
+
+
+struct Title {
+    std::string text_, language_code_;
+
+    Title(const std::string &text, const std::string &language_code): text_(text), language_code_(language_code) { }
+};
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 4 and argc != 5)
+        Usage();
+
+    const std::string stopwords_language_code(argv[3]);
+    unsigned repeat_count(10);
+    if (argc == 5 and not StringUtil::ToUnsigned(argv[4], &repeat_count))
+        Usage();
+
+    std::vector<Title> titles;
+    const auto marc_reader(MARC::Reader::Factory(argv[1]));
+    while (const auto record = marc_reader->read()) {
+        const auto title(record.getCompleteTitle());
+        if (not title.empty())
+            titles.emplace_back(title, MARC::GetLanguageCode(record));
+    }
+    std::cout << "Loaded " << titles.size() << " titles.\n";
+
+    std::unordered_set<std::string> stopwords;
+    for (const auto &line : FileUtil::ReadLines(argv[2])) {
+        if (not line.empty() and line[0] != ';')
+            stopwords.emplace(TextUtil::UTF8ToLower(line));
+    }
+
+    size_t word_count(0);
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+    for (unsigned i(0); i < repeat_count; ++i) {
+        for (const auto &title : titles) {
+            std::string lowercase_title;
+            TextUtil::UTF8ToLower(title.text_, &lowercase_title);
+            std::vector<std::string> words, filtered_words;
+            TextUtil::ChopIntoWords(lowercase_title, &words, /* min_word_length = */ 3);
+            for (const auto &word : words) {
+                if (title.language_code_ != stopwords_language_code or stopwords.find(word) == stopwords.end())
+                    filtered_words.emplace_back(word);
+            }
+            word_count += filtered_words.size();
+        }
+    }
+    timer.stop();
+    std::cout << "ChopIntoWords: " << timer.getTimeInMilliseconds() << " ms, " << word_count << " words\n";
+
+    TextAnalysis::Pipeline pipeline(/* min_word_length = */ 3);
+    pipeline.loadStopwords(stopwords_language_code, argv[2]);
+    std::vector<std::string_view> tokens;
+    word_count = 0;
+    timer.start();
+    for (unsigned i(0); i < repeat_count; ++i) {
+        for (const auto &title : titles) {
+            pipeline.analyse(title.text_, title.language_code_, &tokens);
+            word_count += tokens.size();
+        }
+    }
+    timer.stop();
+    std::cout << "TextAnalysis::Pipeline: " << timer.getTimeInMilliseconds() << " ms, " << word_count << " words\n";
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+/** \brief Measures the throughput of the TextUtil UTF-8 routines that we apply to titles. */
+#include <functional>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include "MARC.h"
+#include "StringUtil.h"
+#include "TextUtil.h"
+#include "WallClockTimer.h"
+#include "util.h"
+
+
+namespace {
+
+
+[[noreturn]] void Usage() {
+    ::Usage("marc_input [repeat_count]\n"
+            "Extracts the titles from \"marc_input\" and reports how long the TextUtil routines take to process them.");
+}
+
+
+void Benchmark(const std::string &description, const std::vector<std::string> &titles, const unsigned repeat_count,
+               const std::function<void(const std::string &)> &routine) {
+    WallClockTimer timer(WallClockTimer::NON_CUMULATIVE);
+    timer.start();
+    for (unsigned i(0); i < repeat_count; ++i) {
+        for (const auto &title : titles)
+            routine(title);
+    }
+    timer.stop();
+
+    const double call_count(static_cast<double>(titles.size()) * repeat_count);
+    std::cout << description << ": " << timer.getTimeInMilliseconds() << " ms, "
+              << (call_count == 0.0 ? 0.0 : timer.getTime() * 1.0e9 / call_count) << " ns/title\n";
+}
+
+
+} // unnamed namespace
+
+
+int Main(int argc, char *argv[]) {
+    if (argc != 2 and argc != 3)
+        Usage();
+
+    unsigned repeat_count(10);
+    if (argc == 3 and not StringUtil::ToUnsigned(argv[2], &repeat_count))
+        Usage();
+
+    std::vector<std::string> titles;
+    size_t ascii_title_count(0);
+    const auto marc_reader(MARC::Reader::Factory(argv[1]));
+    while (const auto record = marc_reader->read()) {
+        const auto title(record.getCompleteTitle());
+        if (title.empty())
+            continue;
+        titles.emplace_back(title);
+        if (TextUtil::IsASCII(title))
+            ++ascii_title_count;
+    }
+    std::cout << "Loaded " << titles.size() << " titles, " << ascii_title_count << " of which are pure ASCII.\n";
+
+    Benchmark("IsASCII", titles, repeat_count, [](const std::string &title) { TextUtil::IsASCII(title); });
+    Benchmark("IsValidUTF8", titles, repeat_count, [](const std::string &title) { TextUtil::IsValidUTF8(title); });
+    Benchmark("UTF8ToLower", titles, repeat_count, [](const std::string &title) { TextUtil::UTF8ToLower(title); });
+    Benchmark("UTF8ToUpper", titles, repeat_count, [](const std::string &title) { TextUtil::UTF8ToUpper(title); });
+    Benchmark("CollapseWhitespace", titles, repeat_count, [](const std::string &title) { TextUtil::CollapseWhitespace(title); });
+    Benchmark("RemoveDiacritics", titles, repeat_count, [](const std::string &title) { TextUtil::RemoveDiacritics(title); });
+    Benchmark("NormaliseDashes", titles, repeat_count, [](const std::string &title) {
+        std::string normalised_title(title);
+        TextUtil::NormaliseDashes(&normalised_title);
+    });
+
+    return EXIT_SUCCESS;
+}
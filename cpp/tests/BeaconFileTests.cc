@@ -0,0 +1,109 @@
+/** \brief Test cases for BeaconFile
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <unistd.h>
+#include "BeaconFile.h"
+#include "FileUtil.h"
+#include "UnitTest.h"
+
+
+const std::string BEACON_FILE_CONTENTS("#FORMAT: BEACON\n"
+                                       "#PREFIX: http://d-nb.info/gnd/\n"
+                                       "#TARGET: https://example.com/person/{ID}\r\n"
+                                       "#NAME: Example Archive\n"
+                                       "118540238\n"
+                                       "4037994-4|3\r\n"
+                                       " 10000069X | 2 | abc \n"
+                                       "\n"
+                                       "1064390793||https://example.org/x\r"
+                                       "118540238|7|duplicate\n"
+                                       "not a GND number|1\n"
+                                       "1234567890123456789|1\n"
+                                       "012345"); // No line end after the last line.
+
+
+void CheckEntries(const BeaconFile &beacon_file) {
+    CHECK_EQ(beacon_file.size(), 5u);
+    CHECK_EQ(beacon_file.getUrlTemplate(), "https://example.com/person/{ID}");
+    CHECK_EQ(beacon_file.getName(), "Example Archive");
+    CHECK_EQ(beacon_file.getMetadatum("NAME"), "Example Archive");
+    CHECK_EQ(beacon_file.getMetadatum("FEED"), "");
+
+    BeaconFile::Entry entry;
+    CHECK_TRUE(beacon_file.find("118540238", &entry));
+    CHECK_EQ(entry.gnd_number_, "118540238");
+    CHECK_EQ(entry.optional_count_, 1u);
+    CHECK_EQ(entry.id_or_url_, "");
+    CHECK_EQ(beacon_file.getURL(entry), "https://example.com/person/118540238");
+
+    CHECK_TRUE(beacon_file.find("4037994-4", &entry));
+    CHECK_EQ(entry.optional_count_, 3u);
+    CHECK_EQ(entry.id_or_url_, "");
+
+    CHECK_TRUE(beacon_file.find("10000069X", &entry));
+    CHECK_EQ(entry.optional_count_, 2u);
+    CHECK_EQ(entry.id_or_url_, "abc");
+    CHECK_EQ(beacon_file.getURL(entry), "https://example.com/person/abc");
+
+    CHECK_TRUE(beacon_file.find("1064390793", &entry));
+    CHECK_EQ(entry.optional_count_, 1u);
+    CHECK_EQ(beacon_file.getURL(entry), "https://example.org/x");
+
+    CHECK_TRUE(beacon_file.find("012345", &entry));
+    CHECK_FALSE(beacon_file.find("12345", &entry));
+    CHECK_FALSE(beacon_file.find("4037994", &entry));
+    CHECK_FALSE(beacon_file.find("not a GND number", &entry));
+    CHECK_FALSE(beacon_file.find("", &entry));
+}
+
+
+TEST(ParseBeaconFile) {
+    const FileUtil::AutoTempFile beacon_file_path("/tmp/BeaconFileTests", ".beacon");
+    FileUtil::WriteStringOrDie(beacon_file_path.getFilePath(), BEACON_FILE_CONTENTS);
+
+    const BeaconFile beacon_file(beacon_file_path.getFilePath());
+    CHECK_FALSE(beacon_file.usesBinaryForm());
+    CheckEntries(beacon_file);
+}
+
+
+TEST(BinaryForm) {
+    const FileUtil::AutoTempFile beacon_file_path("/tmp/BeaconFileTests", ".beacon");
+    FileUtil::WriteStringOrDie(beacon_file_path.getFilePath(), BEACON_FILE_CONTENTS);
+    BeaconFile::CreateBinaryForm(beacon_file_path.getFilePath());
+
+    {
+        std::vector<BeaconFile> beacon_files;
+        beacon_files.emplace_back(beacon_file_path.getFilePath());
+        beacon_files.emplace_back(beacon_file_path.getFilePath());
+        CHECK_TRUE(beacon_files[0].usesBinaryForm());
+        for (const auto &beacon_file : beacon_files)
+            CheckEntries(beacon_file);
+    }
+
+    // Changing the BEACON file invalidates its binary form:
+    FileUtil::WriteStringOrDie(beacon_file_path.getFilePath(), BEACON_FILE_CONTENTS + "\n");
+    const BeaconFile beacon_file(beacon_file_path.getFilePath());
+    CHECK_FALSE(beacon_file.usesBinaryForm());
+    CheckEntries(beacon_file);
+
+    ::unlink(BeaconFile::GetBinaryFormPath(beacon_file_path.getFilePath()).c_str());
+}
+
+
+TEST_MAIN(BeaconFile)
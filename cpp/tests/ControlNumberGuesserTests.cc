@@ -0,0 +1,162 @@
+/** \brief Test cases for ControlNumberGuesser
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <tuple>
+#include "ControlNumberGuesser.h"
+#include "FileUtil.h"
+#include "StringUtil.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+
+const std::string PAULUS_TITLE("Die Theologie des Apostels Paulus im Kontext der antiken Philosophie");
+
+
+void InsertRecord(ControlNumberGuesser * const control_number_guesser, const std::string &ppn, const std::string &title,
+                  const std::set<std::string> &authors, const std::string &year, const std::string &doi = "") {
+    control_number_guesser->insertTitle(title, ppn);
+    control_number_guesser->insertAuthors(authors, ppn);
+    control_number_guesser->insertYear(year, ppn);
+    if (not doi.empty())
+        control_number_guesser->insertDOI(doi, ppn);
+}
+
+
+// Creates the database w/ the same update mode that create_match_db uses.
+void CreateDatabase(const std::string &database_path) {
+    ControlNumberGuesser control_number_guesser(ControlNumberGuesser::SQL_LOOKUPS, ControlNumberGuesser::REPLACE_DATABASE,
+                                                database_path);
+    control_number_guesser.beginUpdate();
+    InsertRecord(&control_number_guesser, "100000001", PAULUS_TITLE, { "Müller, Hans" }, "2020", "10.1234/paulus");
+    InsertRecord(&control_number_guesser, "100000002", PAULUS_TITLE, { "Meier, Anna" }, "2020");
+    InsertRecord(&control_number_guesser, "100000003", PAULUS_TITLE, { "Müller, Hans" }, "2019");
+    InsertRecord(&control_number_guesser, "100000004", "Geschichte der Reformation in Württemberg",
+                 { "Schmidt, Eva", "Müller, Hans" }, "2020");
+
+    // The year 2020 gets a posting list that is much longer than the title posting lists so that the in-memory index has
+    // to intersect lists of very different lengths:
+    for (unsigned i(0); i < 200; ++i)
+        InsertRecord(&control_number_guesser, "2" + StringUtil::PadLeading(std::to_string(i), 8, '0'),
+                     "Unrelated Title Number " + std::to_string(i), { "Author " + std::to_string(i) }, "2020");
+    control_number_guesser.endUpdate();
+    control_number_guesser.installNewDatabase();
+}
+
+
+typedef std::tuple<std::string, std::set<std::string>, std::string, std::set<std::string>> Query; // title, authors, year, DOIs
+
+
+const std::vector<Query> QUERIES{
+    { PAULUS_TITLE, { "Müller, Hans" }, "2020", {} },
+    { PAULUS_TITLE, { "Müller, Hans" }, "", {} },
+    { PAULUS_TITLE, { "Müller, Hans", "Meier, Anna" }, "2020", {} },
+    { "DIE THEOLOGIE DES APOSTELS PAULUS IM KONTEXT DER ANTIKEN PHILOSOPHIE!", { "Müller, Hans" }, "2020", {} },
+    { "Geschichte der Reformation in Württemberg", { "Müller, Hans" }, "2020", {} },
+    { "Unrelated Title Number 42", { "Author 42" }, "2020", {} },
+    { "Something else entirely", {}, "", { "10.1234/PAULUS" } },
+    { PAULUS_TITLE, { "Schmidt, Eva" }, "2020", {} },
+    { PAULUS_TITLE, { "Unknown, Author" }, "", {} },
+    { PAULUS_TITLE, { "Müller, Hans" }, "1999", {} },
+    { "Die Theologie des Apostels Paulos im Kontext der antiken Philosophie", { "Müller, Hans" }, "2020", {} },
+    { "A Title That Nobody Has Ever Used", { "Müller, Hans" }, "2020", {} },
+};
+
+
+std::set<std::string> GetGuessedControlNumbers(const ControlNumberGuesser &control_number_guesser, const Query &query) {
+    const auto &[title, authors, year, dois](query);
+    return control_number_guesser.getGuessedControlNumbers(title, authors, year, dois);
+}
+
+
+} // unnamed namespace
+
+
+TEST(IndexAgreesWithSQL) {
+    const FileUtil::AutoTempFile database_file("/tmp/ControlNumberGuesserTests", ".sq3");
+    CreateDatabase(database_file.getFilePath());
+    const ControlNumberGuesser sql_guesser(ControlNumberGuesser::SQL_LOOKUPS, ControlNumberGuesser::UPDATE_IN_PLACE,
+                                           database_file.getFilePath());
+    const ControlNumberGuesser index_guesser(ControlNumberGuesser::IN_MEMORY_INDEX, ControlNumberGuesser::UPDATE_IN_PLACE,
+                                             database_file.getFilePath());
+
+    for (const auto &query : QUERIES)
+        CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, query), ','),
+                 StringUtil::Join(GetGuessedControlNumbers(sql_guesser, query), ','));
+}
+
+
+TEST(ExactMatches) {
+    const FileUtil::AutoTempFile database_file("/tmp/ControlNumberGuesserTests", ".sq3");
+    CreateDatabase(database_file.getFilePath());
+    const ControlNumberGuesser index_guesser(ControlNumberGuesser::IN_MEMORY_INDEX, ControlNumberGuesser::UPDATE_IN_PLACE,
+                                             database_file.getFilePath());
+
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[0]), ','), "100000001");
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[1]), ','), "100000001,100000003");
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[2]), ','), "100000001,100000002");
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[3]), ','), "100000001");
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[4]), ','), "100000004");
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[5]), ','), "200000042");
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[6]), ','), "100000001");
+}
+
+
+TEST(NoMatches) {
+    const FileUtil::AutoTempFile database_file("/tmp/ControlNumberGuesserTests", ".sq3");
+    CreateDatabase(database_file.getFilePath());
+    const ControlNumberGuesser index_guesser(ControlNumberGuesser::IN_MEMORY_INDEX, ControlNumberGuesser::UPDATE_IN_PLACE,
+                                             database_file.getFilePath());
+
+    for (unsigned i(7); i < QUERIES.size(); ++i)
+        CHECK_TRUE(GetGuessedControlNumbers(index_guesser, QUERIES[i]).empty());
+}
+
+
+TEST(FuzzyMatches) {
+    const FileUtil::AutoTempFile database_file("/tmp/ControlNumberGuesserTests", ".sq3");
+    CreateDatabase(database_file.getFilePath());
+    ControlNumberGuesser index_guesser(ControlNumberGuesser::IN_MEMORY_INDEX, ControlNumberGuesser::UPDATE_IN_PLACE,
+                                       database_file.getFilePath());
+    index_guesser.enableFuzzyTitleMatching(0.8);
+
+    // A typo only changes a few trigrams of a long title:
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[10]), ','), "100000001");
+    CHECK_EQ(StringUtil::Join(index_guesser.getGuessedControlNumbers("Die Theologie des Apostels Paulus im Kontext antiker Philosophie",
+                                                                     { "Meier, Anna" }),
+                              ','),
+             "100000002");
+
+    // Exact matches must not be diluted by similar titles:
+    CHECK_EQ(StringUtil::Join(GetGuessedControlNumbers(index_guesser, QUERIES[0]), ','), "100000001");
+
+    // Titles w/ a similarity below the threshold:
+    CHECK_TRUE(GetGuessedControlNumbers(index_guesser, QUERIES[11]).empty());
+    CHECK_TRUE(index_guesser.getGuessedControlNumbers("Die Theologie des Petrus", { "Müller, Hans" }).empty());
+    CHECK_TRUE(index_guesser.getGuessedControlNumbers("Die Theologie des Apostels Petrus im Kontext der mittelalterlichen Mystik",
+                                                      { "Müller, Hans" })
+                   .empty());
+
+    // The other criteria still have to match:
+    CHECK_TRUE(index_guesser.getGuessedControlNumbers("Die Theologie des Apostels Paulos im Kontext der antiken Philosophie",
+                                                      { "Schmidt, Eva" })
+                   .empty());
+}
+
+
+TEST_MAIN(ControlNumberGuesser)
@@ -0,0 +1,94 @@
+/** \brief Test cases for GNDNameIndex
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FileUtil.h"
+#include "GNDNameIndex.h"
+#include "MARC.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+
+void AddPerson(MARC::Writer * const marc_writer, const std::string &ppn, const std::string &gnd_number, const std::string &name,
+               const std::vector<std::string> &variant_names, const std::string &life_dates, const std::string &profession,
+               const bool differentiated = true) {
+    MARC::Record record(MARC::Record::TypeOfRecord::AUTHORITY, MARC::Record::BibliographicLevel::UNDEFINED, ppn);
+    record.insertField("035", { { 'a', "(DE-588)" + gnd_number } });
+    record.insertField("075", { { 'b', differentiated ? "p" : "n" }, { '2', "gndgen" } });
+    record.insertField("100", { { 'a', name } }, '1');
+    for (const auto &variant_name : variant_names)
+        record.insertField("400", { { 'a', variant_name } }, '1');
+    if (not life_dates.empty())
+        record.insertField("548", { { 'a', life_dates }, { '4', "datl" } });
+    if (not profession.empty())
+        record.insertField("550", { { 'a', profession }, { '4', "berc" } });
+    marc_writer->write(record);
+}
+
+
+} // unnamed namespace
+
+
+TEST(NormaliseName) {
+    CHECK_EQ(GNDNameIndex::NormaliseName("Müller, Hans-Peter"), "muller, hans peter");
+    CHECK_EQ(GNDNameIndex::NormaliseName("Hans-Peter Müller"), "muller, hans peter");
+    CHECK_EQ(GNDNameIndex::NormaliseName("  muller ,hans  peter. "), "muller, hans peter");
+    CHECK_EQ(GNDNameIndex::NormaliseName("Augustinus"), "augustinus");
+    CHECK_EQ(GNDNameIndex::NormaliseName("Wette, Wilhelm Martin Leberecht de"), "wette, wilhelm martin leberecht de");
+    CHECK_EQ(GNDNameIndex::NormaliseName(" ,. "), "");
+}
+
+
+TEST(BuildAndLookup) {
+    const FileUtil::AutoTempFile marc_file("/tmp/GNDNameIndexTests", ".mrc");
+    {
+        const auto marc_writer(MARC::Writer::Factory(marc_file.getFilePath()));
+        AddPerson(marc_writer.get(), "100000001", "118505408", "Bonhoeffer, Dietrich", { "Bonhöffer, Dietrich" }, "1906-1945", "Theologe");
+        AddPerson(marc_writer.get(), "100000002", "100000002", "Müller, Thomas", {}, "1950-", "Theologe");
+        AddPerson(marc_writer.get(), "100000003", "100000003", "Müller, Thomas", {}, "1960-", "Historiker");
+        AddPerson(marc_writer.get(), "100000004", "100000004", "Meier, Anna", {}, "", "", /* differentiated = */ false);
+    }
+
+    const FileUtil::AutoTempFile index_file("/tmp/GNDNameIndexTests", ".index");
+    const auto marc_reader(MARC::Reader::Factory(marc_file.getFilePath()));
+    GNDNameIndex::Build(marc_reader.get(), index_file.getFilePath());
+    const GNDNameIndex gnd_name_index(index_file.getFilePath());
+    CHECK_EQ(gnd_name_index.size(), 4u);
+
+    std::vector<GNDNameIndex::Person> persons;
+    gnd_name_index.lookup("Dietrich Bonhöffer", &persons);
+    CHECK_EQ(persons.size(), 1u);
+    CHECK_EQ(persons[0].gnd_number_, "118505408");
+    CHECK_EQ(persons[0].preferred_name_, "Bonhoeffer, Dietrich");
+    CHECK_EQ(persons[0].life_dates_, "1906-1945");
+    CHECK_EQ(persons[0].professions_.size(), 1u);
+    CHECK_EQ(persons[0].professions_[0], "Theologe");
+
+    persons.clear();
+    gnd_name_index.lookup("Mueller, Thomas", &persons);
+    CHECK_TRUE(persons.empty());
+    gnd_name_index.lookup("Müller,Thomas", &persons);
+    CHECK_EQ(persons.size(), 2u);
+
+    persons.clear();
+    gnd_name_index.lookup("Meier, Anna", &persons);
+    CHECK_TRUE(persons.empty());
+}
+
+
+TEST_MAIN(GNDNameIndex)
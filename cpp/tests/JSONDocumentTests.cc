@@ -0,0 +1,120 @@
+/** \brief Test cases for JSON::Document
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+#include "JSONDocument.h"
+#include "UnitTest.h"
+
+
+const std::string JSON_DOCUMENT("{ \"z\": 1, \"a\": -2.5, \"m\": \"x\", \"b\": true, \"n\": null, \"e\": [], \"o\": {} }");
+
+
+TEST(ScalarsAndMemberOrder) {
+    JSON::Document document;
+    CHECK_TRUE(document.parse(JSON_DOCUMENT));
+
+    const JSON::Value &root(document.getRoot());
+    CHECK_TRUE(root.isObject());
+    CHECK_EQ(root.size(), 7u);
+    const auto members(root.getMembers());
+    CHECK_EQ(members[0].label_, "z");
+    CHECK_EQ(members[1].label_, "a");
+    CHECK_EQ(members[6].label_, "o");
+    CHECK_EQ(members[0].value_.getIntegerValue(), 1);
+    CHECK_EQ(members[1].value_.getDoubleValue(), -2.5);
+    CHECK_EQ(members[2].value_.getStringValue(), "x");
+    CHECK_TRUE(members[3].value_.getBooleanValue());
+    CHECK_TRUE(members[4].value_.isNull());
+    CHECK_EQ(members[5].value_.size(), 0u);
+    CHECK_TRUE(members[6].value_.isObject());
+    CHECK_TRUE(root.getMember("q") == nullptr);
+    CHECK_EQ(root.toString(),
+             "{ \"z\": 1, \"a\":                 -2.5, \"m\": \"x\", \"b\": true, \"n\": null, \"e\": [  ], \"o\": {  } }");
+}
+
+
+TEST(LargeObjects) {
+    std::string json("{");
+    for (unsigned i(0); i < 100; ++i)
+        json += "\"label" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+    json += "\"label7\": -1 }";
+
+    JSON::Document document;
+    CHECK_TRUE(document.parse(json));
+    const JSON::Value &root(document.getRoot());
+    CHECK_EQ(root.size(), 101u);
+    CHECK_EQ(root.getMember("label0")->getIntegerValue(), 0);
+    CHECK_EQ(root.getMember("label99")->getIntegerValue(), 99);
+    CHECK_EQ(root.getMember("label7")->getIntegerValue(), 7);
+    CHECK_TRUE(root.getMember("label100") == nullptr);
+    CHECK_EQ(root.getMembers()[100].value_.getIntegerValue(), -1);
+}
+
+
+TEST(Strings) {
+    JSON::Document document;
+    CHECK_TRUE(document.parse("[ \"plain\", \"a\\\"b\\\\c\\/d\\n\", \"\\u00fc\\u20ac\", \"\" ]"));
+
+    const JSON::Value &root(document.getRoot());
+    CHECK_EQ(root.getElement(0)->getStringValue(), "plain");
+    CHECK_EQ(root.getElement(1)->getStringValue(), "a\"b\\c/d\n");
+    CHECK_EQ(root.getElement(2)->getStringValue(), "ü€");
+    CHECK_EQ(root.getElement(3)->getStringValue(), "");
+    CHECK_TRUE(root.getElement(4) == nullptr);
+}
+
+
+TEST(Lookups) {
+    JSON::Document document;
+    CHECK_TRUE(document.parse("{ \"items\": [ { \"doi\": \"10.1/a\", \"pages\": 12 }, { \"year\": 2026.5, \"open\": false } ] }"));
+
+    const JSON::Value &root(document.getRoot());
+    CHECK_EQ(JSON::LookupString("/items/0/doi", root), "10.1/a");
+    CHECK_EQ(JSON::LookupString("/items/0/pages", root), "12");
+    CHECK_EQ(JSON::LookupString("/items/1/open", root), "false");
+    CHECK_EQ(JSON::LookupString("/items/1/doi", root, "none"), "none");
+    CHECK_EQ(JSON::LookupString("/items/x", root, "none"), "none");
+    CHECK_TRUE(JSON::LookupValue("/items/1", root)->isObject());
+
+    bool caught_exception(false);
+    try {
+        JSON::LookupString("/items", root);
+    } catch (const std::runtime_error &) {
+        caught_exception = true;
+    }
+    CHECK_TRUE(caught_exception);
+}
+
+
+TEST(SyntaxErrors) {
+    JSON::Document document;
+    CHECK_FALSE(document.parse("[ { \"a\": 1, } ]"));
+    CHECK_FALSE(document.getErrorMessage().empty());
+    CHECK_FALSE(document.parse("{}\n{}"));
+    CHECK_EQ(document.getErrorMessage(), "found trailing garbage! (line: 2)");
+    CHECK_FALSE(document.parse("\"abc"));
+    CHECK_FALSE(document.parse("99999999999999999999"));
+    CHECK_FALSE(document.parse("[ tru ]"));
+    CHECK_TRUE(document.getRoot().isNull());
+
+    CHECK_TRUE(document.parse(" [ +1, 1e3 ] "));
+    CHECK_EQ(document.getRoot().getElement(0)->getIntegerValue(), 1);
+    CHECK_EQ(document.getRoot().getElement(1)->getDoubleValue(), 1000.0);
+}
+
+
+TEST_MAIN(JSONDocument)
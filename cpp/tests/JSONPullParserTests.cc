@@ -0,0 +1,187 @@
+/** \brief Test cases for JSON::PullParser
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+#include "FileUtil.h"
+#include "JSON.h"
+#include "UnitTest.h"
+
+
+const std::string OADOI_ENTRIES(
+    "[\n"
+    "  { \"doi\": \"10.1/a\", \"best_oa_location\": { \"url\": \"https://example.com/a\", \"evidence\": \"open\", \"is_best\": true } },\n"
+    "  { \"other\": [ 1, 2.5, null, { \"doi\": \"ignored\" } ], \"doi\": \"10.1/b\", \"best_oa_location\": { \"url\": \"\\u00fc\" } }\n"
+    "]\n");
+
+
+TEST(Events) {
+    const FileUtil::AutoTempFile json_file("/tmp/JSONPullParserTests", ".json");
+    FileUtil::WriteStringOrDie(json_file.getFilePath(), "{ \"a\": [ 1, -2.5, \"x\" ], \"b\": { \"c\": true, \"d\": null } }");
+
+    JSON::PullParser parser(json_file.getFilePath());
+    CHECK_FALSE(parser.isJSONLines());
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::OBJECT_START);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::LABEL);
+    CHECK_EQ(parser.getLabel(), "a");
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::ARRAY_START);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::INTEGER_VALUE);
+    CHECK_EQ(parser.getIntegerValue(), 1);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::DOUBLE_VALUE);
+    CHECK_EQ(parser.getDoubleValue(), -2.5);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::STRING_VALUE);
+    CHECK_EQ(parser.getStringValue(), "x");
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::ARRAY_END);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::LABEL);
+    CHECK_EQ(parser.getDepth(), 1u);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::OBJECT_START);
+    CHECK_EQ(parser.getDepth(), 2u);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::LABEL);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::BOOLEAN_VALUE);
+    CHECK_TRUE(parser.getBooleanValue());
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::LABEL);
+    CHECK_EQ(parser.getLabel(), "d");
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::NULL_VALUE);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::OBJECT_END);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::OBJECT_END);
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::END_OF_DOCUMENT);
+}
+
+
+TEST(ExtractStrings) {
+    const FileUtil::AutoTempFile json_file("/tmp/JSONPullParserTests", ".json");
+    FileUtil::WriteStringOrDie(json_file.getFilePath(), OADOI_ENTRIES);
+
+    JSON::PullParser parser(json_file.getFilePath());
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::ARRAY_START);
+
+    const std::vector<std::string> paths{ "/doi", "/best_oa_location/url", "/best_oa_location/evidence", "/best_oa_location/is_best" };
+    std::vector<std::string> values;
+    JSON::PullParser::EventType element_start_event;
+    CHECK_TRUE(parser.getNextElement(&element_start_event));
+    parser.extractStrings(element_start_event, paths, &values);
+    CHECK_EQ(values.size(), 4u);
+    CHECK_EQ(values[0], "10.1/a");
+    CHECK_EQ(values[1], "https://example.com/a");
+    CHECK_EQ(values[2], "open");
+    CHECK_EQ(values[3], "true");
+
+    CHECK_TRUE(parser.getNextElement(&element_start_event));
+    parser.extractStrings(element_start_event, paths, &values);
+    CHECK_EQ(values[0], "10.1/b");
+    CHECK_EQ(values[1], "ü");
+    CHECK_EQ(values[2], "");
+
+    CHECK_FALSE(parser.getNextElement(&element_start_event));
+    CHECK_EQ(parser.getNextEvent(), JSON::PullParser::END_OF_DOCUMENT);
+}
+
+
+TEST(DescendAndParseValue) {
+    const FileUtil::AutoTempFile json_file("/tmp/JSONPullParserTests", ".json");
+    FileUtil::WriteStringOrDie(json_file.getFilePath(), OADOI_ENTRIES);
+
+    JSON::PullParser parser(json_file.getFilePath());
+    JSON::PullParser::EventType start_event;
+    CHECK_TRUE(parser.descend("/1/other/3", &start_event));
+    CHECK_EQ(start_event, JSON::PullParser::OBJECT_START);
+    const auto node(parser.parseValue(start_event));
+    CHECK_EQ(JSON::LookupString("/doi", node), "ignored");
+
+    JSON::PullParser parser2(json_file.getFilePath());
+    CHECK_FALSE(parser2.descend("/2", &start_event));
+}
+
+
+TEST(JSONLines) {
+    CHECK_TRUE(JSON::PullParser::IsJSONLinesFile("x.jsonl"));
+    CHECK_TRUE(JSON::PullParser::IsJSONLinesFile("x.ndjson.gz"));
+    CHECK_FALSE(JSON::PullParser::IsJSONLinesFile("x.json"));
+
+    const FileUtil::AutoTempFile json_lines_file("/tmp/JSONPullParserTests", ".jsonl");
+    FileUtil::WriteStringOrDie(json_lines_file.getFilePath(), "{\"doi\": \"1\"}\n{\"doi\": \"2\"}\n\n{\"doi\": 3}\n");
+
+    JSON::PullParser parser(json_lines_file.getFilePath());
+    CHECK_TRUE(parser.isJSONLines());
+    std::vector<std::string> dois, values;
+    JSON::PullParser::EventType element_start_event;
+    while (parser.getNextElement(&element_start_event)) {
+        parser.extractStrings(element_start_event, { "/doi" }, &values);
+        dois.emplace_back(values[0]);
+    }
+    CHECK_EQ(dois.size(), 3u);
+    CHECK_EQ(dois[2], "3");
+}
+
+
+TEST(JSONLinesWithNestedRootPath) {
+    const FileUtil::AutoTempFile json_lines_file("/tmp/JSONPullParserTests", ".jsonl");
+    FileUtil::WriteStringOrDie(json_lines_file.getFilePath(), "[{\"data\": [{\"doi\": \"1\"}, {\"doi\": \"2\"}], \"x\": [1]}]\n"
+                                                              "[{\"total\": 1, \"data\": [{\"doi\": \"3\"}]}, {}]\n");
+
+    JSON::PullParser parser(json_lines_file.getFilePath());
+    std::vector<std::string> dois, values;
+    for (;;) {
+        JSON::PullParser::EventType root_start_event;
+        CHECK_TRUE(parser.descend("/0/data", &root_start_event));
+        if (root_start_event == JSON::PullParser::END_OF_DOCUMENT)
+            break;
+
+        CHECK_EQ(root_start_event, JSON::PullParser::ARRAY_START);
+        JSON::PullParser::EventType element_start_event;
+        while (parser.getNextElement(&element_start_event)) {
+            parser.extractStrings(element_start_event, { "/doi" }, &values);
+            dois.emplace_back(values[0]);
+        }
+
+        // Skip the rest of the line:
+        while (parser.getDepth() > 0)
+            parser.getNextEvent();
+    }
+    CHECK_EQ(dois.size(), 3u);
+    CHECK_EQ(dois[0], "1");
+    CHECK_EQ(dois[2], "3");
+}
+
+
+TEST(SyntaxErrors) {
+    const FileUtil::AutoTempFile json_file("/tmp/JSONPullParserTests", ".json");
+    FileUtil::WriteStringOrDie(json_file.getFilePath(), "[ { \"a\": 1, } ]");
+
+    JSON::PullParser parser(json_file.getFilePath());
+    JSON::PullParser::EventType start_event(parser.getNextEvent());
+    bool caught_exception(false);
+    try {
+        parser.skipValue(start_event);
+    } catch (const std::runtime_error &) {
+        caught_exception = true;
+    }
+    CHECK_TRUE(caught_exception);
+
+    FileUtil::WriteStringOrDie(json_file.getFilePath(), "{} {}");
+    JSON::PullParser parser2(json_file.getFilePath());
+    parser2.skipValue(parser2.getNextEvent());
+    caught_exception = false;
+    try {
+        parser2.getNextEvent();
+    } catch (const std::runtime_error &) {
+        caught_exception = true;
+    }
+    CHECK_TRUE(caught_exception);
+}
+
+
+TEST_MAIN(JSONPullParser)
@@ -19,8 +19,10 @@
  */
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <cstdlib>
+#include "CompressedFile.h"
 #include "MARC.h"
 #include "UnitTest.h"
 
@@ -71,4 +73,59 @@ TEST(binary_large_record) {
 }
 
 
+TEST(compressed_read_write_compare) {
+    std::vector<MARC::Record> test_records;
+    std::unique_ptr<MARC::Reader> reader(MARC::Reader::Factory("data/marc_record_test.mrc"));
+    while (MARC::Record record = reader->read())
+        test_records.emplace_back(record);
+
+    // Copies of the test records w/ distinct control numbers that fill several compressed frames:
+    std::vector<MARC::Record> records;
+    size_t total_size(0);
+    while (total_size < 3 * CompressedFile::FRAME_SIZE) {
+        for (auto record : test_records) {
+            record.replaceField("001", "TEST" + std::to_string(records.size()));
+            total_size += record.toBinaryString().length();
+            records.emplace_back(record);
+        }
+    }
+
+    for (const std::string output_filename : { "/tmp/default.out.mrc.zst", "/tmp/default.out.mrc.gz", "/tmp/default.out.xml.zst" }) {
+        std::unique_ptr<MARC::Writer> writer(MARC::Writer::Factory(output_filename));
+        for (const auto &record : records)
+            writer->write(record);
+        writer.reset();
+
+        std::unique_ptr<MARC::Reader> compressed_reader(MARC::Reader::Factory(output_filename));
+        std::unordered_map<std::string, off_t> control_number_to_offset_map;
+        CHECK_EQ(MARC::CollectRecordOffsets(compressed_reader.get(), &control_number_to_offset_map), records.size());
+        CHECK_TRUE(control_number_to_offset_map[records.back().getControlNumber()] > off_t(2 * CompressedFile::FRAME_SIZE));
+
+        // Read the records back in reverse order to exercise seeking in the compressed data:
+        for (auto record(records.crbegin()); record != records.crend(); ++record) {
+            CHECK_TRUE(compressed_reader->seek(control_number_to_offset_map[record->getControlNumber()]));
+            CHECK_EQ(compressed_reader->read().toBinaryString(), record->toBinaryString());
+        }
+    }
+}
+
+
+TEST(xml_escaping) {
+    std::unique_ptr<MARC::Reader> reader(MARC::Reader::Factory("data/default.mrc"));
+    MARC::Record record(reader->read());
+    record.insertField("TST", { { 'a', "<Tom & \"Jerry\">" }, { 'b', "It's a long title w/o metacharacters, really!" } });
+
+    const std::string xml(record.toString(MARC::Record::RecordFormat::MARC_XML));
+    CHECK_TRUE(xml.find("<subfield code=\"a\">&lt;Tom &amp; &quot;Jerry&quot;&gt;</subfield>\n") != std::string::npos);
+    CHECK_TRUE(xml.find("<subfield code=\"b\">It&apos;s a long title w/o metacharacters, really!</subfield>\n") != std::string::npos);
+
+    std::unique_ptr<MARC::Writer> writer(MARC::Writer::Factory("/tmp/default.out.xml"));
+    writer->write(record);
+    writer.reset();
+
+    std::unique_ptr<MARC::Reader> xml_reader(MARC::Reader::Factory("/tmp/default.out.xml"));
+    CHECK_EQ(xml_reader->read().toBinaryString(), record.toBinaryString());
+}
+
+
 TEST_MAIN(MarcReaderAndWriter)
@@ -153,4 +153,42 @@ TEST(getLanguageCode) {
 }
 
 
+TEST(calcChecksum) {
+    std::unique_ptr<MARC::Reader> reader(MARC::Reader::Factory("data/marc_record_test.mrc"));
+    const MARC::Record record(reader->read());
+
+    for (const auto checksum_type : { MARC::ChecksumType::SHA1, MARC::ChecksumType::FAST }) {
+        MARC::Record record_copy(record);
+        record_copy.insertField("650", { { 'a', "Zebra" } });
+        record_copy.insertField("650", { { 'a', "Aardvark" } });
+        MARC::Record reordered_record_copy(record);
+        reordered_record_copy.insertField("650", { { 'a', "Aardvark" } });
+        reordered_record_copy.insertField("650", { { 'a', "Zebra" } });
+        CHECK_EQ(MARC::CalcChecksum(record_copy, { "001" }, true, checksum_type),
+                 MARC::CalcChecksum(reordered_record_copy, { "001" }, true, checksum_type));
+        CHECK_NE(MARC::CalcChecksum(record, { "001" }, true, checksum_type),
+                 MARC::CalcChecksum(record_copy, { "001" }, true, checksum_type));
+
+        // Identical fields must not cancel each other out:
+        reordered_record_copy.insertField("650", { { 'a', "Zebra" } });
+        CHECK_NE(MARC::CalcChecksum(record_copy, { "001" }, true, checksum_type),
+                 MARC::CalcChecksum(reordered_record_copy, { "001" }, true, checksum_type));
+        reordered_record_copy.insertField("650", { { 'a', "Zebra" } });
+        CHECK_NE(MARC::CalcChecksum(record_copy, { "001" }, true, checksum_type),
+                 MARC::CalcChecksum(reordered_record_copy, { "001" }, true, checksum_type));
+
+        // Excluded and local fields don't count:
+        const std::string checksum(MARC::CalcChecksum(record_copy, { "001", "500" }, true, checksum_type));
+        record_copy.insertField("LOK", { { 'a', "local" } });
+        record_copy.insertField("500", { { 'a', "note" } });
+        CHECK_EQ(MARC::CalcChecksum(record_copy, { "001", "500" }, true, checksum_type), checksum);
+        CHECK_NE(MARC::CalcChecksum(record_copy, { "001", "500" }, false, checksum_type), checksum);
+    }
+
+    CHECK_EQ(MARC::CalcChecksum(record).size(), 20u);
+    CHECK_EQ(MARC::CalcChecksum(record, { "001" }, true, MARC::ChecksumType::FAST).size(), 16u);
+    CHECK_EQ(record.begin()->getHash(MARC::ChecksumType::FAST).size(), 16u);
+}
+
+
 TEST_MAIN(MARC::Record)
@@ -0,0 +1,131 @@
+/** \brief Test cases for MarcTagIndex
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FileUtil.h"
+#include "MARC.h"
+#include "MarcTagIndex.h"
+#include "UnitTest.h"
+
+
+// More than 2^16 records, so that we get several chunks w/ array as well as bitmap containers.
+const unsigned RECORD_COUNT(70000);
+
+
+TEST(CreateAndLookup) {
+    const FileUtil::AutoTempFile marc_file("/tmp/MarcTagIndexTests", ".mrc");
+    {
+        const auto marc_writer(MARC::Writer::Factory(marc_file.getFilePath()));
+        for (unsigned i(0); i < RECORD_COUNT; ++i) {
+            MARC::Record record(MARC::Record::TypeOfRecord::LANGUAGE_MATERIAL, MARC::Record::BibliographicLevel::MONOGRAPH_OR_ITEM,
+                                "PPN" + std::to_string(i));
+            record.insertField("245", { { 'a', "Title " + std::to_string(i) } });
+            if (i % 1000 == 0) {
+                record.insertField("LOK", { { '0', "852" } });
+                record.insertField("LOK", { { '0', "935" } });
+            }
+            if (i == 5 or i == RECORD_COUNT - 1)
+                record.insertField("856", { { 'u', "https://example.com/" + std::to_string(i) } });
+            marc_writer->write(record);
+        }
+    }
+
+    const FileUtil::AutoTempFile index_file("/tmp/MarcTagIndexTests", ".index");
+    {
+        const auto marc_reader(MARC::Reader::Factory(marc_file.getFilePath()));
+        MarcTagIndex::Create(marc_reader.get(), index_file.getFilePath());
+    }
+    const MarcTagIndex tag_index(index_file.getFilePath());
+    CHECK_EQ(tag_index.getRecordCount(), RECORD_COUNT);
+    CHECK_TRUE(tag_index.isUpToDate(marc_file.getFilePath()));
+
+    std::vector<uint32_t> record_ordinals;
+    tag_index.getRecordsWithAnyTag({ "245" }, &record_ordinals);
+    CHECK_EQ(record_ordinals.size(), RECORD_COUNT);
+
+    tag_index.getRecordsWithAnyTag({ "LOK" }, &record_ordinals);
+    CHECK_EQ(record_ordinals.size(), RECORD_COUNT / 1000);
+    CHECK_EQ(record_ordinals[1], 1000u);
+
+    tag_index.getRecordsWithAnyTag({ "856", "999" }, &record_ordinals);
+    CHECK_EQ(record_ordinals.size(), 2u);
+    CHECK_EQ(record_ordinals[0], 5u);
+    CHECK_EQ(record_ordinals[1], RECORD_COUNT - 1);
+
+    tag_index.getRecordsWithAnyTag({ "LOK", "856" }, &record_ordinals);
+    CHECK_EQ(record_ordinals.size(), RECORD_COUNT / 1000 + 2);
+
+    const auto marc_reader(MARC::Reader::Factory(marc_file.getFilePath()));
+    CHECK_TRUE(marc_reader->seek(tag_index.getRecordOffset(RECORD_COUNT - 1)));
+    CHECK_EQ(marc_reader->read().getControlNumber(), "PPN" + std::to_string(RECORD_COUNT - 1));
+    CHECK_TRUE(marc_reader->seek(tag_index.getRecordOffset(5)));
+    CHECK_EQ(marc_reader->read().getControlNumber(), "PPN5");
+
+    CHECK_EQ(tag_index.getRecordCount("LOK"), RECORD_COUNT / 1000);
+    CHECK_EQ(tag_index.getRecordCount("999"), 0u);
+    const std::vector<MARC::Tag> tags(tag_index.getTags());
+    CHECK_EQ(tags.size(), 4u);
+    CHECK_EQ(tags.front().toString(), "001");
+    CHECK_EQ(tags.back().toString(), "LOK");
+}
+
+
+TEST(ReadTaggedRecords) {
+    const FileUtil::AutoTempFile marc_file("/tmp/MarcTagIndexTests", ".mrc");
+    {
+        const auto marc_writer(MARC::Writer::Factory(marc_file.getFilePath()));
+        for (unsigned i(0); i < 1000; ++i) {
+            MARC::Record record(MARC::Record::TypeOfRecord::LANGUAGE_MATERIAL, MARC::Record::BibliographicLevel::MONOGRAPH_OR_ITEM,
+                                "PPN" + std::to_string(i));
+            record.insertField("245", { { 'a', "Title " + std::to_string(i) } });
+            if (i % 100 == 0 or i == 101)
+                record.insertField("SPR", { { 'a', "1" } });
+            marc_writer->write(record);
+        }
+    }
+
+    const auto marc_reader(MARC::Reader::Factory(marc_file.getFilePath()));
+    CHECK_TRUE(MarcTagIndex::OpenSidecar(marc_file.getFilePath()) == nullptr);
+    std::vector<std::string> control_numbers_without_index;
+    {
+        TaggedRecordReader tagged_record_reader(marc_reader.get(), { "SPR" });
+        CHECK_TRUE(not tagged_record_reader.usesTagIndex());
+        while (const MARC::Record record = tagged_record_reader.read())
+            control_numbers_without_index.emplace_back(record.getControlNumber());
+    }
+    CHECK_EQ(control_numbers_without_index.size(), 11u);
+    CHECK_EQ(control_numbers_without_index[2], "PPN101");
+
+    const std::string sidecar_path(MarcTagIndex::GetSidecarPath(marc_file.getFilePath()));
+    const FileUtil::AutoDeleteFile sidecar_file(sidecar_path);
+    CHECK_EQ(sidecar_path, marc_file.getFilePath() + ".tag_index");
+    marc_reader->rewind();
+    MarcTagIndex::Create(marc_reader.get(), sidecar_path);
+    CHECK_TRUE(MarcTagIndex::OpenSidecar(marc_file.getFilePath()) != nullptr);
+
+    marc_reader->rewind();
+    std::vector<std::string> control_numbers_with_index;
+    {
+        TaggedRecordReader tagged_record_reader(marc_reader.get(), { "SPR" });
+        CHECK_TRUE(tagged_record_reader.usesTagIndex());
+        while (const MARC::Record record = tagged_record_reader.read())
+            control_numbers_with_index.emplace_back(record.getControlNumber());
+    }
+    CHECK_TRUE(control_numbers_with_index == control_numbers_without_index);
+}
+
+
+TEST_MAIN(MarcTagIndex)
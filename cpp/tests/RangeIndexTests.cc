@@ -0,0 +1,127 @@
+/** \brief Test cases for RangeUtil::RangeIndex
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "FileUtil.h"
+#include "RangeUtil.h"
+#include "UnitTest.h"
+
+
+using Range = RangeUtil::RangeIndex::Range;
+
+
+const std::map<std::string, std::vector<Range>> GND_CODES_TO_BIBLE_RANGES{
+    { "4037994-4", { Range(1000000, 1999999) } },                              // Genesis
+    { "4048904-1", { Range(30006001, 30006013), Range(30006001, 30006013) } }, // The Lord's Prayer, w/ a duplicate
+    { "4071867-2", { Range(30005003, 30007029), Range(2000000, 2999999) } },   // Unsorted
+    { "1064390793", { Range(30005001, 30005012) } },
+};
+
+
+TEST(CreateAndGetRanges) {
+    const FileUtil::AutoTempFile authority_file("/tmp/RangeIndexTests", ".mrc");
+    FileUtil::WriteStringOrDie(authority_file.getFilePath(), "authority data");
+    const std::string index_path(authority_file.getFilePath() + RangeUtil::BIBLE_RANGE_INDEX_SUFFIX);
+    RangeUtil::RangeIndex::Create(index_path, authority_file.getFilePath(), 8, GND_CODES_TO_BIBLE_RANGES);
+
+    {
+        const auto range_index(RangeUtil::RangeIndex::OpenSidecar(authority_file.getFilePath(), RangeUtil::BIBLE_RANGE_INDEX_SUFFIX));
+        CHECK_TRUE(range_index != nullptr);
+        CHECK_EQ(range_index->getKeyCount(), 4u);
+        CHECK_EQ(range_index->getRangeCount(), 5u);
+
+        CHECK_EQ(range_index->getRanges("4048904-1").size(), 1u);
+        const auto ranges(range_index->getRanges("4071867-2"));
+        CHECK_EQ(ranges.size(), 2u);
+        CHECK_EQ(range_index->toString(ranges[0]), "02000000:02999999");
+        CHECK_EQ(range_index->toString(ranges[1]), "30005003:30007029");
+        CHECK_TRUE(range_index->getRanges("4071867").empty());
+        CHECK_TRUE(range_index->getRanges("4071867-3").empty());
+        CHECK_TRUE(range_index->isUpToDate(authority_file.getFilePath()));
+    }
+
+    // Changing the size of the authority data invalidates the index:
+    FileUtil::WriteStringOrDie(authority_file.getFilePath(), "more authority data");
+    CHECK_TRUE(RangeUtil::RangeIndex::OpenSidecar(authority_file.getFilePath(), RangeUtil::BIBLE_RANGE_INDEX_SUFFIX) == nullptr);
+    CHECK_TRUE(RangeUtil::RangeIndex::OpenSidecar(authority_file.getFilePath(), RangeUtil::CANON_LAW_RANGE_INDEX_SUFFIX) == nullptr);
+    ::unlink(index_path.c_str());
+}
+
+
+TEST(FindOverlappingRanges) {
+    const FileUtil::AutoTempFile authority_file("/tmp/RangeIndexTests", ".mrc");
+    const std::string index_path(authority_file.getFilePath() + RangeUtil::BIBLE_RANGE_INDEX_SUFFIX);
+    RangeUtil::RangeIndex::Create(index_path, authority_file.getFilePath(), 8, GND_CODES_TO_BIBLE_RANGES);
+    RangeUtil::RangeIndex range_index(index_path);
+
+    std::vector<RangeUtil::RangeIndex::KeyAndRange> keys_and_ranges;
+    range_index.findOverlappingRanges(30006005, 30006005, &keys_and_ranges);
+    CHECK_EQ(keys_and_ranges.size(), 2u);
+    CHECK_EQ(keys_and_ranges[0].key_, "4071867-2");
+    CHECK_EQ(keys_and_ranges[1].key_, "4048904-1");
+
+    range_index.findOverlappingRanges(30005012, 30005012, &keys_and_ranges);
+    CHECK_EQ(keys_and_ranges.size(), 2u);
+    CHECK_EQ(keys_and_ranges[0].key_, "1064390793");
+    CHECK_EQ(keys_and_ranges[1].key_, "4071867-2");
+
+    // The long first range must be found although the ranges in between end before the query starts:
+    range_index.findOverlappingRanges(1500000, 2000000, &keys_and_ranges);
+    CHECK_EQ(keys_and_ranges.size(), 2u);
+    CHECK_EQ(keys_and_ranges[0].key_, "4037994-4");
+
+    range_index.findOverlappingRanges(3000000, 30004999, &keys_and_ranges);
+    CHECK_TRUE(keys_and_ranges.empty());
+    range_index.findOverlappingRanges(30007030, 99999999, &keys_and_ranges);
+    CHECK_TRUE(keys_and_ranges.empty());
+
+    // Compare against a linear scan for all queries w/ boundaries at interesting places:
+    std::set<uint32_t> boundaries{ 0, 99999999 };
+    for (const auto &[gnd_code, ranges] : GND_CODES_TO_BIBLE_RANGES) {
+        for (const auto &range : ranges)
+            boundaries.insert({ range.start_ - 1, range.start_, range.end_, range.end_ + 1 });
+    }
+    for (const auto start : boundaries) {
+        for (const auto end : boundaries) {
+            if (end < start)
+                continue;
+
+            std::set<std::pair<std::string, uint32_t>> expected_keys_and_starts;
+            for (const auto &[gnd_code, ranges] : GND_CODES_TO_BIBLE_RANGES) {
+                for (const auto &range : ranges) {
+                    if (range.start_ <= end and range.end_ >= start)
+                        expected_keys_and_starts.emplace(gnd_code, range.start_);
+                }
+            }
+
+            range_index.findOverlappingRanges(start, end, &keys_and_ranges);
+            std::set<std::pair<std::string, uint32_t>> keys_and_starts;
+            for (const auto &key_and_range : keys_and_ranges)
+                keys_and_starts.emplace(std::string(key_and_range.key_), key_and_range.range_.start_);
+            CHECK_EQ(keys_and_ranges.size(), expected_keys_and_starts.size());
+            CHECK_TRUE(keys_and_starts == expected_keys_and_starts);
+        }
+    }
+    ::unlink(index_path.c_str());
+}
+
+
+TEST_MAIN(RangeIndex)
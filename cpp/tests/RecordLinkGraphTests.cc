@@ -0,0 +1,101 @@
+/** \brief Test cases for RecordLinkGraph
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FileUtil.h"
+#include "MARC.h"
+#include "RecordLinkGraph.h"
+#include "UnitTest.h"
+
+
+TEST(CreateAndFindRecords) {
+    const FileUtil::AutoTempFile marc_file("/tmp/RecordLinkGraphTests", ".mrc");
+    {
+        const auto marc_writer(MARC::Writer::Factory(marc_file.getFilePath()));
+
+        MARC::Record serial(MARC::Record::TypeOfRecord::LANGUAGE_MATERIAL, MARC::Record::BibliographicLevel::SERIAL, "200");
+        serial.insertField("008", "991231c19709999xx");
+        serial.insertField("776", { { 'i', "Online-Ausg." }, { 'w', "(DE-627)300" } });
+        marc_writer->write(serial);
+
+        MARC::Record article(MARC::Record::TypeOfRecord::LANGUAGE_MATERIAL, MARC::Record::BibliographicLevel::SERIAL_COMPONENT_PART,
+                             "100");
+        article.insertField("008", "991231s2019    xx");
+        article.insertField("773", { { 'i', "In" }, { 'w', "(DE-627)200" } });
+        article.insertField("830", { { 'a', "Series" }, { 'w', "(DE-627)400" } });
+        article.insertField("830", { { 'a', "Other Series" }, { 'w', "(DE-600)123" } });
+        marc_writer->write(article);
+
+        MARC::Record online_serial(MARC::Record::TypeOfRecord::LANGUAGE_MATERIAL, MARC::Record::BibliographicLevel::SERIAL, "300");
+        online_serial.insertField("007", "cr uuu---uuuuu");
+        online_serial.insertField("008", "991231c19uu9999xx");
+        online_serial.insertField("776", { { 'i', "Druckausg." }, { 'w', "(DE-627)200" } });
+        marc_writer->write(online_serial);
+
+        // A second record w/ an already seen PPN must be ignored:
+        MARC::Record duplicate(MARC::Record::TypeOfRecord::LANGUAGE_MATERIAL, MARC::Record::BibliographicLevel::MONOGRAPH_OR_ITEM, "100");
+        duplicate.insertField("008", "991231s1850    xx");
+        marc_writer->write(duplicate);
+    }
+
+    const FileUtil::AutoTempFile graph_file("/tmp/RecordLinkGraphTests", ".graph");
+    {
+        const auto marc_reader(MARC::Reader::Factory(marc_file.getFilePath()));
+        RecordLinkGraph::Create(marc_reader.get(), graph_file.getFilePath());
+    }
+    const RecordLinkGraph link_graph(graph_file.getFilePath());
+    CHECK_EQ(link_graph.getRecordCount(), 3u);
+    CHECK_EQ(link_graph.getNodeCount(), 4u);
+
+    RecordLinkGraph::Node node;
+    CHECK_TRUE(link_graph.findRecord("100", &node));
+    CHECK_EQ(node.getPPN(), "100");
+    CHECK_TRUE(node.isRecord());
+    CHECK_FALSE(node.isElectronicResource());
+    CHECK_EQ(node.getBibliographicLevel(), 'b');
+    CHECK_EQ(node.getPublicationYear(), 2019u);
+    const auto superior_ppns(node.getSuperiorPPNs());
+    CHECK_EQ(superior_ppns.size(), 2u);
+    CHECK_EQ(superior_ppns[0], "200");
+    CHECK_EQ(superior_ppns[1], "400");
+    CHECK_TRUE(node.getCrossLinkPPNs().empty());
+
+    CHECK_TRUE(link_graph.findRecord("200", &node));
+    CHECK_EQ(node.getBibliographicLevel(), 's');
+    CHECK_EQ(node.getPublicationYear(), 1970u);
+    CHECK_TRUE(node.getSuperiorPPNs().empty());
+    CHECK_EQ(node.getCrossLinkPPNs().size(), 1u);
+    CHECK_EQ(node.getCrossLinkPPNs()[0], "300");
+
+    CHECK_TRUE(link_graph.findRecord("300", &node));
+    CHECK_TRUE(node.isElectronicResource());
+    CHECK_EQ(node.getPublicationYear(), 0u);
+    CHECK_EQ(node.getCrossLinkPPNs().size(), 1u);
+    CHECK_EQ(node.getCrossLinkPPNs()[0], "200");
+
+    // "400" is only the target of a link:
+    CHECK_FALSE(link_graph.findRecord("400", &node));
+    node = link_graph.getNode(3);
+    CHECK_EQ(node.getPPN(), "400");
+    CHECK_FALSE(node.isRecord());
+    CHECK_TRUE(node.getSuperiorPPNs().empty());
+
+    CHECK_FALSE(link_graph.findRecord("10", &node));
+    CHECK_FALSE(link_graph.findRecord("999", &node));
+}
+
+
+TEST_MAIN(RecordLinkGraph)
@@ -0,0 +1,99 @@
+/** \brief Test cases for RegexSet
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RegexMatcher.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+
+std::string ExtractRequiredLiteral(const std::string &pattern, const unsigned options = ThreadSafeRegexMatcher::ENABLE_UTF8) {
+    bool case_insensitive;
+    return RegexSet::ExtractRequiredLiteral(pattern, options, &case_insensitive);
+}
+
+
+} // unnamed namespace
+
+
+TEST(RequiredLiterals) {
+    CHECK_EQ(ExtractRequiredLiteral("Bibel"), "Bibel");
+    CHECK_EQ(ExtractRequiredLiteral("^Die (Bibel|Tora)$"), "Die ");
+    CHECK_EQ(ExtractRequiredLiteral("colou?r"), "colo");
+    CHECK_EQ(ExtractRequiredLiteral("ab+cdef"), "cdef");
+    CHECK_EQ(ExtractRequiredLiteral("x{0,3}yz"), "yz");
+    CHECK_EQ(ExtractRequiredLiteral("\\d+\\.\\d+ Seiten"), " Seiten");
+    CHECK_EQ(ExtractRequiredLiteral("\\x41BC"), "BC");
+    CHECK_EQ(ExtractRequiredLiteral("\\p{Lu}ab"), "ab");
+    CHECK_EQ(ExtractRequiredLiteral("[a-z]+ und [0-9]"), " und ");
+    CHECK_EQ(ExtractRequiredLiteral("\\Qa.b\\E*"), "a.");
+    CHECK_EQ(ExtractRequiredLiteral("Über"), "Über");
+
+    // No required literal at all:
+    CHECK_EQ(ExtractRequiredLiteral("Bibel|Tora"), "");
+    CHECK_EQ(ExtractRequiredLiteral("(?x) a b c"), "");
+    CHECK_EQ(ExtractRequiredLiteral(".*"), "");
+
+    // Case-insensitive patterns yield lowercase ASCII literals w/o "k" and "s":
+    bool case_insensitive;
+    CHECK_EQ(RegexSet::ExtractRequiredLiteral("(?i)ThEoLoGie", ThreadSafeRegexMatcher::ENABLE_UTF8, &case_insensitive), "theologie");
+    CHECK_TRUE(case_insensitive);
+    CHECK_EQ(RegexSet::ExtractRequiredLiteral("Rezension", ThreadSafeRegexMatcher::CASE_INSENSITIVE, &case_insensitive), "rezen");
+    CHECK_TRUE(case_insensitive);
+    CHECK_EQ(RegexSet::ExtractRequiredLiteral("Rezension", ThreadSafeRegexMatcher::ENABLE_UTF8, &case_insensitive), "Rezension");
+    CHECK_FALSE(case_insensitive);
+}
+
+
+TEST(Candidates) {
+    const RegexSet regex_set({ "Bibel", "^Die (Bibel|Tora)$", "(?i)REVIEW", "^[0-9]+$", "Bibelwissenschaft" });
+    std::vector<size_t> candidate_indices;
+
+    regex_set.getCandidates("Die Bibel", &candidate_indices);
+    CHECK_EQ(candidate_indices, std::vector<size_t>({ 0, 1, 3 }));
+
+    regex_set.getCandidates("Book Review", &candidate_indices);
+    CHECK_EQ(candidate_indices, std::vector<size_t>({ 2, 3 }));
+
+    regex_set.getCandidates("Einführung in die Bibelwissenschaft", &candidate_indices);
+    CHECK_EQ(candidate_indices, std::vector<size_t>({ 0, 3, 4 }));
+
+    regex_set.getCandidates("Einführung in die Bibelwissenschaft", &candidate_indices, /* first_pattern_index = */ 4);
+    CHECK_EQ(candidate_indices, std::vector<size_t>({ 4 }));
+}
+
+
+TEST(Matching) {
+    const RegexSet regex_set({ "Bibel", "^Die (Bibel|Tora)$", "(?i)REVIEW", "^[0-9]+$", "Bibelwissenschaft" });
+    std::vector<size_t> matched_pattern_indices;
+
+    regex_set.match("Die Bibel", &matched_pattern_indices);
+    CHECK_EQ(matched_pattern_indices, std::vector<size_t>({ 0, 1 }));
+
+    regex_set.match("12345", &matched_pattern_indices);
+    CHECK_EQ(matched_pattern_indices, std::vector<size_t>({ 3 }));
+
+    CHECK_EQ(regex_set.findFirstMatch("Book Review"), 2u);
+    CHECK_EQ(regex_set.findFirstMatch("Die Bibelwissenschaft", 1), 4u);
+    CHECK_EQ(regex_set.findFirstMatch("Koran"), RegexSet::NO_MATCH);
+    CHECK_TRUE(regex_set.matchAny("Zur Bibel"));
+    CHECK_FALSE(regex_set.matchAny("Zur Tora"));
+}
+
+
+TEST_MAIN(RegexSet)
@@ -89,4 +89,57 @@ TEST(Iterators) {
 }
 
 
+TEST(SubfieldsView) {
+    const MARC::Record::Field field(MARC::Tag("245"), std::string("10\x1F" "aTitle\x1F" "b\x1F" "cAuthor\x1F" "aSecond"));
+    const auto subfields_view(field.getSubfieldsView());
+
+    std::string codes, values;
+    for (const auto subfield : subfields_view) {
+        codes += subfield.code_;
+        values += std::string(subfield.value_) + "|";
+    }
+    CHECK_EQ(codes, "abca");
+    CHECK_EQ(values, "Title||Author|Second|");
+    CHECK_TRUE(subfields_view.hasSubfield('c'));
+    CHECK_FALSE(subfields_view.hasSubfield('d'));
+    CHECK_EQ(subfields_view.getFirstSubfieldWithCode('a'), "Title");
+    CHECK_EQ(subfields_view.getFirstSubfieldWithCode('d'), "");
+    CHECK_EQ(subfields_view.toSubfields().size(), 4);
+
+    CHECK_TRUE(MARC::Record::Field(MARC::Tag("245"), std::string("10")).getSubfieldsView().empty());
+    CHECK_TRUE(MARC::Record::Field(MARC::Tag("245"), std::string("10\x1F")).getSubfieldsView().empty());
+}
+
+
+TEST(InPlaceSubfieldEdits) {
+    MARC::Record::Field field(MARC::Tag("650"), std::string(" 7\x1F" "aOld\x1F" "2gnd\x1F" "aOld"));
+    CHECK_TRUE(field.replaceFirstSubfieldValue('a', "New"));
+    CHECK_EQ(field.getContents(), " 7\x1F" "aNew\x1F" "2gnd\x1F" "aOld");
+    CHECK_FALSE(field.replaceFirstSubfieldValue('x', "New"));
+
+    const std::string replacement("Replacement"), empty;
+    CHECK_TRUE(field.replaceSubfieldValues("a", [&](const std::string_view value) { return value == "Old" ? &replacement : nullptr; }));
+    CHECK_EQ(field.getContents(), " 7\x1F" "aNew\x1F" "2gnd\x1F" "aReplacement");
+    CHECK_TRUE(field.replaceSubfieldValues("a", [&](const std::string_view) { return &empty; }));
+    CHECK_EQ(field.getContents(), " 7\x1F" "2gnd");
+
+    field.insertOrReplaceSubfield('a', "Inserted");
+    CHECK_EQ(field.getContents(), " 7\x1F" "2gnd\x1F" "aInserted");
+    field.insertOrReplaceSubfield('0', "Zero");
+    CHECK_EQ(field.getContents(), " 7\x1F" "0Zero\x1F" "2gnd\x1F" "aInserted");
+
+    CHECK_TRUE(field.deleteFirstSubfieldWithCode('2'));
+    CHECK_EQ(field.getContents(), " 7\x1F" "0Zero\x1F" "aInserted");
+    CHECK_FALSE(field.deleteFirstSubfieldWithCode('2'));
+
+    // Empty values never leave an empty subfield behind:
+    CHECK_TRUE(field.replaceFirstSubfieldValue('0', ""));
+    CHECK_EQ(field.getContents(), " 7\x1F" "aInserted");
+    field.insertOrReplaceSubfield('b', "");
+    CHECK_EQ(field.getContents(), " 7\x1F" "aInserted");
+    field.insertOrReplaceSubfield('a', "");
+    CHECK_EQ(field.getContents(), " 7");
+}
+
+
 TEST_MAIN(MARC::Subfields)
@@ -0,0 +1,126 @@
+/** \brief Test cases for the TimeUtil date parsers
+ *
+ *  \copyright 2026 Universitätsbibliothek Tübingen.  All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include "TimeUtil.h"
+#include "UnitTest.h"
+
+
+TEST(TimeGm) {
+    struct tm tm;
+    std::memset(&tm, 0, sizeof tm);
+    tm.tm_year = 94;
+    tm.tm_mon = 10;
+    tm.tm_mday = 6;
+    tm.tm_hour = 8;
+    tm.tm_min = 49;
+    tm.tm_sec = 37;
+    CHECK_EQ(TimeUtil::TimeGm(tm), 784111777);
+
+    tm.tm_year = -100; // 1800 w/ a negative time_t
+    tm.tm_mon = 1;
+    tm.tm_mday = 29;
+    CHECK_EQ(TimeUtil::TimeGm(tm), ::timegm(&tm));
+}
+
+
+TEST(ParseRFC3339DateTime) {
+    time_t date_time;
+    CHECK_TRUE(TimeUtil::ParseRFC3339DateTime("1985-04-12T23:20:50Z", &date_time));
+    CHECK_EQ(date_time, 482196050);
+    CHECK_TRUE(TimeUtil::ParseRFC3339DateTime("1985-04-12t23:20:50z", &date_time));
+    CHECK_EQ(date_time, 482196050);
+    CHECK_TRUE(TimeUtil::ParseRFC3339DateTime("1985-04-12T23:20:50.52Z", &date_time));
+    CHECK_EQ(date_time, 482196051);
+
+    // Not in canonical form, handled by strptime(3):
+    CHECK_TRUE(TimeUtil::ParseRFC3339DateTime("1985-4-12T23:20:50Z", &date_time));
+    CHECK_EQ(date_time, 482196050);
+
+    CHECK_FALSE(TimeUtil::ParseRFC3339DateTime("1985-04-12 23:20:50Z", &date_time));
+    CHECK_FALSE(TimeUtil::ParseRFC3339DateTime("1985-13-12T23:20:50Z", &date_time));
+}
+
+
+TEST(ParseRFC1123DateTime) {
+    time_t date_time;
+    CHECK_TRUE(TimeUtil::ParseRFC1123DateTime("Sun, 06 Nov 1994 08:49:37 GMT", &date_time));
+    CHECK_EQ(date_time, 784111777);
+    CHECK_TRUE(TimeUtil::ParseRFC1123DateTime("6 NOV 94 08:49:37 UT", &date_time));
+    CHECK_EQ(date_time, 784111777);
+    CHECK_TRUE(TimeUtil::ParseRFC1123DateTime("  06 Nov 1994 08:49 +0000  ", &date_time));
+    CHECK_EQ(date_time, 784111740);
+
+    CHECK_FALSE(TimeUtil::ParseRFC1123DateTime("Sun, 06 Nov 1994 08:49:37 XYZ", &date_time));
+    CHECK_FALSE(TimeUtil::ParseRFC1123DateTime("Sun, 32 Nov 1994 08:49:37 GMT", &date_time));
+    CHECK_FALSE(TimeUtil::ParseRFC1123DateTime("Sun, 06 Nox 1994 08:49:37 GMT", &date_time));
+}
+
+
+TEST(StringToBrokenDownTime) {
+    unsigned year, month, day, hour, minute, second;
+    int hour_offset, minute_offset;
+    bool is_definitely_zulu_time;
+    CHECK_EQ(TimeUtil::StringToBrokenDownTime("2017-03-05T10:11:12-01:30", &year, &month, &day, &hour, &minute, &second, &hour_offset,
+                                              &minute_offset, &is_definitely_zulu_time),
+             9u);
+    CHECK_EQ(year, 2017u);
+    CHECK_EQ(month, 3u);
+    CHECK_EQ(day, 5u);
+    CHECK_EQ(hour, 10u);
+    CHECK_EQ(minute, 11u);
+    CHECK_EQ(second, 12u);
+    CHECK_EQ(hour_offset, -1);
+    CHECK_EQ(minute_offset, -30);
+    CHECK_TRUE(is_definitely_zulu_time);
+
+    CHECK_EQ(TimeUtil::StringToBrokenDownTime("2017-03-05", &year, &month, &day, &hour, &minute, &second, &hour_offset,
+                                              &minute_offset, &is_definitely_zulu_time),
+             3u);
+    CHECK_EQ(hour, 0u);
+    CHECK_FALSE(is_definitely_zulu_time);
+
+    // Out of range, handled by sscanf(3) which doesn't care:
+    CHECK_EQ(TimeUtil::StringToBrokenDownTime("2017-13-05 10:11:12", &year, &month, &day, &hour, &minute, &second, &hour_offset,
+                                              &minute_offset, &is_definitely_zulu_time),
+             7u);
+    CHECK_EQ(month, 13u);
+    CHECK_EQ(second, 12u);
+}
+
+
+TEST(StringToStructTm) {
+    struct tm tm;
+    CHECK_TRUE(TimeUtil::StringToStructTm(&tm, "850412", "%y%m%d"));
+    CHECK_EQ(tm.tm_year, 85);
+    CHECK_EQ(tm.tm_mon, 3);
+    CHECK_EQ(tm.tm_mday, 12);
+    CHECK_EQ(tm.tm_wday, 5);
+    CHECK_EQ(tm.tm_yday, 101);
+    CHECK_TRUE(TimeUtil::StringToStructTm(&tm, "680101", "%y%m%d"));
+    CHECK_EQ(tm.tm_year, 168);
+
+    CHECK_TRUE(TimeUtil::StringToStructTm(&tm, "1985-04-12T23:20:50", TimeUtil::ISO_8601_FORMAT));
+    CHECK_EQ(tm.tm_hour, 23);
+    CHECK_EQ(tm.tm_sec, 50);
+
+    CHECK_FALSE(TimeUtil::StringToStructTm(&tm, "851312", "%y%m%d"));
+    CHECK_FALSE(TimeUtil::StringToStructTm(&tm, "1985-04-12T23:20:50Z", TimeUtil::ISO_8601_FORMAT));
+}
+
+
+TEST_MAIN(TimeUtil)
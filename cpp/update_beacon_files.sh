@@ -37,6 +37,10 @@ do
             mv $beacon_file_key_temp $beacon_file_key
             sed -i -e 's/#FORMAT: GND-BEACON/#FORMAT: BEACON/g' $beacon_file_key #kalliope.staatsbibliothek-berlin.lr.beacon
             sed -i -e '1{/^$/d}' $beacon_file_key #replace first line if it is a blank line (e.g. ADB/NDB)
+            # add_authority_beacon_information loads "${beacon_file_key}.bin" instead of parsing the Beacon file:
+            if ! create_beacon_binary_forms $beacon_file_key; then
+                error_message+="Failed to create the binary form of ${beacon_file_key}."$'\n'
+            fi
         fi
     else
        error_message+=$'Failed to download the Beacon file for $beacon_file_key.\n'
@@ -29,7 +29,6 @@
 #include "FullTextCache.h"
 #include "MARC.h"
 #include "MediaTypeUtil.h"
-#include "OCR.h"
 #include "PdfUtil.h"
 #include "Semaphore.h"
 #include "SmartDownloader.h"
@@ -165,7 +164,10 @@ std::string ConvertToPlainText(const std::string &media_type, const std::string
 
     if (StringUtil::StartsWith(media_type, "application/pdf")) {
         if (PdfUtil::PdfDocContainsNoText(document)) {
-            if (not PdfUtil::GetTextFromImagePDF(document, tesseract_language_code, &extracted_text, pdf_extraction_timeout)) {
+            // create_full_text_db runs many of us in parallel, so we must not OCR on more than one thread:
+            if (not PdfUtil::GetTextFromImagePDF(document, tesseract_language_code, &extracted_text, pdf_extraction_timeout,
+                                                 /* thread_count = */ 1))
+            {
                 *error_message = "Failed to extract text from an image PDF!";
                 LOG_WARNING(*error_message);
                 return "";
@@ -177,7 +179,7 @@ std::string ConvertToPlainText(const std::string &media_type, const std::string
     }
 
     if (media_type == "image/jpeg" or media_type == "image/png") {
-        if (OCR(document, &extracted_text, tesseract_language_code) != 0) {
+        if (not PdfUtil::GetTextFromImageData(document, tesseract_language_code, &extracted_text)) {
             *error_message = "Failed to extract text by using OCR on " + media_type;
             LOG_WARNING(*error_message);
             return "";
@@ -455,6 +457,8 @@ bool ProcessRecord(MARC::Reader * const marc_reader, const std::string &marc_out
 
 
 int Main(int argc, char *argv[]) {
+    PdfUtil::LimitTesseractThreads();
+
     unsigned pdf_extraction_timeout(PdfUtil::DEFAULT_PDF_EXTRACTION_TIMEOUT);
     if (argc > 1 and StringUtil::StartsWith(argv[1], "--pdf-extraction-timeout=")) {
         if (not StringUtil::ToNumber(argv[1] + __builtin_strlen("--pdf-extraction-timeout="), &pdf_extraction_timeout)
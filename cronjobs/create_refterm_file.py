@@ -106,7 +106,7 @@ def CreateFulltextIdsFile(ids_output_file, log_file_name):
 
 # Create the database for matching fulltext to vufind entries
 def CreateMatchDB(title_marc_data, log_file_name):
-    util.ExecOrDie("/usr/local/bin/create_match_db", [ title_marc_data ], log_file_name, setsid=False);
+    util.ExecOrDie("/usr/local/bin/create_match_db", [ "--bulk-load", title_marc_data ], log_file_name, setsid=False);
 
 
 def CreateLogFile():